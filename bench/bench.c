@@ -0,0 +1,209 @@
+/**
+ * Harness for the lib's benchmarks, and the suite's entry point
+ *
+ * Usage: fraction_bench [prefix...]
+ *
+ * If any prefix is given, only benchmarks whose names start with one of
+ * them are run. Results are output to stdout, as JSON.
+ *
+ * @file bench/bench.c
+ */
+/* clock_gettime isn't declared on strict ISO C builds */
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+volatile int64_t bench_sink = 0;
+
+/** State of the random generator (xorshift64) */
+static uint64_t bench_state = 1;
+/** Prefixes of the selected benchmarks */
+static char **ppBenchPrefixes = 0;
+/** Number of selected prefixes (if 0, every benchmark is run) */
+static int bench_numPrefixes = 0;
+/** Whether any benchmark was already output */
+static int bench_isFirst = 1;
+
+/**
+ * Retrieve the current time, in nanoseconds
+ *
+ * @return The time, from an arbitrary (but fixed) point
+ */
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Compare two doubles, for sorting them
+ *
+ * @param  [ in]pA One of the doubles
+ * @param  [ in]pB The other double
+ * @return         Negative if A < B, 0 if they are equal, positive otherwise
+ */
+static int bench_compare(const void *pA, const void *pB) {
+    double a, b;
+
+    a = *(const double*)pA;
+    b = *(const double*)pB;
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * Reset the random generator to a fixed seed
+ *
+ * @param  [ in]seed The seed (which musn't be zero)
+ */
+void bench_seed(uint64_t seed) {
+    bench_state = seed;
+}
+
+/**
+ * Retrieve a random number
+ *
+ * @return The number
+ */
+uint32_t bench_rand() {
+    bench_state ^= bench_state << 13;
+    bench_state ^= bench_state >> 7;
+    bench_state ^= bench_state << 17;
+
+    return (uint32_t)(bench_state >> 32);
+}
+
+/**
+ * Retrieve a random, non-zero, term with a controlled magnitude
+ *
+ * @param  [ in]bits       Number of bits of the term's magnitude (up to 62)
+ * @param  [ in]isSigned   Whether the term may be negative
+ * @return                 The term, on [1, 2^bits) (or its negative)
+ */
+int64_t bench_randTerm(int bits, int isSigned) {
+    uint64_t val;
+
+    val = ((uint64_t)bench_rand() << 32) | bench_rand();
+    val &= ((uint64_t)1 << bits) - 1;
+    if (val == 0) {
+        val = 1;
+    }
+
+    if (isSigned && (bench_rand() & 1)) {
+        return -(int64_t)val;
+    }
+    return (int64_t)val;
+}
+
+/**
+ * Retrieve whether a benchmark (or group of benchmarks) was selected
+ *
+ * @param  [ in]pPrefix The benchmark's name (or the prefix of a group)
+ * @return              1 if it should be run, 0 otherwise
+ */
+int bench_isSelected(const char *pPrefix) {
+    int i;
+
+    if (bench_numPrefixes == 0) {
+        return 1;
+    }
+
+    i = 0;
+    while (i < bench_numPrefixes) {
+        size_t len;
+
+        /* Either may be the prefix of the other, so groups are selected by
+         * the prefix of any of its benchmarks */
+        len = strlen(ppBenchPrefixes[i]);
+        if (strlen(pPrefix) < len) {
+            len = strlen(pPrefix);
+        }
+        if (strncmp(ppBenchPrefixes[i], pPrefix, len) == 0) {
+            return 1;
+        }
+        i++;
+    }
+
+    return 0;
+}
+
+/**
+ * Run a benchmark and output its results
+ *
+ * @param  [ in]pName      The benchmark's name
+ * @param  [ in]fn         The benchmark
+ * @param  [ in]pCtx       The benchmark's context
+ * @param  [ in]numOps     Number of operations on each sample
+ * @param  [ in]numSamples Number of samples
+ */
+void bench_run(const char *pName, benchFunc fn, void *pCtx, int numOps,
+        int numSamples) {
+    double *pSamples, p50, p90, p99;
+    int i;
+
+    if (!bench_isSelected(pName)) {
+        return;
+    }
+
+    pSamples = (double*)malloc(sizeof(double) * numSamples);
+    if (!pSamples) {
+        fprintf(stderr, "Failed to run benchmark '%s'\n", pName);
+        return;
+    }
+
+    /* Warm up caches, branch predictors and pools */
+    fn(pCtx, numOps);
+
+    i = 0;
+    while (i < numSamples) {
+        double start;
+
+        start = bench_now();
+        fn(pCtx, numOps);
+        pSamples[i] = (bench_now() - start) / numOps;
+        i++;
+    }
+    qsort(pSamples, numSamples, sizeof(double), bench_compare);
+
+    p50 = pSamples[(numSamples - 1) * 50 / 100];
+    p90 = pSamples[(numSamples - 1) * 90 / 100];
+    p99 = pSamples[(numSamples - 1) * 99 / 100];
+
+    if (!bench_isFirst) {
+        printf(",\n");
+    }
+    bench_isFirst = 0;
+    printf("    {\"name\": \"%s\", \"samples\": %d, \"opsPerSample\": %d, "
+            "\"nsPerOp\": {\"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, "
+            "\"p99\": %.3f, \"max\": %.3f}, "
+            "\"opsPerSec\": {\"p50\": %.0f, \"p90\": %.0f, \"p99\": %.0f}}",
+            pName, numSamples, numOps, pSamples[0], p50, p90, p99,
+            pSamples[numSamples - 1], 1e9 / p50, 1e9 / p90, 1e9 / p99);
+    fflush(stdout);
+
+    free(pSamples);
+}
+
+int main(int argc, char *argv[]) {
+    ppBenchPrefixes = argv + 1;
+    bench_numPrefixes = argc - 1;
+
+    printf("{\n  \"library\": \"libfraction\",\n  \"benchmarks\": [\n");
+
+    benchOps_run();
+    benchAlloc_run();
+    benchInit_run();
+    benchWorkload_run();
+    benchConvert_run();
+
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
+
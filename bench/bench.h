@@ -0,0 +1,112 @@
+/**
+ * Minimal harness for the lib's benchmarks
+ *
+ * Every benchmark is a function that executes a given number of operations.
+ * It's run once to warm up and then a fixed number of times (each run being
+ * a sample), and the time per operation of every sample is reported as
+ * percentiles. Results are output as a single JSON document, so they may be
+ * compared between releases.
+ *
+ * Operands are generated by a fixed-seed generator, so every run of the
+ * suite executes exactly the same operations.
+ *
+ * @file bench/bench.h
+ */
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+
+/** Number of random operands generated for each benchmark */
+#define BENCH_NUM_OPERANDS 1024
+/** Default number of samples taken from each benchmark */
+#define BENCH_NUM_SAMPLES 31
+
+/**
+ * Function that executes a benchmark
+ *
+ * @param  [ in]pCtx   The benchmark's context
+ * @param  [ in]numOps Number of operations that should be executed
+ */
+typedef void (*benchFunc)(void *pCtx, int numOps);
+
+/**
+ * Sink for results that must not be optimized away
+ */
+extern volatile int64_t bench_sink;
+
+/**
+ * Reset the random generator to a fixed seed, so each group of benchmarks
+ * gets the same operands regardless of which groups were run before it
+ *
+ * @param  [ in]seed The seed (which musn't be zero)
+ */
+void bench_seed(uint64_t seed);
+
+/**
+ * Retrieve a random number
+ *
+ * @return The number
+ */
+uint32_t bench_rand();
+
+/**
+ * Retrieve a random, non-zero, term with a controlled magnitude
+ *
+ * @param  [ in]bits       Number of bits of the term's magnitude (up to 62)
+ * @param  [ in]isSigned   Whether the term may be negative
+ * @return                 The term, on [1, 2^bits) (or its negative)
+ */
+int64_t bench_randTerm(int bits, int isSigned);
+
+/**
+ * Retrieve whether a benchmark (or group of benchmarks) was selected, so
+ * expensive setups may be skipped
+ *
+ * @param  [ in]pPrefix The benchmark's name (or the prefix of a group)
+ * @return              1 if it should be run, 0 otherwise
+ */
+int bench_isSelected(const char *pPrefix);
+
+/**
+ * Run a benchmark and output its results
+ *
+ * @param  [ in]pName      The benchmark's name
+ * @param  [ in]fn         The benchmark
+ * @param  [ in]pCtx       The benchmark's context
+ * @param  [ in]numOps     Number of operations on each sample
+ * @param  [ in]numSamples Number of samples
+ */
+void bench_run(const char *pName, benchFunc fn, void *pCtx, int numOps,
+        int numSamples);
+
+/**
+ * Benchmark every constructor, arithmetic operation and converter
+ */
+void benchOps_run();
+
+/**
+ * Benchmark the allocation and release of fractions (from one or many
+ * threads)
+ */
+void benchAlloc_run();
+
+/**
+ * Benchmark the manager's initialization, the generation of primes and
+ * factoring
+ */
+void benchInit_run();
+
+/**
+ * Benchmark end-to-end workloads, like long chains of operations
+ */
+void benchWorkload_run();
+
+/**
+ * Benchmark the conversion of floating point numbers into fractions (and of
+ * arrays of fractions into floating and fixed point numbers)
+ */
+void benchConvert_run();
+
+#endif /* __BENCH_H__ */
+
@@ -0,0 +1,191 @@
+/**
+ * Benchmarks for the allocation and release of fractions
+ *
+ * Fractions are retrieved in batches (so the pools must actually hand out
+ * distinct objects) and then released, as a workload that creates many
+ * temporaries would. On concurrent managers, every thread runs the same
+ * churn at once.
+ *
+ * @file bench/benchAlloc.c
+ */
+#include "bench.h"
+
+#include <fraction/fraction.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Maximum number of fractions retrieved before they are released */
+#define ALLOC_MAX_BATCH 4096
+/** Maximum number of threads on the concurrent benchmarks */
+#define ALLOC_MAX_THREADS 4
+
+/** Context of the allocation benchmarks */
+struct stAllocCtx {
+    /** The fraction manager */
+    fractionManager *pMng;
+    /** The pool of fractions */
+    fractionPool *pPool;
+    /** Number of fractions retrieved before they are released */
+    int batchSize;
+    /** Number of threads running the benchmark */
+    int numThreads;
+};
+typedef struct stAllocCtx allocCtx;
+
+/** Arguments for each thread of the concurrent benchmarks */
+struct stAllocThread {
+    /** The benchmark's context */
+    allocCtx *pCtx;
+    /** Number of operations executed by the thread */
+    int numOps;
+};
+typedef struct stAllocThread allocThread;
+
+static void benchAlloc_manager(void *pArg, int numOps) {
+    fraction *ppFracs[ALLOC_MAX_BATCH];
+    allocCtx *pCtx;
+
+    pCtx = (allocCtx*)pArg;
+
+    while (numOps > 0) {
+        int i, len;
+
+        len = pCtx->batchSize;
+        if (len > numOps) {
+            len = numOps;
+        }
+
+        for (i = 0; i < len; i++) {
+            fractionManager_igetFraction(&ppFracs[i], pCtx->pMng, i);
+        }
+        for (i = len - 1; i >= 0; i--) {
+            fractionManager_releaseFraction(ppFracs[i]);
+        }
+
+        numOps -= len;
+    }
+}
+
+static void benchAlloc_pool(void *pArg, int numOps) {
+    fractionHandle pHandles[ALLOC_MAX_BATCH];
+    allocCtx *pCtx;
+
+    pCtx = (allocCtx*)pArg;
+
+    while (numOps > 0) {
+        int i, len;
+
+        len = pCtx->batchSize;
+        if (len > numOps) {
+            len = numOps;
+        }
+
+        for (i = 0; i < len; i++) {
+            fractionPool_igetFraction(&pHandles[i], pCtx->pPool, i);
+        }
+        for (i = len - 1; i >= 0; i--) {
+            fractionPool_release(pCtx->pPool, pHandles[i]);
+        }
+
+        numOps -= len;
+    }
+}
+
+/**
+ * Run the manager's churn from a thread
+ *
+ * @param  [ in]pArg The thread's arguments
+ * @return           Always NULL
+ */
+static void* benchAlloc_thread(void *pArg) {
+    allocThread *pThread;
+
+    pThread = (allocThread*)pArg;
+    benchAlloc_manager(pThread->pCtx, pThread->numOps);
+    fractionManager_flushThreadCache(pThread->pCtx->pMng);
+
+    return 0;
+}
+
+static void benchAlloc_concurrent(void *pArg, int numOps) {
+    pthread_t pThreads[ALLOC_MAX_THREADS];
+    allocThread pArgs[ALLOC_MAX_THREADS];
+    allocCtx *pCtx;
+    int i;
+
+    pCtx = (allocCtx*)pArg;
+
+    /* Every thread executes its share of the operations, so the time per
+     * operation is comparable to the single threaded case */
+    for (i = 0; i < pCtx->numThreads; i++) {
+        pArgs[i].pCtx = pCtx;
+        pArgs[i].numOps = numOps / pCtx->numThreads;
+        pthread_create(&pThreads[i], 0, benchAlloc_thread, &pArgs[i]);
+    }
+    for (i = 0; i < pCtx->numThreads; i++) {
+        pthread_join(pThreads[i], 0);
+    }
+}
+
+/**
+ * Benchmark the allocation and release of fractions (from one or many
+ * threads)
+ */
+void benchAlloc_run() {
+    fractionManagerConfig config;
+    allocCtx ctx;
+    char pName[64];
+    int irv;
+
+    if (!bench_isSelected("alloc")) {
+        return;
+    }
+
+    irv = fractionManager_init(&ctx.pMng, 1000/*maxNumberChecked*/);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to initialize the fraction manager\n");
+        return;
+    }
+    irv = fractionPool_init(&ctx.pPool, ctx.pMng, ALLOC_MAX_BATCH);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to initialize the fraction pool\n");
+        fractionManager_clean(&ctx.pMng);
+        return;
+    }
+
+    ctx.batchSize = 1;
+    while (ctx.batchSize <= ALLOC_MAX_BATCH) {
+        sprintf(pName, "alloc.manager.batch%d", ctx.batchSize);
+        bench_run(pName, benchAlloc_manager, &ctx, 1 << 18,
+                BENCH_NUM_SAMPLES);
+        sprintf(pName, "alloc.pool.batch%d", ctx.batchSize);
+        bench_run(pName, benchAlloc_pool, &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+        ctx.batchSize *= 16;
+    }
+
+    fractionPool_clean(&ctx.pPool);
+    fractionManager_clean(&ctx.pMng);
+
+    fractionManager_getDefaultConfig(&config);
+    config.maxNumberChecked = 1000;
+    config.isConcurrent = 1;
+    irv = fractionManager_initConfig(&ctx.pMng, &config);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to initialize the concurrent manager\n");
+        return;
+    }
+
+    ctx.batchSize = 256;
+    ctx.numThreads = 1;
+    while (ctx.numThreads <= ALLOC_MAX_THREADS) {
+        sprintf(pName, "alloc.concurrent.threads%d", ctx.numThreads);
+        bench_run(pName, benchAlloc_concurrent, &ctx, 1 << 20,
+                BENCH_NUM_SAMPLES);
+        ctx.numThreads *= 2;
+    }
+
+    fractionManager_clean(&ctx.pMng);
+}
+
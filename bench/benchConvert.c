@@ -0,0 +1,313 @@
+/**
+ * Benchmarks for converting floating point numbers into fractions
+ *
+ * The decimal constructors (which scale the value by 10000 and simplify the
+ * result) are compared against the continued fraction ones, on a few sets of
+ * values: decimals (i.e., values with up to 4 decimal digits, which the
+ * decimal constructors represent exactly), random doubles and dyadic values
+ * (which may be converted exactly). Each operation retrieves and releases a
+ * fraction, and they are named as "convert.<constructor>.<values>".
+ *
+ * The other way around, converting whole arrays of fractions (as
+ * "convert.array.<converter>") is compared against converting them one at a
+ * time (as "convert.array.<converter>.scalar").
+ *
+ * @file bench/benchConvert.c
+ */
+#include "bench.h"
+
+#include <fraction/fraction.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Constructors that may be benchmarked */
+enum enConvertOp {
+    CONVERT_DGET = 0,
+    CONVERT_FGET,
+    CONVERT_DAPPROX,
+    CONVERT_DAPPROX_DEN1000,
+    CONVERT_DAPPROX_ERR1E6,
+    CONVERT_FAPPROX,
+    CONVERT_DEXACT,
+    CONVERT_MAX
+};
+
+/** Name of each constructor, as reported */
+static const char *pConvertNames[CONVERT_MAX] = {
+    "dget",
+    "fget",
+    "dapprox",
+    "dapprox.den1000",
+    "dapprox.err1e-6",
+    "fapprox",
+    "dexact"
+};
+
+/** Context of the conversions */
+struct stConvertCtx {
+    /** The fraction manager */
+    fractionManager *pMng;
+    /** The constructor being benchmarked */
+    int op;
+    /** Values converted */
+    double pValues[BENCH_NUM_OPERANDS];
+    float pFloats[BENCH_NUM_OPERANDS];
+};
+typedef struct stConvertCtx convertCtx;
+
+/** Context of the array conversions */
+struct stConvertArrayCtx {
+    /** The fractions converted */
+    fraction *ppFracs[BENCH_NUM_OPERANDS];
+    /** Converted values */
+    double pDoubles[BENCH_NUM_OPERANDS];
+    float pFloats[BENCH_NUM_OPERANDS];
+    int64_t pFixed[BENCH_NUM_OPERANDS];
+    /** Number of decimal digits on fixed points */
+    int digits;
+};
+typedef struct stConvertArrayCtx convertArrayCtx;
+
+/** Shortcut for the index of an operation's value */
+#define CONVERT_IDX(i) ((i) & (BENCH_NUM_OPERANDS - 1))
+
+static void benchConvert_fraction(void *pArg, int numOps) {
+    convertCtx *pCtx;
+    int i;
+
+    pCtx = (convertCtx*)pArg;
+
+    for (i = 0; i < numOps; i++) {
+        fraction *pTmp;
+        double val;
+        int irv;
+
+        val = pCtx->pValues[CONVERT_IDX(i)];
+        switch (pCtx->op) {
+        case CONVERT_DGET:
+            irv = fractionManager_dgetFraction(&pTmp, pCtx->pMng, val);
+            break;
+        case CONVERT_FGET:
+            irv = fractionManager_fgetFraction(&pTmp, pCtx->pMng,
+                    pCtx->pFloats[CONVERT_IDX(i)]);
+            break;
+        case CONVERT_DAPPROX:
+            irv = fractionManager_dapproxFraction(&pTmp, pCtx->pMng, val, 0,
+                    0);
+            break;
+        case CONVERT_DAPPROX_DEN1000:
+            irv = fractionManager_dapproxFraction(&pTmp, pCtx->pMng, val,
+                    1000, -1);
+            break;
+        case CONVERT_DAPPROX_ERR1E6:
+            irv = fractionManager_dapproxFraction(&pTmp, pCtx->pMng, val, 0,
+                    1e-6);
+            break;
+        case CONVERT_FAPPROX:
+            irv = fractionManager_fapproxFraction(&pTmp, pCtx->pMng,
+                    pCtx->pFloats[CONVERT_IDX(i)], 0, 0);
+            break;
+        default:
+            irv = fractionManager_dexactFraction(&pTmp, pCtx->pMng, val);
+            break;
+        }
+
+        if (irv == 0) {
+            fractionManager_releaseFraction(pTmp);
+        }
+    }
+}
+
+static void benchConvert_dconvertArray(void *pArg, int numOps) {
+    convertArrayCtx *pCtx;
+    int i;
+
+    pCtx = (convertArrayCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        fraction_dconvertArray(pCtx->pDoubles, pCtx->ppFracs,
+                BENCH_NUM_OPERANDS);
+    }
+    bench_sink += (int64_t)pCtx->pDoubles[0];
+}
+
+static void benchConvert_dconvertScalar(void *pArg, int numOps) {
+    convertArrayCtx *pCtx;
+    int i;
+
+    pCtx = (convertArrayCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        int j;
+
+        for (j = 0; j < BENCH_NUM_OPERANDS; j++) {
+            fraction_dconvert(&pCtx->pDoubles[j], pCtx->ppFracs[j]);
+        }
+    }
+    bench_sink += (int64_t)pCtx->pDoubles[0];
+}
+
+static void benchConvert_fconvertArray(void *pArg, int numOps) {
+    convertArrayCtx *pCtx;
+    int i;
+
+    pCtx = (convertArrayCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        fraction_fconvertArray(pCtx->pFloats, pCtx->ppFracs,
+                BENCH_NUM_OPERANDS);
+    }
+    bench_sink += (int64_t)pCtx->pFloats[0];
+}
+
+static void benchConvert_fconvertScalar(void *pArg, int numOps) {
+    convertArrayCtx *pCtx;
+    int i;
+
+    pCtx = (convertArrayCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        int j;
+
+        for (j = 0; j < BENCH_NUM_OPERANDS; j++) {
+            fraction_fconvert(&pCtx->pFloats[j], pCtx->ppFracs[j]);
+        }
+    }
+    bench_sink += (int64_t)pCtx->pFloats[0];
+}
+
+static void benchConvert_fxconvertArray(void *pArg, int numOps) {
+    convertArrayCtx *pCtx;
+    int i;
+
+    pCtx = (convertArrayCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        fraction_fxconvertArray(pCtx->pFixed, pCtx->ppFracs, pCtx->digits,
+                FRACTION_ROUND_HALF_EVEN, BENCH_NUM_OPERANDS);
+    }
+    bench_sink += pCtx->pFixed[0];
+}
+
+/**
+ * Benchmark the conversion of arrays of fractions
+ *
+ * @param  [ in]pMng The fraction manager
+ */
+static void benchConvert_runArrays(fractionManager *pMng) {
+    convertArrayCtx *pCtx;
+    int i;
+
+    pCtx = (convertArrayCtx*)malloc(sizeof(convertArrayCtx));
+    if (!pCtx) {
+        return;
+    }
+
+    bench_seed(0xa77a);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        if (fractionManager_getFraction(&pCtx->ppFracs[i], pMng,
+                (int)bench_randTerm(30, 1/*isSigned*/),
+                (int)bench_randTerm(20, 0/*isSigned*/)) != 0) {
+            while (i > 0) {
+                i--;
+                fractionManager_releaseFraction(pCtx->ppFracs[i]);
+            }
+            free(pCtx);
+            return;
+        }
+    }
+
+    bench_run("convert.array.dconvert", benchConvert_dconvertArray, pCtx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("convert.array.dconvert.scalar", benchConvert_dconvertScalar,
+            pCtx, 1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("convert.array.fconvert", benchConvert_fconvertArray, pCtx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("convert.array.fconvert.scalar", benchConvert_fconvertScalar,
+            pCtx, 1 << 18, BENCH_NUM_SAMPLES);
+    pCtx->digits = 6;
+    bench_run("convert.array.fxconvert.d6", benchConvert_fxconvertArray, pCtx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    pCtx->digits = 18;
+    bench_run("convert.array.fxconvert.d18", benchConvert_fxconvertArray,
+            pCtx, 1 << 18, BENCH_NUM_SAMPLES);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        fractionManager_releaseFraction(pCtx->ppFracs[i]);
+    }
+    free(pCtx);
+}
+
+/**
+ * Benchmark every constructor on the current set of values
+ *
+ * @param  [ in]pCtx    The context
+ * @param  [ in]pValues Name of the set of values
+ * @param  [ in]lastOp  The last constructor benchmarked
+ */
+static void benchConvert_runValues(convertCtx *pCtx, const char *pValues,
+        int lastOp) {
+    char pName[64];
+    int i;
+
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        pCtx->pFloats[i] = (float)pCtx->pValues[i];
+    }
+
+    pCtx->op = CONVERT_DGET;
+    while (pCtx->op <= lastOp) {
+        sprintf(pName, "convert.%s.%s", pConvertNames[pCtx->op], pValues);
+        bench_run(pName, benchConvert_fraction, pCtx, 1 << 16,
+                BENCH_NUM_SAMPLES);
+        pCtx->op++;
+    }
+}
+
+/**
+ * Benchmark the conversion of floating point numbers into fractions (and
+ * of arrays of fractions into floating and fixed point numbers)
+ */
+void benchConvert_run() {
+    convertCtx ctx;
+    int i;
+
+    if (!bench_isSelected("convert")) {
+        return;
+    }
+
+    if (fractionManager_init(&ctx.pMng, 1000/*maxNumberChecked*/) != 0) {
+        return;
+    }
+
+    /* Values with up to 4 decimal digits, below 839 */
+    bench_seed(0xdec1);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pValues[i] = bench_randTerm(23, 1/*isSigned*/) / 10000.0;
+    }
+    benchConvert_runValues(&ctx, "decimal", CONVERT_FAPPROX);
+
+    /* Random values below 1000 (which can't be represented exactly) */
+    bench_seed(0xd0b1);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pValues[i] = (double)bench_randTerm(30, 1/*isSigned*/) /
+                (double)(bench_randTerm(20, 0/*isSigned*/) + (1 << 20));
+    }
+    benchConvert_runValues(&ctx, "random", CONVERT_FAPPROX);
+
+    /* Values with a power of two denominator */
+    bench_seed(0xd1ad);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pValues[i] = (double)bench_randTerm(20, 1/*isSigned*/) /
+                (double)(1 << (bench_rand() % 11));
+    }
+    benchConvert_runValues(&ctx, "dyadic", CONVERT_DEXACT);
+
+    if (bench_isSelected("convert.array")) {
+        benchConvert_runArrays(ctx.pMng);
+    }
+
+    fractionManager_clean(&ctx.pMng);
+}
+
@@ -0,0 +1,218 @@
+/**
+ * Benchmarks for the manager's initialization, the generation of primes and
+ * factoring
+ *
+ * Initialization is dominated by sieving the list of primes, so it's
+ * measured for many values of maxNumberChecked (and with or without a table
+ * of smallest prime factors). Those are slow, so each sample initializes a
+ * single manager. Managers that map a cached list of primes (generated
+ * beforehand) are measured as "init.cached.max<n>".
+ *
+ * Cold starts (i.e., the first manager initialized by a process) are measured
+ * by forking a child that initializes a single manager and exits, as
+ * "init.coldstart.max<n>". "init.coldstart.none" only forks and exits, so
+ * it's the baseline of the others. On a lib built with EMBED_PRIMES=yes,
+ * managers that don't check more than EMBED_PRIMES_MAX don't sieve at all.
+ *
+ * @file bench/benchInit.c
+ */
+#include "bench.h"
+
+#include <fraction/fraction.h>
+#include <fraction_internal/prime.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/** Number of factors on the factoring benchmarks */
+#define INIT_NUM_VALUES 4096
+
+/** Context of the initialization benchmarks */
+struct stInitCtx {
+    /** Options used to initialize the manager */
+    fractionManagerConfig config;
+    /** Manager used to factor numbers */
+    fractionManager *pMng;
+    /** Numbers to be factored */
+    int pValues[INIT_NUM_VALUES];
+};
+typedef struct stInitCtx initCtx;
+
+static void benchInit_manager(void *pArg, int numOps) {
+    initCtx *pCtx;
+
+    pCtx = (initCtx*)pArg;
+
+    while (numOps > 0) {
+        fractionManager *pMng;
+
+        if (fractionManager_initConfig(&pMng, &pCtx->config) == 0) {
+            fractionManager_clean(&pMng);
+        }
+        numOps--;
+    }
+}
+
+static void benchInit_coldStart(void *pArg, int numOps) {
+    initCtx *pCtx;
+
+    pCtx = (initCtx*)pArg;
+
+    while (numOps > 0) {
+        pid_t pid;
+
+        pid = fork();
+        if (pid == 0) {
+            fractionManager *pMng;
+
+            if (pCtx->config.maxNumberChecked > 0 &&
+                    fractionManager_initConfig(&pMng, &pCtx->config) == 0) {
+                fractionManager_clean(&pMng);
+            }
+            _exit(0);
+        }
+        else if (pid > 0) {
+            waitpid(pid, 0, 0);
+        }
+        numOps--;
+    }
+}
+
+static void benchInit_sieve(void *pArg, int numOps) {
+    initCtx *pCtx;
+
+    pCtx = (initCtx*)pArg;
+
+    while (numOps > 0) {
+        int *pList, len;
+
+        if (prime_genPrimeListThreaded(&pList, &len,
+                pCtx->config.maxNumberChecked,
+                pCtx->config.numSieveThreads) == 0) {
+            bench_sink += len;
+            free(pList);
+        }
+        numOps--;
+    }
+}
+
+static void benchInit_factor(void *pArg, int numOps) {
+    int pFactors[FRACTION_MAX_FACTORS], pExps[FRACTION_MAX_FACTORS];
+    initCtx *pCtx;
+    int i;
+
+    pCtx = (initCtx*)pArg;
+
+    for (i = 0; i < numOps; i++) {
+        int num;
+
+        fractionManager_factor(pFactors, pExps, &num, pCtx->pMng,
+                pCtx->pValues[i & (INIT_NUM_VALUES - 1)]);
+        bench_sink += num;
+    }
+}
+
+/**
+ * Benchmark the manager's initialization, the generation of primes and
+ * factoring
+ */
+void benchInit_run() {
+    initCtx ctx;
+    char pName[64], pCachePath[64];
+    int i, max, numThreads;
+
+    if (!bench_isSelected("init") && !bench_isSelected("factor")) {
+        return;
+    }
+
+    sprintf(pCachePath, "/tmp/fraction_bench_%d.primes", (int)getpid());
+
+    fractionManager_getDefaultConfig(&ctx.config);
+    max = 1000;
+    while (max <= 100000000) {
+        int numSamples;
+
+        /* The biggest sieves take hundreds of milliseconds */
+        numSamples = BENCH_NUM_SAMPLES;
+        if (max >= 10000000) {
+            numSamples = 5;
+        }
+
+        ctx.config.maxNumberChecked = max;
+        ctx.config.numSieveThreads = 1;
+        ctx.config.spfLimit = 0;
+        sprintf(pName, "init.manager.max%d", max);
+        bench_run(pName, benchInit_manager, &ctx, 1, numSamples);
+        sprintf(pName, "init.sieve.max%d", max);
+        bench_run(pName, benchInit_sieve, &ctx, 1, numSamples);
+
+        sprintf(pName, "init.cached.max%d", max);
+        if (bench_isSelected(pName) &&
+                fractionManager_genPrimeCache(pCachePath, max, 4) == 0) {
+            ctx.config.pPrimeCachePath = pCachePath;
+            bench_run(pName, benchInit_manager, &ctx, 1, numSamples);
+            ctx.config.pPrimeCachePath = 0;
+            unlink(pCachePath);
+        }
+
+        if (max >= 1000000) {
+            for (numThreads = 2; numThreads <= 4; numThreads *= 2) {
+                ctx.config.numSieveThreads = numThreads;
+                sprintf(pName, "init.sieve.max%d.threads%d", max,
+                        numThreads);
+                bench_run(pName, benchInit_sieve, &ctx, 1, numSamples);
+            }
+        }
+
+        max *= 10;
+    }
+
+    /* Fork a new process for each manager (and a baseline, which doesn't
+     * initialize anything) */
+    ctx.config.numSieveThreads = 1;
+    ctx.config.spfLimit = 0;
+    ctx.config.maxNumberChecked = 0;
+    bench_run("init.coldstart.none", benchInit_coldStart, &ctx, 1,
+            BENCH_NUM_SAMPLES);
+    max = 1000;
+    while (max <= 1000000) {
+        ctx.config.maxNumberChecked = max;
+        sprintf(pName, "init.coldstart.max%d", max);
+        bench_run(pName, benchInit_coldStart, &ctx, 1, BENCH_NUM_SAMPLES);
+        max *= 10;
+    }
+
+    /* The table of smallest prime factors is initialized along the manager */
+    ctx.config.maxNumberChecked = 1000;
+    ctx.config.numSieveThreads = 1;
+    max = 1 << 16;
+    while (max <= (1 << 24)) {
+        ctx.config.spfLimit = max;
+        sprintf(pName, "init.manager.spf%d", max);
+        bench_run(pName, benchInit_manager, &ctx, 1, BENCH_NUM_SAMPLES);
+        max <<= 4;
+    }
+
+    /* Factor numbers below the table, either through it or through trial
+     * division */
+    bench_seed(0xfac7);
+    for (i = 0; i < INIT_NUM_VALUES; i++) {
+        ctx.pValues[i] = (int)bench_randTerm(20, 0/*isSigned*/);
+    }
+    ctx.config.maxNumberChecked = 1 << 10;
+    ctx.config.spfLimit = 0;
+    if (fractionManager_initConfig(&ctx.pMng, &ctx.config) == 0) {
+        bench_run("factor.trial.bits20", benchInit_factor, &ctx, 1 << 16,
+                BENCH_NUM_SAMPLES);
+        fractionManager_clean(&ctx.pMng);
+    }
+    ctx.config.spfLimit = 1 << 20;
+    if (fractionManager_initConfig(&ctx.pMng, &ctx.config) == 0) {
+        bench_run("factor.spf.bits20", benchInit_factor, &ctx, 1 << 16,
+                BENCH_NUM_SAMPLES);
+        fractionManager_clean(&ctx.pMng);
+    }
+}
+
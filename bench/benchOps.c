@@ -0,0 +1,719 @@
+/**
+ * Micro-benchmarks for every constructor, arithmetic operation and converter
+ *
+ * Each benchmark is run for operands of a controlled magnitude (i.e., terms
+ * with up to a given number of bits), and is named as
+ * "<type>.<operation>.bits<magnitude>".
+ *
+ * @file bench/benchOps.c
+ */
+#include "bench.h"
+
+#include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/** Operations that may be benchmarked */
+enum enBenchOp {
+    BENCH_GET = 0,
+    BENCH_SUM,
+    BENCH_SUB,
+    BENCH_MUL,
+    BENCH_DIV,
+    BENCH_ICONVERT,
+    BENCH_DCONVERT,
+    BENCH_DIVCONVERT,
+    BENCH_CMP,
+    BENCH_MAX
+};
+
+/** Name of each operation, as reported */
+static const char *pOpNames[BENCH_MAX] = {
+    "get",
+    "sum",
+    "sub",
+    "mul",
+    "div",
+    "iconvert",
+    "dconvert",
+    "divConvert",
+    "cmp"
+};
+
+/** Operands (and the reusable output) of every type */
+struct stOpsCtx {
+    /** The fraction manager */
+    fractionManager *pMng;
+    /** The pool of fractions */
+    fractionPool *pPool;
+    /** The operation being benchmarked */
+    int op;
+    /** Numerators of every operand (A at i and B at BENCH_NUM_OPERANDS + i) */
+    int64_t pNums[BENCH_NUM_OPERANDS * 2];
+    /** Denominators of every operand */
+    int64_t pDens[BENCH_NUM_OPERANDS * 2];
+    fraction *ppFracs[BENCH_NUM_OPERANDS * 2];
+    fraction *pFracOut;
+    fractionValue pValues[BENCH_NUM_OPERANDS * 2];
+    fractionValue valueOut;
+    fraction64 *ppFracs64[BENCH_NUM_OPERANDS * 2];
+    fraction64 *pFrac64Out;
+    fractionBig *ppFracsBig[BENCH_NUM_OPERANDS * 2];
+    fractionBig *pFracBigOut;
+    fractionFactored *ppFracsFactored[BENCH_NUM_OPERANDS * 2];
+    fractionFactored *pFracFactoredOut;
+    fractionHandle pHandles[BENCH_NUM_OPERANDS * 2];
+    fractionHandle handleOut;
+};
+typedef struct stOpsCtx opsCtx;
+
+/** Shortcut for the index of an operation's operands */
+#define OPS_IDX(i) ((i) & (BENCH_NUM_OPERANDS - 1))
+/** Shortcut for the index of an operation's second operand */
+#define OPS_IDX_B(i) (OPS_IDX(i) + BENCH_NUM_OPERANDS)
+
+/** The benchmarks' context (too big for the stack) */
+static opsCtx ctx;
+
+/**
+ * Generate random operands with terms of a given magnitude
+ *
+ * @param  [ in]pCtx The context
+ * @param  [ in]bits Number of bits on each term
+ */
+static void benchOps_genTerms(opsCtx *pCtx, int bits) {
+    int i;
+
+    bench_seed(0x5eed0000 + bits);
+
+    i = 0;
+    while (i < BENCH_NUM_OPERANDS * 2) {
+        pCtx->pNums[i] = bench_randTerm(bits, 1/*isSigned*/);
+        pCtx->pDens[i] = bench_randTerm(bits, 0/*isSigned*/);
+        i++;
+    }
+}
+
+static void benchOps_fraction(void *pArg, int numOps) {
+    opsCtx *pCtx;
+    int64_t acc;
+    int i;
+
+    pCtx = (opsCtx*)pArg;
+    acc = 0;
+
+    switch (pCtx->op) {
+    case BENCH_GET:
+        for (i = 0; i < numOps; i++) {
+            fraction *pTmp;
+
+            fractionManager_getFraction(&pTmp, pCtx->pMng,
+                    (int)pCtx->pNums[OPS_IDX(i)],
+                    (int)pCtx->pDens[OPS_IDX(i)]);
+            fractionManager_releaseFraction(pTmp);
+        }
+        break;
+    case BENCH_SUM:
+        for (i = 0; i < numOps; i++) {
+            fraction_sum(pCtx->pFracOut, pCtx->ppFracs[OPS_IDX(i)],
+                    pCtx->ppFracs[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_SUB:
+        for (i = 0; i < numOps; i++) {
+            fraction_sub(pCtx->pFracOut, pCtx->ppFracs[OPS_IDX(i)],
+                    pCtx->ppFracs[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_MUL:
+        for (i = 0; i < numOps; i++) {
+            fraction_mul(pCtx->pFracOut, pCtx->ppFracs[OPS_IDX(i)],
+                    pCtx->ppFracs[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_DIV:
+        for (i = 0; i < numOps; i++) {
+            fraction_div(pCtx->pFracOut, pCtx->ppFracs[OPS_IDX(i)],
+                    pCtx->ppFracs[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_ICONVERT:
+        for (i = 0; i < numOps; i++) {
+            int tmp;
+
+            fraction_iconvert(&tmp, pCtx->ppFracs[OPS_IDX(i)]);
+            acc += tmp;
+        }
+        break;
+    case BENCH_DCONVERT:
+        for (i = 0; i < numOps; i++) {
+            double tmp;
+
+            fraction_dconvert(&tmp, pCtx->ppFracs[OPS_IDX(i)]);
+            acc += (int64_t)tmp;
+        }
+        break;
+    case BENCH_DIVCONVERT:
+        for (i = 0; i < numOps; i++) {
+            int quot, rem;
+
+            fraction_divConvert(&quot, &rem, pCtx->ppFracs[OPS_IDX(i)]);
+            acc += quot + rem;
+        }
+        break;
+    case BENCH_CMP:
+        for (i = 0; i < numOps; i++) {
+            acc += fraction_cmp(pCtx->ppFracs[OPS_IDX(i)],
+                    pCtx->ppFracs[OPS_IDX_B(i)]);
+        }
+        break;
+    }
+
+    bench_sink += acc;
+}
+
+static void benchOps_value(void *pArg, int numOps) {
+    opsCtx *pCtx;
+    int64_t acc;
+    int i;
+
+    pCtx = (opsCtx*)pArg;
+    acc = 0;
+
+    /* The output is accumulated into the sink, so the (inlined) operations
+     * aren't optimized away */
+    switch (pCtx->op) {
+    case BENCH_GET:
+        for (i = 0; i < numOps; i++) {
+            fractionValue_init(&pCtx->valueOut, (int)pCtx->pNums[OPS_IDX(i)],
+                    (int)pCtx->pDens[OPS_IDX(i)]);
+            acc += pCtx->valueOut.numerator;
+        }
+        break;
+    case BENCH_SUM:
+        for (i = 0; i < numOps; i++) {
+            fractionValue_sum(&pCtx->valueOut, &pCtx->pValues[OPS_IDX(i)],
+                    &pCtx->pValues[OPS_IDX_B(i)]);
+            acc += pCtx->valueOut.numerator;
+        }
+        break;
+    case BENCH_SUB:
+        for (i = 0; i < numOps; i++) {
+            fractionValue_sub(&pCtx->valueOut, &pCtx->pValues[OPS_IDX(i)],
+                    &pCtx->pValues[OPS_IDX_B(i)]);
+            acc += pCtx->valueOut.numerator;
+        }
+        break;
+    case BENCH_MUL:
+        for (i = 0; i < numOps; i++) {
+            fractionValue_mul(&pCtx->valueOut, &pCtx->pValues[OPS_IDX(i)],
+                    &pCtx->pValues[OPS_IDX_B(i)]);
+            acc += pCtx->valueOut.numerator;
+        }
+        break;
+    case BENCH_DIV:
+        for (i = 0; i < numOps; i++) {
+            fractionValue_div(&pCtx->valueOut, &pCtx->pValues[OPS_IDX(i)],
+                    &pCtx->pValues[OPS_IDX_B(i)]);
+            acc += pCtx->valueOut.numerator;
+        }
+        break;
+    case BENCH_ICONVERT:
+        for (i = 0; i < numOps; i++) {
+            int tmp;
+
+            fractionValue_iconvert(&tmp, &pCtx->pValues[OPS_IDX(i)]);
+            acc += tmp;
+        }
+        break;
+    case BENCH_DCONVERT:
+        for (i = 0; i < numOps; i++) {
+            double tmp;
+
+            fractionValue_dconvert(&tmp, &pCtx->pValues[OPS_IDX(i)]);
+            acc += (int64_t)tmp;
+        }
+        break;
+    case BENCH_DIVCONVERT:
+        for (i = 0; i < numOps; i++) {
+            int quot, rem;
+
+            fractionValue_divConvert(&quot, &rem,
+                    &pCtx->pValues[OPS_IDX(i)]);
+            acc += quot + rem;
+        }
+        break;
+    case BENCH_CMP:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionValue_compare(&pCtx->pValues[OPS_IDX(i)],
+                    &pCtx->pValues[OPS_IDX_B(i)]);
+        }
+        break;
+    }
+
+    bench_sink += acc;
+}
+
+static void benchOps_fraction64(void *pArg, int numOps) {
+    opsCtx *pCtx;
+    int64_t acc;
+    int i;
+
+    pCtx = (opsCtx*)pArg;
+    acc = 0;
+
+    switch (pCtx->op) {
+    case BENCH_GET:
+        for (i = 0; i < numOps; i++) {
+            fraction64 *pTmp;
+
+            fractionManager_getFraction64(&pTmp, pCtx->pMng,
+                    pCtx->pNums[OPS_IDX(i)], pCtx->pDens[OPS_IDX(i)]);
+            fractionManager_releaseFraction64(pTmp);
+        }
+        break;
+    case BENCH_SUM:
+        for (i = 0; i < numOps; i++) {
+            acc += fraction64_sum(pCtx->pFrac64Out,
+                    pCtx->ppFracs64[OPS_IDX(i)],
+                    pCtx->ppFracs64[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_SUB:
+        for (i = 0; i < numOps; i++) {
+            acc += fraction64_sub(pCtx->pFrac64Out,
+                    pCtx->ppFracs64[OPS_IDX(i)],
+                    pCtx->ppFracs64[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_MUL:
+        for (i = 0; i < numOps; i++) {
+            acc += fraction64_mul(pCtx->pFrac64Out,
+                    pCtx->ppFracs64[OPS_IDX(i)],
+                    pCtx->ppFracs64[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_DIV:
+        for (i = 0; i < numOps; i++) {
+            acc += fraction64_div(pCtx->pFrac64Out,
+                    pCtx->ppFracs64[OPS_IDX(i)],
+                    pCtx->ppFracs64[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_ICONVERT:
+        for (i = 0; i < numOps; i++) {
+            int64_t tmp;
+
+            fraction64_iconvert(&tmp, pCtx->ppFracs64[OPS_IDX(i)]);
+            acc += tmp;
+        }
+        break;
+    case BENCH_DCONVERT:
+        for (i = 0; i < numOps; i++) {
+            double tmp;
+
+            fraction64_dconvert(&tmp, pCtx->ppFracs64[OPS_IDX(i)]);
+            acc += (int64_t)tmp;
+        }
+        break;
+    case BENCH_DIVCONVERT:
+        for (i = 0; i < numOps; i++) {
+            int64_t quot, rem;
+
+            fraction64_divConvert(&quot, &rem, pCtx->ppFracs64[OPS_IDX(i)]);
+            acc += quot + rem;
+        }
+        break;
+    }
+
+    bench_sink += acc;
+}
+
+static void benchOps_fractionBig(void *pArg, int numOps) {
+    opsCtx *pCtx;
+    int64_t acc;
+    int i;
+
+    pCtx = (opsCtx*)pArg;
+    acc = 0;
+
+    switch (pCtx->op) {
+    case BENCH_GET:
+        for (i = 0; i < numOps; i++) {
+            fractionBig *pTmp;
+
+            fractionManager_getFractionBig(&pTmp, pCtx->pMng,
+                    pCtx->pNums[OPS_IDX(i)], pCtx->pDens[OPS_IDX(i)]);
+            fractionManager_releaseFractionBig(pTmp);
+        }
+        break;
+    case BENCH_SUM:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionBig_sum(pCtx->pFracBigOut,
+                    pCtx->ppFracsBig[OPS_IDX(i)],
+                    pCtx->ppFracsBig[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_SUB:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionBig_sub(pCtx->pFracBigOut,
+                    pCtx->ppFracsBig[OPS_IDX(i)],
+                    pCtx->ppFracsBig[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_MUL:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionBig_mul(pCtx->pFracBigOut,
+                    pCtx->ppFracsBig[OPS_IDX(i)],
+                    pCtx->ppFracsBig[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_DIV:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionBig_div(pCtx->pFracBigOut,
+                    pCtx->ppFracsBig[OPS_IDX(i)],
+                    pCtx->ppFracsBig[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_ICONVERT:
+        for (i = 0; i < numOps; i++) {
+            int64_t tmp;
+
+            fractionBig_iconvert(&tmp, pCtx->ppFracsBig[OPS_IDX(i)]);
+            acc += tmp;
+        }
+        break;
+    case BENCH_DCONVERT:
+        for (i = 0; i < numOps; i++) {
+            double tmp;
+
+            fractionBig_dconvert(&tmp, pCtx->ppFracsBig[OPS_IDX(i)]);
+            acc += (int64_t)tmp;
+        }
+        break;
+    }
+
+    bench_sink += acc;
+}
+
+static void benchOps_fractionFactored(void *pArg, int numOps) {
+    opsCtx *pCtx;
+    int64_t acc;
+    int i;
+
+    pCtx = (opsCtx*)pArg;
+    acc = 0;
+
+    switch (pCtx->op) {
+    case BENCH_GET:
+        for (i = 0; i < numOps; i++) {
+            fractionFactored *pTmp;
+
+            fractionManager_getFractionFactored(&pTmp, pCtx->pMng,
+                    (int)pCtx->pNums[OPS_IDX(i)],
+                    (int)pCtx->pDens[OPS_IDX(i)]);
+            fractionManager_releaseFractionFactored(pTmp);
+        }
+        break;
+    case BENCH_SUM:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionFactored_sum(pCtx->pFracFactoredOut,
+                    pCtx->ppFracsFactored[OPS_IDX(i)],
+                    pCtx->ppFracsFactored[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_SUB:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionFactored_sub(pCtx->pFracFactoredOut,
+                    pCtx->ppFracsFactored[OPS_IDX(i)],
+                    pCtx->ppFracsFactored[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_MUL:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionFactored_mul(pCtx->pFracFactoredOut,
+                    pCtx->ppFracsFactored[OPS_IDX(i)],
+                    pCtx->ppFracsFactored[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_DIV:
+        for (i = 0; i < numOps; i++) {
+            acc += fractionFactored_div(pCtx->pFracFactoredOut,
+                    pCtx->ppFracsFactored[OPS_IDX(i)],
+                    pCtx->ppFracsFactored[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_ICONVERT:
+        for (i = 0; i < numOps; i++) {
+            int64_t tmp;
+
+            fractionFactored_iconvert(&tmp,
+                    pCtx->ppFracsFactored[OPS_IDX(i)]);
+            acc += tmp;
+        }
+        break;
+    case BENCH_DCONVERT:
+        for (i = 0; i < numOps; i++) {
+            double tmp;
+
+            fractionFactored_dconvert(&tmp,
+                    pCtx->ppFracsFactored[OPS_IDX(i)]);
+            acc += (int64_t)tmp;
+        }
+        break;
+    }
+
+    bench_sink += acc;
+}
+
+static void benchOps_fractionPool(void *pArg, int numOps) {
+    opsCtx *pCtx;
+    int64_t acc;
+    int i;
+
+    pCtx = (opsCtx*)pArg;
+    acc = 0;
+
+    switch (pCtx->op) {
+    case BENCH_GET:
+        for (i = 0; i < numOps; i++) {
+            fractionHandle tmp;
+
+            fractionPool_getFraction(&tmp, pCtx->pPool,
+                    (int)pCtx->pNums[OPS_IDX(i)],
+                    (int)pCtx->pDens[OPS_IDX(i)]);
+            fractionPool_release(pCtx->pPool, tmp);
+        }
+        break;
+    case BENCH_SUM:
+        for (i = 0; i < numOps; i++) {
+            fractionPool_sum(pCtx->pPool, pCtx->handleOut,
+                    pCtx->pHandles[OPS_IDX(i)], pCtx->pHandles[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_SUB:
+        for (i = 0; i < numOps; i++) {
+            fractionPool_sub(pCtx->pPool, pCtx->handleOut,
+                    pCtx->pHandles[OPS_IDX(i)], pCtx->pHandles[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_MUL:
+        for (i = 0; i < numOps; i++) {
+            fractionPool_mul(pCtx->pPool, pCtx->handleOut,
+                    pCtx->pHandles[OPS_IDX(i)], pCtx->pHandles[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_DIV:
+        for (i = 0; i < numOps; i++) {
+            fractionPool_div(pCtx->pPool, pCtx->handleOut,
+                    pCtx->pHandles[OPS_IDX(i)], pCtx->pHandles[OPS_IDX_B(i)]);
+        }
+        break;
+    case BENCH_ICONVERT:
+        for (i = 0; i < numOps; i++) {
+            int tmp;
+
+            fractionPool_iconvert(&tmp, pCtx->pPool,
+                    pCtx->pHandles[OPS_IDX(i)]);
+            acc += tmp;
+        }
+        break;
+    case BENCH_DCONVERT:
+        for (i = 0; i < numOps; i++) {
+            double tmp;
+
+            fractionPool_dconvert(&tmp, pCtx->pPool,
+                    pCtx->pHandles[OPS_IDX(i)]);
+            acc += (int64_t)tmp;
+        }
+        break;
+    case BENCH_DIVCONVERT:
+        for (i = 0; i < numOps; i++) {
+            int quot, rem;
+
+            fractionPool_divConvert(&quot, &rem, pCtx->pPool,
+                    pCtx->pHandles[OPS_IDX(i)]);
+            acc += quot + rem;
+        }
+        break;
+    }
+
+    bench_sink += acc;
+}
+
+/**
+ * Run every operation of a given type
+ *
+ * @param  [ in]pType  Name of the type, as reported
+ * @param  [ in]fn     The type's benchmark
+ * @param  [ in]bits   Number of bits on each term
+ * @param  [ in]numOps Number of operations on each sample
+ * @param  [ in]lastOp Last operation implemented by the type
+ */
+static void benchOps_runType(const char *pType, benchFunc fn, int bits,
+        int numOps, int lastOp) {
+    char pName[64];
+
+    ctx.op = BENCH_GET;
+    while (ctx.op <= lastOp) {
+        sprintf(pName, "%s.%s.bits%d", pType, pOpNames[ctx.op], bits);
+        bench_run(pName, fn, &ctx, numOps, BENCH_NUM_SAMPLES);
+        ctx.op++;
+    }
+}
+
+/**
+ * Benchmark the regular fractions (as well as the plain values and the pool,
+ * which share their range)
+ *
+ * @param  [ in]bits Number of bits on each term
+ */
+static void benchOps_runFraction(int bits) {
+    int i;
+
+    benchOps_genTerms(&ctx, bits);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_getFraction(&ctx.ppFracs[i], ctx.pMng,
+                (int)ctx.pNums[i], (int)ctx.pDens[i]);
+        fractionValue_init(&ctx.pValues[i], (int)ctx.pNums[i],
+                (int)ctx.pDens[i]);
+        fractionPool_getFraction(&ctx.pHandles[i], ctx.pPool,
+                (int)ctx.pNums[i], (int)ctx.pDens[i]);
+    }
+    fractionManager_igetFraction(&ctx.pFracOut, ctx.pMng, 0);
+    fractionPool_igetFraction(&ctx.handleOut, ctx.pPool, 0);
+
+    benchOps_runType("fraction", benchOps_fraction, bits, 1 << 18,
+            BENCH_CMP);
+    benchOps_runType("fractionValue", benchOps_value, bits, 1 << 18,
+            BENCH_CMP);
+    benchOps_runType("fractionPool", benchOps_fractionPool, bits, 1 << 18,
+            BENCH_DIVCONVERT);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_releaseFraction(ctx.ppFracs[i]);
+        fractionPool_release(ctx.pPool, ctx.pHandles[i]);
+    }
+    fractionManager_releaseFraction(ctx.pFracOut);
+    fractionPool_release(ctx.pPool, ctx.handleOut);
+}
+
+/**
+ * Benchmark the 64 bits fractions
+ *
+ * @param  [ in]bits Number of bits on each term
+ */
+static void benchOps_runFraction64(int bits) {
+    int i;
+
+    benchOps_genTerms(&ctx, bits);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_getFraction64(&ctx.ppFracs64[i], ctx.pMng,
+                ctx.pNums[i], ctx.pDens[i]);
+    }
+    fractionManager_igetFraction64(&ctx.pFrac64Out, ctx.pMng, 0);
+
+    benchOps_runType("fraction64", benchOps_fraction64, bits, 1 << 18,
+            BENCH_DIVCONVERT);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_releaseFraction64(ctx.ppFracs64[i]);
+    }
+    fractionManager_releaseFraction64(ctx.pFrac64Out);
+}
+
+/**
+ * Benchmark the big fractions
+ *
+ * @param  [ in]bits Number of bits on each term
+ */
+static void benchOps_runFractionBig(int bits) {
+    int i;
+
+    benchOps_genTerms(&ctx, bits);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_getFractionBig(&ctx.ppFracsBig[i], ctx.pMng,
+                ctx.pNums[i], ctx.pDens[i]);
+    }
+    fractionManager_igetFractionBig(&ctx.pFracBigOut, ctx.pMng, 0);
+
+    benchOps_runType("fractionBig", benchOps_fractionBig, bits, 1 << 15,
+            BENCH_DCONVERT);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_releaseFractionBig(ctx.ppFracsBig[i]);
+    }
+    fractionManager_releaseFractionBig(ctx.pFracBigOut);
+}
+
+/**
+ * Benchmark the factored fractions
+ *
+ * @param  [ in]bits Number of bits on each term
+ */
+static void benchOps_runFractionFactored(int bits) {
+    int i;
+
+    benchOps_genTerms(&ctx, bits);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_getFractionFactored(&ctx.ppFracsFactored[i],
+                ctx.pMng, (int)ctx.pNums[i], (int)ctx.pDens[i]);
+    }
+    fractionManager_igetFractionFactored(&ctx.pFracFactoredOut, ctx.pMng, 0);
+
+    benchOps_runType("fractionFactored", benchOps_fractionFactored, bits,
+            1 << 15, BENCH_DCONVERT);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS * 2; i++) {
+        fractionManager_releaseFractionFactored(ctx.ppFracsFactored[i]);
+    }
+    fractionManager_releaseFractionFactored(ctx.pFracFactoredOut);
+}
+
+/**
+ * Benchmark every constructor, arithmetic operation and converter
+ */
+void benchOps_run() {
+    fractionManagerConfig config;
+    int irv;
+
+    if (!bench_isSelected("fraction")) {
+        return;
+    }
+
+    fractionManager_getDefaultConfig(&config);
+    config.maxNumberChecked = 1 << 16;
+    config.spfLimit = 1 << 20;
+    irv = fractionManager_initConfig(&ctx.pMng, &config);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to initialize the fraction manager\n");
+        return;
+    }
+    irv = fractionPool_init(&ctx.pPool, ctx.pMng, BENCH_NUM_OPERANDS * 4);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to initialize the fraction pool\n");
+        fractionManager_clean(&ctx.pMng);
+        return;
+    }
+
+    /* Terms on regular fractions are kept small enough so no operation
+     * overflows an int */
+    benchOps_runFraction(7);
+    benchOps_runFraction(14);
+    benchOps_runFraction64(15);
+    benchOps_runFraction64(30);
+    benchOps_runFractionBig(30);
+    benchOps_runFractionBig(62);
+    benchOps_runFractionFactored(15);
+    benchOps_runFractionFactored(30);
+
+    fractionPool_clean(&ctx.pPool);
+    fractionManager_clean(&ctx.pMng);
+}
+
@@ -0,0 +1,729 @@
+/**
+ * Benchmarks for end-to-end workloads
+ *
+ * Chains multiply and then divide a running value by the same random
+ * fractions (so it stays bounded, although, on lazy mode, it's kept
+ * unreduced until it would overflow). Accumulations sum fractions with power
+ * of two denominators into a running value (or into an accumulator), which is
+ * reset every few steps.
+ * Weighted sums compare the fused dot products and axpys against multiplying
+ * each pair into a temporary and then summing it. Batches compare processing
+ * whole arrays against doing so one element at a time. Sorts compare sorting
+ * fractions against sorting their values as doubles.
+ *
+ * @file bench/benchWorkload.c
+ */
+#include "bench.h"
+
+#include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of fractions accumulated before resetting the running value */
+#define WORK_ACC_STEPS 64
+/** Biggest power of two on the accumulated denominators */
+#define WORK_ACC_MAX_EXP 10
+/** Number of products on each weighted sum */
+#define WORK_DOT_LEN 64
+/** Biggest power of two on the denominators of weighted sums */
+#define WORK_DOT_MAX_EXP 5
+
+/** Context of the workloads */
+struct stWorkCtx {
+    /** The fraction manager */
+    fractionManager *pMng;
+    /** Factors of the chains (and exponents of the accumulations) */
+    int pNums[BENCH_NUM_OPERANDS];
+    int pDens[BENCH_NUM_OPERANDS];
+    /** Second operands of the batches */
+    int pNumsB[BENCH_NUM_OPERANDS];
+    int pDensB[BENCH_NUM_OPERANDS];
+    /** Results of the batches */
+    int pOutNums[BENCH_NUM_OPERANDS];
+    int pOutDens[BENCH_NUM_OPERANDS];
+    fraction *ppFracs[BENCH_NUM_OPERANDS];
+    fraction64 *ppFracs64[BENCH_NUM_OPERANDS];
+    fractionBig *ppFracsBig[BENCH_NUM_OPERANDS];
+    fractionFactored *ppFracsFactored[BENCH_NUM_OPERANDS];
+    fractionValue pValues[BENCH_NUM_OPERANDS];
+    /** Weights of the weighted sums */
+    fraction *ppWeights[BENCH_NUM_OPERANDS];
+    /** Arrays being sorted (and the doubles they are copied from) */
+    fraction *ppSorted[BENCH_NUM_OPERANDS];
+    double pDoubles[BENCH_NUM_OPERANDS];
+    double pSortedDoubles[BENCH_NUM_OPERANDS];
+    /** The running values */
+    fraction *pFrac;
+    /** Temporary results (and the factors of the axpys) */
+    fraction *pTmp;
+    fraction *pNegTmp;
+    fraction64 *pFrac64;
+    fractionBig *pFracBig;
+    fractionFactored *pFracFactored;
+    fractionAccumulator *pAcc;
+};
+typedef struct stWorkCtx workCtx;
+
+/** Shortcut for the index of a step's operand */
+#define WORK_IDX(i) ((i) & (BENCH_NUM_OPERANDS - 1))
+
+/** The workloads' context (too big for the stack) */
+static workCtx ctx;
+
+/**
+ * Create the operands of every type from the context's terms
+ *
+ * @param  [ in]pCtx The context
+ * @return           0 on success, 1 on failure
+ */
+static int benchWorkload_getOperands(workCtx *pCtx) {
+    int i, irv;
+
+    irv = 0;
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        irv |= fractionManager_getFraction(&pCtx->ppFracs[i], pCtx->pMng,
+                pCtx->pNums[i], pCtx->pDens[i]);
+        irv |= fractionManager_getFraction64(&pCtx->ppFracs64[i],
+                pCtx->pMng, pCtx->pNums[i], pCtx->pDens[i]);
+        irv |= fractionManager_getFractionBig(&pCtx->ppFracsBig[i],
+                pCtx->pMng, pCtx->pNums[i], pCtx->pDens[i]);
+        irv |= fractionManager_getFractionFactored(&pCtx->ppFracsFactored[i],
+                pCtx->pMng, pCtx->pNums[i], pCtx->pDens[i]);
+        irv |= fractionValue_init(&pCtx->pValues[i], pCtx->pNums[i],
+                pCtx->pDens[i]);
+    }
+
+    return irv;
+}
+
+/**
+ * Release the operands of every type
+ *
+ * @param  [ in]pCtx The context
+ */
+static void benchWorkload_releaseOperands(workCtx *pCtx) {
+    int i;
+
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        fractionManager_releaseFraction(pCtx->ppFracs[i]);
+        fractionManager_releaseFraction64(pCtx->ppFracs64[i]);
+        fractionManager_releaseFractionBig(pCtx->ppFracsBig[i]);
+        fractionManager_releaseFractionFactored(pCtx->ppFracsFactored[i]);
+    }
+}
+
+static void benchWorkload_chainFraction(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i, num, den;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += 2) {
+        fraction_mul(pCtx->pFrac, pCtx->pFrac, pCtx->ppFracs[WORK_IDX(i)]);
+        fraction_div(pCtx->pFrac, pCtx->pFrac, pCtx->ppFracs[WORK_IDX(i)]);
+    }
+
+    fraction_getTerms(&num, &den, pCtx->pFrac);
+    bench_sink += num + den;
+}
+
+static void benchWorkload_chainFraction64(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += 2) {
+        fraction64_mul(pCtx->pFrac64, pCtx->pFrac64,
+                pCtx->ppFracs64[WORK_IDX(i)]);
+        fraction64_div(pCtx->pFrac64, pCtx->pFrac64,
+                pCtx->ppFracs64[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_chainFractionBig(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += 2) {
+        fractionBig_mul(pCtx->pFracBig, pCtx->pFracBig,
+                pCtx->ppFracsBig[WORK_IDX(i)]);
+        fractionBig_div(pCtx->pFracBig, pCtx->pFracBig,
+                pCtx->ppFracsBig[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_chainFractionFactored(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += 2) {
+        fractionFactored_mul(pCtx->pFracFactored, pCtx->pFracFactored,
+                pCtx->ppFracsFactored[WORK_IDX(i)]);
+        fractionFactored_div(pCtx->pFracFactored, pCtx->pFracFactored,
+                pCtx->ppFracsFactored[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_chainValue(void *pArg, int numOps) {
+    fractionValue val;
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    val.numerator = 1;
+    val.denominator = 1;
+    for (i = 0; i < numOps; i += 2) {
+        fractionValue_mul(&val, &val, &pCtx->pValues[WORK_IDX(i)]);
+        fractionValue_div(&val, &val, &pCtx->pValues[WORK_IDX(i)]);
+    }
+
+    bench_sink += val.numerator + val.denominator;
+}
+
+static void benchWorkload_accFraction(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i, num, den;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i++) {
+        if (i % WORK_ACC_STEPS == 0) {
+            fraction_getTerms(&num, &den, pCtx->pFrac);
+            bench_sink += num + den;
+            fraction_mul(pCtx->pFrac, pCtx->pFrac, pCtx->ppFracs[0]);
+        }
+        fraction_sum(pCtx->pFrac, pCtx->pFrac, pCtx->ppFracs[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_accFraction64(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i++) {
+        if (i % WORK_ACC_STEPS == 0) {
+            fraction64_mul(pCtx->pFrac64, pCtx->pFrac64, pCtx->ppFracs64[0]);
+        }
+        fraction64_sum(pCtx->pFrac64, pCtx->pFrac64,
+                pCtx->ppFracs64[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_accFractionBig(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i++) {
+        if (i % WORK_ACC_STEPS == 0) {
+            fractionBig_mul(pCtx->pFracBig, pCtx->pFracBig,
+                    pCtx->ppFracsBig[0]);
+        }
+        fractionBig_sum(pCtx->pFracBig, pCtx->pFracBig,
+                pCtx->ppFracsBig[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_accFractionFactored(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i++) {
+        if (i % WORK_ACC_STEPS == 0) {
+            fractionFactored_mul(pCtx->pFracFactored, pCtx->pFracFactored,
+                    pCtx->ppFracsFactored[0]);
+        }
+        fractionFactored_sum(pCtx->pFracFactored, pCtx->pFracFactored,
+                pCtx->ppFracsFactored[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_accValue(void *pArg, int numOps) {
+    fractionValue val;
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    val.numerator = 0;
+    val.denominator = 1;
+    for (i = 0; i < numOps; i++) {
+        if (i % WORK_ACC_STEPS == 0) {
+            bench_sink += val.numerator + val.denominator;
+            val.numerator = 0;
+            val.denominator = 1;
+        }
+        fractionValue_sum(&val, &val, &pCtx->pValues[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_accAccumulator(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i, num, den;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i++) {
+        if (i % WORK_ACC_STEPS == 0) {
+            fractionAccumulator_snapshot(pCtx->pFrac, pCtx->pAcc);
+            fraction_getTerms(&num, &den, pCtx->pFrac);
+            bench_sink += num + den;
+            fractionAccumulator_reset(pCtx->pAcc);
+        }
+        fractionAccumulator_add(pCtx->pAcc, pCtx->ppFracs[WORK_IDX(i)]);
+    }
+}
+
+static void benchWorkload_accAccumulatorArray(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i, num, den;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += WORK_ACC_STEPS) {
+        fractionAccumulator_addArray(pCtx->pAcc,
+                pCtx->ppFracs + WORK_IDX(i), WORK_ACC_STEPS);
+        fractionAccumulator_snapshot(pCtx->pFrac, pCtx->pAcc);
+        fraction_getTerms(&num, &den, pCtx->pFrac);
+        bench_sink += num + den;
+        fractionAccumulator_reset(pCtx->pAcc);
+    }
+}
+
+static void benchWorkload_dotFraction(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i, num, den;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += WORK_DOT_LEN) {
+        fraction_dot(pCtx->pFrac, pCtx->ppFracs + WORK_IDX(i),
+                pCtx->ppWeights + WORK_IDX(i), WORK_DOT_LEN);
+        fraction_getTerms(&num, &den, pCtx->pFrac);
+        bench_sink += num + den;
+    }
+}
+
+static void benchWorkload_dotNaive(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i, num, den;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += WORK_DOT_LEN) {
+        int j;
+
+        fraction_mul(pCtx->pFrac, pCtx->ppFracs[WORK_IDX(i)],
+                pCtx->ppWeights[WORK_IDX(i)]);
+        for (j = i + 1; j < i + WORK_DOT_LEN; j++) {
+            fraction_mul(pCtx->pTmp, pCtx->ppFracs[WORK_IDX(j)],
+                    pCtx->ppWeights[WORK_IDX(j)]);
+            fraction_sum(pCtx->pFrac, pCtx->pFrac, pCtx->pTmp);
+        }
+        fraction_getTerms(&num, &den, pCtx->pFrac);
+        bench_sink += num + den;
+    }
+}
+
+static void benchWorkload_dotBatch(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i, num, den;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += WORK_DOT_LEN) {
+        fractionBatch_dot(&num, &den, pCtx->pNums + WORK_IDX(i),
+                pCtx->pDens + WORK_IDX(i), pCtx->pNumsB + WORK_IDX(i),
+                pCtx->pDensB + WORK_IDX(i), WORK_DOT_LEN);
+        bench_sink += num + den;
+    }
+}
+
+static void benchWorkload_axpyFraction(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    /* Add and then subtract the same products, so the values stay bounded */
+    for (i = 0; i < numOps; i += 2 * WORK_DOT_LEN) {
+        fraction_axpy(pCtx->ppFracs + WORK_IDX(i), pCtx->pTmp,
+                pCtx->ppWeights + WORK_IDX(i), WORK_DOT_LEN);
+        fraction_axpy(pCtx->ppFracs + WORK_IDX(i), pCtx->pNegTmp,
+                pCtx->ppWeights + WORK_IDX(i), WORK_DOT_LEN);
+    }
+}
+
+static void benchWorkload_axpyNaive(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += 2) {
+        fraction_mul(pCtx->pFrac, pCtx->pTmp, pCtx->ppWeights[WORK_IDX(i)]);
+        fraction_sum(pCtx->ppFracs[WORK_IDX(i)], pCtx->ppFracs[WORK_IDX(i)],
+                pCtx->pFrac);
+        fraction_mul(pCtx->pFrac, pCtx->pNegTmp,
+                pCtx->ppWeights[WORK_IDX(i)]);
+        fraction_sum(pCtx->ppFracs[WORK_IDX(i)], pCtx->ppFracs[WORK_IDX(i)],
+                pCtx->pFrac);
+    }
+}
+
+static int benchWorkload_cmpFraction(const void *pA, const void *pB) {
+    return fraction_cmp(*(fraction**)pA, *(fraction**)pB);
+}
+
+static int benchWorkload_cmpDouble(const void *pA, const void *pB) {
+    double a, b;
+
+    a = *(const double*)pA;
+    b = *(const double*)pB;
+    return (a > b) - (a < b);
+}
+
+static void benchWorkload_sortFraction(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        memcpy(pCtx->ppSorted, pCtx->ppFracs, sizeof(pCtx->ppSorted));
+        fraction_sortArray(pCtx->ppSorted, BENCH_NUM_OPERANDS);
+    }
+    bench_sink += (intptr_t)pCtx->ppSorted[0];
+}
+
+static void benchWorkload_sortQsort(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        memcpy(pCtx->ppSorted, pCtx->ppFracs, sizeof(pCtx->ppSorted));
+        qsort(pCtx->ppSorted, BENCH_NUM_OPERANDS, sizeof(fraction*),
+                benchWorkload_cmpFraction);
+    }
+    bench_sink += (intptr_t)pCtx->ppSorted[0];
+}
+
+static void benchWorkload_sortDouble(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        memcpy(pCtx->pSortedDoubles, pCtx->pDoubles,
+                sizeof(pCtx->pSortedDoubles));
+        qsort(pCtx->pSortedDoubles, BENCH_NUM_OPERANDS, sizeof(double),
+                benchWorkload_cmpDouble);
+    }
+    bench_sink += (int64_t)pCtx->pSortedDoubles[0];
+}
+
+static void benchWorkload_batchSum(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        fractionBatch_sum(pCtx->pOutNums, pCtx->pOutDens, pCtx->pNums,
+                pCtx->pDens, pCtx->pNumsB, pCtx->pDensB, BENCH_NUM_OPERANDS);
+    }
+    bench_sink += pCtx->pOutNums[0];
+}
+
+static void benchWorkload_scalarSum(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        int j;
+
+        for (j = 0; j < BENCH_NUM_OPERANDS; j++) {
+            fractionValue a, b, out;
+
+            a.numerator = pCtx->pNums[j];
+            a.denominator = pCtx->pDens[j];
+            b.numerator = pCtx->pNumsB[j];
+            b.denominator = pCtx->pDensB[j];
+            fractionValue_sum(&out, &a, &b);
+            pCtx->pOutNums[j] = out.numerator;
+            pCtx->pOutDens[j] = out.denominator;
+        }
+    }
+    bench_sink += pCtx->pOutNums[0];
+}
+
+static void benchWorkload_batchNormalize(void *pArg, int numOps) {
+    workCtx *pCtx;
+    int i;
+
+    pCtx = (workCtx*)pArg;
+
+    /* Normalize a copy of the (unreduced) input, so every pass does the same
+     * work */
+    for (i = 0; i < numOps; i += BENCH_NUM_OPERANDS) {
+        memcpy(pCtx->pOutNums, pCtx->pNumsB, sizeof(pCtx->pOutNums));
+        memcpy(pCtx->pOutDens, pCtx->pDensB, sizeof(pCtx->pOutDens));
+        fractionBatch_normalize(pCtx->pOutNums, pCtx->pOutDens,
+                BENCH_NUM_OPERANDS);
+    }
+    bench_sink += pCtx->pOutNums[0];
+}
+
+/**
+ * Benchmark the chains of multiplications and divisions
+ */
+static void benchWorkload_runChains() {
+    int i;
+
+    bench_seed(0xc4a1);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pNums[i] = (int)bench_randTerm(8, 1/*isSigned*/);
+        ctx.pDens[i] = (int)bench_randTerm(8, 0/*isSigned*/);
+    }
+    if (benchWorkload_getOperands(&ctx) != 0) {
+        fprintf(stderr, "Failed to create the chains' operands\n");
+        benchWorkload_releaseOperands(&ctx);
+        return;
+    }
+
+    fractionManager_setLazy(ctx.pMng, 0);
+    bench_run("workload.chain.fraction", benchWorkload_chainFraction, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    fractionManager_setLazy(ctx.pMng, 1);
+    bench_run("workload.chain.fraction.lazy", benchWorkload_chainFraction,
+            &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+    fractionManager_setLazy(ctx.pMng, 0);
+    bench_run("workload.chain.fractionValue", benchWorkload_chainValue, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.chain.fraction64", benchWorkload_chainFraction64,
+            &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.chain.fractionBig", benchWorkload_chainFractionBig,
+            &ctx, 1 << 15, BENCH_NUM_SAMPLES);
+    bench_run("workload.chain.fractionFactored",
+            benchWorkload_chainFractionFactored, &ctx, 1 << 16,
+            BENCH_NUM_SAMPLES);
+
+    benchWorkload_releaseOperands(&ctx);
+}
+
+/**
+ * Benchmark the accumulations of fractions with power of two denominators
+ */
+static void benchWorkload_runAccumulations() {
+    int i;
+
+    /* The first operand resets the running value (by multiplying it by 0) */
+    bench_seed(0xacc);
+    ctx.pNums[0] = 0;
+    ctx.pDens[0] = 1;
+    for (i = 1; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pNums[i] = (int)bench_randTerm(4, 1/*isSigned*/);
+        ctx.pDens[i] = 1 << (bench_rand() % (WORK_ACC_MAX_EXP + 1));
+    }
+    if (benchWorkload_getOperands(&ctx) != 0) {
+        fprintf(stderr, "Failed to create the accumulations' operands\n");
+        benchWorkload_releaseOperands(&ctx);
+        return;
+    }
+    if (fractionAccumulator_init(&ctx.pAcc, ctx.pMng) != 0) {
+        fprintf(stderr, "Failed to create the accumulator\n");
+        benchWorkload_releaseOperands(&ctx);
+        return;
+    }
+
+    bench_run("workload.accumulate.fraction", benchWorkload_accFraction,
+            &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+    fractionManager_setLazy(ctx.pMng, 1);
+    bench_run("workload.accumulate.fraction.lazy", benchWorkload_accFraction,
+            &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+    fractionManager_setLazy(ctx.pMng, 0);
+    bench_run("workload.accumulate.fractionValue", benchWorkload_accValue,
+            &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.accumulate.fraction64", benchWorkload_accFraction64,
+            &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.accumulate.fractionBig",
+            benchWorkload_accFractionBig, &ctx, 1 << 15, BENCH_NUM_SAMPLES);
+    bench_run("workload.accumulate.fractionFactored",
+            benchWorkload_accFractionFactored, &ctx, 1 << 16,
+            BENCH_NUM_SAMPLES);
+    bench_run("workload.accumulate.accumulator",
+            benchWorkload_accAccumulator, &ctx, 1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.accumulate.accumulator.array",
+            benchWorkload_accAccumulatorArray, &ctx, 1 << 18,
+            BENCH_NUM_SAMPLES);
+
+    fractionAccumulator_clean(&ctx.pAcc);
+    benchWorkload_releaseOperands(&ctx);
+}
+
+/**
+ * Benchmark the weighted sums of fractions with power of two denominators
+ */
+static void benchWorkload_runWeightedSums() {
+    int i, irv;
+
+    bench_seed(0xd07);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pNums[i] = (int)bench_randTerm(4, 1/*isSigned*/);
+        ctx.pDens[i] = 1 << (bench_rand() % (WORK_DOT_MAX_EXP + 1));
+        ctx.pNumsB[i] = (int)bench_randTerm(4, 1/*isSigned*/);
+        ctx.pDensB[i] = 1 << (bench_rand() % (WORK_DOT_MAX_EXP + 1));
+    }
+    if (benchWorkload_getOperands(&ctx) != 0) {
+        fprintf(stderr, "Failed to create the weighted sums' operands\n");
+        benchWorkload_releaseOperands(&ctx);
+        return;
+    }
+    irv = 0;
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        irv |= fractionManager_getFraction(&ctx.ppWeights[i], ctx.pMng,
+                ctx.pNumsB[i], ctx.pDensB[i]);
+    }
+    irv |= fractionManager_getFraction(&ctx.pTmp, ctx.pMng, 3, 4);
+    irv |= fractionManager_getFraction(&ctx.pNegTmp, ctx.pMng, -3, 4);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to create the weighted sums' weights\n");
+        benchWorkload_releaseOperands(&ctx);
+        return;
+    }
+
+    bench_run("workload.dot.fraction", benchWorkload_dotFraction, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.dot.fraction.naive", benchWorkload_dotNaive, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.dot.batch", benchWorkload_dotBatch, &ctx, 1 << 18,
+            BENCH_NUM_SAMPLES);
+    bench_run("workload.axpy.fraction", benchWorkload_axpyFraction, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.axpy.fraction.naive", benchWorkload_axpyNaive, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        fractionManager_releaseFraction(ctx.ppWeights[i]);
+    }
+    fractionManager_releaseFraction(ctx.pTmp);
+    fractionManager_releaseFraction(ctx.pNegTmp);
+    benchWorkload_releaseOperands(&ctx);
+}
+
+/**
+ * Benchmark processing whole arrays against processing each element
+ */
+static void benchWorkload_runBatches() {
+    int i;
+
+    bench_seed(0xba7c);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pNums[i] = (int)bench_randTerm(14, 1/*isSigned*/);
+        ctx.pDens[i] = (int)bench_randTerm(14, 0/*isSigned*/);
+        ctx.pNumsB[i] = (int)bench_randTerm(14, 1/*isSigned*/);
+        ctx.pDensB[i] = (int)bench_randTerm(14, 0/*isSigned*/);
+    }
+
+    bench_run("workload.batch.sum", benchWorkload_batchSum, &ctx, 1 << 18,
+            BENCH_NUM_SAMPLES);
+    bench_run("workload.batch.sum.scalar", benchWorkload_scalarSum, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+
+    /* Share a common factor between the terms, so there's something to
+     * reduce */
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        int common;
+
+        common = (int)bench_randTerm(8, 0/*isSigned*/);
+        ctx.pNumsB[i] = ctx.pNums[i] * common;
+        ctx.pDensB[i] = ctx.pDens[i] * common;
+    }
+    bench_run("workload.batch.normalize", benchWorkload_batchNormalize, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+}
+
+/**
+ * Benchmark sorting arrays of fractions against sorting arrays of doubles
+ */
+static void benchWorkload_runSorts() {
+    int i;
+
+    bench_seed(0x5027);
+    for (i = 0; i < BENCH_NUM_OPERANDS; i++) {
+        ctx.pNums[i] = (int)bench_randTerm(14, 1/*isSigned*/);
+        ctx.pDens[i] = (int)bench_randTerm(14, 0/*isSigned*/);
+    }
+    if (benchWorkload_getOperands(&ctx) != 0) {
+        fprintf(stderr, "Failed to create the sorts' operands\n");
+        benchWorkload_releaseOperands(&ctx);
+        return;
+    }
+    fraction_dconvertArray(ctx.pDoubles, ctx.ppFracs, BENCH_NUM_OPERANDS);
+
+    bench_run("workload.sort.fraction", benchWorkload_sortFraction, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.sort.fraction.qsort", benchWorkload_sortQsort, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+    bench_run("workload.sort.double", benchWorkload_sortDouble, &ctx,
+            1 << 18, BENCH_NUM_SAMPLES);
+
+    benchWorkload_releaseOperands(&ctx);
+}
+
+/**
+ * Benchmark end-to-end workloads, like long chains of operations
+ */
+void benchWorkload_run() {
+    int irv;
+
+    if (!bench_isSelected("workload")) {
+        return;
+    }
+
+    irv = fractionManager_init(&ctx.pMng, 1 << 16/*maxNumberChecked*/);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to initialize the fraction manager\n");
+        return;
+    }
+
+    irv = fractionManager_igetFraction(&ctx.pFrac, ctx.pMng, 1);
+    irv |= fractionManager_igetFraction64(&ctx.pFrac64, ctx.pMng, 1);
+    irv |= fractionManager_igetFractionBig(&ctx.pFracBig, ctx.pMng, 1);
+    irv |= fractionManager_igetFractionFactored(&ctx.pFracFactored, ctx.pMng,
+            1);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to create the running values\n");
+        fractionManager_clean(&ctx.pMng);
+        return;
+    }
+
+    benchWorkload_runChains();
+    benchWorkload_runAccumulations();
+    benchWorkload_runWeightedSums();
+    benchWorkload_runBatches();
+    benchWorkload_runSorts();
+
+    /* Releasing the manager also releases every fraction */
+    fractionManager_clean(&ctx.pMng);
+}
+
@@ -3,15 +3,56 @@
  * number is composed by a numerator and a denominator, and both are represented
  * as integer.
  *
- * The current implementation isn't really optimized for speed. After every
- * operation, the resulted number is simplified, which requires a list of
- * primes. Perhaps, keeping both numerator and denominator as lists of primes
- * would be more optimized for speed. However, a list of primes is required for
- * the current implementation.
+ * After every operation, the resulted number is simplified by dividing both
+ * its numerator and denominator by their greatest common divisor. This is
+ * calculated through the binary GCD algorithm, so it takes O(log n) steps and
+ * doesn't depend on the list of primes. Perhaps, keeping both numerator and
+ * denominator as lists of primes would be more optimized for multiplications.
+ *
+ * Alternatively, a manager may be set to lazy mode, so long chains of
+ * operations don't reduce their intermediate results. Those are only
+ * simplified when they are about to overflow or when they are converted.
+ *
+ * Weighted sums may be calculated through fused operations (fraction_fma,
+ * fraction_dot and fraction_axpy), which accumulate their products over a
+ * common denominator on 64 bits and only reduce the final result.
+ *
+ * Fractions with 64 bits terms are also available. Those are always kept on
+ * their lowest terms, and every operation on them reports whether its result
+ * overflowed (instead of silently wrapping around).
+ *
+ * Fractions may also be used as plain values (see fraction_value.h), which
+ * don't need a manager and whose operations are inlined. Regular fractions
+ * are implemented on top of those.
+ *
+ * Lastly, there are also fractions with arbitrary precision. Their terms are
+ * stored inline while they fit into 64 bits, and are only promoted to lists
+ * of limbs (which are recycled by the manager) when an operation overflows.
+ *
+ * For long chains of multiplications and divisions, factored fractions store
+ * their value as a sparse list of primes and exponents (negative for the
+ * denominator), factored through the manager's list of primes. Multiplying
+ * those simply adds exponents, so it never overflows nor needs a GCD. Only
+ * sums switch them back to regular terms.
+ *
+ * For processing many fractions at once, a fraction pool stores numerators
+ * and denominators on two separated arrays, and references each fraction by
+ * a 32 bits handle (its index on both arrays). Those arrays may be processed
+ * element-wise by the batch functions, which normalize their results in
+ * blocks (on x86, through SIMD kernels selected for the running CPU).
+ *
+ * Long streams of fractions may be summed by an accumulator, which keeps its
+ * running sum over a common denominator (only reducing it now and then) and
+ * falls back to a big fraction if it ever overflows, so it's always exact.
+ *
+ * Fractions are compared by cross multiplying their terms on 64 bits, so
+ * comparisons are exact and never reduce (nor modify) either fraction. Arrays
+ * of fractions are sorted by their values as doubles, and only those that
+ * round to the same double are compared exactly.
  *
  * The lib has an "unexported" module for generating lists of primes. It's
- * initialized with the main context, and its precision (i.e., maximum
- * calculated prime) may be set.
+ * initialized with the main context, and its initial precision (i.e., maximum
+ * calculated prime) may be set. Afterward, it's extended on demand.
  *
  * If, at some point, the need to use these numbers in a more conventional way
  * arise, they can be exported to intege (dicarding the decimal part), to
@@ -22,16 +63,171 @@
 #ifndef __FRACTION_STRUCT__
 #define __FRACTION_STRUCT__
 
+#include <fraction/fraction_value.h>
+
+#include <stdint.h>
+
 /** Manager that stores all fraction number references and primes */
 typedef struct stFractionManager fractionManager;
 /** A fraction number */
 typedef struct stFraction fraction;
+/** A fraction number with 64 bits terms */
+typedef struct stFraction64 fraction64;
+/** A fraction number with arbitrary precision terms */
+typedef struct stFractionBig fractionBig;
+/** A fraction number stored as a list of prime factors */
+typedef struct stFractionFactored fractionFactored;
+/** Fraction numbers stored as arrays of numerators and denominators */
+typedef struct stFractionPool fractionPool;
+/** Exact running sum of many fraction numbers */
+typedef struct stFractionAccumulator fractionAccumulator;
+/** Maximum number of distinct prime factors of an int */
+#define FRACTION_MAX_FACTORS 9
+
+/** Reference to a fraction number on a fraction pool */
+typedef uint32_t fractionHandle;
+
+/** Options for initializing a fraction manager */
+struct stFractionManagerConfig {
+    /** Biggest number to be checked for primality */
+    int maxNumberChecked;
+    /** Whether the manager may be used by many threads at once */
+    int isConcurrent;
+    /** Number of threads used to generate the list of primes */
+    int numSieveThreads;
+    /** Maximum size of the list of primes, in bytes, as it grows on demand
+     * (or 0, if it's unbounded) */
+    int maxPrimeBytes;
+    /** Biggest number on the table of smallest prime factors, which takes
+     * one byte per number (or 0, to only factor through trial division) */
+    int spfLimit;
+    /** Path of a file caching the list of primes, which is mapped
+     * read-only (so it's shared by every process that uses it). It's
+     * (re)written if it doesn't have every prime up to maxNumberChecked (or
+     * 0, to always generate the list) */
+    const char *pPrimeCachePath;
+    /** Trace 1 in every traceInterval operations (on average), on each
+     * thread (or nothing, if 0). Only used if the lib was built with
+     * FRACTION_TRACE */
+    int traceInterval;
+    /** Number of sampled operations kept until they are drained */
+    int traceCapacity;
+};
+typedef struct stFractionManagerConfig fractionManagerConfig;
+
+/** Usage of the objects of a given kind on a fraction manager */
+struct stFractionObjectStats {
+    /** Number of buffers alloc'ed (each holding many objects) */
+    int numBuffers;
+    /** Number of objects currently retrieved (i.e., in use) */
+    int64_t numLive;
+    /** Number of alloc'ed objects currently released (to be recycled) */
+    int64_t numFree;
+    /** Most objects ever retrieved at once */
+    int64_t highWater;
+};
+typedef struct stFractionObjectStats fractionObjectStats;
+
+/** Performance counters of a fraction manager (only kept if the lib was
+ * built with FRACTION_STATS) */
+struct stFractionManagerStats {
+    /** Arithmetic operations on regular fractions */
+    uint64_t opsFraction;
+    /** Arithmetic operations on 64 bits fractions */
+    uint64_t opsFraction64;
+    /** Arithmetic operations on big fractions */
+    uint64_t opsFractionBig;
+    /** Arithmetic operations on factored fractions */
+    uint64_t opsFractionFactored;
+    /** Arithmetic operations on pools of fractions */
+    uint64_t opsFractionPool;
+    /** Number of times a regular fraction was reduced to its lowest terms */
+    uint64_t numSimplifications;
+    /** Number of numbers factored into primes */
+    uint64_t numFactorizations;
+    /** Number of trial divisions by primes, while factoring */
+    uint64_t numTrialDivisions;
+    /** Average number of trial divisions per factored number */
+    double avgTrialDivisions;
+    /** Number of primes currently on the manager's list */
+    int numPrimes;
+    /** Usage of the regular fractions */
+    fractionObjectStats fractions;
+    /** Usage of the 64 bits fractions */
+    fractionObjectStats fractions64;
+    /** Usage of the big fractions */
+    fractionObjectStats fractionsBig;
+    /** Usage of the factored fractions */
+    fractionObjectStats fractionsFactored;
+};
+typedef struct stFractionManagerStats fractionManagerStats;
+
+/** How fixed point conversions round their results */
+enum enFractionRounding {
+    /** Toward zero (i.e., discarding the remainder) */
+    FRACTION_ROUND_TRUNC = 0,
+    /** Toward negative infinity */
+    FRACTION_ROUND_FLOOR,
+    /** Toward positive infinity */
+    FRACTION_ROUND_CEIL,
+    /** To the nearest value, with ties away from zero */
+    FRACTION_ROUND_HALF_AWAY,
+    /** To the nearest value, with ties to the even one */
+    FRACTION_ROUND_HALF_EVEN
+};
+
+/** Operations that may be traced */
+enum enFractionTraceOp {
+    FRACTION_TRACE_GET = 0,
+    FRACTION_TRACE_IGET,
+    FRACTION_TRACE_FXGET,
+    FRACTION_TRACE_FGET,
+    FRACTION_TRACE_DGET,
+    FRACTION_TRACE_CLONE,
+    FRACTION_TRACE_SUM,
+    FRACTION_TRACE_SUB,
+    FRACTION_TRACE_MUL,
+    FRACTION_TRACE_DIV,
+    FRACTION_TRACE_ICONVERT,
+    FRACTION_TRACE_FXCONVERT,
+    FRACTION_TRACE_FCONVERT,
+    FRACTION_TRACE_DCONVERT,
+    FRACTION_TRACE_DIVCONVERT,
+    FRACTION_TRACE_GETTERMS,
+    FRACTION_TRACE_VCONVERT,
+    FRACTION_TRACE_DAPPROX,
+    FRACTION_TRACE_FAPPROX,
+    FRACTION_TRACE_DEXACT,
+    FRACTION_TRACE_FMA,
+    FRACTION_TRACE_NUM_OPS
+};
+
+/** A sampled operation */
+struct stFractionTraceEvent {
+    /** The operation (one of FRACTION_TRACE_*) */
+    int op;
+    /** Bits on the biggest term of the first operand (or of the value, on
+     * constructors) */
+    int bitsA;
+    /** Bits on the biggest term of the second operand (or 0) */
+    int bitsB;
+    /** Number of times the operation reduced a fraction to its lowest
+     * terms */
+    int numSimplifications;
+    /** The operation's duration, in ticks (see fractionTrace_getNsPerTick) */
+    uint64_t ticks;
+};
+typedef struct stFractionTraceEvent fractionTraceEvent;
 
 #endif /* __FRACTION_STRUCT__ */
 
 #ifndef __FRACTION_H__
 #define __FRACTION_H__
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * Initializes the fraction manager
  *
@@ -41,6 +237,43 @@ typedef struct stFraction fraction;
  */
 int fractionManager_init(fractionManager **ppOut, int maxNumberChecked);
 
+/**
+ * Retrieve the default options for initializing a fraction manager
+ *
+ * @param  [out]pConfig The default options
+ */
+void fractionManager_getDefaultConfig(fractionManagerConfig *pConfig);
+
+/**
+ * Initializes the fraction manager with the supplied options
+ *
+ * On concurrent managers, fractions may be retrieved and released by many
+ * threads at once, and may be handed from one thread to another. Each thread
+ * caches some released fractions, which may be returned to the manager
+ * through fractionManager_flushThreadCache (e.g., before the thread exits).
+ *
+ * NOTE: A single fraction still musn't be used by many threads at once (even
+ *       as an operation's input, since inputs may get simplified)
+ *
+ * @param  [out]ppOut   The alloc'ed and initialized fraction manager
+ * @param  [ in]pConfig The manager's options
+ * @return              0 on success, 1 on failure
+ */
+int fractionManager_initConfig(fractionManager **ppOut,
+        const fractionManagerConfig *pConfig);
+
+/**
+ * Generate every prime up to a given number into a cache file, so managers
+ * that use it (through pPrimeCachePath) don't have to
+ *
+ * @param  [ in]pPath            Path of the cache file
+ * @param  [ in]maxNumberChecked Biggest number to be checked for primality
+ * @param  [ in]numSieveThreads  Number of threads used to generate the list
+ * @return                       0 on success, 1 on failure
+ */
+int fractionManager_genPrimeCache(const char *pPath, int maxNumberChecked,
+        int numSieveThreads);
+
 /**
  * Releases all alloc'ed resources for the fraction manager
  *
@@ -51,6 +284,99 @@ int fractionManager_init(fractionManager **ppOut, int maxNumberChecked);
  */
 void fractionManager_clean(fractionManager **ppMng);
 
+/**
+ * Return every object cached by the calling thread to a concurrent manager,
+ * so other threads may recycle them
+ *
+ * @param  [ in]pMng The fraction manager
+ */
+void fractionManager_flushThreadCache(fractionManager *pMng);
+
+/**
+ * Retrieve a snapshot of the manager's performance counters
+ *
+ * Counters are only kept if the lib was built with FRACTION_STATS (e.g.,
+ * through 'make STATS=yes'). Otherwise, they cost nothing and this function
+ * simply fails. On concurrent managers, each counter is read atomically, but
+ * they may be updated while the snapshot is taken.
+ *
+ * @param  [out]pOut The counters (zeroed on failure)
+ * @param  [ in]pMng The fraction manager
+ * @return           0 on success, 1 if the counters weren't compiled
+ */
+int fractionManager_getStats(fractionManagerStats *pOut,
+        fractionManager *pMng);
+
+/**
+ * Move the sampled operations out of the manager's ring (oldest first)
+ *
+ * Operations are only sampled if the lib was built with FRACTION_TRACE
+ * (e.g., through 'make TRACE=yes'). Many threads may be sampling operations
+ * while the ring is drained, so a consumer thread may periodically drain it.
+ *
+ * NOTE: Only a single thread may drain a manager's ring at a time
+ *
+ * @param  [out]pEvents     The sampled operations
+ * @param  [out]pNumEvents  Number of drained operations
+ * @param  [out]pNumDropped Number of operations dropped because the ring was
+ *                          full, since the last drain (may be NULL)
+ * @param  [ in]pMng        The fraction manager
+ * @param  [ in]maxEvents   Maximum number of operations drained
+ * @return                  0 on success, 1 if tracing wasn't compiled (or
+ *                          isn't enabled on the manager)
+ */
+int fractionManager_drainTrace(fractionTraceEvent *pEvents, int *pNumEvents,
+        uint64_t *pNumDropped, fractionManager *pMng, int maxEvents);
+
+/**
+ * Retrieve how long each tick of the traced durations takes
+ *
+ * NOTE: The first call calibrates the time-stamp counter, which takes a few
+ *       milliseconds
+ *
+ * @param  [out]pOut Nanoseconds per tick
+ */
+void fractionTrace_getNsPerTick(double *pOut);
+
+/**
+ * Retrieve the name of a traced operation
+ *
+ * @param  [out]ppOut The operation's name (or "unknown")
+ * @param  [ in]op    The operation (one of FRACTION_TRACE_*)
+ */
+void fractionTrace_getOpName(const char **ppOut, int op);
+
+/**
+ * Factor an integer into primes (in increasing order), ignoring its sign
+ *
+ * If the manager has a table of smallest prime factors, factors are found in
+ * as many lookups as the number has prime factors. Otherwise (or for numbers
+ * bigger than the table), they are found through trial division.
+ *
+ * @param  [out]pFactors    The number's distinct prime factors (there are at
+ *                          most FRACTION_MAX_FACTORS of them)
+ * @param  [out]pExponents  The exponent of each prime factor
+ * @param  [out]pNumFactors Number of distinct prime factors
+ * @param  [ in]pMng        The fraction manager
+ * @param  [ in]value       The number (which musn't be 0)
+ * @return                  0 on success, 1 on failure
+ */
+int fractionManager_factor(int *pFactors, int *pExponents, int *pNumFactors,
+        fractionManager *pMng, int value);
+
+/**
+ * Set whether the manager's operations should only simplify their results
+ * when those are observed
+ *
+ * On lazy mode, sums, subtractions, multiplications and divisions store their
+ * results unreduced, as long as it fits into an int. Those fractions are then
+ * simplified as soon as they are converted to anything else
+ *
+ * @param  [ in]pMng   The fraction manager
+ * @param  [ in]isLazy Whether lazy mode should be enabled
+ */
+void fractionManager_setLazy(fractionManager *pMng, int isLazy);
+
 /**
  * Initializes a fraction from an integer number
  *
@@ -62,6 +388,31 @@ void fractionManager_clean(fractionManager **ppMng);
 int fractionManager_igetFraction(fraction **ppOut, fractionManager *pMng,
         int val);
 
+/**
+ * Initializes a fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFraction(fraction **ppOut, fractionManager *pMng,
+        int numerator, int denominator);
+
+/**
+ * Initializes a fraction from a plain fraction value
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]pVal  The fraction initial value
+ * @return            0 on success, 1 on failure (or if the denominator is
+ *                    zero)
+ */
+int fractionManager_vgetFraction(fraction **ppOut, fractionManager *pMng,
+        const fractionValue *pVal);
+
 /**
  * Initializes a fraction from a decimal fixed point number
  *
@@ -97,6 +448,59 @@ int fractionManager_fgetFraction(fraction **ppOut, fractionManager *pMng,
 int fractionManager_dgetFraction(fraction **ppOut, fractionManager *pMng,
         double val);
 
+/**
+ * Initializes a fraction from the best rational approximation of a double,
+ * found through its continued fraction (so it's never simplified)
+ *
+ * @param  [out]ppOut          The alloc'ed/initialized fraction
+ * @param  [ in]pMng           The fraction manager (so all references are
+ *                             kept)
+ * @param  [ in]val            The fraction initial value
+ * @param  [ in]maxDenominator The biggest denominator (or 0, for INT_MAX)
+ * @param  [ in]maxError       Maximum distance to the value, in which case
+ *                             the simplest fraction that's close enough is
+ *                             used (or 0, to find the simplest fraction that
+ *                             converts back to the very same double; or
+ *                             negative, to only be bound by the denominator)
+ * @return                     0 on success, 1 on failure (or if the value
+ *                             isn't finite or doesn't fit into an int)
+ */
+int fractionManager_dapproxFraction(fraction **ppOut, fractionManager *pMng,
+        double val, int maxDenominator, double maxError);
+
+/**
+ * Initializes a fraction from the best rational approximation of a float,
+ * found through its continued fraction (so it's never simplified)
+ *
+ * @param  [out]ppOut          The alloc'ed/initialized fraction
+ * @param  [ in]pMng           The fraction manager (so all references are
+ *                             kept)
+ * @param  [ in]val            The fraction initial value
+ * @param  [ in]maxDenominator The biggest denominator (or 0, for INT_MAX)
+ * @param  [ in]maxError       Maximum distance to the value, in which case
+ *                             the simplest fraction that's close enough is
+ *                             used (or 0, to find the simplest fraction
+ *                             within half an ulp of the float; or negative,
+ *                             to only be bound by the denominator)
+ * @return                     0 on success, 1 on failure (or if the value
+ *                             isn't finite or doesn't fit into an int)
+ */
+int fractionManager_fapproxFraction(fraction **ppOut, fractionManager *pMng,
+        float val, int maxDenominator, float maxError);
+
+/**
+ * Initializes a fraction with the exact value of a double, decomposed into
+ * its mantissa and a power of two (so it's never simplified)
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure (or if the value isn't
+ *                    finite or either term doesn't fit into an int)
+ */
+int fractionManager_dexactFraction(fraction **ppOut, fractionManager *pMng,
+        double val);
+
 /**
  * Releases a fraction to the fraction manager. This enables the manager to
  * recycle fractions that have already been allocated but aren't in use
@@ -159,6 +563,109 @@ void fraction_mul(fraction *pOut, fraction *pA, fraction *pB);
  */
 void fraction_div(fraction *pOut, fraction *pA, fraction *pB);
 
+/**
+ * Multiplies two fractional numbers and adds a third one to their product,
+ * reducing only the final result
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (A * B + C)
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factor
+ * @param  [ in]pC   The summand
+ */
+void fraction_fma(fraction *pOut, fraction *pA, fraction *pB, fraction *pC);
+
+/**
+ * Calculates the dot product of two arrays of fractional numbers (i.e., the
+ * sum of the products of their elements)
+ *
+ * The products are accumulated over a common denominator, on 64 bits terms,
+ * and only the final result is reduced. So, it's exact whenever multiplying
+ * and summing each pair would be (and usually way past that).
+ *
+ * NOTE: The output may be on either array!
+ *
+ * @param  [out]pOut The operation's result (0, if the arrays are empty)
+ * @param  [ in]ppA  The first factors
+ * @param  [ in]ppB  The second factors
+ * @param  [ in]len  Number of fractions on every array
+ */
+void fraction_dot(fraction *pOut, fraction **ppA, fraction **ppB, int len);
+
+/**
+ * Multiplies every element of an array by a fractional number, adding the
+ * product to the respective element of another array (i.e., Y = A * X + Y)
+ *
+ * Just like fraction_fma, each element is only reduced once
+ *
+ * NOTE: The factor may be on either array, but its original value is used
+ *       for every element
+ *
+ * @param  [ in]ppY The summands, which are replaced by the results
+ * @param  [ in]pA  The factor
+ * @param  [ in]ppX The other factors
+ * @param  [ in]len Number of fractions on every array
+ */
+void fraction_axpy(fraction **ppY, fraction *pA, fraction **ppX, int len);
+
+/**
+ * Compares two fractional numbers, without reducing either
+ *
+ * @param  [ in]pA A fraction
+ * @param  [ in]pB The other fraction
+ * @return         -1 if A < B, 0 if they are equal and 1 if A > B
+ */
+int fraction_cmp(fraction *pA, fraction *pB);
+
+/**
+ * Checks whether two fractional numbers are equal, without reducing either
+ *
+ * @param  [ in]pA A fraction
+ * @param  [ in]pB The other fraction
+ * @return         1 if they are equal, 0 otherwise
+ */
+int fraction_eq(fraction *pA, fraction *pB);
+
+/**
+ * Copies the smallest of two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The smallest fraction (A, if they are equal)
+ * @param  [ in]pA   A fraction
+ * @param  [ in]pB   The other fraction
+ */
+void fraction_min(fraction *pOut, fraction *pA, fraction *pB);
+
+/**
+ * Copies the biggest of two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The biggest fraction (A, if they are equal)
+ * @param  [ in]pA   A fraction
+ * @param  [ in]pB   The other fraction
+ */
+void fraction_max(fraction *pOut, fraction *pA, fraction *pB);
+
+/**
+ * Retrieve the sign of a fractional number, without reducing it
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            -1 if it's negative, 0 if it's zero and 1 if it's
+ *                    positive
+ */
+int fraction_sign(fraction *pFrac);
+
+/**
+ * Checks whether a fractional number is zero, without reducing it
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            1 if it's zero, 0 otherwise
+ */
+int fraction_isZero(fraction *pFrac);
+
 /**
  * Converts a fractional number to an integer, retrieving only its quotient
  *
@@ -203,5 +710,987 @@ void fraction_dconvert(double *pOut, fraction *pFrac);
  */
 void fraction_divConvert(int *pQuotOut, int *pRemOut, fraction *pFrac);
 
+/**
+ * Retrieve both terms of a fractional number, on its lowest terms (so the
+ * denominator is always positive)
+ *
+ * @param  [out]pNumerator   The fraction's numerator
+ * @param  [out]pDenominator The fraction's denominator
+ * @param  [ in]pFrac        The fraction
+ */
+void fraction_getTerms(int *pNumerator, int *pDenominator, fraction *pFrac);
+
+/**
+ * Converts a fractional number to a plain fraction value (on its lowest terms)
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fraction_vconvert(fractionValue *pOut, fraction *pFrac);
+
+/**
+ * Converts an array of fractional numbers to doubles
+ *
+ * @param  [out]pOut    The converted fractions
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions
+ */
+void fraction_dconvertArray(double *pOut, fraction **ppFracs, int len);
+
+/**
+ * Converts an array of fractional numbers to floats
+ *
+ * @param  [out]pOut    The converted fractions
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions
+ */
+void fraction_fconvertArray(float *pOut, fraction **ppFracs, int len);
+
+/**
+ * Converts an array of fractional numbers to 64 bits decimal fixed points
+ *
+ * @param  [out]pOut          The converted fractions
+ * @param  [ in]ppFracs       The fractions
+ * @param  [ in]decimalDigits Number of digits in the values that represent
+ *                            the decimal part (up to
+ *                            FRACTION_MAX_DECIMAL_DIGITS)
+ * @param  [ in]rounding      How results are rounded (one of
+ *                            FRACTION_ROUND_*)
+ * @param  [ in]len           Number of fractions
+ * @return                    0 on success, 1 if any result didn't fit (and
+ *                            was saturated)
+ */
+int fraction_fxconvertArray(int64_t *pOut, fraction **ppFracs,
+        int decimalDigits, int rounding, int len);
+
+/**
+ * Sorts an array of fractional numbers into ascending order, without
+ * reducing any of them
+ *
+ * The sort is stable (i.e., equal fractions are kept on their original
+ * order)
+ *
+ * NOTE: Fractions with a zero denominator aren't ordered
+ *
+ * @param  [ in]ppFracs The fractions, which are sorted in place
+ * @param  [ in]len     Number of fractions
+ * @return              0 on success, 1 on failure (and the array is left
+ *                      untouched)
+ */
+int fraction_sortArray(fraction **ppFracs, int len);
+
+/**
+ * Initializes a 64 bits fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFraction64(fraction64 **ppOut, fractionManager *pMng,
+        int64_t numerator, int64_t denominator);
+
+/**
+ * Initializes a 64 bits fraction from an integer number
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_igetFraction64(fraction64 **ppOut, fractionManager *pMng,
+        int64_t val);
+
+/**
+ * Initializes a 64 bits fraction with the value of a regular fraction
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_widenFraction(fraction64 **ppOut, fraction *pSrc);
+
+/**
+ * Releases a 64 bits fraction to the fraction manager
+ *
+ * @param  [ in]pFrac The number to be released
+ */
+void fractionManager_releaseFraction64(fraction64 *pFrac);
+
+/**
+ * Clones a 64 bits fraction number into a newly alloc'ed one
+ *
+ * @param  [out]ppOut The cloned fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_clone64(fraction64 **ppOut, fraction64 *pSrc);
+
+/**
+ * Adds two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on overflow
+ */
+int fraction64_sum(fraction64 *pOut, fraction64 *pA, fraction64 *pB);
+
+/**
+ * Subtracts two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on overflow
+ */
+int fraction64_sub(fraction64 *pOut, fraction64 *pA, fraction64 *pB);
+
+/**
+ * Multiplies two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factors
+ * @return           0 on success, 1 on overflow
+ */
+int fraction64_mul(fraction64 *pOut, fraction64 *pA, fraction64 *pB);
+
+/**
+ * Divides two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   The dividend
+ * @param  [ in]pB   The divisor
+ * @return           0 on success, 1 on overflow or division by zero
+ */
+int fraction64_div(fraction64 *pOut, fraction64 *pA, fraction64 *pB);
+
+/**
+ * Converts a 64 bits fractional number to a regular one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The 64 bits fraction
+ * @return            0 on success, 1 if it doesn't fit into a regular fraction
+ */
+int fraction64_narrow(fraction *pOut, fraction64 *pFrac);
+
+/**
+ * Converts a 64 bits fractional number to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fraction64_iconvert(int64_t *pOut, fraction64 *pFrac);
+
+/**
+ * Converts a 64 bits fractional number to a double
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fraction64_dconvert(double *pOut, fraction64 *pFrac);
+
+/**
+ * Converts a 64 bits fractional number through a division, retrieving the
+ * number's quotient and remainder
+ *
+ * @param  [out]pQuotOut The fraction's quotient
+ * @param  [out]pRemOut  The fraction's remainder
+ * @param  [ in]pFrac    The fraction
+ */
+void fraction64_divConvert(int64_t *pQuotOut, int64_t *pRemOut,
+        fraction64 *pFrac);
+
+/**
+ * Initializes a big fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFractionBig(fractionBig **ppOut, fractionManager *pMng,
+        int64_t numerator, int64_t denominator);
+
+/**
+ * Initializes a big fraction from an integer number
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_igetFractionBig(fractionBig **ppOut,
+        fractionManager *pMng, int64_t val);
+
+/**
+ * Initializes a big fraction with the value of a regular fraction
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_widenFractionBig(fractionBig **ppOut, fraction *pSrc);
+
+/**
+ * Releases a big fraction (and its limbs) to the fraction manager
+ *
+ * @param  [ in]pFrac The number to be released
+ */
+void fractionManager_releaseFractionBig(fractionBig *pFrac);
+
+/**
+ * Clones a big fraction number into a newly alloc'ed one
+ *
+ * @param  [out]ppOut The cloned fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_cloneBig(fractionBig **ppOut, fractionBig *pSrc);
+
+/**
+ * Adds two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on failure
+ */
+int fractionBig_sum(fractionBig *pOut, fractionBig *pA, fractionBig *pB);
+
+/**
+ * Subtracts two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on failure
+ */
+int fractionBig_sub(fractionBig *pOut, fractionBig *pA, fractionBig *pB);
+
+/**
+ * Multiplies two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factors
+ * @return           0 on success, 1 on failure
+ */
+int fractionBig_mul(fractionBig *pOut, fractionBig *pA, fractionBig *pB);
+
+/**
+ * Divides two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   The dividend
+ * @param  [ in]pB   The divisor
+ * @return           0 on success, 1 on failure or division by zero
+ */
+int fractionBig_div(fractionBig *pOut, fractionBig *pA, fractionBig *pB);
+
+/**
+ * Converts a big fractional number to a 64 bits one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The big fraction
+ * @return            0 on success, 1 if it doesn't fit into 64 bits
+ */
+int fractionBig_narrow(fraction64 *pOut, fractionBig *pFrac);
+
+/**
+ * Converts a big fractional number to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 if the quotient doesn't fit into 64 bits
+ */
+int fractionBig_iconvert(int64_t *pOut, fractionBig *pFrac);
+
+/**
+ * Converts a big fractional number to a double
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fractionBig_dconvert(double *pOut, fractionBig *pFrac);
+
+/**
+ * Initializes a factored fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFractionFactored(fractionFactored **ppOut,
+        fractionManager *pMng, int numerator, int denominator);
+
+/**
+ * Initializes a factored fraction from an integer number
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_igetFractionFactored(fractionFactored **ppOut,
+        fractionManager *pMng, int val);
+
+/**
+ * Initializes a factored fraction with the value of a regular fraction
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_factorFraction(fractionFactored **ppOut, fraction *pSrc);
+
+/**
+ * Releases a factored fraction (and its list of factors) to the fraction
+ * manager
+ *
+ * @param  [ in]pFrac The number to be released
+ */
+void fractionManager_releaseFractionFactored(fractionFactored *pFrac);
+
+/**
+ * Clones a factored fraction number into a newly alloc'ed one
+ *
+ * @param  [out]ppOut The cloned fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_cloneFactored(fractionFactored **ppOut,
+        fractionFactored *pSrc);
+
+/**
+ * Adds two factored fractional numbers
+ *
+ * The sum can't be done on the lists of factors, so both fractions are
+ * converted to their 64 bits terms and the result is kept as regular terms
+ * (until it's used on a multiplication or division)
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on failure or if either the summands or
+ *                   the result don't fit into 64 bits terms
+ */
+int fractionFactored_sum(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB);
+
+/**
+ * Subtracts two factored fractional numbers
+ *
+ * The subtraction can't be done on the lists of factors, so both fractions
+ * are converted to their 64 bits terms and the result is kept as regular
+ * terms (until it's used on a multiplication or division)
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on failure or if either the inputs or the
+ *                   result don't fit into 64 bits terms
+ */
+int fractionFactored_sub(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB);
+
+/**
+ * Multiplies two factored fractional numbers, by adding the exponent of every
+ * prime factor (so it never overflows)
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on failure)
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factors
+ * @return           0 on success, 1 on failure
+ */
+int fractionFactored_mul(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB);
+
+/**
+ * Divides two factored fractional numbers, by subtracting the exponent of
+ * every prime factor (so it never overflows)
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on failure)
+ * @param  [ in]pA   The dividend
+ * @param  [ in]pB   The divisor
+ * @return           0 on success, 1 on failure or division by zero
+ */
+int fractionFactored_div(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB);
+
+/**
+ * Retrieve whether a factored fraction is currently stored as its list of
+ * prime factors (instead of as regular terms)
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            1 if it's stored as prime factors, 0 otherwise
+ */
+int fractionFactored_isFactored(fractionFactored *pFrac);
+
+/**
+ * Converts a factored fractional number to a regular one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The factored fraction
+ * @return            0 on success, 1 if it doesn't fit into a regular fraction
+ */
+int fractionFactored_narrow(fraction *pOut, fractionFactored *pFrac);
+
+/**
+ * Converts a factored fractional number to a 64 bits one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The factored fraction
+ * @return            0 on success, 1 if it doesn't fit into 64 bits
+ */
+int fractionFactored_narrow64(fraction64 *pOut, fractionFactored *pFrac);
+
+/**
+ * Converts a factored fractional number to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 if its terms don't fit into 64 bits
+ */
+int fractionFactored_iconvert(int64_t *pOut, fractionFactored *pFrac);
+
+/**
+ * Converts a factored fractional number to a double
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fractionFactored_dconvert(double *pOut, fractionFactored *pFrac);
+
+/**
+ * Initializes a pool of fractions
+ *
+ * @param  [out]ppOut    The alloc'ed and initialized pool
+ * @param  [ in]pMng     The fraction manager
+ * @param  [ in]capacity How many fractions should be pre-alloc'ed
+ * @return               0 on success, 1 on failure
+ */
+int fractionPool_init(fractionPool **ppOut, fractionManager *pMng,
+        int capacity);
+
+/**
+ * Releases a pool of fractions (and every fraction on it)
+ *
+ * @param  [ in]ppPool The pool to be dealloc'ed
+ */
+void fractionPool_clean(fractionPool **ppPool);
+
+/**
+ * Initializes a fraction on the pool from its numerator and denominator
+ *
+ * @param  [out]pOut        The fraction's handle
+ * @param  [ in]pPool       The pool
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure
+ */
+int fractionPool_getFraction(fractionHandle *pOut, fractionPool *pPool,
+        int numerator, int denominator);
+
+/**
+ * Initializes many fractions on the pool at once, reducing them in blocks
+ *
+ * NOTE: The handles aren't necessarily contiguous, since released ones are
+ *       recycled first
+ *
+ * @param  [out]pOut  The fractions' handles
+ * @param  [ in]pPool The pool
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions
+ * @return            0 on success, 1 on failure
+ */
+int fractionPool_getFractions(fractionHandle *pOut, fractionPool *pPool,
+        const int *pNums, const int *pDens, int len);
+
+/**
+ * Initializes a fraction on the pool from an integer number
+ *
+ * @param  [out]pOut  The fraction's handle
+ * @param  [ in]pPool The pool
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionPool_igetFraction(fractionHandle *pOut, fractionPool *pPool,
+        int val);
+
+/**
+ * Initializes a fraction on the pool with the value of a regular fraction
+ *
+ * @param  [out]pOut  The fraction's handle
+ * @param  [ in]pPool The pool
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionPool_fromFraction(fractionHandle *pOut, fractionPool *pPool,
+        fraction *pSrc);
+
+/**
+ * Releases a fraction, so its handle may be recycled
+ *
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_release(fractionPool *pPool, fractionHandle handle);
+
+/**
+ * Retrieve both arrays of the pool, so they may be directly processed
+ *
+ * NOTE: Both pointers are invalidated whenever a fraction is retrieved from
+ *       the pool (since the arrays may have to be expanded)!
+ *
+ * @param  [out]ppNumerators   Every fraction's numerator
+ * @param  [out]ppDenominators Every fraction's denominator
+ * @param  [out]pLen           Number of entries on each array (including
+ *                             released ones)
+ * @param  [ in]pPool          The pool
+ */
+void fractionPool_getArrays(int **ppNumerators, int **ppDenominators,
+        int *pLen, fractionPool *pPool);
+
+/**
+ * Adds two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     One of the summands
+ * @param  [ in]b     The other summand
+ */
+void fractionPool_sum(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b);
+
+/**
+ * Subtracts two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     The minuend
+ * @param  [ in]b     The subtrahend
+ */
+void fractionPool_sub(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b);
+
+/**
+ * Multiplies two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     One of the factors
+ * @param  [ in]b     The other factor
+ */
+void fractionPool_mul(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b);
+
+/**
+ * Divides two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     The dividend
+ * @param  [ in]b     The divisor
+ */
+void fractionPool_div(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b);
+
+/**
+ * Converts a fractional number on a pool to a regular fraction
+ *
+ * @param  [out]pOut   The converted fraction
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_toFraction(fraction *pOut, fractionPool *pPool,
+        fractionHandle handle);
+
+/**
+ * Converts a fractional number on a pool to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut   The converted fraction
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_iconvert(int *pOut, fractionPool *pPool,
+        fractionHandle handle);
+
+/**
+ * Converts a fractional number on a pool to a double
+ *
+ * @param  [out]pOut   The converted fraction
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_dconvert(double *pOut, fractionPool *pPool,
+        fractionHandle handle);
+
+/**
+ * Converts a fractional number on a pool through a division, retrieving the
+ * number's quotient and remainder
+ *
+ * @param  [out]pQuotOut The fraction's quotient
+ * @param  [out]pRemOut  The fraction's remainder
+ * @param  [ in]pPool    The pool
+ * @param  [ in]handle   The fraction
+ */
+void fractionPool_divConvert(int *pQuotOut, int *pRemOut, fractionPool *pPool,
+        fractionHandle handle);
+
+/**
+ * Initializes an accumulator (whose sum starts at zero)
+ *
+ * NOTE: The accumulator must be released before its manager
+ *
+ * @param  [out]ppOut The alloc'ed and initialized accumulator
+ * @param  [ in]pMng  The fraction manager
+ * @return            0 on success, 1 on failure
+ */
+int fractionAccumulator_init(fractionAccumulator **ppOut,
+        fractionManager *pMng);
+
+/**
+ * Releases an accumulator
+ *
+ * @param  [ in]ppAcc The accumulator to be dealloc'ed
+ */
+void fractionAccumulator_clean(fractionAccumulator **ppAcc);
+
+/**
+ * Resets the accumulator's sum back to zero
+ *
+ * @param  [ in]pAcc The accumulator
+ */
+void fractionAccumulator_reset(fractionAccumulator *pAcc);
+
+/**
+ * Adds a fractional number to the accumulator
+ *
+ * @param  [ in]pAcc  The accumulator
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 on failure (or if the fraction's
+ *                    denominator is zero)
+ */
+int fractionAccumulator_add(fractionAccumulator *pAcc, fraction *pFrac);
+
+/**
+ * Adds a fractional number, given by its numerator and denominator, to the
+ * accumulator
+ *
+ * @param  [ in]pAcc        The accumulator
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionAccumulator_addTerms(fractionAccumulator *pAcc, int numerator,
+        int denominator);
+
+/**
+ * Adds an array of fractional numbers to the accumulator
+ *
+ * NOTE: Fractions with a zero denominator are skipped
+ *
+ * @param  [ in]pAcc    The accumulator
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions
+ * @return              0 on success, 1 if any fraction couldn't be added
+ */
+int fractionAccumulator_addArray(fractionAccumulator *pAcc,
+        fraction **ppFracs, int len);
+
+/**
+ * Adds an array of fractional numbers, given by their numerators and
+ * denominators, to the accumulator
+ *
+ * NOTE: Fractions with a zero denominator are skipped
+ *
+ * @param  [ in]pAcc  The accumulator
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ * @return            0 on success, 1 if any fraction couldn't be added
+ */
+int fractionAccumulator_addTermsArray(fractionAccumulator *pAcc,
+        const int *pNums, const int *pDens, int len);
+
+/**
+ * Retrieve the accumulator's current sum, without resetting it
+ *
+ * @param  [out]pOut The sum (untouched on failure)
+ * @param  [ in]pAcc The accumulator
+ * @return           0 on success, 1 on failure or if the sum doesn't fit into
+ *                   a regular fraction
+ */
+int fractionAccumulator_snapshot(fraction *pOut, fractionAccumulator *pAcc);
+
+/**
+ * Retrieve the accumulator's current sum as a 64 bits fraction, without
+ * resetting it
+ *
+ * @param  [out]pOut The sum (untouched on failure)
+ * @param  [ in]pAcc The accumulator
+ * @return           0 on success, 1 on failure or if the sum doesn't fit into
+ *                   64 bits
+ */
+int fractionAccumulator_snapshot64(fraction64 *pOut,
+        fractionAccumulator *pAcc);
+
+/**
+ * Retrieve the accumulator's sum as a newly alloc'ed fraction, resetting
+ * the accumulator
+ *
+ * @param  [out]ppOut The alloc'ed fraction
+ * @param  [ in]pAcc  The accumulator (untouched on failure)
+ * @return            0 on success, 1 on failure or if the sum doesn't fit
+ *                    into a regular fraction
+ */
+int fractionAccumulator_finalize(fraction **ppOut,
+        fractionAccumulator *pAcc);
+
+/**
+ * Retrieve the accumulator's sum as a newly alloc'ed big fraction (so it
+ * always fits), resetting the accumulator
+ *
+ * @param  [out]ppOut The alloc'ed fraction
+ * @param  [ in]pAcc  The accumulator (untouched on failure)
+ * @return            0 on success, 1 on failure
+ */
+int fractionAccumulator_finalizeBig(fractionBig **ppOut,
+        fractionAccumulator *pAcc);
+
+/**
+ * Reduces every fraction of an array to its lowest terms (with its sign on
+ * the numerator)
+ *
+ * NOTE: Fractions with a zero denominator are left untouched
+ *
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ */
+void fractionBatch_normalize(int *pNums, int *pDens, int len);
+
+/**
+ * Adds two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The first summands' numerators
+ * @param  [ in]pDensA   The first summands' denominators
+ * @param  [ in]pNumsB   The second summands' numerators
+ * @param  [ in]pDensB   The second summands' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_sum(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len);
+
+/**
+ * Subtracts two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The minuends' numerators
+ * @param  [ in]pDensA   The minuends' denominators
+ * @param  [ in]pNumsB   The subtrahends' numerators
+ * @param  [ in]pDensB   The subtrahends' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_sub(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len);
+
+/**
+ * Multiplies two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The first factors' numerators
+ * @param  [ in]pDensA   The first factors' denominators
+ * @param  [ in]pNumsB   The second factors' numerators
+ * @param  [ in]pDensB   The second factors' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_mul(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len);
+
+/**
+ * Divides two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The dividends' numerators
+ * @param  [ in]pDensA   The dividends' denominators
+ * @param  [ in]pNumsB   The divisors' numerators
+ * @param  [ in]pDensB   The divisors' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_div(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len);
+
+/**
+ * Adds a fractional number to every element of an array
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The added number's numerator
+ * @param  [ in]den      The added number's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_sumScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len);
+
+/**
+ * Subtracts a fractional number from every element of an array
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The subtrahend's numerator
+ * @param  [ in]den      The subtrahend's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_subScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len);
+
+/**
+ * Multiplies every element of an array by a fractional number
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The factor's numerator
+ * @param  [ in]den      The factor's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_mulScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len);
+
+/**
+ * Divides every element of an array by a fractional number
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The divisor's numerator
+ * @param  [ in]den      The divisor's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_divScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len);
+
+/**
+ * Calculates the dot product of two arrays of fractional numbers (i.e., the
+ * sum of the products of their elements), reducing only the final result
+ *
+ * NOTE: If any fraction has a zero denominator, so does the result
+ *
+ * @param  [out]pOutNum The result's numerator
+ * @param  [out]pOutDen The result's denominator
+ * @param  [ in]pNumsA  The first factors' numerators
+ * @param  [ in]pDensA  The first factors' denominators
+ * @param  [ in]pNumsB  The second factors' numerators
+ * @param  [ in]pDensB  The second factors' denominators
+ * @param  [ in]len     Number of fractions on every array
+ */
+void fractionBatch_dot(int *pOutNum, int *pOutDen, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len);
+
+/**
+ * Converts an array of fractional numbers to doubles
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ */
+void fractionBatch_dconvert(double *pOut, const int *pNums, const int *pDens,
+        int len);
+
+/**
+ * Converts an array of fractional numbers to floats
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ */
+void fractionBatch_fconvert(float *pOut, const int *pNums, const int *pDens,
+        int len);
+
+/**
+ * Converts an array of fractional numbers to 64 bits decimal fixed points
+ *
+ * NOTE: Fractions with a zero denominator are converted to 0
+ *
+ * @param  [out]pOut          The converted fractions
+ * @param  [ in]pNums         The fractions' numerators
+ * @param  [ in]pDens         The fractions' denominators
+ * @param  [ in]decimalDigits Number of digits in the values that represent
+ *                            the decimal part (up to
+ *                            FRACTION_MAX_DECIMAL_DIGITS)
+ * @param  [ in]rounding      How results are rounded (one of
+ *                            FRACTION_ROUND_*)
+ * @param  [ in]len           Number of fractions on every array
+ * @return                    0 on success, 1 if any result didn't fit (and
+ *                            was saturated)
+ */
+int fractionBatch_fxconvert(int64_t *pOut, const int *pNums,
+        const int *pDens, int decimalDigits, int rounding, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __FRACTION_H__ */
 
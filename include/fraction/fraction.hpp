@@ -0,0 +1,561 @@
+/**
+ * Defines fractional numbers as a C++17 value type, so they may be stored on
+ * the stack, inlined and even evaluated at compile time
+ *
+ * Differently from the C API, these don't go through a fraction manager:
+ * libfraction::fraction<T> simply holds both terms, of type T (which must be
+ * one of int16_t, int32_t, int64_t or, if the compiler supports it, 128 bits
+ * integers, as libfraction::int128). Every operation is constexpr and keeps
+ * the result on its lowest terms, with a positive denominator.
+ *
+ * The width of T selects (at compile time) how operations are done:
+ * products are calculated on an integer twice as wide as T, so only the
+ * reduced result must fit into T. If there's no wider integer (i.e., for
+ * 128 bits terms), products are reduced before being calculated (like on 64
+ * bits fractions), so they only overflow if the result itself can't be
+ * represented. Every result is checked against T's range before being
+ * narrowed, and an overflowing result fails to compile if it's evaluated at
+ * compile time. At run time, just like with regular integers, it's undefined
+ * (i.e., it may wrap around).
+ *
+ * Fractions may be converted from and to the C API's fraction through
+ * fromFraction() and toFraction().
+ *
+ * @file include/fraction/fraction.hpp
+ */
+#ifndef __FRACTION_HPP__
+#define __FRACTION_HPP__
+
+#include <fraction/fraction.h>
+
+#include <cstdint>
+
+namespace libfraction {
+
+/**
+ * Width specialization of every supported type of term: the (signed) type
+ * used to calculate products and the unsigned type used to calculate the
+ * GCD. Unsupported types simply don't have a specialization
+ */
+template <typename T> struct fractionTraits;
+
+template <> struct fractionTraits<int16_t> {
+    typedef int32_t wide;
+    typedef uint16_t unsignedType;
+};
+
+template <> struct fractionTraits<int32_t> {
+    typedef int64_t wide;
+    typedef uint32_t unsignedType;
+};
+
+#if defined(__SIZEOF_INT128__)
+/** 128 bits integers (declared as extensions, so -pedantic doesn't warn) */
+__extension__ typedef __int128 int128;
+__extension__ typedef unsigned __int128 uint128;
+
+template <> struct fractionTraits<int64_t> {
+    typedef int128 wide;
+    typedef uint64_t unsignedType;
+};
+
+template <> struct fractionTraits<int128> {
+    typedef int128 wide;
+    typedef uint128 unsignedType;
+};
+#else
+template <> struct fractionTraits<int64_t> {
+    typedef int64_t wide;
+    typedef uint64_t unsignedType;
+};
+#endif
+
+namespace detail {
+
+/**
+ * Count the trailing zeros of a (non-zero) unsigned number
+ *
+ * @param  [ in]val The number
+ * @return          Its number of trailing zeros
+ */
+template <typename U>
+constexpr int ctz(U val) {
+    if constexpr (sizeof(U) <= sizeof(unsigned long long)) {
+        return __builtin_ctzll(static_cast<unsigned long long>(val));
+    }
+    else {
+        unsigned long long high = static_cast<unsigned long long>(val >> 64);
+        unsigned long long low = static_cast<unsigned long long>(val);
+
+        if (low != 0) {
+            return __builtin_ctzll(low);
+        }
+        return 64 + __builtin_ctzll(high);
+    }
+}
+
+/**
+ * Calculate the greatest common divisor of two unsigned numbers, through the
+ * binary GCD algorithm
+ *
+ * @param  [ in]a A number
+ * @param  [ in]b The other number
+ * @return        Their greatest common divisor (or the other number, if
+ *                either is zero)
+ */
+template <typename U>
+constexpr U gcd(U a, U b) {
+    if (a == 0) {
+        return b;
+    }
+    else if (b == 0) {
+        return a;
+    }
+
+    int shift = ctz(static_cast<U>(a | b));
+    a >>= ctz(a);
+    do {
+        b >>= ctz(b);
+        if (a > b) {
+            U tmp = a;
+            a = b;
+            b = tmp;
+        }
+        b -= a;
+    } while (b != 0);
+
+    return static_cast<U>(a << shift);
+}
+
+/**
+ * Retrieve the biggest value of a signed type (even if std::numeric_limits
+ * isn't specialized for it, like 128 bits integers on strict modes)
+ *
+ * @return The biggest value
+ */
+template <typename T>
+constexpr T maxValue() {
+    typedef typename fractionTraits<T>::unsignedType U;
+
+    return static_cast<T>(static_cast<U>(~U(0)) >> 1);
+}
+
+/**
+ * Called whenever a result doesn't fit into its fraction's terms
+ *
+ * It isn't constexpr, so any overflowing result evaluated at compile time
+ * fails to compile. At run time, it does nothing.
+ */
+inline void overflow() {}
+
+/**
+ * Narrow a (wider) result into a term, checking that it fits
+ *
+ * @param  [ in]val The result
+ * @return          The narrowed result
+ */
+template <typename T, typename W>
+constexpr T narrow(W val) {
+    if (val > W(maxValue<T>()) || val < W(-maxValue<T>() - 1)) {
+        overflow();
+    }
+    return static_cast<T>(val);
+}
+
+/**
+ * Retrieve the absolute value of a number, even if it's the smallest one
+ *
+ * @param  [ in]val The number
+ * @return          Its absolute value
+ */
+template <typename T>
+constexpr typename fractionTraits<T>::unsignedType abs(T val) {
+    typedef typename fractionTraits<T>::unsignedType U;
+
+    if (val < 0) {
+        return static_cast<U>(U(0) - static_cast<U>(val));
+    }
+    return static_cast<U>(val);
+}
+
+} /* namespace detail */
+
+/** Fractional number with terms of type T, always on its lowest terms */
+template <typename T>
+class fraction {
+public:
+    /** Type of both terms */
+    typedef T valueType;
+
+private:
+    typedef typename fractionTraits<T>::wide wide;
+    typedef typename fractionTraits<T>::unsignedType unsignedType;
+
+    /** Whether products may be calculated on a wider type */
+    static constexpr bool hasWide = sizeof(wide) > sizeof(T);
+
+    /** The fraction's numerator */
+    T numerator_;
+    /** The fraction's denominator (always positive) */
+    T denominator_;
+
+    /** Tag for constructing fractions already on their lowest terms */
+    struct reduced {};
+
+    /**
+     * Initializes a fraction already on its lowest terms
+     *
+     * @param  [ in]num The fraction's numerator
+     * @param  [ in]den The fraction's (positive) denominator
+     */
+    constexpr fraction(T num, T den, reduced) : numerator_(num),
+            denominator_(den) {}
+
+    /**
+     * Reduce a pair of numerator and denominator (of any integer type) to
+     * its lowest terms, moving the sign to the numerator
+     *
+     * @param  [ in]num The numerator
+     * @param  [ in]den The (non-zero) denominator
+     * @return          The reduced fraction
+     */
+    template <typename W>
+    static constexpr fraction reduce(W num, W den) {
+        typedef typename fractionTraits<W>::unsignedType UW;
+        bool isNegative = (num < 0) != (den < 0);
+        UW absNum = num < 0 ? UW(UW(0) - UW(num)) : UW(num);
+        UW absDen = den < 0 ? UW(UW(0) - UW(den)) : UW(den);
+        UW div = detail::gcd(absNum, absDen);
+
+        absNum /= div;
+        absDen /= div;
+        /* The smallest number's magnitude is one past the biggest one's */
+        UW maxT = static_cast<UW>(detail::maxValue<T>());
+        if (absDen > maxT || absNum > maxT + UW(isNegative)) {
+            detail::overflow();
+        }
+        if (isNegative) {
+            absNum = UW(0) - absNum;
+        }
+
+        return fraction(static_cast<T>(static_cast<W>(absNum)),
+                static_cast<T>(absDen), reduced());
+    }
+
+    /**
+     * Multiply two fractions, given by their terms
+     *
+     * NOTE: Either denominator may be negative, so this also divides
+     *       fractions
+     *
+     * @param  [ in]numA The first fraction's numerator
+     * @param  [ in]denA The first fraction's denominator
+     * @param  [ in]numB The second fraction's numerator
+     * @param  [ in]denB The second fraction's denominator
+     * @return           The product
+     */
+    static constexpr fraction mulTerms(T numA, T denA, T numB, T denB) {
+        if constexpr (hasWide) {
+            return reduce<wide>(wide(numA) * numB, wide(denA) * denB);
+        }
+        else {
+            /* Cancel the factors common to each numerator and the other
+             * denominator, so the products are already on their lowest
+             * terms */
+            T divAB = static_cast<T>(detail::gcd(detail::abs(numA),
+                    detail::abs(denB)));
+            T divBA = static_cast<T>(detail::gcd(detail::abs(numB),
+                    detail::abs(denA)));
+
+            return reduce<T>((numA / divAB) * (numB / divBA),
+                    (denA / divBA) * (denB / divAB));
+        }
+    }
+
+    /**
+     * Add (or subtract) two fractions on their lowest terms, through Knuth's
+     * method (so the only reduction needed is by the gcd between the sum and
+     * the gcd of both denominators)
+     *
+     * @param  [ in]a     The first fraction
+     * @param  [ in]b     The second fraction
+     * @param  [ in]isSub Whether the second fraction should be subtracted
+     * @return            The result
+     */
+    static constexpr fraction addTerms(const fraction &a, const fraction &b,
+            bool isSub) {
+        T div = static_cast<T>(detail::gcd(
+                static_cast<unsignedType>(a.denominator_),
+                static_cast<unsignedType>(b.denominator_)));
+        T mulA = b.denominator_ / div;
+        T mulB = a.denominator_ / div;
+        wide sum = wide(a.numerator_) * mulA;
+
+        if (isSub) {
+            sum -= wide(b.numerator_) * mulB;
+        }
+        else {
+            sum += wide(b.numerator_) * mulB;
+        }
+        if (sum == 0) {
+            return fraction(0, 1, reduced());
+        }
+
+        /* gcd(sum, div) == gcd(sum % div, div) */
+        wide divSum = static_cast<wide>(detail::gcd(
+                detail::abs(static_cast<T>(sum % div)),
+                static_cast<unsignedType>(div)));
+        wide den = wide(mulB) * (b.denominator_ / divSum);
+
+        return fraction(detail::narrow<T>(sum / divSum),
+                detail::narrow<T>(den), reduced());
+    }
+
+    /**
+     * Compare two fractions on their lowest terms without any products,
+     * through their continued fractions (so it never overflows)
+     *
+     * @param  [ in]numA The first fraction's numerator
+     * @param  [ in]denA The first fraction's (positive) denominator
+     * @param  [ in]numB The second fraction's numerator
+     * @param  [ in]denB The second fraction's (positive) denominator
+     * @return           -1 if a < b, 0 if they are equal and 1 if a > b
+     */
+    static constexpr int compareTerms(T numA, T denA, T numB, T denB) {
+        int sign = 1;
+
+        while (true) {
+            /* Floor division, so the remainders are never negative */
+            T quotA = numA / denA;
+            T remA = numA % denA;
+            T quotB = numB / denB;
+            T remB = numB % denB;
+
+            if (remA < 0) {
+                quotA--;
+                remA += denA;
+            }
+            if (remB < 0) {
+                quotB--;
+                remB += denB;
+            }
+
+            if (quotA != quotB) {
+                return quotA < quotB ? -sign : sign;
+            }
+            else if (remA == 0 || remB == 0) {
+                if (remA == remB) {
+                    return 0;
+                }
+                return remA == 0 ? -sign : sign;
+            }
+
+            /* Compare the reciprocals of the fractional parts, inverting the
+             * result */
+            numA = denA;
+            denA = remA;
+            numB = denB;
+            denB = remB;
+            sign = -sign;
+        }
+    }
+
+public:
+    /** Initializes a fraction as zero */
+    constexpr fraction() : numerator_(0), denominator_(1) {}
+
+    /**
+     * Initializes a fraction from an integer number
+     *
+     * @param  [ in]val The fraction's value
+     */
+    constexpr fraction(T val) : numerator_(val), denominator_(1) {}
+
+    /**
+     * Initializes a fraction from its numerator and denominator
+     *
+     * @param  [ in]num The fraction's numerator
+     * @param  [ in]den The fraction's (non-zero) denominator
+     */
+    constexpr fraction(T num, T den) : fraction(reduce<T>(num, den)) {}
+
+    /**
+     * Initializes a fraction from a compile-time ratio (e.g., std::milli)
+     *
+     * @return The fraction
+     */
+    template <typename R>
+    static constexpr fraction fromRatio() {
+        static_assert(static_cast<T>(R::num) == R::num &&
+                static_cast<T>(R::den) == R::den,
+                "ratio doesn't fit into the fraction's terms");
+        return fraction(static_cast<T>(R::num), static_cast<T>(R::den),
+                reduced());
+    }
+
+    /**
+     * Initializes a fraction with the value of a C API fraction
+     *
+     * @param  [ in]pSrc The original number
+     * @return           The fraction
+     */
+    static fraction fromFraction(::fraction *pSrc) {
+        int den = 0, num = 0;
+
+        fraction_getTerms(&num, &den, pSrc);
+        return fraction(static_cast<T>(num), static_cast<T>(den), reduced());
+    }
+
+    /**
+     * Converts the fraction to a newly alloc'ed C API fraction
+     *
+     * @param  [out]ppOut The alloc'ed/initialized fraction
+     * @param  [ in]pMng  The fraction manager (so all references are kept)
+     * @return            0 on success, 1 on failure (or if the terms don't
+     *                    fit into an int)
+     */
+    int toFraction(::fraction **ppOut, fractionManager *pMng) const {
+        if (static_cast<int>(numerator_) != numerator_ ||
+                static_cast<int>(denominator_) != denominator_) {
+            return 1;
+        }
+
+        return fractionManager_getFraction(ppOut, pMng,
+                static_cast<int>(numerator_), static_cast<int>(denominator_));
+    }
+
+    /**
+     * Converts the fraction to one with terms of another type
+     *
+     * @return The converted fraction (undefined, if it doesn't fit)
+     */
+    template <typename U>
+    explicit constexpr operator fraction<U>() const {
+        return fraction<U>(static_cast<U>(numerator_),
+                static_cast<U>(denominator_));
+    }
+
+    /** @return The fraction's numerator */
+    constexpr T numerator() const { return numerator_; }
+
+    /** @return The fraction's (always positive) denominator */
+    constexpr T denominator() const { return denominator_; }
+
+    /** @return The fraction's quotient (truncated toward zero) */
+    constexpr T quotient() const { return numerator_ / denominator_; }
+
+    /** @return The fraction's remainder (with the numerator's sign) */
+    constexpr T remainder() const { return numerator_ % denominator_; }
+
+    /** @return The fraction converted to a double */
+    explicit constexpr operator double() const {
+        return static_cast<double>(numerator_) /
+                static_cast<double>(denominator_);
+    }
+
+    /** @return The fraction converted to a float */
+    explicit constexpr operator float() const {
+        return static_cast<float>(static_cast<double>(*this));
+    }
+
+    constexpr fraction operator+() const { return *this; }
+
+    constexpr fraction operator-() const {
+        if (numerator_ < -detail::maxValue<T>()) {
+            detail::overflow();
+        }
+        return fraction(static_cast<T>(-numerator_), denominator_,
+                reduced());
+    }
+
+    friend constexpr fraction operator+(const fraction &a,
+            const fraction &b) {
+        return addTerms(a, b, false/*isSub*/);
+    }
+
+    friend constexpr fraction operator-(const fraction &a,
+            const fraction &b) {
+        return addTerms(a, b, true/*isSub*/);
+    }
+
+    friend constexpr fraction operator*(const fraction &a,
+            const fraction &b) {
+        return mulTerms(a.numerator_, a.denominator_, b.numerator_,
+                b.denominator_);
+    }
+
+    /** NOTE: The divisor musn't be zero */
+    friend constexpr fraction operator/(const fraction &a,
+            const fraction &b) {
+        return mulTerms(a.numerator_, a.denominator_, b.denominator_,
+                b.numerator_);
+    }
+
+    constexpr fraction &operator+=(const fraction &other) {
+        return *this = *this + other;
+    }
+
+    constexpr fraction &operator-=(const fraction &other) {
+        return *this = *this - other;
+    }
+
+    constexpr fraction &operator*=(const fraction &other) {
+        return *this = *this * other;
+    }
+
+    constexpr fraction &operator/=(const fraction &other) {
+        return *this = *this / other;
+    }
+
+    /**
+     * Compare two fractions
+     *
+     * @param  [ in]a A fraction
+     * @param  [ in]b The other fraction
+     * @return        -1 if a < b, 0 if they are equal and 1 if a > b
+     */
+    friend constexpr int compare(const fraction &a, const fraction &b) {
+        if constexpr (hasWide) {
+            wide lhs = wide(a.numerator_) * b.denominator_;
+            wide rhs = wide(b.numerator_) * a.denominator_;
+
+            return (lhs > rhs) - (lhs < rhs);
+        }
+        else {
+            return compareTerms(a.numerator_, a.denominator_, b.numerator_,
+                    b.denominator_);
+        }
+    }
+
+    /* Both fractions are on their lowest terms, so they are only equal if
+     * their terms are */
+    friend constexpr bool operator==(const fraction &a, const fraction &b) {
+        return a.numerator_ == b.numerator_ &&
+                a.denominator_ == b.denominator_;
+    }
+
+    friend constexpr bool operator!=(const fraction &a, const fraction &b) {
+        return !(a == b);
+    }
+
+    friend constexpr bool operator<(const fraction &a, const fraction &b) {
+        return compare(a, b) < 0;
+    }
+
+    friend constexpr bool operator<=(const fraction &a, const fraction &b) {
+        return compare(a, b) <= 0;
+    }
+
+    friend constexpr bool operator>(const fraction &a, const fraction &b) {
+        return compare(a, b) > 0;
+    }
+
+    friend constexpr bool operator>=(const fraction &a, const fraction &b) {
+        return compare(a, b) >= 0;
+    }
+};
+
+} /* namespace libfraction */
+
+#endif /* __FRACTION_HPP__ */
+
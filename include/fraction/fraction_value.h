@@ -0,0 +1,692 @@
+/**
+ * Defines fractional numbers as plain values, which don't depend on a
+ * fraction manager
+ *
+ * A fractionValue simply holds a numerator and a denominator, so it may be
+ * kept on the stack, on the caller's own arrays or even on registers. Every
+ * operation is a static inline function, so it may be inlined into its
+ * caller (instead of going through the shared library).
+ *
+ * Just like the manager's fractions, every operation stores its result on
+ * its lowest terms, with a positive denominator. Results are calculated on
+ * 64 bits and only then reduced, so they only overflow if the reduced result
+ * doesn't fit into an int (in which case it wraps around, like the regular
+ * fractions do).
+ *
+ * Sums and subtractions rely on their inputs also being on that form (as
+ * output by every operation), so they are only reduced by the gcd of the
+ * denominators (see fractionValue_addReduced) instead of by the gcd of the
+ * whole cross multiplied result.
+ *
+ * The manager's fractions are implemented on top of these, so both always
+ * agree on their results.
+ *
+ * Floating point numbers may be converted either exactly (if they fit) or
+ * into their best rational approximation, found by expanding the number's
+ * exact binary value into a continued fraction. Every convergent (and
+ * semiconvergent) of a continued fraction is already on its lowest terms,
+ * so those results are never reduced.
+ *
+ * @file include/fraction/fraction_value.h
+ */
+#ifndef __FRACTION_VALUE_H__
+#define __FRACTION_VALUE_H__
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+
+/** Biggest number of decimal digits on a fixed point conversion */
+#define FRACTION_MAX_DECIMAL_DIGITS 18
+
+/** Powers of ten, used by fixed point conversions */
+static const int64_t fractionValue_pow10[FRACTION_MAX_DECIMAL_DIGITS + 1] = {
+    1LL,
+    10LL,
+    100LL,
+    1000LL,
+    10000LL,
+    100000LL,
+    1000000LL,
+    10000000LL,
+    100000000LL,
+    1000000000LL,
+    10000000000LL,
+    100000000000LL,
+    1000000000000LL,
+    10000000000000LL,
+    100000000000000LL,
+    1000000000000000LL,
+    10000000000000000LL,
+    100000000000000000LL,
+    1000000000000000000LL
+};
+
+/** Fractional number, without any reference to a manager */
+struct stFractionValue {
+    /** The fraction's numerator */
+    int numerator;
+    /** The fraction's denominator */
+    int denominator;
+};
+typedef struct stFractionValue fractionValue;
+
+/**
+ * Calculate the greatest common divisor of two unsigned numbers, through the
+ * binary GCD algorithm
+ *
+ * @param  [ in]a A number
+ * @param  [ in]b The other number
+ * @return        Their greatest common divisor (or the other number, if
+ *                either is zero)
+ */
+static inline uint64_t fractionValue_gcd(uint64_t a, uint64_t b) {
+#if defined(__GNUC__)
+    int shift;
+
+    if (a == 0) {
+        return b;
+    }
+    else if (b == 0) {
+        return a;
+    }
+
+    shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            uint64_t tmp;
+
+            tmp = a;
+            a = b;
+            b = tmp;
+        }
+        b -= a;
+    } while (b != 0);
+
+    return a << shift;
+#else
+    while (b != 0) {
+        uint64_t tmp;
+
+        tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+
+    return a;
+#endif
+}
+
+/**
+ * Store a (widened) pair of numerator and denominator on its lowest terms,
+ * moving the sign to the numerator
+ *
+ * NOTE: A zero denominator is stored untouched
+ *
+ * @param  [out]pOut The fraction
+ * @param  [ in]num  The numerator
+ * @param  [ in]den  The denominator
+ */
+static inline void fractionValue_store(fractionValue *pOut, int64_t num,
+        int64_t den) {
+    uint64_t absDen, absNum, div;
+    int isNegative;
+
+    if (den == 0) {
+        pOut->numerator = (int)num;
+        pOut->denominator = 0;
+        return;
+    }
+
+    /* Work on the absolute values, so INT64_MIN is handled correctly */
+    isNegative = (num < 0) != (den < 0);
+    absNum = (uint64_t)num;
+    if (num < 0) {
+        absNum = 0u - absNum;
+    }
+    absDen = (uint64_t)den;
+    if (den < 0) {
+        absDen = 0u - absDen;
+    }
+
+    div = fractionValue_gcd(absNum, absDen);
+    absNum /= div;
+    absDen /= div;
+
+    if (isNegative) {
+        absNum = 0u - absNum;
+    }
+    pOut->numerator = (int)(int64_t)absNum;
+    pOut->denominator = (int)absDen;
+}
+
+/**
+ * Initializes a fraction from its numerator and denominator
+ *
+ * @param  [out]pOut        The fraction
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 if the denominator is zero
+ */
+static inline int fractionValue_init(fractionValue *pOut, int numerator,
+        int denominator) {
+    if (denominator == 0) {
+        return 1;
+    }
+
+    fractionValue_store(pOut, numerator, denominator);
+    return 0;
+}
+
+/**
+ * Simplify a fraction, in place, to its lowest terms
+ *
+ * @param  [ in]pFrac The fraction
+ */
+static inline void fractionValue_reduce(fractionValue *pFrac) {
+    fractionValue_store(pFrac, pFrac->numerator, pFrac->denominator);
+}
+
+/**
+ * Adds two fractions on their lowest terms (with positive denominators),
+ * storing the result on its lowest terms
+ *
+ * Given g = gcd(denA, denB), the sum is
+ * t / lcm(denA, denB), with t = numA * (denB / g) + numB * (denA / g). Since
+ * both inputs are on their lowest terms, any factor shared by t and the lcm
+ * must also divide g. So, the result is reduced by gcd(t, g), which is
+ * cheaper than the gcd of the cross multiplied result (and unneeded if the
+ * denominators are coprime, which is the most common case). This is
+ * algorithm 4.5.1 from Knuth's TAOCP, vol. 2.
+ *
+ * NOTE: Inputs that aren't on their lowest terms result in the correct
+ *       value, but not necessarily on its lowest terms
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]numA The first summand's numerator
+ * @param  [ in]denA The first summand's denominator (positive)
+ * @param  [ in]numB The second summand's numerator
+ * @param  [ in]denB The second summand's denominator (positive)
+ */
+static inline void fractionValue_addReduced(fractionValue *pOut,
+        int64_t numA, int64_t denA, int64_t numB, int64_t denB) {
+    uint64_t absNum, div, div2;
+    int64_t num;
+
+    div = fractionValue_gcd((uint64_t)denA, (uint64_t)denB);
+    if (div == 1) {
+        pOut->numerator = (int)(numA * denB + numB * denA);
+        pOut->denominator = (int)(denA * denB);
+        return;
+    }
+
+    /* Every term fits into 62 bits, so this never overflows */
+    num = numA * (denB / (int64_t)div) + numB * (denA / (int64_t)div);
+    absNum = (uint64_t)num;
+    if (num < 0) {
+        absNum = 0u - absNum;
+    }
+    div2 = fractionValue_gcd(absNum, div);
+
+    pOut->numerator = (int)(num / (int64_t)div2);
+    pOut->denominator = (int)((denA / (int64_t)div) * (denB / (int64_t)div2));
+}
+
+/**
+ * Adds two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ */
+static inline void fractionValue_sum(fractionValue *pOut,
+        const fractionValue *pA, const fractionValue *pB) {
+    if (pA->denominator > 0 && pB->denominator > 0) {
+        fractionValue_addReduced(pOut, pA->numerator, pA->denominator,
+                pB->numerator, pB->denominator);
+        return;
+    }
+
+    fractionValue_store(pOut,
+            (int64_t)pA->numerator * pB->denominator +
+            (int64_t)pB->numerator * pA->denominator,
+            (int64_t)pA->denominator * pB->denominator);
+}
+
+/**
+ * Subtracts two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ */
+static inline void fractionValue_sub(fractionValue *pOut,
+        const fractionValue *pA, const fractionValue *pB) {
+    if (pA->denominator > 0 && pB->denominator > 0) {
+        fractionValue_addReduced(pOut, pA->numerator, pA->denominator,
+                -(int64_t)pB->numerator, pB->denominator);
+        return;
+    }
+
+    fractionValue_store(pOut,
+            (int64_t)pA->numerator * pB->denominator -
+            (int64_t)pB->numerator * pA->denominator,
+            (int64_t)pA->denominator * pB->denominator);
+}
+
+/**
+ * Multiplies two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factors
+ */
+static inline void fractionValue_mul(fractionValue *pOut,
+        const fractionValue *pA, const fractionValue *pB) {
+    fractionValue_store(pOut, (int64_t)pA->numerator * pB->numerator,
+            (int64_t)pA->denominator * pB->denominator);
+}
+
+/**
+ * Divides two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (with a zero denominator, if the
+ *                   divisor is zero)
+ * @param  [ in]pA   The dividend
+ * @param  [ in]pB   The divisor
+ */
+static inline void fractionValue_div(fractionValue *pOut,
+        const fractionValue *pA, const fractionValue *pB) {
+    fractionValue_store(pOut, (int64_t)pA->numerator * pB->denominator,
+            (int64_t)pA->denominator * pB->numerator);
+}
+
+/**
+ * Compare two fractional numbers (with positive denominators)
+ *
+ * @param  [ in]pA A fraction
+ * @param  [ in]pB The other fraction
+ * @return         -1 if A < B, 0 if they are equal and 1 if A > B
+ */
+static inline int fractionValue_compare(const fractionValue *pA,
+        const fractionValue *pB) {
+    int64_t lhs, rhs;
+
+    lhs = (int64_t)pA->numerator * pB->denominator;
+    rhs = (int64_t)pB->numerator * pA->denominator;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/**
+ * Converts a fractional number to an integer, retrieving only its quotient
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+static inline void fractionValue_iconvert(int *pOut,
+        const fractionValue *pFrac) {
+    *pOut = pFrac->numerator / pFrac->denominator;
+}
+
+/**
+ * Converts a fractional number to a decimal fixed point
+ *
+ * @param  [out]pOut          The converted fraction
+ * @param  [ in]pFrac         The fraction
+ * @param  [ in]decimalDigits Number of digits in the value that represents the
+ *                            decimal part (up to
+ *                            FRACTION_MAX_DECIMAL_DIGITS)
+ */
+static inline void fractionValue_fxconvert(int *pOut,
+        const fractionValue *pFrac, int decimalDigits) {
+    int64_t multiplier;
+
+    if (decimalDigits <= 0) {
+        multiplier = 1;
+    }
+    else if (decimalDigits > FRACTION_MAX_DECIMAL_DIGITS) {
+        multiplier = fractionValue_pow10[FRACTION_MAX_DECIMAL_DIGITS];
+    }
+    else {
+        multiplier = fractionValue_pow10[decimalDigits];
+    }
+
+#if defined(__SIZEOF_INT128__)
+    /* Past 9 digits, the numerator times the multiplier needs more than 64
+     * bits (declared as an extension, so -pedantic doesn't warn) */
+    if (multiplier > 1000000000LL) {
+        *pOut = __extension__ (int)(int64_t)((__int128)pFrac->numerator *
+                multiplier / pFrac->denominator);
+        return;
+    }
+#endif
+    *pOut = (int)(pFrac->numerator * multiplier / pFrac->denominator);
+}
+
+/**
+ * Converts a fractional number to a float
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+static inline void fractionValue_fconvert(float *pOut,
+        const fractionValue *pFrac) {
+    *pOut = pFrac->numerator / (float)pFrac->denominator;
+}
+
+/**
+ * Converts a fractional number to a double
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+static inline void fractionValue_dconvert(double *pOut,
+        const fractionValue *pFrac) {
+    *pOut = pFrac->numerator / (double)pFrac->denominator;
+}
+
+/**
+ * Converts a fractional number through a division, retrieving the number's
+ * quotient and remainder
+ *
+ * @param  [out]pQuotOut The fraction's quotient
+ * @param  [out]pRemOut  The fraction's remainder
+ * @param  [ in]pFrac    The fraction
+ */
+static inline void fractionValue_divConvert(int *pQuotOut, int *pRemOut,
+        const fractionValue *pFrac) {
+    *pQuotOut = pFrac->numerator / pFrac->denominator;
+    *pRemOut = pFrac->numerator % pFrac->denominator;
+}
+
+/**
+ * Decompose a (non-negative) double into its exact binary value, i.e.,
+ * mantissa / 2^shift
+ *
+ * NOTE: Values below 2^-10 may be rounded, so the shift fits into 63 bits
+ *       (which only affects approximations with denominators way bigger
+ *       than an int)
+ *
+ * @param  [out]pMantissa The number's mantissa, without trailing zeros
+ * @param  [out]pShift    The exponent of the denominator (at least 0)
+ * @param  [ in]val       The number (less than 2^63)
+ */
+static inline void fractionValue_decompose(uint64_t *pMantissa, int *pShift,
+        double val) {
+    uint64_t mantissa;
+    int exp, shift;
+
+    if (val == 0) {
+        *pMantissa = 0;
+        *pShift = 0;
+        return;
+    }
+
+    /* val = frac * 2^exp, with frac in [0.5, 1), so frac * 2^53 is exact */
+    mantissa = (uint64_t)ldexp(frexp(val, &exp), 53);
+    shift = 53 - exp;
+    if (shift > 63) {
+        /* Round the bits that don't fit */
+        if (shift - 63 >= 64) {
+            mantissa = 0;
+        }
+        else {
+            mantissa = (mantissa + ((uint64_t)1 << (shift - 64))) >>
+                    (shift - 63);
+        }
+        shift = 63;
+    }
+    else if (shift < 0) {
+        mantissa <<= -shift;
+        shift = 0;
+    }
+
+    if (mantissa == 0) {
+        shift = 0;
+    }
+    else {
+        int zeros;
+
+#if defined(__GNUC__)
+        zeros = __builtin_ctzll(mantissa);
+#else
+        zeros = 0;
+        while (((mantissa >> zeros) & 1) == 0) {
+            zeros++;
+        }
+#endif
+        if (zeros > shift) {
+            zeros = shift;
+        }
+        mantissa >>= zeros;
+        shift -= zeros;
+    }
+
+    *pMantissa = mantissa;
+    *pShift = shift;
+}
+
+/**
+ * Check whether an approximation is close enough to a number
+ *
+ * @param  [ in]val      The (non-negative) number
+ * @param  [ in]num      The approximation's numerator
+ * @param  [ in]den      The approximation's denominator
+ * @param  [ in]maxError Maximum distance to the number (or 0, so it must
+ *                       convert back to the very same double; or negative,
+ *                       so nothing is close enough)
+ * @return               1 if it's close enough, 0 otherwise
+ */
+static inline int fractionValue_isClose(double val, uint64_t num,
+        uint64_t den, double maxError) {
+    if (maxError < 0) {
+        return 0;
+    }
+    else if (maxError == 0) {
+        return (double)num / (double)den == val;
+    }
+    return fabs(val - (double)num / (double)den) <= maxError;
+}
+
+/**
+ * Initializes a fraction from the best rational approximation of a double
+ *
+ * The number is expanded into a continued fraction until either one of its
+ * convergents is close enough to the number, or until the next convergent
+ * wouldn't fit. In the first case, the fraction with the smallest
+ * denominator that's close enough is returned. In the later, the closest
+ * fraction whose terms fit is returned, so it's the best approximation with
+ * a denominator up to maxDenominator.
+ *
+ * @param  [out]pOut           The fraction
+ * @param  [ in]val            The number
+ * @param  [ in]maxDenominator The biggest denominator (or 0, for INT_MAX)
+ * @param  [ in]maxError       Maximum distance to the number (or 0, to find
+ *                             the simplest fraction that converts back to the
+ *                             very same double; or negative, to only be
+ *                             bound by the denominator)
+ * @return                     0 on success, 1 if the number isn't finite or
+ *                             if it doesn't fit into an int
+ */
+static inline int fractionValue_dapprox(fractionValue *pOut, double val,
+        int maxDenominator, double maxError) {
+    uint64_t h0, h1, k0, k1, maxH, maxK, p, q;
+    double absVal;
+    int shift;
+
+    absVal = fabs(val);
+    if (!(absVal < (double)INT_MAX + 1.0)) {
+        /* Either too big, infinite or NaN */
+        return 1;
+    }
+    maxK = (maxDenominator > 0) ? (uint64_t)maxDenominator : INT_MAX;
+    maxH = INT_MAX;
+
+    /* Expand absVal = p / q, exactly (so no error accumulates) */
+    fractionValue_decompose(&p, &shift, absVal);
+    q = (uint64_t)1 << shift;
+
+    /* h1 / k1 is the last convergent, and h0 / k0 the one before it */
+    h0 = 0;
+    h1 = 1;
+    k0 = 1;
+    k1 = 0;
+    while (1) {
+        uint64_t a, h, k, r, t;
+        int isLast;
+
+        a = p / q;
+        r = p - a * q;
+        isLast = (r == 0);
+
+        /* Limit the partial quotient so both terms fit (which never happens
+         * on the first one, since absVal fits into an int) */
+        t = a;
+        if (h1 != 0 && (maxH - h0) / h1 < t) {
+            t = (maxH - h0) / h1;
+        }
+        if (k1 != 0 && (maxK - k0) / k1 < t) {
+            t = (maxK - k0) / k1;
+        }
+        if (t < a) {
+            /* The next convergent doesn't fit, so the best approximation is
+             * either the last convergent or the biggest semiconvergent that
+             * fits (which is only better if it's past the halfway point) */
+            if (t > 0 && t * 2 == a) {
+                double errLast, errSemi;
+
+                errLast = fabs(absVal - (double)h1 / (double)k1);
+                errSemi = fabs(absVal - (double)(t * h1 + h0) /
+                        (double)(t * k1 + k0));
+                if (errSemi >= errLast) {
+                    t = 0;
+                }
+            }
+            else if (t * 2 < a) {
+                t = 0;
+            }
+
+            if (t == 0) {
+                pOut->numerator = (val < 0) ? -(int)h1 : (int)h1;
+                pOut->denominator = (int)k1;
+                return 0;
+            }
+            a = t;
+            isLast = 1;
+        }
+
+        h = a * h1 + h0;
+        k = a * k1 + k0;
+        if (fractionValue_isClose(absVal, h, k, maxError)) {
+            if (a > 1) {
+                uint64_t hi, lo;
+
+                /* Semiconvergents approach the number monotonically, so
+                 * search for the smallest one that's close enough */
+                lo = 1;
+                hi = a;
+                while (lo < hi) {
+                    uint64_t mid;
+
+                    mid = lo + (hi - lo) / 2;
+                    if (fractionValue_isClose(absVal, mid * h1 + h0,
+                            mid * k1 + k0, maxError)) {
+                        hi = mid;
+                    }
+                    else {
+                        lo = mid + 1;
+                    }
+                }
+                h = lo * h1 + h0;
+                k = lo * k1 + k0;
+            }
+            isLast = 1;
+        }
+
+        if (isLast) {
+            pOut->numerator = (val < 0) ? -(int)h : (int)h;
+            pOut->denominator = (int)k;
+            return 0;
+        }
+
+        h0 = h1;
+        h1 = h;
+        k0 = k1;
+        k1 = k;
+        p = q;
+        q = r;
+    }
+}
+
+/**
+ * Initializes a fraction from the best rational approximation of a float
+ *
+ * See fractionValue_dapprox
+ *
+ * @param  [out]pOut           The fraction
+ * @param  [ in]val            The number
+ * @param  [ in]maxDenominator The biggest denominator (or 0, for INT_MAX)
+ * @param  [ in]maxError       Maximum distance to the number (or 0, to find
+ *                             the simplest fraction within half an ulp of
+ *                             the float; or negative, to only be bound by the
+ *                             denominator)
+ * @return                     0 on success, 1 if the number isn't finite or
+ *                             if it doesn't fit into an int
+ */
+static inline int fractionValue_fapprox(fractionValue *pOut, float val,
+        int maxDenominator, float maxError) {
+    double bound;
+
+    bound = maxError;
+    if (maxError == 0 && val != 0) {
+        int exp;
+
+        /* Floats have 24 bits of precision, so half an ulp is 2^(exp-25) */
+        frexp(val, &exp);
+        bound = ldexp(1.0, exp - 25);
+    }
+
+    return fractionValue_dapprox(pOut, val, maxDenominator, bound);
+}
+
+/**
+ * Initializes a fraction with the exact value of a double, decomposing it
+ * into a mantissa and a power of two
+ *
+ * @param  [out]pOut The fraction
+ * @param  [ in]val  The number
+ * @return           0 on success, 1 if the number isn't finite or if either
+ *                   term doesn't fit into an int
+ */
+static inline int fractionValue_dexact(fractionValue *pOut, double val) {
+    uint64_t mantissa;
+    int shift;
+
+    if (!(fabs(val) < (double)INT_MAX + 1.0)) {
+        return 1;
+    }
+
+    /* Only values below 2^-10 may be rounded, and those never fit */
+    fractionValue_decompose(&mantissa, &shift, fabs(val));
+    if (mantissa > INT_MAX || shift > 30) {
+        return 1;
+    }
+
+    pOut->numerator = (val < 0) ? -(int)mantissa : (int)mantissa;
+    pOut->denominator = 1 << shift;
+    return 0;
+}
+
+#endif /* __FRACTION_VALUE_H__ */
+
@@ -0,0 +1,243 @@
+/**
+ * Exact running sums of fractions, kept over a common denominator
+ *
+ * Terms are added to the running sum by scaling both of them to the least
+ * common multiple of their denominators, just like when summing two
+ * fractions. However, neither is reduced afterward. If the running
+ * denominator is already a multiple of the term's one (which is the most
+ * common case, once a few terms have been added), it doesn't even have to
+ * calculate a gcd.
+ *
+ * Every product and sum is checked for overflows. On overflow, both the
+ * running sum and the term are reduced and the term is added once again. If
+ * both were on their lowest terms and fit into an int, every intermediate
+ * value takes at most 63 bits. So, this only fails after a result that
+ * wouldn't be representable by regular fractions anyway.
+ *
+ * @file src/accum.c
+ */
+#include <fraction/fraction_value.h>
+#include <fraction_internal/accum.h>
+#include <fraction_internal/gcd.h>
+
+#include <stdint.h>
+
+/**
+ * Retrieve the absolute value of a number, even if it's INT64_MIN
+ *
+ * @param  [ in]val The number
+ * @return          Its absolute value
+ */
+static uint64_t accum_abs(int64_t val) {
+    if (val < 0) {
+        return 0u - (uint64_t)val;
+    }
+    return (uint64_t)val;
+}
+
+/**
+ * Initialize a running sum with a fraction
+ *
+ * @param  [out]pAcc The running sum
+ * @param  [ in]num  The fraction's numerator
+ * @param  [ in]den  The fraction's denominator
+ */
+void accum_init(accum *pAcc, int num, int den) {
+    if (den == 0) {
+        pAcc->num = 0;
+        pAcc->den = 0;
+    }
+    else if (den < 0) {
+        pAcc->num = -(int64_t)num;
+        pAcc->den = -(int64_t)den;
+    }
+    else {
+        pAcc->num = num;
+        pAcc->den = den;
+    }
+}
+
+/**
+ * Try to add a fraction to the running sum, without reducing either
+ *
+ * @param  [ in]pAcc The running sum
+ * @param  [ in]num  The term's numerator
+ * @param  [ in]den  The term's (positive) denominator
+ * @return           0 on success, 1 on overflow (and the running sum is left
+ *                   untouched)
+ */
+static int accum_tryAdd(accum *pAcc, int64_t num, int64_t den) {
+    int64_t mulSum, mulTerm, newDen, newNum, prodSum, prodTerm;
+
+    if (den == pAcc->den) {
+        if (__builtin_add_overflow(pAcc->num, num, &newNum)) {
+            return 1;
+        }
+        pAcc->num = newNum;
+        return 0;
+    }
+    else if (pAcc->num == 0) {
+        /* Drop the previous denominator, so it doesn't grow needlessly */
+        pAcc->num = num;
+        pAcc->den = den;
+        return 0;
+    }
+    else if (pAcc->den % den == 0) {
+        mulSum = 1;
+        mulTerm = pAcc->den / den;
+        newDen = pAcc->den;
+    }
+    else {
+        int64_t div;
+
+        div = (int64_t)gcd_u64((uint64_t)pAcc->den, (uint64_t)den);
+        mulSum = den / div;
+        mulTerm = pAcc->den / div;
+        if (__builtin_mul_overflow(pAcc->den, mulSum, &newDen)) {
+            return 1;
+        }
+    }
+
+    if (__builtin_mul_overflow(pAcc->num, mulSum, &prodSum) ||
+            __builtin_mul_overflow(num, mulTerm, &prodTerm) ||
+            __builtin_add_overflow(prodSum, prodTerm, &newNum)) {
+        return 1;
+    }
+    pAcc->num = newNum;
+    pAcc->den = newDen;
+
+    return 0;
+}
+
+/**
+ * Add a (widened) fraction to the running sum
+ *
+ * The term is always added exactly, unless even the sum of both reduced
+ * fractions can't be calculated on 64 bits (in which case, the running
+ * sum's value is left untouched)
+ *
+ * @param  [ in]pAcc The running sum
+ * @param  [ in]num  The term's numerator (which musn't be INT64_MIN)
+ * @param  [ in]den  The term's denominator (which musn't be INT64_MIN)
+ * @return           0 on success, 1 on overflow
+ */
+int accum_add(accum *pAcc, int64_t num, int64_t den) {
+    uint64_t div;
+
+    if (pAcc->den == 0) {
+        return 0;
+    }
+    else if (den == 0) {
+        pAcc->num = 0;
+        pAcc->den = 0;
+        return 0;
+    }
+    else if (den < 0) {
+        num = -num;
+        den = -den;
+    }
+
+    if (accum_tryAdd(pAcc, num, den) == 0) {
+        return 0;
+    }
+
+    /* Retry with both fractions on their lowest terms */
+    accum_reduce(pAcc);
+    div = gcd_u64(accum_abs(num), (uint64_t)den);
+    num /= (int64_t)div;
+    den /= (int64_t)div;
+
+    return accum_tryAdd(pAcc, num, den);
+}
+
+/**
+ * Add an array of fractions to the running sum, stopping at the first one
+ * that can't be added (i.e., that overflows the running sum or that has a
+ * zero denominator)
+ *
+ * @param  [ in]pAcc  The running sum
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ * @return            Number of fractions added
+ */
+int accum_addArray(accum *pAcc, const int *pNums, const int *pDens, int len) {
+    int i;
+
+    for (i = 0; i < len; i++) {
+        if (pDens[i] == 0 || accum_add(pAcc, pNums[i], pDens[i]) != 0) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * Add the product of two fractions to the running sum, just like
+ * accum_addProducts does for each pair of elements
+ *
+ * @param  [ in]pAcc The running sum
+ * @param  [ in]numA The first factor's numerator
+ * @param  [ in]denA The first factor's denominator
+ * @param  [ in]numB The second factor's numerator
+ * @param  [ in]denB The second factor's denominator
+ */
+void accum_addProduct(accum *pAcc, int numA, int denA, int numB, int denB) {
+    fractionValue a, b, sum;
+
+    /* Both products take at most 62 bits */
+    if (accum_add(pAcc, (int64_t)numA * numB,
+            (int64_t)denA * denB) == 0) {
+        return;
+    }
+
+    /* The partial sum (or the product) doesn't fit into an int, so wrap it
+     * around just like multiplying and then summing them would */
+    a.numerator = numA;
+    a.denominator = denA;
+    b.numerator = numB;
+    b.denominator = denB;
+    fractionValue_mul(&a, &a, &b);
+    fractionValue_store(&sum, pAcc->num, pAcc->den);
+    fractionValue_sum(&sum, &sum, &a);
+    accum_init(pAcc, sum.numerator, sum.denominator);
+}
+
+/**
+ * Add the products of the elements of two arrays of fractions to the running
+ * sum
+ *
+ * @param  [ in]pAcc   The running sum
+ * @param  [ in]pNumsA The first factors' numerators
+ * @param  [ in]pDensA The first factors' denominators
+ * @param  [ in]pNumsB The second factors' numerators
+ * @param  [ in]pDensB The second factors' denominators
+ * @param  [ in]len    Number of fractions on every array
+ */
+void accum_addProducts(accum *pAcc, const int *pNumsA, const int *pDensA,
+        const int *pNumsB, const int *pDensB, int len) {
+    int i;
+
+    for (i = 0; i < len; i++) {
+        accum_addProduct(pAcc, pNumsA[i], pDensA[i], pNumsB[i], pDensB[i]);
+    }
+}
+
+/**
+ * Reduce the running sum to its lowest terms
+ *
+ * @param  [ in]pAcc The running sum
+ */
+void accum_reduce(accum *pAcc) {
+    int64_t div;
+
+    if (pAcc->den == 0) {
+        return;
+    }
+
+    div = (int64_t)gcd_u64(accum_abs(pAcc->num), (uint64_t)pAcc->den);
+    pAcc->num /= div;
+    pAcc->den /= div;
+}
+
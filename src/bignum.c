@@ -0,0 +1,906 @@
+/**
+ * Arbitrary precision integers, used as the terms of big fractions
+ *
+ * Any number that fits into 64 bits is stored inline (on 'small'), without
+ * alloc'ing anything. As soon as an operation overflows, its result is
+ * promoted to a list of 32 bits limbs (on 'pLimbs', least significant limb
+ * first), which stores the number's magnitude. Results that fit into 64 bits
+ * once again are demoted back to their inline representation.
+ *
+ * Limbs are retrieved from the fraction manager, on pools of power-of-two
+ * sizes, so they are recycled just like fractions are.
+ *
+ * Every operation is done on "views" of its operands, which simply point to
+ * the magnitude's limbs (converting inline values to limbs on the stack), so
+ * only the actual algorithms on magnitudes have to be implemented. Multiplying
+ * is done through the schoolbook method and dividing through Knuth's
+ * algorithm D.
+ *
+ * @file src/bignum.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/bignum.h>
+#include <fraction_internal/gcd.h>
+#include <fraction_internal/manager.h>
+#include <fraction_internal/pool.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Magnitude of a number, as a list of limbs */
+struct stBignumView {
+    /** The magnitude's limbs, least significant first */
+    const uint32_t *pLimbs;
+    /** Number of limbs (without leading zeros, so 0 has no limbs) */
+    int numLimbs;
+    /** Whether the number is negative */
+    int isNegative;
+    /** Storage for inline values */
+    uint32_t small[2];
+};
+typedef struct stBignumView bignumView;
+
+/**
+ * Retrieve a list of limbs from the manager
+ *
+ * @param  [out]ppLimbs  The list of limbs
+ * @param  [out]pCap     How many limbs were actually alloc'ed
+ * @param  [ in]pMng     The fraction manager
+ * @param  [ in]numLimbs Minimum number of limbs
+ * @return               0 on success, 1 on failure
+ */
+static int bignum_allocLimbs(uint32_t **ppLimbs, int *pCap,
+        fractionManager *pMng, int numLimbs) {
+    pool *pPool;
+    int cap, i;
+
+    /* Find the smallest size that fits the requested number of limbs */
+    cap = BIGNUM_MIN_LIMBS;
+    i = 0;
+    while (cap < numLimbs) {
+        cap <<= 1;
+        i++;
+    }
+    if (i >= BIGNUM_NUM_CLASSES) {
+        return 1;
+    }
+
+    /* Each pool is only initialized when it's first used, and roughly 16KB
+     * are alloc'ed at once. On concurrent managers, only one thread may
+     * initialize it */
+    pPool = &(pMng->limbs[i]);
+    if (!pool_isReady(pPool)) {
+        int irv, num;
+
+        num = 16384 / (cap * sizeof(uint32_t));
+        if (num < 1) {
+            num = 1;
+        }
+
+        irv = 0;
+        if (pMng->isConcurrent) {
+            pthread_mutex_lock(&(pMng->lock));
+        }
+        if (!pool_isReady(pPool)) {
+            irv = pool_init(pPool, cap * sizeof(uint32_t), num,
+                    pMng->isConcurrent);
+        }
+        if (pMng->isConcurrent) {
+            pthread_mutex_unlock(&(pMng->lock));
+        }
+        if (irv != 0) {
+            return 1;
+        }
+    }
+
+    if (pool_getObject((void**)ppLimbs, pPool) != 0) {
+        return 1;
+    }
+    *pCap = cap;
+
+    return 0;
+}
+
+/**
+ * Return a list of limbs to the manager
+ *
+ * @param  [ in]pMng    The fraction manager
+ * @param  [ in]pLimbs  The list of limbs
+ * @param  [ in]capLimbs How many limbs were alloc'ed
+ */
+static void bignum_freeLimbs(fractionManager *pMng, uint32_t *pLimbs,
+        int capLimbs) {
+    int i;
+
+    i = 0;
+    while ((BIGNUM_MIN_LIMBS << i) < capLimbs) {
+        i++;
+    }
+    pool_releaseObject(&(pMng->limbs[i]), pLimbs);
+}
+
+/**
+ * Retrieve a view of a number's magnitude
+ *
+ * @param  [out]pView The view
+ * @param  [ in]pNum  The number
+ */
+static void bignum_getView(bignumView *pView, const bignum *pNum) {
+    uint64_t mag;
+
+    if (pNum->pLimbs) {
+        pView->pLimbs = pNum->pLimbs;
+        pView->numLimbs = pNum->numLimbs;
+        pView->isNegative = pNum->isNegative;
+        return;
+    }
+
+    pView->isNegative = (pNum->small < 0);
+    mag = (uint64_t)pNum->small;
+    if (pView->isNegative) {
+        mag = 0u - mag;
+    }
+    pView->small[0] = (uint32_t)mag;
+    pView->small[1] = (uint32_t)(mag >> 32);
+    pView->pLimbs = pView->small;
+    if (pView->small[1] != 0) {
+        pView->numLimbs = 2;
+    }
+    else if (pView->small[0] != 0) {
+        pView->numLimbs = 1;
+    }
+    else {
+        pView->numLimbs = 0;
+    }
+}
+
+/**
+ * Store a freshly computed magnitude on a number, demoting it to an inline
+ * value if it fits into 64 bits
+ *
+ * NOTE: The output takes ownership of the list of limbs
+ *
+ * @param  [ in]pMng       The fraction manager
+ * @param  [out]pOut       The number
+ * @param  [ in]pLimbs     The magnitude (alloc'ed from bignum_allocLimbs)
+ * @param  [ in]capLimbs   How many limbs were alloc'ed
+ * @param  [ in]numLimbs   How many limbs are used
+ * @param  [ in]isNegative Whether the number is negative
+ */
+static void bignum_adopt(fractionManager *pMng, bignum *pOut,
+        uint32_t *pLimbs, int capLimbs, int numLimbs, int isNegative) {
+    while (numLimbs > 0 && pLimbs[numLimbs - 1] == 0) {
+        numLimbs--;
+    }
+
+    bignum_clean(pMng, pOut);
+
+    if (numLimbs <= 2) {
+        uint64_t mag;
+
+        mag = 0;
+        if (numLimbs > 0) {
+            mag = pLimbs[0];
+        }
+        if (numLimbs > 1) {
+            mag |= (uint64_t)pLimbs[1] << 32;
+        }
+
+        if (mag <= (uint64_t)INT64_MAX ||
+                (isNegative && mag == (uint64_t)INT64_MAX + 1)) {
+            bignum_freeLimbs(pMng, pLimbs, capLimbs);
+            if (isNegative) {
+                mag = 0u - mag;
+            }
+            pOut->small = (int64_t)mag;
+            return;
+        }
+    }
+
+    pOut->pLimbs = pLimbs;
+    pOut->capLimbs = capLimbs;
+    pOut->numLimbs = numLimbs;
+    pOut->isNegative = isNegative;
+}
+
+/**
+ * Store a copy of a magnitude on a number
+ *
+ * @param  [ in]pMng       The fraction manager
+ * @param  [out]pOut       The number
+ * @param  [ in]pLimbs     The magnitude
+ * @param  [ in]numLimbs   How many limbs are used
+ * @param  [ in]isNegative Whether the number is negative
+ * @return                 0 on success, 1 on failure
+ */
+static int bignum_setMagnitude(fractionManager *pMng, bignum *pOut,
+        const uint32_t *pLimbs, int numLimbs, int isNegative) {
+    uint32_t *pCopy;
+    int cap;
+
+    if (numLimbs <= 2) {
+        uint64_t mag;
+
+        mag = 0;
+        if (numLimbs > 0) {
+            mag = pLimbs[0];
+        }
+        if (numLimbs > 1) {
+            mag |= (uint64_t)pLimbs[1] << 32;
+        }
+
+        if (mag <= (uint64_t)INT64_MAX ||
+                (isNegative && mag == (uint64_t)INT64_MAX + 1)) {
+            bignum_clean(pMng, pOut);
+            if (isNegative) {
+                mag = 0u - mag;
+            }
+            pOut->small = (int64_t)mag;
+            return 0;
+        }
+    }
+
+    if (bignum_allocLimbs(&pCopy, &cap, pMng, numLimbs) != 0) {
+        return 1;
+    }
+    memcpy(pCopy, pLimbs, sizeof(uint32_t) * numLimbs);
+    bignum_adopt(pMng, pOut, pCopy, cap, numLimbs, isNegative);
+
+    return 0;
+}
+
+/**
+ * Compare two magnitudes
+ *
+ * @param  [ in]pA A magnitude
+ * @param  [ in]pB The other magnitude
+ * @return         -1 if A < B, 0 if A == B and 1 if A > B
+ */
+static int bignum_cmpMagnitude(const bignumView *pA, const bignumView *pB) {
+    int i;
+
+    if (pA->numLimbs != pB->numLimbs) {
+        return (pA->numLimbs < pB->numLimbs) ? -1 : 1;
+    }
+
+    i = pA->numLimbs - 1;
+    while (i >= 0) {
+        if (pA->pLimbs[i] != pB->pLimbs[i]) {
+            return (pA->pLimbs[i] < pB->pLimbs[i]) ? -1 : 1;
+        }
+        i--;
+    }
+
+    return 0;
+}
+
+/**
+ * Add two magnitudes
+ *
+ * @param  [out]pOut Output magnitude (with space for max(A, B) + 1 limbs)
+ * @param  [ in]pA   A magnitude
+ * @param  [ in]pB   The other magnitude
+ * @return           How many limbs were written
+ */
+static int bignum_addMagnitude(uint32_t *pOut, const bignumView *pA,
+        const bignumView *pB) {
+    uint64_t carry;
+    int i, len;
+
+    len = pA->numLimbs;
+    if (pB->numLimbs > len) {
+        len = pB->numLimbs;
+    }
+
+    carry = 0;
+    i = 0;
+    while (i < len) {
+        if (i < pA->numLimbs) {
+            carry += pA->pLimbs[i];
+        }
+        if (i < pB->numLimbs) {
+            carry += pB->pLimbs[i];
+        }
+        pOut[i] = (uint32_t)carry;
+        carry >>= 32;
+        i++;
+    }
+    pOut[len] = (uint32_t)carry;
+
+    return len + 1;
+}
+
+/**
+ * Subtract two magnitudes
+ *
+ * @param  [out]pOut Output magnitude (with space for A limbs)
+ * @param  [ in]pA   The bigger magnitude
+ * @param  [ in]pB   The smaller magnitude
+ * @return           How many limbs were written
+ */
+static int bignum_subMagnitude(uint32_t *pOut, const bignumView *pA,
+        const bignumView *pB) {
+    int64_t borrow;
+    int i;
+
+    borrow = 0;
+    i = 0;
+    while (i < pA->numLimbs) {
+        borrow += pA->pLimbs[i];
+        if (i < pB->numLimbs) {
+            borrow -= pB->pLimbs[i];
+        }
+        pOut[i] = (uint32_t)borrow;
+        /* Either 0 or -1 */
+        borrow = (borrow < 0) ? -1 : 0;
+        i++;
+    }
+
+    return pA->numLimbs;
+}
+
+/**
+ * Initializes a number from an integer (this never allocs anything)
+ *
+ * @param  [ in]pNum The number
+ * @param  [ in]val  Its initial value
+ */
+void bignum_init(bignum *pNum, int64_t val) {
+    memset(pNum, 0x0, sizeof(bignum));
+    pNum->small = val;
+}
+
+/**
+ * Releases the number's limbs (if any), setting it to 0
+ *
+ * @param  [ in]pMng The fraction manager that alloc'ed the limbs
+ * @param  [ in]pNum The number
+ */
+void bignum_clean(fractionManager *pMng, bignum *pNum) {
+    if (pNum->pLimbs) {
+        bignum_freeLimbs(pMng, pNum->pLimbs, pNum->capLimbs);
+    }
+    bignum_init(pNum, 0);
+}
+
+/**
+ * Retrieve a number's sign
+ *
+ * @param  [ in]pNum The number
+ * @return           -1 if it's negative, 0 if it's zero and 1 if positive
+ */
+int bignum_sign(const bignum *pNum) {
+    if (pNum->pLimbs) {
+        /* Promoted numbers are never zero */
+        return pNum->isNegative ? -1 : 1;
+    }
+    return (pNum->small > 0) - (pNum->small < 0);
+}
+
+/**
+ * Copy a number
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The copy
+ * @param  [ in]pSrc The original number
+ * @return           0 on success, 1 on failure
+ */
+int bignum_copy(fractionManager *pMng, bignum *pOut, const bignum *pSrc) {
+    if (pOut == pSrc) {
+        return 0;
+    }
+    else if (!pSrc->pLimbs) {
+        bignum_clean(pMng, pOut);
+        pOut->small = pSrc->small;
+        return 0;
+    }
+
+    return bignum_setMagnitude(pMng, pOut, pSrc->pLimbs, pSrc->numLimbs,
+            pSrc->isNegative);
+}
+
+/**
+ * Negate a number, in place
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [ in]pNum The number
+ * @return           0 on success, 1 on failure
+ */
+int bignum_negate(fractionManager *pMng, bignum *pNum) {
+    bignumView view;
+
+    if (pNum->pLimbs) {
+        pNum->isNegative = !pNum->isNegative;
+        return 0;
+    }
+    else if (pNum->small != INT64_MIN) {
+        pNum->small = -pNum->small;
+        return 0;
+    }
+
+    /* -INT64_MIN must be promoted */
+    bignum_getView(&view, pNum);
+    return bignum_setMagnitude(pMng, pNum, view.pLimbs, view.numLimbs, 0);
+}
+
+/**
+ * Add (or subtract) two numbers
+ *
+ * @param  [ in]pMng    The fraction manager
+ * @param  [out]pOut    The result
+ * @param  [ in]pA      The first operand
+ * @param  [ in]pB      The second operand
+ * @param  [ in]negateB Whether the second operand should be subtracted
+ * @return              0 on success, 1 on failure
+ */
+static int bignum_addSigned(fractionManager *pMng, bignum *pOut,
+        const bignum *pA, const bignum *pB, int negateB) {
+    bignumView viewA, viewB;
+    uint32_t *pLimbs;
+    int cap, isNegative, len;
+
+    if (!pA->pLimbs && !pB->pLimbs) {
+        int64_t res;
+        int irv;
+
+        if (negateB) {
+            irv = __builtin_sub_overflow(pA->small, pB->small, &res);
+        }
+        else {
+            irv = __builtin_add_overflow(pA->small, pB->small, &res);
+        }
+        if (!irv) {
+            bignum_clean(pMng, pOut);
+            pOut->small = res;
+            return 0;
+        }
+    }
+
+    bignum_getView(&viewA, pA);
+    bignum_getView(&viewB, pB);
+    viewB.isNegative ^= negateB;
+
+    len = viewA.numLimbs;
+    if (viewB.numLimbs > len) {
+        len = viewB.numLimbs;
+    }
+    if (bignum_allocLimbs(&pLimbs, &cap, pMng, len + 1) != 0) {
+        return 1;
+    }
+
+    if (viewA.isNegative == viewB.isNegative) {
+        len = bignum_addMagnitude(pLimbs, &viewA, &viewB);
+        isNegative = viewA.isNegative;
+    }
+    else if (bignum_cmpMagnitude(&viewA, &viewB) >= 0) {
+        len = bignum_subMagnitude(pLimbs, &viewA, &viewB);
+        isNegative = viewA.isNegative;
+    }
+    else {
+        len = bignum_subMagnitude(pLimbs, &viewB, &viewA);
+        isNegative = viewB.isNegative;
+    }
+
+    bignum_adopt(pMng, pOut, pLimbs, cap, len, isNegative);
+    return 0;
+}
+
+/**
+ * Add two numbers
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The sum
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on failure
+ */
+int bignum_add(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB) {
+    return bignum_addSigned(pMng, pOut, pA, pB, 0/*negateB*/);
+}
+
+/**
+ * Subtract two numbers
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The difference
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on failure
+ */
+int bignum_sub(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB) {
+    return bignum_addSigned(pMng, pOut, pA, pB, 1/*negateB*/);
+}
+
+/**
+ * Multiply two numbers
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The product
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factor
+ * @return           0 on success, 1 on failure
+ */
+int bignum_mul(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB) {
+    bignumView viewA, viewB;
+    uint32_t *pLimbs;
+    int cap, i, len;
+
+    if (!pA->pLimbs && !pB->pLimbs) {
+        int64_t res;
+
+        if (!__builtin_mul_overflow(pA->small, pB->small, &res)) {
+            bignum_clean(pMng, pOut);
+            pOut->small = res;
+            return 0;
+        }
+    }
+
+    bignum_getView(&viewA, pA);
+    bignum_getView(&viewB, pB);
+
+    len = viewA.numLimbs + viewB.numLimbs;
+    if (bignum_allocLimbs(&pLimbs, &cap, pMng, len) != 0) {
+        return 1;
+    }
+    memset(pLimbs, 0x0, sizeof(uint32_t) * len);
+
+    /* Schoolbook multiplication */
+    i = 0;
+    while (i < viewA.numLimbs) {
+        uint64_t carry;
+        int j;
+
+        carry = 0;
+        j = 0;
+        while (j < viewB.numLimbs) {
+            carry += (uint64_t)viewA.pLimbs[i] * viewB.pLimbs[j] +
+                    pLimbs[i + j];
+            pLimbs[i + j] = (uint32_t)carry;
+            carry >>= 32;
+            j++;
+        }
+        pLimbs[i + j] = (uint32_t)carry;
+        i++;
+    }
+
+    bignum_adopt(pMng, pOut, pLimbs, cap, len,
+            viewA.isNegative != viewB.isNegative);
+    return 0;
+}
+
+/**
+ * Divide two magnitudes through Knuth's algorithm D, as described on Hacker's
+ * Delight (divmnu)
+ *
+ * @param  [out]pQuot  The quotient (with space for A - B + 1 limbs)
+ * @param  [out]pRem   The remainder (with space for B limbs)
+ * @param  [ in]pA     The dividend
+ * @param  [ in]pB     The divisor (with at least 2 limbs)
+ * @param  [ in]pTmpA  Scratch space for A + 1 limbs
+ * @param  [ in]pTmpB  Scratch space for B limbs
+ */
+static void bignum_divMagnitude(uint32_t *pQuot, uint32_t *pRem,
+        const bignumView *pA, const bignumView *pB, uint32_t *pTmpA,
+        uint32_t *pTmpB) {
+    const uint32_t *u, *v;
+    uint32_t *un, *vn;
+    int i, j, m, n, s;
+
+    u = pA->pLimbs;
+    v = pB->pLimbs;
+    m = pA->numLimbs;
+    n = pB->numLimbs;
+    un = pTmpA;
+    vn = pTmpB;
+
+    /* Normalize both numbers, so the divisor's highest bit is set */
+    s = __builtin_clz(v[n - 1]);
+    i = n - 1;
+    while (i > 0) {
+        vn[i] = (v[i] << s) | (uint32_t)((uint64_t)v[i - 1] >> (32 - s));
+        i--;
+    }
+    vn[0] = v[0] << s;
+
+    un[m] = (uint32_t)((uint64_t)u[m - 1] >> (32 - s));
+    i = m - 1;
+    while (i > 0) {
+        un[i] = (u[i] << s) | (uint32_t)((uint64_t)u[i - 1] >> (32 - s));
+        i--;
+    }
+    un[0] = u[0] << s;
+
+    j = m - n;
+    while (j >= 0) {
+        uint64_t num, qhat, rhat;
+        int64_t k, t;
+
+        /* Estimate the current digit of the quotient */
+        num = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+        qhat = num / vn[n - 1];
+        rhat = num - qhat * vn[n - 1];
+        while (qhat > 0xffffffffu ||
+                qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat > 0xffffffffu) {
+                break;
+            }
+        }
+
+        /* Multiply and subtract */
+        k = 0;
+        i = 0;
+        while (i < n) {
+            uint64_t p;
+
+            p = qhat * vn[i];
+            t = (int64_t)un[i + j] - k - (int64_t)(p & 0xffffffffu);
+            un[i + j] = (uint32_t)t;
+            k = (int64_t)(p >> 32) - (t >> 32);
+            i++;
+        }
+        t = (int64_t)un[j + n] - k;
+        un[j + n] = (uint32_t)t;
+
+        /* If too much was subtracted, add it back */
+        pQuot[j] = (uint32_t)qhat;
+        if (t < 0) {
+            pQuot[j]--;
+            k = 0;
+            i = 0;
+            while (i < n) {
+                t = (int64_t)un[i + j] + vn[i] + k;
+                un[i + j] = (uint32_t)t;
+                k = t >> 32;
+                i++;
+            }
+            un[j + n] += (uint32_t)k;
+        }
+
+        j--;
+    }
+
+    /* Unnormalize the remainder */
+    i = 0;
+    while (i < n - 1) {
+        pRem[i] = (un[i] >> s) | (uint32_t)((uint64_t)un[i + 1] << (32 - s));
+        i++;
+    }
+    pRem[n - 1] = un[n - 1] >> s;
+}
+
+/**
+ * Divide two numbers, truncating the quotient toward zero (so the remainder
+ * has the dividend's sign)
+ *
+ * @param  [ in]pMng  The fraction manager
+ * @param  [out]pQuot The quotient (may be NULL)
+ * @param  [out]pRem  The remainder (may be NULL)
+ * @param  [ in]pA    The dividend
+ * @param  [ in]pB    The divisor
+ * @return            0 on success, 1 on failure (or division by zero)
+ */
+int bignum_divmod(fractionManager *pMng, bignum *pQuot, bignum *pRem,
+        const bignum *pA, const bignum *pB) {
+    bignumView viewA, viewB;
+    uint32_t *pQLimbs, *pRLimbs, *pTmpA, *pTmpB;
+    int capQ, capR, capTmpA, capTmpB, lenQ, lenR;
+    int isNegativeA, isNegativeQ;
+
+    if (bignum_sign(pB) == 0) {
+        return 1;
+    }
+
+    if (!pA->pLimbs && !pB->pLimbs &&
+            !(pA->small == INT64_MIN && pB->small == -1)) {
+        int64_t quot, rem;
+
+        quot = pA->small / pB->small;
+        rem = pA->small % pB->small;
+        if (pQuot) {
+            bignum_clean(pMng, pQuot);
+            pQuot->small = quot;
+        }
+        if (pRem) {
+            bignum_clean(pMng, pRem);
+            pRem->small = rem;
+        }
+        return 0;
+    }
+
+    bignum_getView(&viewA, pA);
+    bignum_getView(&viewB, pB);
+    isNegativeA = viewA.isNegative;
+    isNegativeQ = (viewA.isNegative != viewB.isNegative);
+
+    /* Trivial case: |A| < |B|, so the quotient is 0 and the remainder A */
+    if (bignum_cmpMagnitude(&viewA, &viewB) < 0) {
+        if (pRem && bignum_copy(pMng, pRem, pA) != 0) {
+            return 1;
+        }
+        if (pQuot) {
+            bignum_clean(pMng, pQuot);
+        }
+        return 0;
+    }
+
+    lenQ = viewA.numLimbs - viewB.numLimbs + 1;
+    lenR = viewB.numLimbs;
+    pQLimbs = 0;
+    pRLimbs = 0;
+    pTmpA = 0;
+    pTmpB = 0;
+    if (bignum_allocLimbs(&pQLimbs, &capQ, pMng, lenQ) != 0) {
+        return 1;
+    }
+    if (bignum_allocLimbs(&pRLimbs, &capR, pMng, lenR) != 0) {
+        bignum_freeLimbs(pMng, pQLimbs, capQ);
+        return 1;
+    }
+
+    if (viewB.numLimbs == 1) {
+        uint64_t rem;
+        uint32_t div;
+        int i;
+
+        /* Short division */
+        div = viewB.pLimbs[0];
+        rem = 0;
+        i = viewA.numLimbs - 1;
+        while (i >= 0) {
+            uint64_t cur;
+
+            cur = (rem << 32) | viewA.pLimbs[i];
+            pQLimbs[i] = (uint32_t)(cur / div);
+            rem = cur % div;
+            i--;
+        }
+        pRLimbs[0] = (uint32_t)rem;
+    }
+    else {
+        if (bignum_allocLimbs(&pTmpA, &capTmpA, pMng,
+                viewA.numLimbs + 1) != 0 ||
+                bignum_allocLimbs(&pTmpB, &capTmpB, pMng,
+                viewB.numLimbs) != 0) {
+            if (pTmpA) {
+                bignum_freeLimbs(pMng, pTmpA, capTmpA);
+            }
+            bignum_freeLimbs(pMng, pQLimbs, capQ);
+            bignum_freeLimbs(pMng, pRLimbs, capR);
+            return 1;
+        }
+
+        bignum_divMagnitude(pQLimbs, pRLimbs, &viewA, &viewB, pTmpA, pTmpB);
+
+        bignum_freeLimbs(pMng, pTmpA, capTmpA);
+        bignum_freeLimbs(pMng, pTmpB, capTmpB);
+    }
+
+    /* Only store the results after both were calculated, since the outputs
+     * may be the inputs */
+    if (pQuot) {
+        bignum_adopt(pMng, pQuot, pQLimbs, capQ, lenQ, isNegativeQ);
+    }
+    else {
+        bignum_freeLimbs(pMng, pQLimbs, capQ);
+    }
+    if (pRem) {
+        bignum_adopt(pMng, pRem, pRLimbs, capR, lenR, isNegativeA);
+    }
+    else {
+        bignum_freeLimbs(pMng, pRLimbs, capR);
+    }
+
+    return 0;
+}
+
+/**
+ * Calculate the (non-negative) greatest common divisor of two numbers
+ *
+ * This uses Euclid's algorithm while the numbers are big, switching to the
+ * binary GCD as soon as both fit into 64 bits
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The greatest common divisor
+ * @param  [ in]pA   A number
+ * @param  [ in]pB   The other number
+ * @return           0 on success, 1 on failure
+ */
+int bignum_gcd(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB) {
+    bignum a, b, rem;
+    int irv;
+
+    bignum_init(&a, 0);
+    bignum_init(&b, 0);
+    bignum_init(&rem, 0);
+    irv = 1;
+
+    if (bignum_copy(pMng, &a, pA) != 0 || bignum_copy(pMng, &b, pB) != 0) {
+        goto cleanup;
+    }
+
+    while (a.pLimbs || b.pLimbs) {
+        bignum tmp;
+
+        if (bignum_sign(&b) == 0) {
+            break;
+        }
+
+        if (bignum_divmod(pMng, 0, &rem, &a, &b) != 0) {
+            goto cleanup;
+        }
+        tmp = a;
+        a = b;
+        b = rem;
+        rem = tmp;
+    }
+
+    if (!a.pLimbs && !b.pLimbs) {
+        bignumView viewA, viewB;
+        uint64_t div;
+        uint32_t limbs[2];
+
+        bignum_getView(&viewA, &a);
+        bignum_getView(&viewB, &b);
+        div = gcd_u64(viewA.small[0] | ((uint64_t)viewA.small[1] << 32),
+                viewB.small[0] | ((uint64_t)viewB.small[1] << 32));
+
+        limbs[0] = (uint32_t)div;
+        limbs[1] = (uint32_t)(div >> 32);
+        irv = bignum_setMagnitude(pMng, pOut, limbs, 2, 0);
+    }
+    else {
+        /* b is 0, so the result is |a| */
+        irv = bignum_setMagnitude(pMng, pOut, a.pLimbs, a.numLimbs, 0);
+    }
+
+cleanup:
+    bignum_clean(pMng, &a);
+    bignum_clean(pMng, &b);
+    bignum_clean(pMng, &rem);
+
+    return irv;
+}
+
+/**
+ * Convert a number to a double, as value * 2^exponent, so even numbers
+ * bigger than the biggest double may be divided by one another
+ *
+ * @param  [out]pExp The exponent
+ * @param  [ in]pNum The number
+ * @return           The number's value, scaled down by 2^exponent
+ */
+double bignum_toDouble(int *pExp, const bignum *pNum) {
+    double val;
+    int i, last;
+
+    if (!pNum->pLimbs) {
+        *pExp = 0;
+        return (double)pNum->small;
+    }
+
+    /* Three limbs are more than enough for a double's mantissa */
+    val = 0.0;
+    last = pNum->numLimbs - 3;
+    if (last < 0) {
+        last = 0;
+    }
+    i = pNum->numLimbs - 1;
+    while (i >= last) {
+        val = val * 4294967296.0 + pNum->pLimbs[i];
+        i--;
+    }
+
+    *pExp = last * 32;
+    if (pNum->isNegative) {
+        return -val;
+    }
+    return val;
+}
+
@@ -0,0 +1,254 @@
+/**
+ * Converts blocks of fractions to floating point numbers
+ *
+ * On x86, both terms of many fractions are converted at once (through
+ * cvtdq2pd/cvtdq2ps) and then divided on every lane of a SIMD register (4
+ * doubles or 8 floats with AVX, and half as many with SSE2). Every lane does
+ * exactly what the scalar conversion does (i.e., converts both terms and
+ * divides them, rounding each step the same way), so results are bit for bit
+ * equal.
+ *
+ * The best kernels are selected on the first call, based on the running CPU.
+ *
+ * @file src/convertBlock.c
+ */
+#include <fraction_internal/convert.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+        !defined(__EMSCRIPTEN__)
+#  define CONVERT_BLOCK_X86
+#  include <immintrin.h>
+#endif
+
+/** Signature of every kernel that converts to doubles */
+typedef void (*convertDoubleKernel)(double *pOut, const int *pNums,
+        const int *pDens, int len);
+/** Signature of every kernel that converts to floats */
+typedef void (*convertFloatKernel)(float *pOut, const int *pNums,
+        const int *pDens, int len);
+
+/**
+ * Convert a block of numerators and denominators to doubles, one fraction at
+ * a time
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+static void convert_toDoubleScalar(double *pOut, const int *pNums,
+        const int *pDens, int len) {
+    int i;
+
+    for (i = 0; i < len; i++) {
+        pOut[i] = pNums[i] / (double)pDens[i];
+    }
+}
+
+/**
+ * Convert a block of numerators and denominators to floats, one fraction at
+ * a time
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+static void convert_toFloatScalar(float *pOut, const int *pNums,
+        const int *pDens, int len) {
+    int i;
+
+    for (i = 0; i < len; i++) {
+        pOut[i] = pNums[i] / (float)pDens[i];
+    }
+}
+
+#if defined(CONVERT_BLOCK_X86)
+
+/**
+ * Convert a block of numerators and denominators to doubles, two fractions
+ * at a time
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+__attribute__((target("sse2")))
+static void convert_toDoubleSSE(double *pOut, const int *pNums,
+        const int *pDens, int len) {
+    int i;
+
+    for (i = 0; i + 2 <= len; i += 2) {
+        __m128d den, num;
+
+        num = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(pNums + i)));
+        den = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(pDens + i)));
+        _mm_storeu_pd(pOut + i, _mm_div_pd(num, den));
+    }
+
+    convert_toDoubleScalar(pOut + i, pNums + i, pDens + i, len - i);
+}
+
+/**
+ * Convert a block of numerators and denominators to floats, four fractions
+ * at a time
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+__attribute__((target("sse2")))
+static void convert_toFloatSSE(float *pOut, const int *pNums,
+        const int *pDens, int len) {
+    int i;
+
+    for (i = 0; i + 4 <= len; i += 4) {
+        __m128 den, num;
+
+        num = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(pNums + i)));
+        den = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(pDens + i)));
+        _mm_storeu_ps(pOut + i, _mm_div_ps(num, den));
+    }
+
+    convert_toFloatScalar(pOut + i, pNums + i, pDens + i, len - i);
+}
+
+/**
+ * Convert a block of numerators and denominators to doubles, four fractions
+ * at a time
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+__attribute__((target("avx")))
+static void convert_toDoubleAVX(double *pOut, const int *pNums,
+        const int *pDens, int len) {
+    int i;
+
+    for (i = 0; i + 4 <= len; i += 4) {
+        __m256d den, num;
+
+        num = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(pNums + i)));
+        den = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(pDens + i)));
+        _mm256_storeu_pd(pOut + i, _mm256_div_pd(num, den));
+    }
+
+    convert_toDoubleSSE(pOut + i, pNums + i, pDens + i, len - i);
+}
+
+/**
+ * Convert a block of numerators and denominators to floats, eight fractions
+ * at a time
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+__attribute__((target("avx")))
+static void convert_toFloatAVX(float *pOut, const int *pNums,
+        const int *pDens, int len) {
+    int i;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 den, num;
+
+        num = _mm256_cvtepi32_ps(_mm256_loadu_si256(
+                (const __m256i*)(pNums + i)));
+        den = _mm256_cvtepi32_ps(_mm256_loadu_si256(
+                (const __m256i*)(pDens + i)));
+        _mm256_storeu_ps(pOut + i, _mm256_div_ps(num, den));
+    }
+
+    convert_toFloatSSE(pOut + i, pNums + i, pDens + i, len - i);
+}
+
+#endif /* CONVERT_BLOCK_X86 */
+
+/**
+ * Select the best kernel that converts to doubles for the running CPU
+ *
+ * @return The kernel
+ */
+static convertDoubleKernel convert_selectDoubleKernel() {
+#if defined(CONVERT_BLOCK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return convert_toDoubleAVX;
+    }
+    else if (__builtin_cpu_supports("sse2")) {
+        return convert_toDoubleSSE;
+    }
+#endif
+    return convert_toDoubleScalar;
+}
+
+/**
+ * Select the best kernel that converts to floats for the running CPU
+ *
+ * @return The kernel
+ */
+static convertFloatKernel convert_selectFloatKernel() {
+#if defined(CONVERT_BLOCK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return convert_toFloatAVX;
+    }
+    else if (__builtin_cpu_supports("sse2")) {
+        return convert_toFloatSSE;
+    }
+#endif
+    return convert_toFloatScalar;
+}
+
+/** The kernels selected for the running CPU (selecting them is idempotent,
+ * so racing threads atomically store the same pointer) */
+static convertDoubleKernel convert_doubleKernel = 0;
+static convertFloatKernel convert_floatKernel = 0;
+
+/**
+ * Convert a block of numerators and denominators to doubles, just like
+ * fractionValue_dconvert does for each pair
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+void convert_toDoubleBlock(double *pOut, const int *pNums, const int *pDens,
+        int len) {
+    convertDoubleKernel kernel;
+
+    kernel = __atomic_load_n(&convert_doubleKernel, __ATOMIC_RELAXED);
+    if (!kernel) {
+        kernel = convert_selectDoubleKernel();
+        __atomic_store_n(&convert_doubleKernel, kernel, __ATOMIC_RELAXED);
+    }
+    kernel(pOut, pNums, pDens, len);
+}
+
+/**
+ * Convert a block of numerators and denominators to floats, just like
+ * fractionValue_fconvert does for each pair
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+void convert_toFloatBlock(float *pOut, const int *pNums, const int *pDens,
+        int len) {
+    convertFloatKernel kernel;
+
+    kernel = __atomic_load_n(&convert_floatKernel, __ATOMIC_RELAXED);
+    if (!kernel) {
+        kernel = convert_selectFloatKernel();
+        __atomic_store_n(&convert_floatKernel, kernel, __ATOMIC_RELAXED);
+    }
+    kernel(pOut, pNums, pDens, len);
+}
+
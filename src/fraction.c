@@ -3,11 +3,11 @@
  * number is composed by a numerator and a denominator, and both are represented
  * as integer.
  *
- * The current implementation isn't really optimized for speed. After every
- * operation, the resulted number is simplified, which requires a list of
- * primes. Perhaps, keeping both numerator and denominator as lists of primes
- * would be more optimized for speed. However, a list of primes is required for
- * the current implementation.
+ * After every operation, the resulted number is simplified by dividing both
+ * its numerator and denominator by their greatest common divisor. This is
+ * calculated through the binary GCD algorithm, so it takes O(log n) steps and
+ * doesn't depend on the list of primes. Perhaps, keeping both numerator and
+ * denominator as lists of primes would be more optimized for multiplications.
  *
  * The lib has an "unexported" module for generating lists of primes. It's
  * initialized with the main context, and its precision (i.e., maximum
@@ -18,48 +18,22 @@
  * decimal fixed point, to float-point numbers and to doubles.
  */
 #include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+#include <fraction_internal/accum.h>
+#include <fraction_internal/manager.h>
+#include <fraction_internal/pool.h>
 #include <fraction_internal/prime.h>
-
+#include <fraction_internal/spf.h>
+#include <fraction_internal/stats.h>
+#include <fraction_internal/trace.h>
+
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-/** Buffer of fractions, from which new references are recycled */
-struct stFractionBuffer {
-    /** All fractions alloc'ed on this buffer */
-    fraction *pFractions;
-    /** Number of alloc'ed objects */
-    int numFractions;
-    /** Number of used objects */
-    int usedFractions;
-};
-typedef struct stFractionBuffer fractionBuffer;
-
-/** Keep references to all fraction lists and the list of primes */
-struct stFractionManager {
-    /** Store all fraction buffers */
-    fractionBuffer **ppFractionBuffers;
-    /** Number of buffers */
-    int numFractionBuffers;
-    /** List of sequential prime numbers */
-    int *pPrimes;
-    /** Number of primes in the list */
-    int numPrimes;
-    /** Linked list of released fractions */
-    fraction *pFreeFractions;
-};
-
-/** Fractional number */
-struct stFraction {
-    /** The fraction's numerator */
-    int numerator;
-    /** The fraction's denominator */
-    int denominator;
-    /** Next released fraction, if this is on pFreeFractions LL */
-    fraction *pNext;
-    /** Reference to the manager that alloc'ed this object */
-    fractionManager *pManager;
-};
-
 /**
  * Initializes the fraction manager
  *
@@ -68,9 +42,42 @@ struct stFraction {
  * @return                       0 on success, 1 on failure
  */
 int fractionManager_init(fractionManager **ppOut, int maxNumberChecked) {
-    fractionBuffer *pCurBuffer;
+    fractionManagerConfig config;
+
+    fractionManager_getDefaultConfig(&config);
+    config.maxNumberChecked = maxNumberChecked;
+
+    return fractionManager_initConfig(ppOut, &config);
+}
+
+/**
+ * Retrieve the default options for initializing a fraction manager
+ *
+ * @param  [out]pConfig The default options
+ */
+void fractionManager_getDefaultConfig(fractionManagerConfig *pConfig) {
+    memset(pConfig, 0x0, sizeof(fractionManagerConfig));
+    pConfig->maxNumberChecked = 1000;
+    pConfig->isConcurrent = 0;
+    pConfig->numSieveThreads = 1;
+    pConfig->maxPrimeBytes = 0;
+    pConfig->spfLimit = 0;
+    pConfig->pPrimeCachePath = 0;
+    pConfig->traceInterval = 1024;
+    pConfig->traceCapacity = 4096;
+}
+
+/**
+ * Initializes the fraction manager with the supplied options
+ *
+ * @param  [out]ppOut   The alloc'ed and initialized fraction manager
+ * @param  [ in]pConfig The manager's options
+ * @return              0 on success, 1 on failure
+ */
+int fractionManager_initConfig(fractionManager **ppOut,
+        const fractionManagerConfig *pConfig) {
     fractionManager *pMng;
-    int irv;
+    int irv, isConcurrent;
 
 #define INIT_ASSERT(val) \
   do { \
@@ -85,28 +92,50 @@ int fractionManager_init(fractionManager **ppOut, int maxNumberChecked) {
     INIT_ASSERT(pMng);
     memset(pMng, 0x0, sizeof(fractionManager));
 
+    /* Create the lock before anything else, so it's always destroyed */
+    isConcurrent = pConfig->isConcurrent;
+    if (isConcurrent) {
+        irv = pthread_mutex_init(&(pMng->lock), 0);
+        INIT_ASSERT(irv == 0);
+        pMng->isConcurrent = 1;
+    }
+
     /* Create the list of primes */
-    irv = prime_genPrimeList(&(pMng->pPrimes), &(pMng->numPrimes),
-            maxNumberChecked);
+    if (pConfig->pPrimeCachePath) {
+        irv = prime_initTableCached(&(pMng->primes), pConfig->pPrimeCachePath,
+                pConfig->maxNumberChecked, pConfig->numSieveThreads,
+                pConfig->maxPrimeBytes, isConcurrent);
+    }
+    else {
+        irv = prime_initTable(&(pMng->primes), pConfig->maxNumberChecked,
+                pConfig->numSieveThreads, pConfig->maxPrimeBytes,
+                isConcurrent);
+    }
     INIT_ASSERT(irv == 0);
+    if (pConfig->spfLimit > 0) {
+        irv = spf_init(&(pMng->spf), pConfig->spfLimit);
+        INIT_ASSERT(irv == 0);
+    }
+#if defined(FRACTION_TRACE)
+    if (pConfig->traceInterval > 0) {
+        irv = trace_init(&(pMng->trace), pConfig->traceCapacity,
+                pConfig->traceInterval);
+        INIT_ASSERT(irv == 0);
+    }
+#endif
 
-    /* Alloc a list of fraction buffer */
-    pMng->numFractionBuffers = 1;
-    pMng->ppFractionBuffers = (fractionBuffer**)malloc(sizeof(fractionBuffer*));
-    INIT_ASSERT(pMng->ppFractionBuffers);
-    pMng->ppFractionBuffers[0] = 0;
-
-    /* "Pre-alloc" the first buffer of fractions */
-    pCurBuffer = (fractionBuffer*)malloc(sizeof(fractionBuffer));
-    INIT_ASSERT(pCurBuffer);
-    memset(pCurBuffer, 0x0, sizeof(fractionBuffer));
-    /* Store it in the list */
-    pMng->ppFractionBuffers[0] = pCurBuffer;
-
-    pCurBuffer->numFractions = 512;
-    pCurBuffer->pFractions = (fraction*)malloc(sizeof(fraction) *
-            pCurBuffer->numFractions);
-    INIT_ASSERT(pCurBuffer->pFractions);
+    /* "Pre-alloc" the first buffer of each kind of fraction */
+    irv = pool_init(&(pMng->fractions), sizeof(fraction), 512, isConcurrent);
+    INIT_ASSERT(irv == 0);
+    irv = pool_init(&(pMng->fractions64), sizeof(fraction64), 512,
+            isConcurrent);
+    INIT_ASSERT(irv == 0);
+    irv = pool_init(&(pMng->fractionsBig), sizeof(fractionBig), 512,
+            isConcurrent);
+    INIT_ASSERT(irv == 0);
+    irv = pool_init(&(pMng->fractionsFactored), sizeof(fractionFactored),
+            512, isConcurrent);
+    INIT_ASSERT(irv == 0);
 
 #undef INIT_ASSERT
 
@@ -116,6 +145,30 @@ int fractionManager_init(fractionManager **ppOut, int maxNumberChecked) {
     return 0;
 }
 
+/**
+ * Generate every prime up to a given number into a cache file, so managers
+ * that use it (through pPrimeCachePath) don't have to
+ *
+ * @param  [ in]pPath            Path of the cache file
+ * @param  [ in]maxNumberChecked Biggest number to be checked for primality
+ * @param  [ in]numSieveThreads  Number of threads used to generate the list
+ * @return                       0 on success, 1 on failure
+ */
+int fractionManager_genPrimeCache(const char *pPath, int maxNumberChecked,
+        int numSieveThreads) {
+    primeTable table;
+    int irv;
+
+    if (prime_initTable(&table, maxNumberChecked, numSieveThreads,
+            0/*maxBytes*/, 0/*isConcurrent*/) != 0) {
+        return 1;
+    }
+    irv = prime_writeCache(pPath, &table);
+    prime_cleanTable(&table);
+
+    return irv;
+}
+
 /**
  * Releases all alloc'ed resources for the fraction manager
  *
@@ -126,6 +179,7 @@ int fractionManager_init(fractionManager **ppOut, int maxNumberChecked) {
  */
 void fractionManager_clean(fractionManager **ppMng) {
     fractionManager *pMng;
+    int i;
 
     /* Check that the object was initialized */
     if (!ppMng || !(*ppMng)) {
@@ -134,26 +188,30 @@ void fractionManager_clean(fractionManager **ppMng) {
     pMng = *ppMng;
 
     /* Clear all fraction buffers */
-    if (pMng->ppFractionBuffers) {
-        int i;
-
-        i = 0;
-        while (i < pMng->numFractionBuffers) {
-            if (pMng->ppFractionBuffers[i]) {
-                if (pMng->ppFractionBuffers[i]->pFractions) {
-                    free(pMng->ppFractionBuffers[i]->pFractions);
-                }
-                free(pMng->ppFractionBuffers[i]);
-            }
-            i++;
-        }
-
-        free(pMng->ppFractionBuffers);
+    pool_clean(&(pMng->fractions));
+    pool_clean(&(pMng->fractions64));
+    pool_clean(&(pMng->fractionsBig));
+    pool_clean(&(pMng->fractionsFactored));
+    i = 0;
+    while (i < BIGNUM_NUM_CLASSES) {
+        pool_clean(&(pMng->limbs[i]));
+        i++;
+    }
+    i = 0;
+    while (i < FACTORED_NUM_CLASSES) {
+        pool_clean(&(pMng->factors[i]));
+        i++;
     }
 
     /* Clear the list of primes */
-    if (pMng->pPrimes) {
-        free(pMng->pPrimes);
+    prime_cleanTable(&(pMng->primes));
+    spf_clean(&(pMng->spf));
+#if defined(FRACTION_TRACE)
+    trace_clean(&(pMng->trace));
+#endif
+
+    if (pMng->isConcurrent) {
+        pthread_mutex_destroy(&(pMng->lock));
     }
 
     /* Clear the manager itself */
@@ -162,88 +220,188 @@ void fractionManager_clean(fractionManager **ppMng) {
 }
 
 /**
- * Alloc/retrieve a new fraction
+ * Return every object cached by the calling thread to a concurrent manager,
+ * so other threads may recycle them
  *
- * @param  [out]ppOut The alloc'ed fraction
- * @param  [ in]pMng  The fraction manager (so all references are kept)
- * @return            0 on success, 1 on failure
+ * @param  [ in]pMng The fraction manager
  */
-static int fractionManager_getNewFraction(fraction **ppOut,
-        fractionManager *pMng) {
-    fractionBuffer *pCurBuffer;
-
-    /* Try to recycle a reference */
-    if (pMng->pFreeFractions) {
-        *ppOut = pMng->pFreeFractions;
-        pMng->pFreeFractions = pMng->pFreeFractions->pNext;
+void fractionManager_flushThreadCache(fractionManager *pMng) {
+    int i;
 
-        return 0;
+    pool_flushThreadCache(&(pMng->fractions));
+    pool_flushThreadCache(&(pMng->fractions64));
+    pool_flushThreadCache(&(pMng->fractionsBig));
+    pool_flushThreadCache(&(pMng->fractionsFactored));
+    i = 0;
+    while (i < BIGNUM_NUM_CLASSES) {
+        if (pool_isReady(&(pMng->limbs[i]))) {
+            pool_flushThreadCache(&(pMng->limbs[i]));
+        }
+        i++;
+    }
+    i = 0;
+    while (i < FACTORED_NUM_CLASSES) {
+        if (pool_isReady(&(pMng->factors[i]))) {
+            pool_flushThreadCache(&(pMng->factors[i]));
+        }
+        i++;
     }
+}
 
-    pCurBuffer = pMng->ppFractionBuffers[pMng->numFractionBuffers - 1];
-    /* Try to retrieve an already alloc'ed fraction */
-    if (pCurBuffer->usedFractions < pCurBuffer->numFractions) {
-        *ppOut = &(pCurBuffer->pFractions[pCurBuffer->usedFractions]);
-        pCurBuffer->usedFractions++;
+/**
+ * Retrieve a snapshot of the manager's performance counters
+ *
+ * @param  [out]pOut The counters (zeroed on failure)
+ * @param  [ in]pMng The fraction manager
+ * @return           0 on success, 1 if the counters weren't compiled
+ */
+int fractionManager_getStats(fractionManagerStats *pOut,
+        fractionManager *pMng) {
+    memset(pOut, 0x0, sizeof(fractionManagerStats));
+
+#if defined(FRACTION_STATS)
+    {
+        const int *pList;
+
+        pOut->opsFraction = STATS_LOAD(pMng->opsFraction);
+        pOut->opsFraction64 = STATS_LOAD(pMng->opsFraction64);
+        pOut->opsFractionBig = STATS_LOAD(pMng->opsFractionBig);
+        pOut->opsFractionFactored = STATS_LOAD(pMng->opsFractionFactored);
+        pOut->opsFractionPool = STATS_LOAD(pMng->opsFractionPool);
+        pOut->numSimplifications = STATS_LOAD(pMng->numSimplifications);
+        pOut->numFactorizations = STATS_LOAD(pMng->primes.numFactorizations);
+        pOut->numTrialDivisions = STATS_LOAD(pMng->primes.numTrialDivisions);
+        if (pOut->numFactorizations > 0) {
+            pOut->avgTrialDivisions = (double)pOut->numTrialDivisions /
+                    pOut->numFactorizations;
+        }
+        prime_getList(&pList, &(pOut->numPrimes), &(pMng->primes));
 
-        return 0;
+        pool_getStats(&(pOut->fractions), &(pMng->fractions));
+        pool_getStats(&(pOut->fractions64), &(pMng->fractions64));
+        pool_getStats(&(pOut->fractionsBig), &(pMng->fractionsBig));
+        pool_getStats(&(pOut->fractionsFactored),
+                &(pMng->fractionsFactored));
     }
 
-    /* Otherwise, expand the buffer */
-    pMng->numFractionBuffers++;
-    pMng->ppFractionBuffers = (fractionBuffer**)realloc(pMng->ppFractionBuffers,
-            sizeof(fractionBuffer*) * pMng->numFractionBuffers);
-    if (!pMng->ppFractionBuffers) {
-        return 1;
-    }
-    pMng->ppFractionBuffers[pMng->numFractionBuffers - 1] = 0;
+    return 0;
+#else
+    return 1;
+#endif
+}
 
-    /* Alloc a new buffer and store it in the list */
-    pCurBuffer = (fractionBuffer*)malloc(sizeof(fractionBuffer));
-    if (!pCurBuffer) {
-        return 1;
+/**
+ * Factor an integer into primes (in increasing order), ignoring its sign
+ *
+ * @param  [out]pFactors    The number's distinct prime factors (there are at
+ *                          most FRACTION_MAX_FACTORS of them)
+ * @param  [out]pExponents  The exponent of each prime factor
+ * @param  [out]pNumFactors Number of distinct prime factors
+ * @param  [ in]pMng        The fraction manager
+ * @param  [ in]value       The number (which musn't be 0)
+ * @return                  0 on success, 1 on failure
+ */
+int fractionManager_factor(int *pFactors, int *pExponents, int *pNumFactors,
+        fractionManager *pMng, int value) {
+    uint32_t mag;
+    spfTable *pTable;
+
+    /* Work on the magnitude, so INT_MIN is handled correctly */
+    mag = (uint32_t)value;
+    if (value < 0) {
+        mag = 0u - mag;
     }
-    memset(pCurBuffer, 0x0, sizeof(fractionBuffer));
-    pMng->ppFractionBuffers[pMng->numFractionBuffers - 1] = pCurBuffer;
 
-    pCurBuffer->numFractions = 512;
-    pCurBuffer->pFractions = (fraction*)malloc(sizeof(fraction) *
-            pCurBuffer->numFractions);
-    if (!pCurBuffer->pFractions) {
-        return 1;
+    pTable = 0;
+    if (pMng->spf.pEntries) {
+        pTable = &(pMng->spf);
     }
 
-    /* Retrieve a reference from this new buffer */
-    *ppOut = &(pCurBuffer->pFractions[0]);
-    pCurBuffer->usedFractions++;
-    return 0;
+    return spf_factor(pFactors, pExponents, pNumFactors, pTable,
+            &(pMng->primes), mag);
 }
 
 /**
- * Simplify a fraction
+ * Set whether the manager's operations should only simplify their results
+ * when those are observed
+ *
+ * On lazy mode, sums, subtractions, multiplications and divisions store their
+ * results unreduced, as long as it fits into an int. Those fractions are then
+ * simplified as soon as they are converted to anything else
+ *
+ * @param  [ in]pMng   The fraction manager
+ * @param  [ in]isLazy Whether lazy mode should be enabled
+ */
+void fractionManager_setLazy(fractionManager *pMng, int isLazy) {
+    pMng->isLazy = isLazy;
+}
+
+/**
+ * Alloc/retrieve a new fraction
+ *
+ * @param  [out]ppOut The alloc'ed fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @return            0 on success, 1 on failure
+ */
+static int fractionManager_getNewFraction(fraction **ppOut,
+        fractionManager *pMng) {
+    return pool_getObject((void**)ppOut, &(pMng->fractions));
+}
+
+/**
+ * Simplify a fraction, dividing both numerator and denominator by their
+ * greatest common divisor
  *
  * @param  [ in]pFrac The fraction
  */
 static void fraction_simplify(fraction *pFrac) {
-    fractionManager *pMng;
-    int i;
+    STATS_INC(pFrac->pManager->numSimplifications);
+    TRACE_SIMPLIFY();
+    fractionValue_reduce(&(pFrac->value));
+    pFrac->isSimplified = 1;
+}
 
-    pMng = pFrac->pManager;
+/**
+ * Simplify a fraction that is about to be observed, if it was left unreduced
+ * by a lazy manager
+ *
+ * @param  [ in]pFrac The fraction
+ */
+static void fraction_observe(fraction *pFrac) {
+    if (!pFrac->isSimplified) {
+        fraction_simplify(pFrac);
+    }
+}
 
-    /* Check all feasible prime */
-    i = 0;
-    /* TODO OPTIMIZATION: run loop while pPrimes[i] < sqrt(num) */
-    while (i < pMng->numPrimes && pMng->pPrimes[i] < pFrac->numerator && 
-            pMng->pPrimes[i] < pFrac->denominator) {
-        /* Divide both numerator and denominator if the prime is common to
-         * both */
-        while (pFrac->numerator % pMng->pPrimes[i] == 0 &&
-                pFrac->denominator % pMng->pPrimes[i] == 0) {
-            pFrac->numerator /= pMng->pPrimes[i];
-            pFrac->denominator /= pMng->pPrimes[i];
+/**
+ * Store the (widened) result of an operation into a fraction
+ *
+ * Lazy managers keep the result unreduced as long as both its terms fit into
+ * an int. Otherwise, the result is immediately reduced
+ *
+ * @param  [out]pOut The fraction
+ * @param  [ in]num  The result's numerator
+ * @param  [ in]den  The result's denominator
+ */
+static void fraction_store(fraction *pOut, int64_t num, int64_t den) {
+    if (num >= -INT_MAX && num <= INT_MAX && den >= -INT_MAX &&
+            den <= INT_MAX) {
+        pOut->value.numerator = (int)num;
+        pOut->value.denominator = (int)den;
+        if (pOut->pManager->isLazy) {
+            pOut->isSimplified = 0;
         }
-        i++;
+        else {
+            fraction_simplify(pOut);
+        }
+        return;
     }
+
+    /* The result is about to overflow, so reduce it on its widened form */
+    STATS_INC(pOut->pManager->numSimplifications);
+    TRACE_SIMPLIFY();
+    fractionValue_store(&(pOut->value), num, den);
+    pOut->isSimplified = 1;
 }
 
 /**
@@ -258,22 +416,76 @@ int fractionManager_igetFraction(fraction **ppOut, fractionManager *pMng,
         int val) {
     int irv;
 
+    TRACE_BEGIN(pMng, val, 1, 0, 0);
+
+    /* Retrieve a unused referece */
+    irv = fractionManager_getNewFraction(ppOut, pMng);
+    if (irv != 0) {
+        TRACE_END(FRACTION_TRACE_IGET);
+        return 1;
+    }
+
+    /* Initialize it */
+    (*ppOut)->value.numerator = val;
+    (*ppOut)->value.denominator = 1;
+    (*ppOut)->pManager = pMng;
+    fraction_simplify(*ppOut);
+
+    TRACE_END(FRACTION_TRACE_IGET);
+    return 0;
+}
+
+/**
+ * Initializes a fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFraction(fraction **ppOut, fractionManager *pMng,
+        int numerator, int denominator) {
+    int irv;
+
+    if (denominator == 0) {
+        return 1;
+    }
+
+    TRACE_BEGIN(pMng, numerator, denominator, 0, 0);
     /* Retrieve a unused referece */
     irv = fractionManager_getNewFraction(ppOut, pMng);
     if (irv != 0) {
+        TRACE_END(FRACTION_TRACE_GET);
         return 1;
     }
 
     /* Initialize it */
-    (*ppOut)->numerator = val;
-    (*ppOut)->denominator = 1;
-    (*ppOut)->pNext = 0;
+    (*ppOut)->value.numerator = numerator;
+    (*ppOut)->value.denominator = denominator;
     (*ppOut)->pManager = pMng;
     fraction_simplify(*ppOut);
 
+    TRACE_END(FRACTION_TRACE_GET);
     return 0;
 }
 
+/**
+ * Initializes a fraction from a plain fraction value
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]pVal  The fraction initial value
+ * @return            0 on success, 1 on failure (or if the denominator is
+ *                    zero)
+ */
+int fractionManager_vgetFraction(fraction **ppOut, fractionManager *pMng,
+        const fractionValue *pVal) {
+    return fractionManager_getFraction(ppOut, pMng, pVal->numerator,
+            pVal->denominator);
+}
+
 /**
  * Initializes a fraction from a decimal fixed point number
  *
@@ -288,9 +500,12 @@ int fractionManager_fxGetFraction(fraction **ppOut, fractionManager *pMng,
         int val, int decimalDigits) {
     int divisor, irv;
 
+    TRACE_BEGIN(pMng, val, 1, 0, 0);
+
     /* Retrieve a unused referece */
     irv = fractionManager_getNewFraction(ppOut, pMng);
     if (irv != 0) {
+        TRACE_END(FRACTION_TRACE_FXGET);
         return 1;
     }
 
@@ -301,12 +516,12 @@ int fractionManager_fxGetFraction(fraction **ppOut, fractionManager *pMng,
     }
 
     /* Initialize it */
-    (*ppOut)->numerator = val;
-    (*ppOut)->denominator = divisor;
-    (*ppOut)->pNext = 0;
+    (*ppOut)->value.numerator = val;
+    (*ppOut)->value.denominator = divisor;
     (*ppOut)->pManager = pMng;
     fraction_simplify(*ppOut);
 
+    TRACE_END(FRACTION_TRACE_FXGET);
     return 0;
 }
 
@@ -322,19 +537,22 @@ int fractionManager_fgetFraction(fraction **ppOut, fractionManager *pMng,
         float val) {
     int irv;
 
+    TRACE_BEGIN(pMng, (int64_t)val, 1, 0, 0);
+
     /* Retrieve a unused referece */
     irv = fractionManager_getNewFraction(ppOut, pMng);
     if (irv != 0) {
+        TRACE_END(FRACTION_TRACE_FGET);
         return 1;
     }
 
     /* Initialize it */
-    (*ppOut)->numerator = val * 10000;
-    (*ppOut)->denominator = 10000;
-    (*ppOut)->pNext = 0;
+    (*ppOut)->value.numerator = val * 10000;
+    (*ppOut)->value.denominator = 10000;
     (*ppOut)->pManager = pMng;
     fraction_simplify(*ppOut);
 
+    TRACE_END(FRACTION_TRACE_FGET);
     return 0;
 }
 
@@ -350,22 +568,146 @@ int fractionManager_dgetFraction(fraction **ppOut, fractionManager *pMng,
         double val) {
     int irv;
 
+    TRACE_BEGIN(pMng, (int64_t)val, 1, 0, 0);
+
     /* Retrieve a unused referece */
     irv = fractionManager_getNewFraction(ppOut, pMng);
     if (irv != 0) {
+        TRACE_END(FRACTION_TRACE_DGET);
         return 1;
     }
 
     /* Initialize it */
-    (*ppOut)->numerator = val * 10000;
-    (*ppOut)->denominator = 10000;
-    (*ppOut)->pNext = 0;
+    (*ppOut)->value.numerator = val * 10000;
+    (*ppOut)->value.denominator = 10000;
     (*ppOut)->pManager = pMng;
     fraction_simplify(*ppOut);
 
+    TRACE_END(FRACTION_TRACE_DGET);
     return 0;
 }
 
+/**
+ * Initializes a fraction from an already reduced value
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]pVal  The fraction initial value, on its lowest terms
+ * @return            0 on success, 1 on failure
+ */
+static int fractionManager_getReducedFraction(fraction **ppOut,
+        fractionManager *pMng, const fractionValue *pVal) {
+    int irv;
+
+    /* Retrieve a unused referece */
+    irv = fractionManager_getNewFraction(ppOut, pMng);
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Initialize it */
+    (*ppOut)->value = *pVal;
+    (*ppOut)->isSimplified = 1;
+    (*ppOut)->pManager = pMng;
+
+    return 0;
+}
+
+/**
+ * Initializes a fraction from the best rational approximation of a double,
+ * found through its continued fraction (so it's never simplified)
+ *
+ * @param  [out]ppOut          The alloc'ed/initialized fraction
+ * @param  [ in]pMng           The fraction manager (so all references are
+ *                             kept)
+ * @param  [ in]val            The fraction initial value
+ * @param  [ in]maxDenominator The biggest denominator (or 0, for INT_MAX)
+ * @param  [ in]maxError       Maximum distance to the value, in which case
+ *                             the simplest fraction that's close enough is
+ *                             used (or 0, to find the simplest fraction that
+ *                             converts back to the very same double; or
+ *                             negative, to only be bound by the denominator)
+ * @return                     0 on success, 1 on failure (or if the value
+ *                             isn't finite or doesn't fit into an int)
+ */
+int fractionManager_dapproxFraction(fraction **ppOut, fractionManager *pMng,
+        double val, int maxDenominator, double maxError) {
+    fractionValue value;
+    int irv;
+
+    TRACE_BEGIN(pMng, (fabs(val) < INT_MAX) ? (int64_t)val : INT_MAX,
+            maxDenominator, 0, 0);
+
+    irv = fractionValue_dapprox(&value, val, maxDenominator, maxError);
+    if (irv == 0) {
+        irv = fractionManager_getReducedFraction(ppOut, pMng, &value);
+    }
+
+    TRACE_END(FRACTION_TRACE_DAPPROX);
+    return irv;
+}
+
+/**
+ * Initializes a fraction from the best rational approximation of a float,
+ * found through its continued fraction (so it's never simplified)
+ *
+ * @param  [out]ppOut          The alloc'ed/initialized fraction
+ * @param  [ in]pMng           The fraction manager (so all references are
+ *                             kept)
+ * @param  [ in]val            The fraction initial value
+ * @param  [ in]maxDenominator The biggest denominator (or 0, for INT_MAX)
+ * @param  [ in]maxError       Maximum distance to the value, in which case
+ *                             the simplest fraction that's close enough is
+ *                             used (or 0, to find the simplest fraction
+ *                             within half an ulp of the float; or negative,
+ *                             to only be bound by the denominator)
+ * @return                     0 on success, 1 on failure (or if the value
+ *                             isn't finite or doesn't fit into an int)
+ */
+int fractionManager_fapproxFraction(fraction **ppOut, fractionManager *pMng,
+        float val, int maxDenominator, float maxError) {
+    fractionValue value;
+    int irv;
+
+    TRACE_BEGIN(pMng, (fabs(val) < INT_MAX) ? (int64_t)val : INT_MAX,
+            maxDenominator, 0, 0);
+
+    irv = fractionValue_fapprox(&value, val, maxDenominator, maxError);
+    if (irv == 0) {
+        irv = fractionManager_getReducedFraction(ppOut, pMng, &value);
+    }
+
+    TRACE_END(FRACTION_TRACE_FAPPROX);
+    return irv;
+}
+
+/**
+ * Initializes a fraction with the exact value of a double, decomposed into
+ * its mantissa and a power of two (so it's never simplified)
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure (or if the value isn't
+ *                    finite or either term doesn't fit into an int)
+ */
+int fractionManager_dexactFraction(fraction **ppOut, fractionManager *pMng,
+        double val) {
+    fractionValue value;
+    int irv;
+
+    TRACE_BEGIN(pMng, (fabs(val) < INT_MAX) ? (int64_t)val : INT_MAX, 1,
+            0, 0);
+
+    irv = fractionValue_dexact(&value, val);
+    if (irv == 0) {
+        irv = fractionManager_getReducedFraction(ppOut, pMng, &value);
+    }
+
+    TRACE_END(FRACTION_TRACE_DEXACT);
+    return irv;
+}
+
 /**
  * Releases a fraction to the fraction manager. This enables the manager to
  * recycle fractions that have already been allocated but aren't in use
@@ -373,9 +715,7 @@ int fractionManager_dgetFraction(fraction **ppOut, fractionManager *pMng,
  * @param  [ in]pFrac The number to be released
  */
 void fractionManager_releaseFraction(fraction *pFrac) {
-    /* Append it to the list of freed fractions */
-    pFrac->pNext = pFrac->pManager->pFreeFractions;
-    pFrac->pManager->pFreeFractions = pFrac;
+    pool_releaseObject(&(pFrac->pManager->fractions), pFrac);
 }
 
 /**
@@ -388,72 +728,25 @@ void fractionManager_releaseFraction(fraction *pFrac) {
 int fractionManager_clone(fraction **ppOut, fraction *pSrc) {
     int irv;
 
+    TRACE_BEGIN(pSrc->pManager, pSrc->value.numerator,
+            pSrc->value.denominator, 0, 0);
+
     /* Retrieve a unused referece */
     irv = fractionManager_getNewFraction(ppOut, pSrc->pManager);
     if (irv != 0) {
+        TRACE_END(FRACTION_TRACE_CLONE);
         return 1;
     }
 
     /* Initialize it */
-    (*ppOut)->numerator = pSrc->numerator;
-    (*ppOut)->denominator = pSrc->denominator;
-    (*ppOut)->pNext = 0;
+    (*ppOut)->value = pSrc->value;
+    (*ppOut)->isSimplified = pSrc->isSimplified;
     (*ppOut)->pManager = pSrc->pManager;
 
+    TRACE_END(FRACTION_TRACE_CLONE);
     return 0;
 }
 
-/**
- * Find the least common denominator to both fractions, and set it as the base
- * for both fractions
- *
- * @param  [ in]pA A fraction
- * @param  [ in]pB The other fraction
- */
-static void fraction_setLCD(fraction *pA, fraction *pB) {
-    fractionManager *pMng;
-    int denA, denB, i;
-
-    pMng = pA->pManager;
-
-    /* Retrieve both numbers denominators */
-    denA = pA->denominator;
-    denB = pB->denominator;
-
-    /* Check which prime is missing in each denominator and multiply the other
-     * fraction */
-    i = 0;
-    while (i < pMng->numPrimes && (denA != 1 || denB != 1)) {
-        if (pMng->pPrimes[i] % denA == 0 && pMng->pPrimes[i] % denB == 0) {
-            /* If both numbers are divisible by this prime, do nothing */
-            denA /= pMng->pPrimes[i];
-            denB /= pMng->pPrimes[i];
-        }
-        else if (pMng->pPrimes[i] % denA == 0 && pMng->pPrimes[i] % denB != 0) {
-            /* Only A is divisible*/
-            
-            /* Remove it from A's denominator */
-            denA /= pMng->pPrimes[i];
-            /* Multiply B by this prime */
-            pB->numerator *= pMng->pPrimes[i];
-            pB->denominator *= pMng->pPrimes[i];
-        }
-        else if (pMng->pPrimes[i] % denA != 0 && pMng->pPrimes[i] % denB == 0) {
-            /* Only B is divisible*/
-            
-            /* Remove it from B's denominator */
-            denB /= pMng->pPrimes[i];
-            /* Multiply A by this prime */
-            pA->numerator *= pMng->pPrimes[i];
-            pA->denominator *= pMng->pPrimes[i];
-        }
-        else if (pMng->pPrimes[i] % denA != 0 && pMng->pPrimes[i] % denB != 0) {
-            /* Done with this prime, move to the next one */
-            i++;
-        }
-    }
-}
-
 /**
  * Adds two fractional numbers
  *
@@ -464,16 +757,28 @@ static void fraction_setLCD(fraction *pA, fraction *pB) {
  * @param  [ in]pB   The other summand
  */
 void fraction_sum(fraction *pOut, fraction *pA, fraction *pB) {
-    fraction_setLCD(pA, pB);
-
-    /* Set the result's denominator */
-    pOut->denominator = pA->denominator;
-    /* Add the numerator */
-    pOut->numerator = pA->numerator + pB->numerator;
+    STATS_INC(pOut->pManager->opsFraction);
+    TRACE_BEGIN(pOut->pManager, pA->value.numerator, pA->value.denominator,
+            pB->value.numerator, pB->value.denominator);
+    if (pOut->pManager->isLazy) {
+        /* Cross multiply on widened terms, without touching the inputs */
+        fraction_store(pOut,
+                (int64_t)pA->value.numerator * pB->value.denominator +
+                (int64_t)pB->value.numerator * pA->value.denominator,
+                (int64_t)pA->value.denominator * pB->value.denominator);
+        TRACE_END(FRACTION_TRACE_SUM);
+        return;
+    }
 
-    fraction_simplify(pA);
-    fraction_simplify(pB);
-    fraction_simplify(pOut);
+    /* Neither input is modified (as they are already on their lowest
+     * terms), and the result is reduced only once */
+    fraction_observe(pA);
+    fraction_observe(pB);
+    STATS_INC(pOut->pManager->numSimplifications);
+    TRACE_SIMPLIFY();
+    fractionValue_sum(&(pOut->value), &(pA->value), &(pB->value));
+    pOut->isSimplified = 1;
+    TRACE_END(FRACTION_TRACE_SUM);
 }
 
 /**
@@ -486,16 +791,28 @@ void fraction_sum(fraction *pOut, fraction *pA, fraction *pB) {
  * @param  [ in]pB   The subtrahend
  */
 void fraction_sub(fraction *pOut, fraction *pA, fraction *pB) {
-    fraction_setLCD(pA, pB);
-
-    /* Set the result's denominator */
-    pOut->denominator = pA->denominator;
-    /* Add the numerator */
-    pOut->numerator = pA->numerator - pB->numerator;
+    STATS_INC(pOut->pManager->opsFraction);
+    TRACE_BEGIN(pOut->pManager, pA->value.numerator, pA->value.denominator,
+            pB->value.numerator, pB->value.denominator);
+    if (pOut->pManager->isLazy) {
+        /* Cross multiply on widened terms, without touching the inputs */
+        fraction_store(pOut,
+                (int64_t)pA->value.numerator * pB->value.denominator -
+                (int64_t)pB->value.numerator * pA->value.denominator,
+                (int64_t)pA->value.denominator * pB->value.denominator);
+        TRACE_END(FRACTION_TRACE_SUB);
+        return;
+    }
 
-    fraction_simplify(pA);
-    fraction_simplify(pB);
-    fraction_simplify(pOut);
+    /* Neither input is modified (as they are already on their lowest
+     * terms), and the result is reduced only once */
+    fraction_observe(pA);
+    fraction_observe(pB);
+    STATS_INC(pOut->pManager->numSimplifications);
+    TRACE_SIMPLIFY();
+    fractionValue_sub(&(pOut->value), &(pA->value), &(pB->value));
+    pOut->isSimplified = 1;
+    TRACE_END(FRACTION_TRACE_SUB);
 }
 
 /**
@@ -508,26 +825,74 @@ void fraction_sub(fraction *pOut, fraction *pA, fraction *pB) {
  * @param  [ in]pB   The other factors
  */
 void fraction_mul(fraction *pOut, fraction *pA, fraction *pB) {
-    pOut->numerator = pA->numerator * pB->numerator;
-    pOut->denominator = pA->denominator * pB->denominator;
+    STATS_INC(pOut->pManager->opsFraction);
+    TRACE_BEGIN(pOut->pManager, pA->value.numerator, pA->value.denominator,
+            pB->value.numerator, pB->value.denominator);
+    if (pOut->pManager->isLazy) {
+        fraction_store(pOut,
+                (int64_t)pA->value.numerator * pB->value.numerator,
+                (int64_t)pA->value.denominator * pB->value.denominator);
+        TRACE_END(FRACTION_TRACE_MUL);
+        return;
+    }
 
-    fraction_simplify(pOut);
+    STATS_INC(pOut->pManager->numSimplifications);
+    TRACE_SIMPLIFY();
+    fractionValue_mul(&(pOut->value), &(pA->value), &(pB->value));
+    pOut->isSimplified = 1;
+    TRACE_END(FRACTION_TRACE_MUL);
 }
 
 /**
  * Divides two fractional numbers
  *
- * NOTE: The output mustn't be pB!
+ * NOTE: The output may be one of the inputs!
  *
  * @param  [out]pOut The operation's result
  * @param  [ in]pA   The minuend
  * @param  [ in]pB   The subtrahend
  */
 void fraction_div(fraction *pOut, fraction *pA, fraction *pB) {
-    pOut->numerator = pA->numerator * pB->denominator;
-    pOut->denominator = pA->denominator * pB->numerator;
+    STATS_INC(pOut->pManager->opsFraction);
+    TRACE_BEGIN(pOut->pManager, pA->value.numerator, pA->value.denominator,
+            pB->value.numerator, pB->value.denominator);
+    if (pOut->pManager->isLazy) {
+        fraction_store(pOut,
+                (int64_t)pA->value.numerator * pB->value.denominator,
+                (int64_t)pA->value.denominator * pB->value.numerator);
+        TRACE_END(FRACTION_TRACE_DIV);
+        return;
+    }
 
-    fraction_simplify(pOut);
+    STATS_INC(pOut->pManager->numSimplifications);
+    TRACE_SIMPLIFY();
+    fractionValue_div(&(pOut->value), &(pA->value), &(pB->value));
+    pOut->isSimplified = 1;
+    TRACE_END(FRACTION_TRACE_DIV);
+}
+
+/**
+ * Multiplies two fractional numbers and adds a third one to their product,
+ * reducing only the final result
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (A * B + C)
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factor
+ * @param  [ in]pC   The summand
+ */
+void fraction_fma(fraction *pOut, fraction *pA, fraction *pB, fraction *pC) {
+    accum acc;
+
+    STATS_INC(pOut->pManager->opsFraction);
+    TRACE_BEGIN(pOut->pManager, pA->value.numerator, pA->value.denominator,
+            pB->value.numerator, pB->value.denominator);
+    accum_init(&acc, pC->value.numerator, pC->value.denominator);
+    accum_addProduct(&acc, pA->value.numerator, pA->value.denominator,
+            pB->value.numerator, pB->value.denominator);
+    fraction_store(pOut, acc.num, acc.den);
+    TRACE_END(FRACTION_TRACE_FMA);
 }
 
 /**
@@ -537,7 +902,11 @@ void fraction_div(fraction *pOut, fraction *pA, fraction *pB) {
  * @param  [ in]pFrac The fraction
  */
 void fraction_iconvert(int *pOut, fraction *pFrac) {
-    *pOut = pFrac->numerator / pFrac->denominator;
+    TRACE_BEGIN(pFrac->pManager, pFrac->value.numerator,
+            pFrac->value.denominator, 0, 0);
+    fraction_observe(pFrac);
+    fractionValue_iconvert(pOut, &(pFrac->value));
+    TRACE_END(FRACTION_TRACE_ICONVERT);
 }
 
 /**
@@ -549,15 +918,11 @@ void fraction_iconvert(int *pOut, fraction *pFrac) {
  *                            decimal part
  */
 void fraction_fxconvert(int *pOut, fraction *pFrac, int decimalDigits) {
-    int multiplier;
-
-    multiplier = 1;
-    while (decimalDigits > 0) {
-        multiplier *= 10;
-        decimalDigits--;
-    }
-
-    *pOut = pFrac->numerator * multiplier / pFrac->denominator;
+    TRACE_BEGIN(pFrac->pManager, pFrac->value.numerator,
+            pFrac->value.denominator, 0, 0);
+    fraction_observe(pFrac);
+    fractionValue_fxconvert(pOut, &(pFrac->value), decimalDigits);
+    TRACE_END(FRACTION_TRACE_FXCONVERT);
 }
 
 /**
@@ -567,7 +932,11 @@ void fraction_fxconvert(int *pOut, fraction *pFrac, int decimalDigits) {
  * @param  [ in]pFrac The fraction
  */
 void fraction_fconvert(float *pOut, fraction *pFrac) {
-    *pOut = pFrac->numerator / (float)pFrac->denominator;
+    TRACE_BEGIN(pFrac->pManager, pFrac->value.numerator,
+            pFrac->value.denominator, 0, 0);
+    fraction_observe(pFrac);
+    fractionValue_fconvert(pOut, &(pFrac->value));
+    TRACE_END(FRACTION_TRACE_FCONVERT);
 }
 
 /**
@@ -577,7 +946,11 @@ void fraction_fconvert(float *pOut, fraction *pFrac) {
  * @param  [ in]pFrac The fraction
  */
 void fraction_dconvert(double *pOut, fraction *pFrac) {
-    *pOut = pFrac->numerator / (double)pFrac->denominator;
+    TRACE_BEGIN(pFrac->pManager, pFrac->value.numerator,
+            pFrac->value.denominator, 0, 0);
+    fraction_observe(pFrac);
+    fractionValue_dconvert(pOut, &(pFrac->value));
+    TRACE_END(FRACTION_TRACE_DCONVERT);
 }
 
 /**
@@ -589,7 +962,470 @@ void fraction_dconvert(double *pOut, fraction *pFrac) {
  * @param  [ in]pFrac    The fraction
  */
 void fraction_divConvert(int *pQuotOut, int *pRemOut, fraction *pFrac) {
-    *pQuotOut = pFrac->numerator / pFrac->denominator;
-    *pRemOut = pFrac->numerator % pFrac->denominator;
+    TRACE_BEGIN(pFrac->pManager, pFrac->value.numerator,
+            pFrac->value.denominator, 0, 0);
+    fraction_observe(pFrac);
+    fractionValue_divConvert(pQuotOut, pRemOut, &(pFrac->value));
+    TRACE_END(FRACTION_TRACE_DIVCONVERT);
+}
+
+/**
+ * Retrieve both terms of a fractional number, on its lowest terms (so the
+ * denominator is always positive)
+ *
+ * @param  [out]pNumerator   The fraction's numerator
+ * @param  [out]pDenominator The fraction's denominator
+ * @param  [ in]pFrac        The fraction
+ */
+void fraction_getTerms(int *pNumerator, int *pDenominator, fraction *pFrac) {
+    TRACE_BEGIN(pFrac->pManager, pFrac->value.numerator,
+            pFrac->value.denominator, 0, 0);
+    fraction_observe(pFrac);
+    *pNumerator = pFrac->value.numerator;
+    *pDenominator = pFrac->value.denominator;
+    TRACE_END(FRACTION_TRACE_GETTERMS);
+}
+
+/**
+ * Converts a fractional number to a plain fraction value (on its lowest terms)
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fraction_vconvert(fractionValue *pOut, fraction *pFrac) {
+    TRACE_BEGIN(pFrac->pManager, pFrac->value.numerator,
+            pFrac->value.denominator, 0, 0);
+    fraction_observe(pFrac);
+    *pOut = pFrac->value;
+    TRACE_END(FRACTION_TRACE_VCONVERT);
+}
+
+/**
+ * Compare the values of two fractions, which may be unreduced (and may have
+ * negative denominators)
+ *
+ * Both terms fit into an int, so their cross products fit into 63 bits and
+ * are compared exactly
+ *
+ * @param  [ in]pA A fraction
+ * @param  [ in]pB The other fraction
+ * @return         -1 if A < B, 0 if they are equal and 1 if A > B
+ */
+static int fraction_compareValues(const fractionValue *pA,
+        const fractionValue *pB) {
+    int64_t lhs, rhs;
+    int cmp;
+
+    lhs = (int64_t)pA->numerator * pB->denominator;
+    rhs = (int64_t)pB->numerator * pA->denominator;
+    cmp = (lhs > rhs) - (lhs < rhs);
+
+    /* Multiplying by a single negative denominator flips the inequality */
+    if ((pA->denominator < 0) != (pB->denominator < 0)) {
+        cmp = -cmp;
+    }
+    return cmp;
+}
+
+/**
+ * Compares two fractional numbers, without reducing either
+ *
+ * @param  [ in]pA A fraction
+ * @param  [ in]pB The other fraction
+ * @return         -1 if A < B, 0 if they are equal and 1 if A > B
+ */
+int fraction_cmp(fraction *pA, fraction *pB) {
+    return fraction_compareValues(&(pA->value), &(pB->value));
+}
+
+/**
+ * Checks whether two fractional numbers are equal, without reducing either
+ *
+ * @param  [ in]pA A fraction
+ * @param  [ in]pB The other fraction
+ * @return         1 if they are equal, 0 otherwise
+ */
+int fraction_eq(fraction *pA, fraction *pB) {
+    return (int64_t)pA->value.numerator * pB->value.denominator ==
+            (int64_t)pB->value.numerator * pA->value.denominator;
+}
+
+/**
+ * Copies the smallest of two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The smallest fraction (A, if they are equal)
+ * @param  [ in]pA   A fraction
+ * @param  [ in]pB   The other fraction
+ */
+void fraction_min(fraction *pOut, fraction *pA, fraction *pB) {
+    if (fraction_compareValues(&(pB->value), &(pA->value)) < 0) {
+        pA = pB;
+    }
+    pOut->value = pA->value;
+    pOut->isSimplified = pA->isSimplified;
+}
+
+/**
+ * Copies the biggest of two fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The biggest fraction (A, if they are equal)
+ * @param  [ in]pA   A fraction
+ * @param  [ in]pB   The other fraction
+ */
+void fraction_max(fraction *pOut, fraction *pA, fraction *pB) {
+    if (fraction_compareValues(&(pB->value), &(pA->value)) > 0) {
+        pA = pB;
+    }
+    pOut->value = pA->value;
+    pOut->isSimplified = pA->isSimplified;
+}
+
+/**
+ * Retrieve the sign of a fractional number, without reducing it
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            -1 if it's negative, 0 if it's zero and 1 if it's
+ *                    positive
+ */
+int fraction_sign(fraction *pFrac) {
+    int sign;
+
+    sign = (pFrac->value.numerator > 0) - (pFrac->value.numerator < 0);
+    if (pFrac->value.denominator < 0) {
+        sign = -sign;
+    }
+    return sign;
+}
+
+/**
+ * Checks whether a fractional number is zero, without reducing it
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            1 if it's zero, 0 otherwise
+ */
+int fraction_isZero(fraction *pFrac) {
+    return pFrac->value.numerator == 0;
+}
+
+/** Number of fractions gathered (on the stack) by the array converters */
+#define FRACTION_ARRAY_BLOCK 256
+
+/**
+ * Gather the terms of a few fractions (on their lowest terms) into separate
+ * arrays, so they may be converted in bulk
+ *
+ * @param  [out]pNums   The fractions' numerators
+ * @param  [out]pDens   The fractions' denominators
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions (up to FRACTION_ARRAY_BLOCK)
+ */
+static void fraction_gatherTerms(int *pNums, int *pDens, fraction **ppFracs,
+        int len) {
+    int i;
+
+    for (i = 0; i < len; i++) {
+        fraction_observe(ppFracs[i]);
+        pNums[i] = ppFracs[i]->value.numerator;
+        pDens[i] = ppFracs[i]->value.denominator;
+    }
+}
+
+/**
+ * Converts an array of fractional numbers to doubles
+ *
+ * @param  [out]pOut    The converted fractions
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions
+ */
+void fraction_dconvertArray(double *pOut, fraction **ppFracs, int len) {
+    int pNums[FRACTION_ARRAY_BLOCK], pDens[FRACTION_ARRAY_BLOCK];
+    int i, num;
+
+    for (i = 0; i < len; i += num) {
+        num = len - i;
+        if (num > FRACTION_ARRAY_BLOCK) {
+            num = FRACTION_ARRAY_BLOCK;
+        }
+        fraction_gatherTerms(pNums, pDens, ppFracs + i, num);
+        fractionBatch_dconvert(pOut + i, pNums, pDens, num);
+    }
+}
+
+/**
+ * Converts an array of fractional numbers to floats
+ *
+ * @param  [out]pOut    The converted fractions
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions
+ */
+void fraction_fconvertArray(float *pOut, fraction **ppFracs, int len) {
+    int pNums[FRACTION_ARRAY_BLOCK], pDens[FRACTION_ARRAY_BLOCK];
+    int i, num;
+
+    for (i = 0; i < len; i += num) {
+        num = len - i;
+        if (num > FRACTION_ARRAY_BLOCK) {
+            num = FRACTION_ARRAY_BLOCK;
+        }
+        fraction_gatherTerms(pNums, pDens, ppFracs + i, num);
+        fractionBatch_fconvert(pOut + i, pNums, pDens, num);
+    }
+}
+
+/**
+ * Converts an array of fractional numbers to 64 bits decimal fixed points
+ *
+ * @param  [out]pOut          The converted fractions
+ * @param  [ in]ppFracs       The fractions
+ * @param  [ in]decimalDigits Number of digits in the values that represent
+ *                            the decimal part (up to
+ *                            FRACTION_MAX_DECIMAL_DIGITS)
+ * @param  [ in]rounding      How results are rounded (one of
+ *                            FRACTION_ROUND_*)
+ * @param  [ in]len           Number of fractions
+ * @return                    0 on success, 1 if any result didn't fit (and
+ *                            was saturated)
+ */
+int fraction_fxconvertArray(int64_t *pOut, fraction **ppFracs,
+        int decimalDigits, int rounding, int len) {
+    int pNums[FRACTION_ARRAY_BLOCK], pDens[FRACTION_ARRAY_BLOCK];
+    int i, irv, num;
+
+    irv = 0;
+    for (i = 0; i < len; i += num) {
+        num = len - i;
+        if (num > FRACTION_ARRAY_BLOCK) {
+            num = FRACTION_ARRAY_BLOCK;
+        }
+        fraction_gatherTerms(pNums, pDens, ppFracs + i, num);
+        irv |= fractionBatch_fxconvert(pOut + i, pNums, pDens, decimalDigits,
+                rounding, num);
+    }
+
+    return irv;
+}
+
+/**
+ * Calculates the dot product of two arrays of fractional numbers (i.e., the
+ * sum of the products of their elements)
+ *
+ * NOTE: The output may be on either array!
+ *
+ * @param  [out]pOut The operation's result (0, if the arrays are empty)
+ * @param  [ in]ppA  The first factors
+ * @param  [ in]ppB  The second factors
+ * @param  [ in]len  Number of fractions on every array
+ */
+void fraction_dot(fraction *pOut, fraction **ppA, fraction **ppB, int len) {
+    int pNumsA[FRACTION_ARRAY_BLOCK], pDensA[FRACTION_ARRAY_BLOCK];
+    int pNumsB[FRACTION_ARRAY_BLOCK], pDensB[FRACTION_ARRAY_BLOCK];
+    accum acc;
+    int i, num;
+
+    STATS_INC(pOut->pManager->opsFraction);
+    accum_init(&acc, 0, 1);
+    for (i = 0; i < len; i += num) {
+        num = len - i;
+        if (num > FRACTION_ARRAY_BLOCK) {
+            num = FRACTION_ARRAY_BLOCK;
+        }
+        fraction_gatherTerms(pNumsA, pDensA, ppA + i, num);
+        fraction_gatherTerms(pNumsB, pDensB, ppB + i, num);
+        accum_addProducts(&acc, pNumsA, pDensA, pNumsB, pDensB, num);
+    }
+    fraction_store(pOut, acc.num, acc.den);
+}
+
+/**
+ * Multiplies every element of an array by a fractional number, adding the
+ * product to the respective element of another array (i.e., Y = A * X + Y)
+ *
+ * NOTE: The factor may be on either array, but its original value is used
+ *       for every element
+ *
+ * @param  [ in]ppY The summands, which are replaced by the results
+ * @param  [ in]pA  The factor
+ * @param  [ in]ppX The other factors
+ * @param  [ in]len Number of fractions on every array
+ */
+void fraction_axpy(fraction **ppY, fraction *pA, fraction **ppX, int len) {
+    int i, num, den;
+
+    fraction_observe(pA);
+    num = pA->value.numerator;
+    den = pA->value.denominator;
+    for (i = 0; i < len; i++) {
+        accum acc;
+
+        STATS_INC(ppY[i]->pManager->opsFraction);
+        accum_init(&acc, ppY[i]->value.numerator,
+                ppY[i]->value.denominator);
+        accum_addProduct(&acc, num, den, ppX[i]->value.numerator,
+                ppX[i]->value.denominator);
+        fraction_store(ppY[i], acc.num, acc.den);
+    }
+}
+
+/** Arrays shorter than this are simply sorted by insertion */
+#define FRACTION_SORT_MIN_RADIX 64
+
+/** A fraction and its sort key (the bits of its value as a double) */
+struct stFractionSortKey {
+    /** The fraction's value, mapped so it sorts as an unsigned integer */
+    uint64_t key;
+    /** The fraction */
+    fraction *pFrac;
+};
+typedef struct stFractionSortKey fractionSortKey;
+
+/**
+ * Retrieve the sort key of a fraction: its value as a double, with its bits
+ * mapped so every key sorts just like its double
+ *
+ * Since every term fits exactly into a double, the division is correctly
+ * rounded. So, the key of a bigger fraction is never smaller than the key
+ * of a smaller one (although distinct fractions may share a key).
+ *
+ * @param  [ in]pValue The fraction's value
+ * @return             The sort key
+ */
+static uint64_t fraction_getSortKey(const fractionValue *pValue) {
+    int64_t num, den;
+    uint64_t bits;
+    double val;
+
+    num = pValue->numerator;
+    den = pValue->denominator;
+    if (den < 0) {
+        num = -num;
+        den = -den;
+    }
+    /* With a positive denominator, every zero results in +0.0 */
+    val = (double)num / (double)den;
+    memcpy(&bits, &val, sizeof(bits));
+
+    /* Negative doubles sort backward, and before every positive one */
+    if (bits & ((uint64_t)1 << 63)) {
+        return ~bits;
+    }
+    return bits | ((uint64_t)1 << 63);
+}
+
+/**
+ * Sort a (short) array of fractions in place, by insertion
+ *
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions
+ */
+static void fraction_insertionSort(fraction **ppFracs, int len) {
+    int i, j;
+
+    for (i = 1; i < len; i++) {
+        fraction *pFrac;
+
+        pFrac = ppFracs[i];
+        for (j = i; j > 0 && fraction_compareValues(&(ppFracs[j - 1]->value),
+                &(pFrac->value)) > 0; j--) {
+            ppFracs[j] = ppFracs[j - 1];
+        }
+        ppFracs[j] = pFrac;
+    }
+}
+
+/**
+ * Sorts an array of fractional numbers into ascending order, without
+ * reducing any of them
+ *
+ * Fractions are radix sorted by their values as doubles and only those that
+ * round to the same double are then compared exactly. The sort is stable
+ * (i.e., equal fractions are kept on their original order).
+ *
+ * NOTE: Fractions with a zero denominator aren't ordered
+ *
+ * @param  [ in]ppFracs The fractions, which are sorted in place
+ * @param  [ in]len     Number of fractions
+ * @return              0 on success, 1 on failure (and the array is left
+ *                      untouched)
+ */
+int fraction_sortArray(fraction **ppFracs, int len) {
+    int pCounts[sizeof(uint64_t)][256];
+    fractionSortKey *pBuf, *pKeys, *pTmp;
+    int byte, i, start;
+
+    if (len < FRACTION_SORT_MIN_RADIX) {
+        fraction_insertionSort(ppFracs, len);
+        return 0;
+    }
+
+    pBuf = (fractionSortKey*)malloc(sizeof(fractionSortKey) * len * 2);
+    if (!pBuf) {
+        return 1;
+    }
+    pKeys = pBuf;
+    pTmp = pBuf + len;
+
+    /* Count the digits of every pass at once */
+    memset(pCounts, 0x0, sizeof(pCounts));
+    for (i = 0; i < len; i++) {
+        uint64_t key;
+
+        key = fraction_getSortKey(&(ppFracs[i]->value));
+        pKeys[i].key = key;
+        pKeys[i].pFrac = ppFracs[i];
+        for (byte = 0; byte < (int)sizeof(uint64_t); byte++) {
+            pCounts[byte][(key >> (byte * 8)) & 0xff]++;
+        }
+    }
+
+    /* Stable LSD radix sort, skipping bytes shared by every key (e.g., the
+     * exponent's, if every fraction has about the same magnitude) */
+    for (byte = 0; byte < (int)sizeof(uint64_t); byte++) {
+        fractionSortKey *pSwap;
+        int *pCount;
+        int digit, sum, tmp;
+
+        pCount = pCounts[byte];
+        if (pCount[(pKeys[0].key >> (byte * 8)) & 0xff] == len) {
+            continue;
+        }
+
+        sum = 0;
+        for (digit = 0; digit < 256; digit++) {
+            tmp = pCount[digit];
+            pCount[digit] = sum;
+            sum += tmp;
+        }
+        for (i = 0; i < len; i++) {
+            digit = (int)((pKeys[i].key >> (byte * 8)) & 0xff);
+            pTmp[pCount[digit]++] = pKeys[i];
+        }
+
+        pSwap = pKeys;
+        pKeys = pTmp;
+        pTmp = pSwap;
+    }
+
+    for (i = 0; i < len; i++) {
+        ppFracs[i] = pKeys[i].pFrac;
+    }
+
+    /* Only distinct fractions that round to the same double may be out of
+     * order, so sort each run of equal keys exactly */
+    start = 0;
+    for (i = 1; i <= len; i++) {
+        if (i == len || pKeys[i].key != pKeys[start].key) {
+            if (i - start > 1) {
+                fraction_insertionSort(ppFracs + start, i - start);
+            }
+            start = i;
+        }
+    }
+
+    free(pBuf);
+    return 0;
 }
 
@@ -0,0 +1,421 @@
+/**
+ * Defines fractional numbers with 64 bits terms
+ *
+ * Differently from regular fractions, these are always kept on their lowest
+ * terms and every operation checks whether its result fits into 64 bits.
+ * Whenever it doesn't, the operation fails and its output is left untouched.
+ *
+ * Multiplications and divisions first cancel the common factors between each
+ * numerator and the other denominator, so their products are already on
+ * their lowest terms (and overflow only if the result itself can't be
+ * represented). Sums and subtractions cross multiply their terms on 128 bits,
+ * when the compiler supports it, so only the reduced result must fit.
+ *
+ * @file src/fraction64.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/gcd.h>
+#include <fraction_internal/fraction64.h>
+#include <fraction_internal/manager.h>
+#include <fraction_internal/pool.h>
+#include <fraction_internal/stats.h>
+
+#include <stdint.h>
+
+/**
+ * Retrieve the absolute value of a number, even if it's INT64_MIN
+ *
+ * @param  [ in]val The number
+ * @return          Its absolute value
+ */
+static uint64_t fraction64_abs(int64_t val) {
+    if (val < 0) {
+        return 0u - (uint64_t)val;
+    }
+    return (uint64_t)val;
+}
+
+/**
+ * Store a result, given its sign and the magnitude of both its terms
+ *
+ * @param  [out]pNum       The result's numerator
+ * @param  [out]pDen       The result's denominator
+ * @param  [ in]isNegative Whether the result is negative
+ * @param  [ in]num        The numerator's magnitude
+ * @param  [ in]den        The denominator's magnitude
+ * @return                 0 on success, 1 on overflow
+ */
+static int fraction64_store(int64_t *pNum, int64_t *pDen, int isNegative,
+        uint64_t num, uint64_t den) {
+    if (num == 0) {
+        *pNum = 0;
+        *pDen = 1;
+        return 0;
+    }
+
+    if (den > (uint64_t)INT64_MAX) {
+        return 1;
+    }
+    else if (num > (uint64_t)INT64_MAX + (isNegative ? 1u : 0u)) {
+        return 1;
+    }
+
+    if (isNegative) {
+        *pNum = (int64_t)(0u - num);
+    }
+    else {
+        *pNum = (int64_t)num;
+    }
+    *pDen = (int64_t)den;
+
+    return 0;
+}
+
+/**
+ * Multiply two fractions, given by their terms. The result is only stored if
+ * it fits into 64 bits
+ *
+ * NOTE: Either denominator may be negative, so this also divides fractions
+ *
+ * @param  [out]pNum The result's numerator
+ * @param  [out]pDen The result's denominator
+ * @param  [ in]numA The first fraction's numerator
+ * @param  [ in]denA The first fraction's denominator
+ * @param  [ in]numB The second fraction's numerator
+ * @param  [ in]denB The second fraction's denominator
+ * @return           0 on success, 1 on overflow or division by zero
+ */
+int fraction64_mulTerms(int64_t *pNum, int64_t *pDen, int64_t numA,
+        int64_t denA, int64_t numB, int64_t denB) {
+    uint64_t den, divAB, divBA, num;
+    int isNegative;
+
+    if (denA == 0 || denB == 0) {
+        return 1;
+    }
+
+    isNegative = (numA < 0) ^ (denA < 0) ^ (numB < 0) ^ (denB < 0);
+
+    /* Cancel the factors common to each numerator and the other
+     * denominator, so the products are already on their lowest terms */
+    divAB = gcd_u64(fraction64_abs(numA), fraction64_abs(denB));
+    divBA = gcd_u64(fraction64_abs(numB), fraction64_abs(denA));
+
+    if (__builtin_mul_overflow(fraction64_abs(numA) / divAB,
+            fraction64_abs(numB) / divBA, &num)) {
+        return 1;
+    }
+    if (__builtin_mul_overflow(fraction64_abs(denA) / divBA,
+            fraction64_abs(denB) / divAB, &den)) {
+        return 1;
+    }
+
+    return fraction64_store(pNum, pDen, isNegative, num, den);
+}
+
+/**
+ * Add (or subtract) two fractions on their lowest terms, given by their
+ * terms. The result is only stored if it fits into 64 bits
+ *
+ * This uses Knuth's method, so the only reduction needed is by the gcd
+ * between the sum and the gcd of both denominators
+ *
+ * @param  [out]pNum  The result's numerator
+ * @param  [out]pDen  The result's denominator
+ * @param  [ in]numA  The first fraction's numerator
+ * @param  [ in]denA  The first fraction's (positive) denominator
+ * @param  [ in]numB  The second fraction's numerator
+ * @param  [ in]denB  The second fraction's (positive) denominator
+ * @param  [ in]isSub Whether the second fraction should be subtracted
+ * @return            0 on success, 1 on overflow
+ */
+int fraction64_addTerms(int64_t *pNum, int64_t *pDen, int64_t numA,
+        int64_t denA, int64_t numB, int64_t denB, int isSub) {
+    uint64_t den, div, divSum, mulA, mulB, num;
+    int isNegative;
+
+    div = gcd_u64((uint64_t)denA, (uint64_t)denB);
+    mulA = (uint64_t)denB / div;
+    mulB = (uint64_t)denA / div;
+
+#if defined(__SIZEOF_INT128__)
+    {
+        __int128 sum;
+
+        /* Each product takes at most 127 bits, and so does their sum */
+        sum = (__int128)numA * (__int128)mulA;
+        if (isSub) {
+            sum -= (__int128)numB * (__int128)mulB;
+        }
+        else {
+            sum += (__int128)numB * (__int128)mulB;
+        }
+
+        isNegative = (sum < 0);
+        if (isNegative) {
+            sum = -sum;
+        }
+
+        /* gcd(sum, div) == gcd(sum % div, div) */
+        divSum = gcd_u64((uint64_t)(sum % div), div);
+        sum /= divSum;
+        if (sum > (__int128)UINT64_MAX) {
+            return 1;
+        }
+        num = (uint64_t)sum;
+    }
+#else
+    {
+        int64_t prodA, prodB, sum;
+        int irv;
+
+        /* Without 128 bits integers, the sum itself must fit into 64 bits */
+        if (__builtin_mul_overflow(numA, (int64_t)mulA, &prodA) ||
+                __builtin_mul_overflow(numB, (int64_t)mulB, &prodB)) {
+            return 1;
+        }
+        if (isSub) {
+            irv = __builtin_sub_overflow(prodA, prodB, &sum);
+        }
+        else {
+            irv = __builtin_add_overflow(prodA, prodB, &sum);
+        }
+        if (irv) {
+            return 1;
+        }
+
+        isNegative = (sum < 0);
+        num = fraction64_abs(sum);
+        divSum = gcd_u64(num % div, div);
+        num /= divSum;
+    }
+#endif
+
+    if (num == 0) {
+        return fraction64_store(pNum, pDen, 0, 0, 1);
+    }
+    if (__builtin_mul_overflow(mulB, (uint64_t)denB / divSum, &den)) {
+        return 1;
+    }
+
+    return fraction64_store(pNum, pDen, isNegative, num, den);
+}
+
+/**
+ * Initializes a 64 bits fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFraction64(fraction64 **ppOut, fractionManager *pMng,
+        int64_t numerator, int64_t denominator) {
+    fraction64 *pFrac;
+    int irv;
+
+    if (denominator == 0) {
+        return 1;
+    }
+
+    /* Retrieve a unused referece */
+    irv = pool_getObject((void**)&pFrac, &(pMng->fractions64));
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Initialize it */
+    pFrac->pManager = pMng;
+    irv = fraction64_mulTerms(&(pFrac->numerator), &(pFrac->denominator),
+            numerator, 1, 1, denominator);
+    if (irv != 0) {
+        /* -INT64_MIN can't be represented */
+        fractionManager_releaseFraction64(pFrac);
+        return 1;
+    }
+
+    *ppOut = pFrac;
+    return 0;
+}
+
+/**
+ * Initializes a 64 bits fraction from an integer number
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_igetFraction64(fraction64 **ppOut, fractionManager *pMng,
+        int64_t val) {
+    return fractionManager_getFraction64(ppOut, pMng, val, 1);
+}
+
+/**
+ * Initializes a 64 bits fraction with the value of a regular fraction
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_widenFraction(fraction64 **ppOut, fraction *pSrc) {
+    return fractionManager_getFraction64(ppOut, pSrc->pManager,
+            pSrc->value.numerator, pSrc->value.denominator);
+}
+
+/**
+ * Releases a 64 bits fraction to the fraction manager
+ *
+ * @param  [ in]pFrac The number to be released
+ */
+void fractionManager_releaseFraction64(fraction64 *pFrac) {
+    pool_releaseObject(&(pFrac->pManager->fractions64), pFrac);
+}
+
+/**
+ * Clones a 64 bits fraction number into a newly alloc'ed one
+ *
+ * @param  [out]ppOut The cloned fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_clone64(fraction64 **ppOut, fraction64 *pSrc) {
+    int irv;
+
+    /* Retrieve a unused referece */
+    irv = pool_getObject((void**)ppOut, &(pSrc->pManager->fractions64));
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Initialize it */
+    (*ppOut)->numerator = pSrc->numerator;
+    (*ppOut)->denominator = pSrc->denominator;
+    (*ppOut)->pManager = pSrc->pManager;
+
+    return 0;
+}
+
+/**
+ * Adds two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on overflow
+ */
+int fraction64_sum(fraction64 *pOut, fraction64 *pA, fraction64 *pB) {
+    STATS_INC(pOut->pManager->opsFraction64);
+    return fraction64_addTerms(&(pOut->numerator), &(pOut->denominator),
+            pA->numerator, pA->denominator, pB->numerator, pB->denominator,
+            0/*isSub*/);
+}
+
+/**
+ * Subtracts two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on overflow
+ */
+int fraction64_sub(fraction64 *pOut, fraction64 *pA, fraction64 *pB) {
+    STATS_INC(pOut->pManager->opsFraction64);
+    return fraction64_addTerms(&(pOut->numerator), &(pOut->denominator),
+            pA->numerator, pA->denominator, pB->numerator, pB->denominator,
+            1/*isSub*/);
+}
+
+/**
+ * Multiplies two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factors
+ * @return           0 on success, 1 on overflow
+ */
+int fraction64_mul(fraction64 *pOut, fraction64 *pA, fraction64 *pB) {
+    STATS_INC(pOut->pManager->opsFraction64);
+    return fraction64_mulTerms(&(pOut->numerator), &(pOut->denominator),
+            pA->numerator, pA->denominator, pB->numerator, pB->denominator);
+}
+
+/**
+ * Divides two 64 bits fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result (untouched on overflow)
+ * @param  [ in]pA   The dividend
+ * @param  [ in]pB   The divisor
+ * @return           0 on success, 1 on overflow or division by zero
+ */
+int fraction64_div(fraction64 *pOut, fraction64 *pA, fraction64 *pB) {
+    STATS_INC(pOut->pManager->opsFraction64);
+    return fraction64_mulTerms(&(pOut->numerator), &(pOut->denominator),
+            pA->numerator, pA->denominator, pB->denominator, pB->numerator);
+}
+
+/**
+ * Converts a 64 bits fractional number to a regular one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The 64 bits fraction
+ * @return            0 on success, 1 if it doesn't fit into a regular fraction
+ */
+int fraction64_narrow(fraction *pOut, fraction64 *pFrac) {
+    if (pFrac->numerator < INT32_MIN || pFrac->numerator > INT32_MAX ||
+            pFrac->denominator > INT32_MAX) {
+        return 1;
+    }
+
+    pOut->value.numerator = (int)pFrac->numerator;
+    pOut->value.denominator = (int)pFrac->denominator;
+    pOut->isSimplified = 1;
+
+    return 0;
+}
+
+/**
+ * Converts a 64 bits fractional number to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fraction64_iconvert(int64_t *pOut, fraction64 *pFrac) {
+    *pOut = pFrac->numerator / pFrac->denominator;
+}
+
+/**
+ * Converts a 64 bits fractional number to a double
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fraction64_dconvert(double *pOut, fraction64 *pFrac) {
+    *pOut = pFrac->numerator / (double)pFrac->denominator;
+}
+
+/**
+ * Converts a 64 bits fractional number through a division, retrieving the
+ * number's quotient and remainder
+ *
+ * @param  [out]pQuotOut The fraction's quotient
+ * @param  [out]pRemOut  The fraction's remainder
+ * @param  [ in]pFrac    The fraction
+ */
+void fraction64_divConvert(int64_t *pQuotOut, int64_t *pRemOut,
+        fraction64 *pFrac) {
+    *pQuotOut = pFrac->numerator / pFrac->denominator;
+    *pRemOut = pFrac->numerator % pFrac->denominator;
+}
+
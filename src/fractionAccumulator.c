@@ -0,0 +1,347 @@
+/**
+ * Sums many fractional numbers exactly, without reducing each partial sum
+ *
+ * An accumulator keeps its running sum over a common denominator (the least
+ * common multiple of every denominator added so far), on 64 bits terms, and
+ * never reduces it after adding a term. It's only reduced when the next term
+ * would overflow it, or when its value is retrieved. So, feeds whose
+ * denominators come from a small set mostly cost a division and a few
+ * multiplications per term (see src/accum.c).
+ *
+ * If even the reduced running sum overflows, it's folded into a big fraction
+ * (retrieved from the manager) and the accumulator starts over from zero.
+ * Therefore, the sum never loses any precision, and the value is only
+ * required to fit when it's retrieved as a regular (or 64 bits) fraction.
+ *
+ * @file src/fractionAccumulator.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/accum.h>
+#include <fraction_internal/manager.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of fractions gathered at once on bulk additions */
+#define FRACTION_ACCUMULATOR_BLOCK 256
+
+/**
+ * Initializes an accumulator (whose sum starts at zero)
+ *
+ * @param  [out]ppOut The alloc'ed and initialized accumulator
+ * @param  [ in]pMng  The fraction manager
+ * @return            0 on success, 1 on failure
+ */
+int fractionAccumulator_init(fractionAccumulator **ppOut,
+        fractionManager *pMng) {
+    fractionAccumulator *pAcc;
+
+    pAcc = (fractionAccumulator*)malloc(sizeof(fractionAccumulator));
+    if (!pAcc) {
+        return 1;
+    }
+    memset(pAcc, 0x0, sizeof(fractionAccumulator));
+    pAcc->pManager = pMng;
+    accum_init(&(pAcc->sum), 0, 1);
+
+    *ppOut = pAcc;
+    return 0;
+}
+
+/**
+ * Releases an accumulator
+ *
+ * @param  [ in]ppAcc The accumulator to be dealloc'ed
+ */
+void fractionAccumulator_clean(fractionAccumulator **ppAcc) {
+    fractionAccumulator *pAcc;
+
+    /* Check that the object was initialized */
+    if (!ppAcc || !(*ppAcc)) {
+        return;
+    }
+    pAcc = *ppAcc;
+
+    if (pAcc->pBig) {
+        fractionManager_releaseFractionBig(pAcc->pBig);
+    }
+
+    free(pAcc);
+    *ppAcc = 0;
+}
+
+/**
+ * Resets the accumulator's sum back to zero
+ *
+ * @param  [ in]pAcc The accumulator
+ */
+void fractionAccumulator_reset(fractionAccumulator *pAcc) {
+    if (pAcc->pBig) {
+        fractionManager_releaseFractionBig(pAcc->pBig);
+        pAcc->pBig = 0;
+    }
+    accum_init(&(pAcc->sum), 0, 1);
+}
+
+/**
+ * Fold the running sum into the big one, so the running sum starts over from
+ * zero
+ *
+ * @param  [ in]pAcc The accumulator
+ * @return           0 on success, 1 on failure
+ */
+static int fractionAccumulator_fold(fractionAccumulator *pAcc) {
+    fractionBig *pTerm;
+    int irv;
+
+    if (pAcc->sum.num == 0) {
+        return 0;
+    }
+
+    if (!pAcc->pBig) {
+        irv = fractionManager_getFractionBig(&(pAcc->pBig), pAcc->pManager,
+                pAcc->sum.num, pAcc->sum.den);
+    }
+    else {
+        irv = fractionManager_getFractionBig(&pTerm, pAcc->pManager,
+                pAcc->sum.num, pAcc->sum.den);
+        if (irv == 0) {
+            irv = fractionBig_sum(pAcc->pBig, pAcc->pBig, pTerm);
+            fractionManager_releaseFractionBig(pTerm);
+        }
+    }
+    if (irv != 0) {
+        return 1;
+    }
+
+    accum_init(&(pAcc->sum), 0, 1);
+    return 0;
+}
+
+/**
+ * Add a fraction, given by its terms, to the accumulator
+ *
+ * @param  [ in]pAcc The accumulator
+ * @param  [ in]num  The fraction's numerator
+ * @param  [ in]den  The fraction's denominator
+ * @return           0 on success, 1 on failure
+ */
+static int fractionAccumulator_addValue(fractionAccumulator *pAcc, int num,
+        int den) {
+    if (den == 0) {
+        return 1;
+    }
+    else if (accum_add(&(pAcc->sum), num, den) == 0) {
+        return 0;
+    }
+
+    /* Any fraction fits into the emptied running sum */
+    if (fractionAccumulator_fold(pAcc) != 0) {
+        return 1;
+    }
+    return accum_add(&(pAcc->sum), num, den);
+}
+
+/**
+ * Adds a fractional number to the accumulator
+ *
+ * @param  [ in]pAcc  The accumulator
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 on failure (or if the fraction's
+ *                    denominator is zero)
+ */
+int fractionAccumulator_add(fractionAccumulator *pAcc, fraction *pFrac) {
+    return fractionAccumulator_addValue(pAcc, pFrac->value.numerator,
+            pFrac->value.denominator);
+}
+
+/**
+ * Adds a fractional number, given by its numerator and denominator, to the
+ * accumulator
+ *
+ * @param  [ in]pAcc        The accumulator
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionAccumulator_addTerms(fractionAccumulator *pAcc, int numerator,
+        int denominator) {
+    return fractionAccumulator_addValue(pAcc, numerator, denominator);
+}
+
+/**
+ * Adds an array of fractional numbers, given by their numerators and
+ * denominators, to the accumulator
+ *
+ * NOTE: Fractions with a zero denominator are skipped
+ *
+ * @param  [ in]pAcc  The accumulator
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ * @return            0 on success, 1 if any fraction couldn't be added
+ */
+int fractionAccumulator_addTermsArray(fractionAccumulator *pAcc,
+        const int *pNums, const int *pDens, int len) {
+    int i, irv;
+
+    irv = 0;
+    i = 0;
+    while (i < len) {
+        i += accum_addArray(&(pAcc->sum), pNums + i, pDens + i, len - i);
+        if (i < len) {
+            /* Either fold the overflowed sum or skip the invalid fraction */
+            irv |= fractionAccumulator_addValue(pAcc, pNums[i], pDens[i]);
+            i++;
+        }
+    }
+
+    return irv;
+}
+
+/**
+ * Adds an array of fractional numbers to the accumulator
+ *
+ * NOTE: Fractions with a zero denominator are skipped
+ *
+ * @param  [ in]pAcc    The accumulator
+ * @param  [ in]ppFracs The fractions
+ * @param  [ in]len     Number of fractions
+ * @return              0 on success, 1 if any fraction couldn't be added
+ */
+int fractionAccumulator_addArray(fractionAccumulator *pAcc,
+        fraction **ppFracs, int len) {
+    int pNums[FRACTION_ACCUMULATOR_BLOCK], pDens[FRACTION_ACCUMULATOR_BLOCK];
+    int i, irv, j, num;
+
+    irv = 0;
+    for (i = 0; i < len; i += num) {
+        num = len - i;
+        if (num > FRACTION_ACCUMULATOR_BLOCK) {
+            num = FRACTION_ACCUMULATOR_BLOCK;
+        }
+        for (j = 0; j < num; j++) {
+            pNums[j] = ppFracs[i + j]->value.numerator;
+            pDens[j] = ppFracs[i + j]->value.denominator;
+        }
+        irv |= fractionAccumulator_addTermsArray(pAcc, pNums, pDens, num);
+    }
+
+    return irv;
+}
+
+/**
+ * Retrieve the accumulator's sum as a 64 bits fraction, folding the running
+ * sum into the big one (if there's any)
+ *
+ * @param  [out]pOut The sum (untouched on failure)
+ * @param  [ in]pAcc The accumulator
+ * @return           0 on success, 1 on failure or if it doesn't fit
+ */
+static int fractionAccumulator_getSum(fraction64 *pOut,
+        fractionAccumulator *pAcc) {
+    if (pAcc->pBig) {
+        if (fractionAccumulator_fold(pAcc) != 0) {
+            return 1;
+        }
+        return fractionBig_narrow(pOut, pAcc->pBig);
+    }
+
+    accum_reduce(&(pAcc->sum));
+    pOut->numerator = pAcc->sum.num;
+    pOut->denominator = pAcc->sum.den;
+    return 0;
+}
+
+/**
+ * Retrieve the accumulator's current sum, without resetting it
+ *
+ * @param  [out]pOut The sum (untouched on failure)
+ * @param  [ in]pAcc The accumulator
+ * @return           0 on success, 1 on failure or if the sum doesn't fit into
+ *                   a regular fraction
+ */
+int fractionAccumulator_snapshot(fraction *pOut, fractionAccumulator *pAcc) {
+    fraction64 sum;
+
+    if (fractionAccumulator_getSum(&sum, pAcc) != 0) {
+        return 1;
+    }
+    return fraction64_narrow(pOut, &sum);
+}
+
+/**
+ * Retrieve the accumulator's current sum as a 64 bits fraction, without
+ * resetting it
+ *
+ * @param  [out]pOut The sum (untouched on failure)
+ * @param  [ in]pAcc The accumulator
+ * @return           0 on success, 1 on failure or if the sum doesn't fit into
+ *                   64 bits
+ */
+int fractionAccumulator_snapshot64(fraction64 *pOut,
+        fractionAccumulator *pAcc) {
+    fraction64 sum;
+
+    if (fractionAccumulator_getSum(&sum, pAcc) != 0) {
+        return 1;
+    }
+    pOut->numerator = sum.numerator;
+    pOut->denominator = sum.denominator;
+    return 0;
+}
+
+/**
+ * Retrieve the accumulator's sum as a newly alloc'ed fraction, resetting
+ * the accumulator
+ *
+ * @param  [out]ppOut The alloc'ed fraction
+ * @param  [ in]pAcc  The accumulator (untouched on failure)
+ * @return            0 on success, 1 on failure or if the sum doesn't fit
+ *                    into a regular fraction
+ */
+int fractionAccumulator_finalize(fraction **ppOut,
+        fractionAccumulator *pAcc) {
+    fraction *pFrac;
+
+    if (fractionManager_igetFraction(&pFrac, pAcc->pManager, 0) != 0) {
+        return 1;
+    }
+    if (fractionAccumulator_snapshot(pFrac, pAcc) != 0) {
+        fractionManager_releaseFraction(pFrac);
+        return 1;
+    }
+
+    fractionAccumulator_reset(pAcc);
+    *ppOut = pFrac;
+    return 0;
+}
+
+/**
+ * Retrieve the accumulator's sum as a newly alloc'ed big fraction (so it
+ * always fits), resetting the accumulator
+ *
+ * @param  [out]ppOut The alloc'ed fraction
+ * @param  [ in]pAcc  The accumulator (untouched on failure)
+ * @return            0 on success, 1 on failure
+ */
+int fractionAccumulator_finalizeBig(fractionBig **ppOut,
+        fractionAccumulator *pAcc) {
+    if (pAcc->pBig) {
+        if (fractionAccumulator_fold(pAcc) != 0) {
+            return 1;
+        }
+        *ppOut = pAcc->pBig;
+        pAcc->pBig = 0;
+    }
+    else if (fractionManager_getFractionBig(ppOut, pAcc->pManager,
+            pAcc->sum.num, pAcc->sum.den) != 0) {
+        return 1;
+    }
+
+    fractionAccumulator_reset(pAcc);
+    return 0;
+}
+
@@ -0,0 +1,484 @@
+/**
+ * Operates element-wise on arrays of numerators and denominators (e.g., the
+ * ones of a fraction pool), so many fractions are processed on a single call
+ *
+ * Each operation is done in blocks: first, every result of the block is
+ * calculated on 64 bits and stored on the output. Results that don't fit into
+ * an int are reduced right away. Then, the whole block is normalized at once,
+ * while it's still on the cache (on x86, through SIMD kernels selected for the
+ * running CPU).
+ *
+ * Every output may be the same array as the first operand, so operations may
+ * be done in place. Just like regular fractions, every result is stored on
+ * its lowest terms (with its sign on the numerator).
+ *
+ * Arrays may also be converted to floating point numbers (through SIMD
+ * kernels, on x86) and to decimal fixed points. Fixed points are calculated
+ * through long division, a few decimal digits at a time, so the numerator
+ * times the power of ten never overflows (which would otherwise require 128
+ * bits) and the remainder may be rounded as requested.
+ *
+ * @file src/fractionBatch.c
+ */
+#include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+#include <fraction_internal/accum.h>
+#include <fraction_internal/convert.h>
+#include <fraction_internal/gcd.h>
+
+#include <limits.h>
+#include <stdint.h>
+
+/** Number of fractions normalized at once */
+#define FRACTION_BATCH_BLOCK 256
+
+/**
+ * Store the (widened) result of an operation, reducing it only if it doesn't
+ * fit into an int
+ *
+ * @param  [out]pNum The result's numerator
+ * @param  [out]pDen The result's denominator
+ * @param  [ in]num  The widened numerator
+ * @param  [ in]den  The widened denominator
+ */
+static void fractionBatch_store(int *pNum, int *pDen, int64_t num,
+        int64_t den) {
+    if (num < -INT_MAX || num > INT_MAX || den < -INT_MAX || den > INT_MAX) {
+        gcd_reduce64(&num, &den);
+    }
+    *pNum = (int)num;
+    *pDen = (int)den;
+}
+
+/**
+ * Reduces every fraction of an array to its lowest terms (with its sign on
+ * the numerator)
+ *
+ * NOTE: Fractions with a zero denominator are left untouched
+ *
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ */
+void fractionBatch_normalize(int *pNums, int *pDens, int len) {
+    gcd_reduceBlock(pNums, pDens, len);
+}
+
+/**
+ * Adds two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The first summands' numerators
+ * @param  [ in]pDensA   The first summands' denominators
+ * @param  [ in]pNumsB   The second summands' numerators
+ * @param  [ in]pDensB   The second summands' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_sum(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNumsA[j] * pDensB[j] +
+                    (int64_t)pNumsB[j] * pDensA[j],
+                    (int64_t)pDensA[j] * pDensB[j]);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Subtracts two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The minuends' numerators
+ * @param  [ in]pDensA   The minuends' denominators
+ * @param  [ in]pNumsB   The subtrahends' numerators
+ * @param  [ in]pDensB   The subtrahends' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_sub(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNumsA[j] * pDensB[j] -
+                    (int64_t)pNumsB[j] * pDensA[j],
+                    (int64_t)pDensA[j] * pDensB[j]);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Multiplies two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The first factors' numerators
+ * @param  [ in]pDensA   The first factors' denominators
+ * @param  [ in]pNumsB   The second factors' numerators
+ * @param  [ in]pDensB   The second factors' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_mul(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNumsA[j] * pNumsB[j],
+                    (int64_t)pDensA[j] * pDensB[j]);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Divides two arrays of fractional numbers, element-wise
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNumsA   The dividends' numerators
+ * @param  [ in]pDensA   The dividends' denominators
+ * @param  [ in]pNumsB   The divisors' numerators
+ * @param  [ in]pDensB   The divisors' denominators
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_div(int *pOutNums, int *pOutDens, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNumsA[j] * pDensB[j],
+                    (int64_t)pDensA[j] * pNumsB[j]);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Adds a fractional number to every element of an array
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The added number's numerator
+ * @param  [ in]den      The added number's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_sumScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNums[j] * den + (int64_t)num * pDens[j],
+                    (int64_t)pDens[j] * den);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Subtracts a fractional number from every element of an array
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The subtrahend's numerator
+ * @param  [ in]den      The subtrahend's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_subScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNums[j] * den - (int64_t)num * pDens[j],
+                    (int64_t)pDens[j] * den);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Multiplies every element of an array by a fractional number
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The factor's numerator
+ * @param  [ in]den      The factor's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_mulScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNums[j] * num, (int64_t)pDens[j] * den);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Divides every element of an array by a fractional number
+ *
+ * @param  [out]pOutNums The results' numerators
+ * @param  [out]pOutDens The results' denominators
+ * @param  [ in]pNums    The array's numerators
+ * @param  [ in]pDens    The array's denominators
+ * @param  [ in]num      The divisor's numerator
+ * @param  [ in]den      The divisor's denominator
+ * @param  [ in]len      Number of fractions on every array
+ */
+void fractionBatch_divScalar(int *pOutNums, int *pOutDens, const int *pNums,
+        const int *pDens, int num, int den, int len) {
+    int i, j, end;
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_BATCH_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        for (j = i; j < end; j++) {
+            fractionBatch_store(pOutNums + j, pOutDens + j,
+                    (int64_t)pNums[j] * den, (int64_t)pDens[j] * num);
+        }
+        gcd_reduceBlock(pOutNums + i, pOutDens + i, end - i);
+    }
+}
+
+/**
+ * Calculates the dot product of two arrays of fractional numbers (i.e., the
+ * sum of the products of their elements), reducing only the final result
+ *
+ * NOTE: If any fraction has a zero denominator, so does the result
+ *
+ * @param  [out]pOutNum The result's numerator
+ * @param  [out]pOutDen The result's denominator
+ * @param  [ in]pNumsA  The first factors' numerators
+ * @param  [ in]pDensA  The first factors' denominators
+ * @param  [ in]pNumsB  The second factors' numerators
+ * @param  [ in]pDensB  The second factors' denominators
+ * @param  [ in]len     Number of fractions on every array
+ */
+void fractionBatch_dot(int *pOutNum, int *pOutDen, const int *pNumsA,
+        const int *pDensA, const int *pNumsB, const int *pDensB, int len) {
+    fractionValue val;
+    accum acc;
+
+    accum_init(&acc, 0, 1);
+    accum_addProducts(&acc, pNumsA, pDensA, pNumsB, pDensB, len);
+    fractionValue_store(&val, acc.num, acc.den);
+
+    *pOutNum = val.numerator;
+    *pOutDen = val.denominator;
+}
+
+/**
+ * Converts an array of fractional numbers to doubles
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ */
+void fractionBatch_dconvert(double *pOut, const int *pNums, const int *pDens,
+        int len) {
+    convert_toDoubleBlock(pOut, pNums, pDens, len);
+}
+
+/**
+ * Converts an array of fractional numbers to floats
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ */
+void fractionBatch_fconvert(float *pOut, const int *pNums, const int *pDens,
+        int len) {
+    convert_toFloatBlock(pOut, pNums, pDens, len);
+}
+
+/**
+ * Converts a fractional number to a 64 bits decimal fixed point
+ *
+ * @param  [out]pOut     The converted fraction
+ * @param  [ in]num      The fraction's numerator
+ * @param  [ in]den      The fraction's denominator (which mustn't be zero)
+ * @param  [ in]digits   Number of decimal digits (from 0 to
+ *                       FRACTION_MAX_DECIMAL_DIGITS)
+ * @param  [ in]rounding How the result is rounded (one of FRACTION_ROUND_*)
+ * @return               0 on success, 1 if the result didn't fit (and was
+ *                       saturated)
+ */
+static int fractionBatch_fxconvertOne(int64_t *pOut, int64_t num,
+        int64_t den, int digits, int rounding) {
+    uint64_t absDen, absNum, limit, quot, rem;
+    int isNegative;
+
+    isNegative = (num < 0) != (den < 0);
+    absNum = (num < 0) ? (uint64_t)-num : (uint64_t)num;
+    absDen = (den < 0) ? (uint64_t)-den : (uint64_t)den;
+
+    if (digits <= 9) {
+        /* Both terms fit into 32 bits, so this fits into 64 bits */
+        absNum *= (uint64_t)fractionValue_pow10[digits];
+        quot = absNum / absDen;
+        rem = absNum % absDen;
+    }
+    else {
+        uint64_t frac, mult;
+
+        /* Divide the integer part, and then append a few digits at a time
+         * (the remainder is smaller than the denominator, so multiplying it
+         * by up to 10^9 still fits into 64 bits) */
+        mult = (uint64_t)fractionValue_pow10[digits];
+        quot = absNum / absDen;
+        rem = absNum % absDen;
+        frac = 0;
+        while (digits > 0) {
+            int step;
+
+            step = (digits > 9) ? 9 : digits;
+            rem *= (uint64_t)fractionValue_pow10[step];
+            frac = frac * (uint64_t)fractionValue_pow10[step] + rem / absDen;
+            rem %= absDen;
+            digits -= step;
+        }
+
+        if (quot > (UINT64_MAX - frac) / mult) {
+            /* Past any limit, even after being rounded */
+            quot = (uint64_t)INT64_MAX + 2;
+            rem = 0;
+        }
+        else {
+            quot = quot * mult + frac;
+        }
+    }
+
+    switch (rounding) {
+    case FRACTION_ROUND_FLOOR:
+        quot += (isNegative && rem != 0);
+        break;
+    case FRACTION_ROUND_CEIL:
+        quot += (!isNegative && rem != 0);
+        break;
+    case FRACTION_ROUND_HALF_AWAY:
+        quot += (rem * 2 >= absDen && rem != 0);
+        break;
+    case FRACTION_ROUND_HALF_EVEN:
+        quot += (rem * 2 > absDen || (rem * 2 == absDen && (quot & 1)));
+        break;
+    default:
+        break;
+    }
+
+    /* INT64_MIN's magnitude is one past INT64_MAX */
+    limit = (uint64_t)INT64_MAX + isNegative;
+    if (quot > limit) {
+        *pOut = isNegative ? INT64_MIN : INT64_MAX;
+        return 1;
+    }
+
+    *pOut = isNegative ? (int64_t)(0u - quot) : (int64_t)quot;
+    return 0;
+}
+
+/**
+ * Converts an array of fractional numbers to 64 bits decimal fixed points
+ *
+ * NOTE: Fractions with a zero denominator are converted to 0
+ *
+ * @param  [out]pOut          The converted fractions
+ * @param  [ in]pNums         The fractions' numerators
+ * @param  [ in]pDens         The fractions' denominators
+ * @param  [ in]decimalDigits Number of digits in the values that represent
+ *                            the decimal part (up to
+ *                            FRACTION_MAX_DECIMAL_DIGITS)
+ * @param  [ in]rounding      How results are rounded (one of
+ *                            FRACTION_ROUND_*)
+ * @param  [ in]len           Number of fractions on every array
+ * @return                    0 on success, 1 if any result didn't fit (and
+ *                            was saturated)
+ */
+int fractionBatch_fxconvert(int64_t *pOut, const int *pNums,
+        const int *pDens, int decimalDigits, int rounding, int len) {
+    int i, irv;
+
+    if (decimalDigits < 0) {
+        decimalDigits = 0;
+    }
+    else if (decimalDigits > FRACTION_MAX_DECIMAL_DIGITS) {
+        decimalDigits = FRACTION_MAX_DECIMAL_DIGITS;
+    }
+
+    irv = 0;
+    for (i = 0; i < len; i++) {
+        if (pDens[i] == 0) {
+            pOut[i] = 0;
+            continue;
+        }
+        irv |= fractionBatch_fxconvertOne(pOut + i, pNums[i], pDens[i],
+                decimalDigits, rounding);
+    }
+
+    return irv;
+}
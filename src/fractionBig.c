@@ -0,0 +1,450 @@
+/**
+ * Defines fractional numbers with arbitrary precision
+ *
+ * Both terms are big numbers, which are stored inline while they fit into 64
+ * bits. While every term is inline, operations are done just like on 64 bits
+ * fractions. Only if that overflows are the terms promoted to limbs (which
+ * are retrieved from the fraction manager).
+ *
+ * Just like 64 bits fractions, these are always kept on their lowest terms.
+ * Multiplications cancel each numerator with the other denominator before
+ * multiplying, and sums reduce their results by the gcd between the sum and
+ * the gcd of both denominators (Knuth's method), so the gcd of big numbers is
+ * only ever calculated on (hopefully) small numbers.
+ *
+ * @file src/fractionBig.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/bignum.h>
+#include <fraction_internal/fraction64.h>
+#include <fraction_internal/manager.h>
+#include <fraction_internal/pool.h>
+#include <fraction_internal/stats.h>
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Store a result on a fraction, moving the sign to the numerator
+ *
+ * NOTE: The fraction takes ownership of both numbers
+ *
+ * @param  [out]pOut The fraction
+ * @param  [ in]pNum The result's numerator
+ * @param  [ in]pDen The result's denominator
+ * @return           0 on success, 1 on failure
+ */
+static int fractionBig_store(fractionBig *pOut, bignum *pNum, bignum *pDen) {
+    fractionManager *pMng;
+
+    pMng = pOut->pManager;
+
+    if (bignum_sign(pNum) == 0) {
+        bignum_clean(pMng, pDen);
+        bignum_init(pDen, 1);
+    }
+    else if (bignum_sign(pDen) < 0) {
+        if (bignum_negate(pMng, pNum) != 0 || bignum_negate(pMng, pDen) != 0) {
+            return 1;
+        }
+    }
+
+    bignum_clean(pMng, &(pOut->numerator));
+    bignum_clean(pMng, &(pOut->denominator));
+    pOut->numerator = *pNum;
+    pOut->denominator = *pDen;
+    bignum_init(pNum, 0);
+    bignum_init(pDen, 0);
+
+    return 0;
+}
+
+/**
+ * Multiply two fractions, given by their terms
+ *
+ * NOTE: Either denominator may be negative, so this also divides fractions
+ *
+ * @param  [out]pOut  The operation's result
+ * @param  [ in]pNumA The first fraction's numerator
+ * @param  [ in]pDenA The first fraction's denominator
+ * @param  [ in]pNumB The second fraction's numerator
+ * @param  [ in]pDenB The second fraction's denominator
+ * @return            0 on success, 1 on failure or division by zero
+ */
+static int fractionBig_mulTerms(fractionBig *pOut, const bignum *pNumA,
+        const bignum *pDenA, const bignum *pNumB, const bignum *pDenB) {
+    fractionManager *pMng;
+    bignum den, divAB, divBA, num, tmp;
+    int irv;
+
+    pMng = pOut->pManager;
+
+    if (bignum_sign(pDenA) == 0 || bignum_sign(pDenB) == 0) {
+        return 1;
+    }
+
+    /* Fast path: every term is inline, and so is the result */
+    if (!pNumA->pLimbs && !pDenA->pLimbs && !pNumB->pLimbs &&
+            !pDenB->pLimbs) {
+        int64_t resNum, resDen;
+
+        irv = fraction64_mulTerms(&resNum, &resDen, pNumA->small,
+                pDenA->small, pNumB->small, pDenB->small);
+        if (irv == 0) {
+            bignum_clean(pMng, &(pOut->numerator));
+            bignum_clean(pMng, &(pOut->denominator));
+            pOut->numerator.small = resNum;
+            pOut->denominator.small = resDen;
+            return 0;
+        }
+    }
+
+    bignum_init(&den, 0);
+    bignum_init(&divAB, 0);
+    bignum_init(&divBA, 0);
+    bignum_init(&num, 0);
+    bignum_init(&tmp, 0);
+
+    /* Cancel the factors common to each numerator and the other
+     * denominator, so the products are already on their lowest terms */
+    irv = bignum_gcd(pMng, &divAB, pNumA, pDenB);
+    irv = irv || bignum_gcd(pMng, &divBA, pNumB, pDenA);
+
+    irv = irv || bignum_divmod(pMng, &num, 0, pNumA, &divAB);
+    irv = irv || bignum_divmod(pMng, &tmp, 0, pNumB, &divBA);
+    irv = irv || bignum_mul(pMng, &num, &num, &tmp);
+
+    irv = irv || bignum_divmod(pMng, &den, 0, pDenA, &divBA);
+    irv = irv || bignum_divmod(pMng, &tmp, 0, pDenB, &divAB);
+    irv = irv || bignum_mul(pMng, &den, &den, &tmp);
+
+    irv = irv || fractionBig_store(pOut, &num, &den);
+
+    bignum_clean(pMng, &den);
+    bignum_clean(pMng, &divAB);
+    bignum_clean(pMng, &divBA);
+    bignum_clean(pMng, &num);
+    bignum_clean(pMng, &tmp);
+
+    return irv;
+}
+
+/**
+ * Add (or subtract) two fractions
+ *
+ * @param  [out]pOut  The operation's result
+ * @param  [ in]pA    The first fraction
+ * @param  [ in]pB    The second fraction
+ * @param  [ in]isSub Whether pB should be subtracted from pA
+ * @return            0 on success, 1 on failure
+ */
+static int fractionBig_addTerms(fractionBig *pOut, fractionBig *pA,
+        fractionBig *pB, int isSub) {
+    fractionManager *pMng;
+    bignum den, div, divSum, mulA, mulB, num, tmp;
+    int irv;
+
+    pMng = pOut->pManager;
+
+    /* Fast path: every term is inline, and so is the result */
+    if (!pA->numerator.pLimbs && !pA->denominator.pLimbs &&
+            !pB->numerator.pLimbs && !pB->denominator.pLimbs) {
+        int64_t resNum, resDen;
+
+        irv = fraction64_addTerms(&resNum, &resDen, pA->numerator.small,
+                pA->denominator.small, pB->numerator.small,
+                pB->denominator.small, isSub);
+        if (irv == 0) {
+            bignum_clean(pMng, &(pOut->numerator));
+            bignum_clean(pMng, &(pOut->denominator));
+            pOut->numerator.small = resNum;
+            pOut->denominator.small = resDen;
+            return 0;
+        }
+    }
+
+    bignum_init(&den, 0);
+    bignum_init(&div, 0);
+    bignum_init(&divSum, 0);
+    bignum_init(&mulA, 0);
+    bignum_init(&mulB, 0);
+    bignum_init(&num, 0);
+    bignum_init(&tmp, 0);
+
+    /* Cross multiply by whatever is missing from each denominator */
+    irv = bignum_gcd(pMng, &div, &(pA->denominator), &(pB->denominator));
+    irv = irv || bignum_divmod(pMng, &mulA, 0, &(pB->denominator), &div);
+    irv = irv || bignum_divmod(pMng, &mulB, 0, &(pA->denominator), &div);
+
+    irv = irv || bignum_mul(pMng, &num, &(pA->numerator), &mulA);
+    irv = irv || bignum_mul(pMng, &tmp, &(pB->numerator), &mulB);
+    if (isSub) {
+        irv = irv || bignum_sub(pMng, &num, &num, &tmp);
+    }
+    else {
+        irv = irv || bignum_add(pMng, &num, &num, &tmp);
+    }
+
+    /* gcd(num, den) == gcd(num, div), so only that has to be removed */
+    if (!irv && bignum_sign(&num) != 0) {
+        irv = bignum_gcd(pMng, &divSum, &num, &div);
+        irv = irv || bignum_divmod(pMng, &num, 0, &num, &divSum);
+        irv = irv || bignum_divmod(pMng, &den, 0, &(pB->denominator),
+                &divSum);
+        irv = irv || bignum_mul(pMng, &den, &den, &mulB);
+    }
+
+    irv = irv || fractionBig_store(pOut, &num, &den);
+
+    bignum_clean(pMng, &den);
+    bignum_clean(pMng, &div);
+    bignum_clean(pMng, &divSum);
+    bignum_clean(pMng, &mulA);
+    bignum_clean(pMng, &mulB);
+    bignum_clean(pMng, &num);
+    bignum_clean(pMng, &tmp);
+
+    return irv;
+}
+
+/**
+ * Initializes a big fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFractionBig(fractionBig **ppOut, fractionManager *pMng,
+        int64_t numerator, int64_t denominator) {
+    fractionBig *pFrac;
+    bignum num, den, one;
+    int irv;
+
+    if (denominator == 0) {
+        return 1;
+    }
+
+    /* Retrieve a unused referece */
+    irv = pool_getObject((void**)&pFrac, &(pMng->fractionsBig));
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Initialize it */
+    pFrac->pManager = pMng;
+    bignum_init(&(pFrac->numerator), 0);
+    bignum_init(&(pFrac->denominator), 1);
+
+    bignum_init(&num, numerator);
+    bignum_init(&den, denominator);
+    bignum_init(&one, 1);
+    irv = fractionBig_mulTerms(pFrac, &num, &one, &one, &den);
+    if (irv != 0) {
+        fractionManager_releaseFractionBig(pFrac);
+        return 1;
+    }
+
+    *ppOut = pFrac;
+    return 0;
+}
+
+/**
+ * Initializes a big fraction from an integer number
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_igetFractionBig(fractionBig **ppOut,
+        fractionManager *pMng, int64_t val) {
+    return fractionManager_getFractionBig(ppOut, pMng, val, 1);
+}
+
+/**
+ * Initializes a big fraction with the value of a regular fraction
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_widenFractionBig(fractionBig **ppOut, fraction *pSrc) {
+    return fractionManager_getFractionBig(ppOut, pSrc->pManager,
+            pSrc->value.numerator, pSrc->value.denominator);
+}
+
+/**
+ * Releases a big fraction (and its limbs) to the fraction manager
+ *
+ * @param  [ in]pFrac The number to be released
+ */
+void fractionManager_releaseFractionBig(fractionBig *pFrac) {
+    fractionManager *pMng;
+
+    pMng = pFrac->pManager;
+    bignum_clean(pMng, &(pFrac->numerator));
+    bignum_clean(pMng, &(pFrac->denominator));
+    pool_releaseObject(&(pMng->fractionsBig), pFrac);
+}
+
+/**
+ * Clones a big fraction number into a newly alloc'ed one
+ *
+ * @param  [out]ppOut The cloned fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_cloneBig(fractionBig **ppOut, fractionBig *pSrc) {
+    fractionManager *pMng;
+    fractionBig *pFrac;
+    int irv;
+
+    pMng = pSrc->pManager;
+
+    /* Retrieve a unused referece */
+    irv = pool_getObject((void**)&pFrac, &(pMng->fractionsBig));
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Initialize it */
+    pFrac->pManager = pMng;
+    bignum_init(&(pFrac->numerator), 0);
+    bignum_init(&(pFrac->denominator), 1);
+    irv = bignum_copy(pMng, &(pFrac->numerator), &(pSrc->numerator));
+    irv = irv || bignum_copy(pMng, &(pFrac->denominator),
+            &(pSrc->denominator));
+    if (irv != 0) {
+        fractionManager_releaseFractionBig(pFrac);
+        return 1;
+    }
+
+    *ppOut = pFrac;
+    return 0;
+}
+
+/**
+ * Adds two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on failure
+ */
+int fractionBig_sum(fractionBig *pOut, fractionBig *pA, fractionBig *pB) {
+    STATS_INC(pOut->pManager->opsFractionBig);
+    return fractionBig_addTerms(pOut, pA, pB, 0/*isSub*/);
+}
+
+/**
+ * Subtracts two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on failure
+ */
+int fractionBig_sub(fractionBig *pOut, fractionBig *pA, fractionBig *pB) {
+    STATS_INC(pOut->pManager->opsFractionBig);
+    return fractionBig_addTerms(pOut, pA, pB, 1/*isSub*/);
+}
+
+/**
+ * Multiplies two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factors
+ * @return           0 on success, 1 on failure
+ */
+int fractionBig_mul(fractionBig *pOut, fractionBig *pA, fractionBig *pB) {
+    STATS_INC(pOut->pManager->opsFractionBig);
+    return fractionBig_mulTerms(pOut, &(pA->numerator), &(pA->denominator),
+            &(pB->numerator), &(pB->denominator));
+}
+
+/**
+ * Divides two big fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   The dividend
+ * @param  [ in]pB   The divisor
+ * @return           0 on success, 1 on failure or division by zero
+ */
+int fractionBig_div(fractionBig *pOut, fractionBig *pA, fractionBig *pB) {
+    STATS_INC(pOut->pManager->opsFractionBig);
+    return fractionBig_mulTerms(pOut, &(pA->numerator), &(pA->denominator),
+            &(pB->denominator), &(pB->numerator));
+}
+
+/**
+ * Converts a big fractional number to a 64 bits one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The big fraction
+ * @return            0 on success, 1 if it doesn't fit into 64 bits
+ */
+int fractionBig_narrow(fraction64 *pOut, fractionBig *pFrac) {
+    if (pFrac->numerator.pLimbs || pFrac->denominator.pLimbs) {
+        return 1;
+    }
+
+    pOut->numerator = pFrac->numerator.small;
+    pOut->denominator = pFrac->denominator.small;
+
+    return 0;
+}
+
+/**
+ * Converts a big fractional number to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 if the quotient doesn't fit into 64 bits
+ */
+int fractionBig_iconvert(int64_t *pOut, fractionBig *pFrac) {
+    bignum quot;
+    int irv;
+
+    bignum_init(&quot, 0);
+    irv = bignum_divmod(pFrac->pManager, &quot, 0, &(pFrac->numerator),
+            &(pFrac->denominator));
+    if (irv == 0 && quot.pLimbs) {
+        irv = 1;
+    }
+    else if (irv == 0) {
+        *pOut = quot.small;
+    }
+    bignum_clean(pFrac->pManager, &quot);
+
+    return irv;
+}
+
+/**
+ * Converts a big fractional number to a double
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fractionBig_dconvert(double *pOut, fractionBig *pFrac) {
+    double num, den;
+    int expNum, expDen;
+
+    num = bignum_toDouble(&expNum, &(pFrac->numerator));
+    den = bignum_toDouble(&expDen, &(pFrac->denominator));
+
+    *pOut = ldexp(num / den, expNum - expDen);
+}
+
@@ -0,0 +1,799 @@
+/**
+ * Defines fractional numbers stored as lists of prime factors
+ *
+ * Every prime that divides either term is stored along its exponent, which
+ * is positive for the numerator and negative for the denominator. Since both
+ * terms are factored together, common factors cancel out as soon as they are
+ * added, so these are always on their lowest terms. Multiplications and
+ * divisions merge both (sorted) lists, adding or subtracting exponents, so
+ * they never need a GCD and never overflow (as long as the exponents fit into
+ * an int).
+ *
+ * Sums, however, can't be done on the factors. Those convert both fractions
+ * to their 64 bits terms and store the result as regular terms, which is
+ * only factored again when it's multiplied or divided by something (and if
+ * its terms fit into 32 bits, so they may be factored by the manager).
+ *
+ * @file src/fractionFactored.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/fraction64.h>
+#include <fraction_internal/manager.h>
+#include <fraction_internal/pool.h>
+#include <fraction_internal/spf.h>
+#include <fraction_internal/stats.h>
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Return a list of factors to the manager
+ *
+ * @param  [ in]pMng  The fraction manager
+ * @param  [ in]pList The list of factors
+ * @param  [ in]cap   How many pairs were alloc'ed
+ */
+static void fractionFactored_freeList(fractionManager *pMng,
+        factorPair *pList, int cap) {
+    int i;
+
+    i = 0;
+    while ((FACTORED_MIN_PAIRS << i) < cap) {
+        i++;
+    }
+    pool_releaseObject(&(pMng->factors[i]), pList);
+}
+
+/**
+ * Make sure a list of factors has, at least, the requested number of entries
+ *
+ * Lists are retrieved from the manager (so they are released along it), by
+ * size. The list's previous contents are discarded.
+ *
+ * @param  [ in]ppList The list of factors
+ * @param  [ in]pCap   Number of alloc'ed entries on the list
+ * @param  [ in]pMng   The fraction manager
+ * @param  [ in]len    Number of required entries
+ * @return             0 on success, 1 on failure
+ */
+static int fractionFactored_reserve(factorPair **ppList, int *pCap,
+        fractionManager *pMng, int len) {
+    factorPair *pTmp;
+    pool *pPool;
+    int cap, i;
+
+    if (len <= *pCap) {
+        return 0;
+    }
+
+    /* Find the smallest size that fits the requested number of pairs */
+    cap = FACTORED_MIN_PAIRS;
+    i = 0;
+    while (cap < len) {
+        cap <<= 1;
+        i++;
+    }
+    if (i >= FACTORED_NUM_CLASSES) {
+        return 1;
+    }
+
+    /* Each pool is only initialized when it's first used (just like the
+     * limbs of big numbers) */
+    pPool = &(pMng->factors[i]);
+    if (!pool_isReady(pPool)) {
+        int irv, num;
+
+        num = 16384 / (cap * sizeof(factorPair));
+        if (num < 1) {
+            num = 1;
+        }
+
+        irv = 0;
+        if (pMng->isConcurrent) {
+            pthread_mutex_lock(&(pMng->lock));
+        }
+        if (!pool_isReady(pPool)) {
+            irv = pool_init(pPool, cap * sizeof(factorPair), num,
+                    pMng->isConcurrent);
+        }
+        if (pMng->isConcurrent) {
+            pthread_mutex_unlock(&(pMng->lock));
+        }
+        if (irv != 0) {
+            return 1;
+        }
+    }
+
+    if (pool_getObject((void**)&pTmp, pPool) != 0) {
+        return 1;
+    }
+    if (*ppList) {
+        fractionFactored_freeList(pMng, *ppList, *pCap);
+    }
+    *ppList = pTmp;
+    *pCap = cap;
+
+    return 0;
+}
+
+/**
+ * Swap a fraction's list of factors with the (just written) spare list
+ *
+ * @param  [ in]pFrac      The fraction
+ * @param  [ in]numFactors Number of factors on the spare list
+ * @param  [ in]isNegative Whether the fraction is negative
+ */
+static void fractionFactored_swap(fractionFactored *pFrac, int numFactors,
+        int isNegative) {
+    factorPair *pTmp;
+    int cap;
+
+    pTmp = pFrac->pFactors;
+    pFrac->pFactors = pFrac->pSpare;
+    pFrac->pSpare = pTmp;
+
+    cap = pFrac->capFactors;
+    pFrac->capFactors = pFrac->capSpare;
+    pFrac->capSpare = cap;
+
+    pFrac->numFactors = numFactors;
+    pFrac->isNegative = isNegative;
+    pFrac->isFactored = 1;
+}
+
+/**
+ * Store a fraction as regular terms
+ *
+ * @param  [ in]pFrac The fraction
+ * @param  [ in]num   Its numerator
+ * @param  [ in]den   Its (positive) denominator, on lowest terms with num
+ */
+static void fractionFactored_setTerms(fractionFactored *pFrac, int64_t num,
+        int64_t den) {
+    pFrac->numerator = num;
+    pFrac->denominator = den;
+    pFrac->numFactors = 0;
+    pFrac->isNegative = 0;
+    pFrac->isFactored = 0;
+}
+
+/**
+ * Factor both terms of a fraction and store the result on the fraction
+ *
+ * @param  [ in]pFrac      The fraction
+ * @param  [ in]num        The numerator's magnitude (which musn't be zero)
+ * @param  [ in]den        The denominator's magnitude (which musn't be zero)
+ * @param  [ in]isNegative Whether the fraction is negative
+ * @return                 0 on success, 1 on failure
+ */
+static int fractionFactored_factorTerms(fractionFactored *pFrac, uint32_t num,
+        uint32_t den, int isNegative) {
+    int pNumFactors[FRACTION_MAX_FACTORS], pNumExps[FRACTION_MAX_FACTORS];
+    int pDenFactors[FRACTION_MAX_FACTORS], pDenExps[FRACTION_MAX_FACTORS];
+    fractionManager *pMng;
+    spfTable *pTable;
+    factorPair *pDst;
+    int i, irv, j, len, lenDen, lenNum;
+
+    pMng = pFrac->pManager;
+    pTable = 0;
+    if (pMng->spf.pEntries) {
+        pTable = &(pMng->spf);
+    }
+
+    irv = spf_factor(pNumFactors, pNumExps, &lenNum, pTable, &(pMng->primes),
+            num);
+    irv = irv || spf_factor(pDenFactors, pDenExps, &lenDen, pTable,
+            &(pMng->primes), den);
+    irv = irv || fractionFactored_reserve(&(pFrac->pSpare),
+            &(pFrac->capSpare), pMng, lenNum + lenDen);
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Merge both lists, cancelling the primes common to both terms */
+    pDst = pFrac->pSpare;
+    i = 0;
+    j = 0;
+    len = 0;
+    while (i < lenNum || j < lenDen) {
+        if (j == lenDen || (i < lenNum && pNumFactors[i] < pDenFactors[j])) {
+            pDst[len].prime = pNumFactors[i];
+            pDst[len].exponent = pNumExps[i];
+            i++;
+        }
+        else if (i == lenNum || pDenFactors[j] < pNumFactors[i]) {
+            pDst[len].prime = pDenFactors[j];
+            pDst[len].exponent = -pDenExps[j];
+            j++;
+        }
+        else {
+            pDst[len].prime = pNumFactors[i];
+            pDst[len].exponent = pNumExps[i] - pDenExps[j];
+            i++;
+            j++;
+        }
+
+        if (pDst[len].exponent != 0) {
+            len++;
+        }
+    }
+
+    fractionFactored_swap(pFrac, len, isNegative);
+    return 0;
+}
+
+/**
+ * Factor a fraction stored as regular terms, if they fit into 32 bits
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 if it couldn't be factored (in which
+ *                    case the fraction is left untouched)
+ */
+static int fractionFactored_refactor(fractionFactored *pFrac) {
+    int64_t num;
+    int isNegative;
+
+    if (pFrac->isFactored) {
+        return 0;
+    }
+
+    num = pFrac->numerator;
+    isNegative = (num < 0);
+    if (isNegative) {
+        num = -num;
+    }
+    if (num == 0 || num > UINT32_MAX || pFrac->denominator > UINT32_MAX) {
+        return 1;
+    }
+
+    return fractionFactored_factorTerms(pFrac, (uint32_t)num,
+            (uint32_t)pFrac->denominator, isNegative);
+}
+
+/**
+ * Retrieve whether a fraction is zero (which is never factored)
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            1 if it's zero, 0 otherwise
+ */
+static int fractionFactored_isZero(fractionFactored *pFrac) {
+    return !pFrac->isFactored && pFrac->numerator == 0;
+}
+
+/**
+ * Retrieve both terms of a fraction, if they fit into 64 bits
+ *
+ * @param  [out]pNum  The fraction's numerator
+ * @param  [out]pDen  The fraction's (positive) denominator
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 on overflow
+ */
+static int fractionFactored_toTerms(int64_t *pNum, int64_t *pDen,
+        fractionFactored *pFrac) {
+    uint64_t num, den;
+    int i;
+
+    if (!pFrac->isFactored) {
+        *pNum = pFrac->numerator;
+        *pDen = pFrac->denominator;
+        return 0;
+    }
+
+    num = 1;
+    den = 1;
+    i = 0;
+    while (i < pFrac->numFactors) {
+        uint64_t *pTerm;
+        int exp;
+
+        exp = pFrac->pFactors[i].exponent;
+        pTerm = &num;
+        if (exp < 0) {
+            pTerm = &den;
+            exp = -exp;
+        }
+
+        /* Every prime is at least 2, so this overflows in at most 64
+         * iterations */
+        while (exp > 0) {
+            if (__builtin_mul_overflow(*pTerm,
+                    (uint64_t)pFrac->pFactors[i].prime, pTerm)) {
+                return 1;
+            }
+            exp--;
+        }
+        i++;
+    }
+
+    if (num > (uint64_t)INT64_MAX || den > (uint64_t)INT64_MAX) {
+        return 1;
+    }
+
+    *pNum = (int64_t)num;
+    if (pFrac->isNegative) {
+        *pNum = -(*pNum);
+    }
+    *pDen = (int64_t)den;
+
+    return 0;
+}
+
+/**
+ * Initializes a factored fraction from its numerator and denominator
+ *
+ * @param  [out]ppOut       The alloc'ed/initialized fraction
+ * @param  [ in]pMng        The fraction manager (so all references are kept)
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure (or if the denominator
+ *                          is zero)
+ */
+int fractionManager_getFractionFactored(fractionFactored **ppOut,
+        fractionManager *pMng, int numerator, int denominator) {
+    fractionFactored *pFrac;
+    uint32_t den, num;
+    int irv;
+
+    if (denominator == 0) {
+        return 1;
+    }
+
+    /* Retrieve a unused referece */
+    irv = pool_getObject((void**)&pFrac, &(pMng->fractionsFactored));
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Initialize it */
+    pFrac->pManager = pMng;
+    pFrac->pFactors = 0;
+    pFrac->pSpare = 0;
+    pFrac->capFactors = 0;
+    pFrac->capSpare = 0;
+    fractionFactored_setTerms(pFrac, 0, 1);
+
+    if (numerator != 0) {
+        /* Work on the magnitudes, so INT_MIN is handled correctly */
+        num = (uint32_t)numerator;
+        if (numerator < 0) {
+            num = 0u - num;
+        }
+        den = (uint32_t)denominator;
+        if (denominator < 0) {
+            den = 0u - den;
+        }
+
+        irv = fractionFactored_factorTerms(pFrac, num, den,
+                (numerator < 0) ^ (denominator < 0));
+        if (irv != 0) {
+            fractionManager_releaseFractionFactored(pFrac);
+            return 1;
+        }
+    }
+
+    *ppOut = pFrac;
+    return 0;
+}
+
+/**
+ * Initializes a factored fraction from an integer number
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pMng  The fraction manager (so all references are kept)
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_igetFractionFactored(fractionFactored **ppOut,
+        fractionManager *pMng, int val) {
+    return fractionManager_getFractionFactored(ppOut, pMng, val, 1);
+}
+
+/**
+ * Initializes a factored fraction with the value of a regular fraction
+ *
+ * @param  [out]ppOut The alloc'ed/initialized fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_factorFraction(fractionFactored **ppOut, fraction *pSrc) {
+    return fractionManager_getFractionFactored(ppOut, pSrc->pManager,
+            pSrc->value.numerator, pSrc->value.denominator);
+}
+
+/**
+ * Releases a factored fraction (and its list of factors) to the fraction
+ * manager
+ *
+ * @param  [ in]pFrac The number to be released
+ */
+void fractionManager_releaseFractionFactored(fractionFactored *pFrac) {
+    if (pFrac->pFactors) {
+        fractionFactored_freeList(pFrac->pManager, pFrac->pFactors,
+                pFrac->capFactors);
+    }
+    if (pFrac->pSpare) {
+        fractionFactored_freeList(pFrac->pManager, pFrac->pSpare,
+                pFrac->capSpare);
+    }
+    pFrac->pFactors = 0;
+    pFrac->pSpare = 0;
+    pool_releaseObject(&(pFrac->pManager->fractionsFactored), pFrac);
+}
+
+/**
+ * Clones a factored fraction number into a newly alloc'ed one
+ *
+ * @param  [out]ppOut The cloned fraction
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionManager_cloneFactored(fractionFactored **ppOut,
+        fractionFactored *pSrc) {
+    fractionFactored *pFrac;
+    int i, irv;
+
+    irv = fractionManager_igetFractionFactored(&pFrac, pSrc->pManager, 0);
+    if (irv != 0) {
+        return 1;
+    }
+
+    if (pSrc->isFactored) {
+        irv = fractionFactored_reserve(&(pFrac->pSpare), &(pFrac->capSpare),
+                pFrac->pManager, pSrc->numFactors);
+        if (irv != 0) {
+            fractionManager_releaseFractionFactored(pFrac);
+            return 1;
+        }
+
+        i = 0;
+        while (i < pSrc->numFactors) {
+            pFrac->pSpare[i] = pSrc->pFactors[i];
+            i++;
+        }
+        fractionFactored_swap(pFrac, pSrc->numFactors, pSrc->isNegative);
+    }
+    else {
+        fractionFactored_setTerms(pFrac, pSrc->numerator, pSrc->denominator);
+    }
+
+    *ppOut = pFrac;
+    return 0;
+}
+
+/**
+ * Add (or subtract) two factored fractions, storing the result as regular
+ * terms
+ *
+ * @param  [out]pOut  The operation's result
+ * @param  [ in]pA    The first fraction
+ * @param  [ in]pB    The second fraction
+ * @param  [ in]isSub Whether pB should be subtracted from pA
+ * @return            0 on success, 1 on overflow
+ */
+static int fractionFactored_addTerms(fractionFactored *pOut,
+        fractionFactored *pA, fractionFactored *pB, int isSub) {
+    int64_t denA, denB, num, numA, numB, den;
+    int irv;
+
+    irv = fractionFactored_toTerms(&numA, &denA, pA);
+    irv = irv || fractionFactored_toTerms(&numB, &denB, pB);
+    irv = irv || fraction64_addTerms(&num, &den, numA, denA, numB, denB,
+            isSub);
+    if (irv != 0) {
+        return 1;
+    }
+
+    fractionFactored_setTerms(pOut, num, den);
+    return 0;
+}
+
+/**
+ * Multiply (or divide) two factored fractions
+ *
+ * If both fractions are factored (or may be factored), their lists are
+ * merged. Otherwise, the operation is done on their 64 bits terms
+ *
+ * @param  [out]pOut  The operation's result
+ * @param  [ in]pA    The first fraction
+ * @param  [ in]pB    The second fraction
+ * @param  [ in]isDiv Whether pA should be divided by pB
+ * @return            0 on success, 1 on failure or division by zero
+ */
+static int fractionFactored_mulTerms(fractionFactored *pOut,
+        fractionFactored *pA, fractionFactored *pB, int isDiv) {
+    factorPair *pDst, *pListA, *pListB;
+    int i, irv, j, len, lenA, lenB;
+
+    if (isDiv && fractionFactored_isZero(pB)) {
+        return 1;
+    }
+    else if (fractionFactored_isZero(pA) || fractionFactored_isZero(pB)) {
+        fractionFactored_setTerms(pOut, 0, 1);
+        return 0;
+    }
+
+    /* Results of sums are only factored when they are used again */
+    fractionFactored_refactor(pA);
+    fractionFactored_refactor(pB);
+    if (!pA->isFactored || !pB->isFactored) {
+        int64_t denA, denB, num, numA, numB, den;
+
+        irv = fractionFactored_toTerms(&numA, &denA, pA);
+        irv = irv || fractionFactored_toTerms(&numB, &denB, pB);
+        if (irv == 0 && isDiv) {
+            irv = fraction64_mulTerms(&num, &den, numA, denA, denB, numB);
+        }
+        else if (irv == 0) {
+            irv = fraction64_mulTerms(&num, &den, numA, denA, numB, denB);
+        }
+        if (irv != 0) {
+            return 1;
+        }
+
+        fractionFactored_setTerms(pOut, num, den);
+        return 0;
+    }
+
+    /* Merge both lists into the spare one (which is never an input) */
+    lenA = pA->numFactors;
+    lenB = pB->numFactors;
+    irv = fractionFactored_reserve(&(pOut->pSpare), &(pOut->capSpare),
+            pOut->pManager, lenA + lenB);
+    if (irv != 0) {
+        return 1;
+    }
+
+    pDst = pOut->pSpare;
+    pListA = pA->pFactors;
+    pListB = pB->pFactors;
+    i = 0;
+    j = 0;
+    len = 0;
+    while (i < lenA || j < lenB) {
+        int expB;
+
+        if (j == lenB || (i < lenA && pListA[i].prime < pListB[j].prime)) {
+            pDst[len] = pListA[i];
+            i++;
+        }
+        else if (i == lenA || pListB[j].prime < pListA[i].prime) {
+            expB = isDiv ? -pListB[j].exponent : pListB[j].exponent;
+            pDst[len].prime = pListB[j].prime;
+            pDst[len].exponent = expB;
+            j++;
+        }
+        else {
+            expB = isDiv ? -pListB[j].exponent : pListB[j].exponent;
+            pDst[len].prime = pListA[i].prime;
+            /* INT_MIN is also rejected, so exponents may always be negated */
+            if (__builtin_add_overflow(pListA[i].exponent, expB,
+                    &(pDst[len].exponent)) || pDst[len].exponent == INT_MIN) {
+                return 1;
+            }
+            i++;
+            j++;
+        }
+
+        if (pDst[len].exponent != 0) {
+            len++;
+        }
+    }
+
+    fractionFactored_swap(pOut, len, pA->isNegative ^ pB->isNegative);
+    return 0;
+}
+
+/**
+ * Adds two factored fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on failure
+ */
+int fractionFactored_sum(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB) {
+    STATS_INC(pOut->pManager->opsFractionFactored);
+    return fractionFactored_addTerms(pOut, pA, pB, 0/*isSub*/);
+}
+
+/**
+ * Subtracts two factored fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on failure
+ */
+int fractionFactored_sub(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB) {
+    STATS_INC(pOut->pManager->opsFractionFactored);
+    return fractionFactored_addTerms(pOut, pA, pB, 1/*isSub*/);
+}
+
+/**
+ * Multiplies two factored fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factors
+ * @return           0 on success, 1 on failure
+ */
+int fractionFactored_mul(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB) {
+    STATS_INC(pOut->pManager->opsFractionFactored);
+    return fractionFactored_mulTerms(pOut, pA, pB, 0/*isDiv*/);
+}
+
+/**
+ * Divides two factored fractional numbers
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [out]pOut The operation's result
+ * @param  [ in]pA   The dividend
+ * @param  [ in]pB   The divisor
+ * @return           0 on success, 1 on failure or division by zero
+ */
+int fractionFactored_div(fractionFactored *pOut, fractionFactored *pA,
+        fractionFactored *pB) {
+    STATS_INC(pOut->pManager->opsFractionFactored);
+    return fractionFactored_mulTerms(pOut, pA, pB, 1/*isDiv*/);
+}
+
+/**
+ * Retrieve whether a factored fraction is currently stored as its list of
+ * prime factors (instead of as regular terms)
+ *
+ * @param  [ in]pFrac The fraction
+ * @return            1 if it's stored as prime factors, 0 otherwise
+ */
+int fractionFactored_isFactored(fractionFactored *pFrac) {
+    return pFrac->isFactored;
+}
+
+/**
+ * Converts a factored fractional number to a regular one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The factored fraction
+ * @return            0 on success, 1 if it doesn't fit into a regular fraction
+ */
+int fractionFactored_narrow(fraction *pOut, fractionFactored *pFrac) {
+    int64_t den, num;
+
+    if (fractionFactored_toTerms(&num, &den, pFrac) != 0) {
+        return 1;
+    }
+    if (num < INT32_MIN || num > INT32_MAX || den > INT32_MAX) {
+        return 1;
+    }
+
+    pOut->value.numerator = (int)num;
+    pOut->value.denominator = (int)den;
+    pOut->isSimplified = 1;
+
+    return 0;
+}
+
+/**
+ * Converts a factored fractional number to a 64 bits one
+ *
+ * @param  [out]pOut  The converted fraction (untouched on overflow)
+ * @param  [ in]pFrac The factored fraction
+ * @return            0 on success, 1 if it doesn't fit into 64 bits
+ */
+int fractionFactored_narrow64(fraction64 *pOut, fractionFactored *pFrac) {
+    int64_t den, num;
+
+    if (fractionFactored_toTerms(&num, &den, pFrac) != 0) {
+        return 1;
+    }
+
+    pOut->numerator = num;
+    pOut->denominator = den;
+
+    return 0;
+}
+
+/**
+ * Converts a factored fractional number to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ * @return            0 on success, 1 if its terms don't fit into 64 bits
+ */
+int fractionFactored_iconvert(int64_t *pOut, fractionFactored *pFrac) {
+    int64_t den, num;
+
+    if (fractionFactored_toTerms(&num, &den, pFrac) != 0) {
+        return 1;
+    }
+
+    *pOut = num / den;
+    return 0;
+}
+
+/**
+ * Converts a factored fractional number to a double
+ *
+ * Each prime power is calculated as mantissa * 2^exponent, so huge (or tiny)
+ * intermediate values don't overflow
+ *
+ * @param  [out]pOut  The converted fraction
+ * @param  [ in]pFrac The fraction
+ */
+void fractionFactored_dconvert(double *pOut, fractionFactored *pFrac) {
+    int64_t exp2;
+    double val;
+    int i, tmp;
+
+    if (!pFrac->isFactored) {
+        *pOut = pFrac->numerator / (double)pFrac->denominator;
+        return;
+    }
+
+    val = 1.0;
+    exp2 = 0;
+    i = 0;
+    while (i < pFrac->numFactors) {
+        double base, pow;
+        int64_t baseExp, powExp;
+        int exp;
+
+        base = frexp((double)pFrac->pFactors[i].prime, &tmp);
+        baseExp = tmp;
+        pow = 1.0;
+        powExp = 0;
+        exp = pFrac->pFactors[i].exponent;
+        if (exp < 0) {
+            exp = -exp;
+        }
+
+        /* Exponentiation by squaring, keeping every value normalized */
+        while (exp > 0) {
+            if (exp & 1) {
+                pow = frexp(pow * base, &tmp);
+                powExp += baseExp + tmp;
+            }
+            base = frexp(base * base, &tmp);
+            baseExp = baseExp * 2 + tmp;
+            exp >>= 1;
+        }
+
+        if (pFrac->pFactors[i].exponent < 0) {
+            val = frexp(val / pow, &tmp);
+            exp2 -= powExp;
+        }
+        else {
+            val = frexp(val * pow, &tmp);
+            exp2 += powExp;
+        }
+        exp2 += tmp;
+        i++;
+    }
+
+    /* Anything this far out of range is either infinity or zero anyway */
+    if (exp2 > 4096) {
+        exp2 = 4096;
+    }
+    else if (exp2 < -4096) {
+        exp2 = -4096;
+    }
+    if (pFrac->isNegative) {
+        val = -val;
+    }
+
+    *pOut = ldexp(val, (int)exp2);
+}
+
@@ -0,0 +1,459 @@
+/**
+ * Stores fractional numbers as two contiguous arrays, one for numerators and
+ * another for denominators, instead of as individual objects
+ *
+ * Each fraction is referenced by a 32 bits handle, which is simply its index
+ * on both arrays. Therefore, a fraction takes only 8 bytes and both arrays
+ * may be directly used by code that processes many fractions at once. Since
+ * handles are indexes, they stay valid even when the arrays are expanded.
+ *
+ * Released handles are kept on a stack, so they may be recycled later. Just
+ * like regular fractions, every result is stored on its lowest terms.
+ *
+ * @file src/fractionPool.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/gcd.h>
+#include <fraction_internal/manager.h>
+#include <fraction_internal/stats.h>
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of fractions reduced at once on bulk initializations */
+#define FRACTION_POOL_BLOCK 256
+
+/**
+ * Initializes a pool of fractions
+ *
+ * @param  [out]ppOut    The alloc'ed and initialized pool
+ * @param  [ in]pMng     The fraction manager
+ * @param  [ in]capacity How many fractions should be pre-alloc'ed
+ * @return               0 on success, 1 on failure
+ */
+int fractionPool_init(fractionPool **ppOut, fractionManager *pMng,
+        int capacity) {
+    fractionPool *pPool;
+
+#define INIT_ASSERT(val) \
+  do { \
+    if (!(val)) { \
+      fractionPool_clean(&pPool); \
+      return 1; \
+    } \
+  } while (0)
+
+    if (capacity < 16) {
+        capacity = 16;
+    }
+
+    /* Alloc the pool itself */
+    pPool = (fractionPool*)malloc(sizeof(fractionPool));
+    INIT_ASSERT(pPool);
+    memset(pPool, 0x0, sizeof(fractionPool));
+    pPool->pManager = pMng;
+
+    /* Alloc every array */
+    pPool->capacity = capacity;
+    pPool->pNumerators = (int*)malloc(sizeof(int) * capacity);
+    INIT_ASSERT(pPool->pNumerators);
+    pPool->pDenominators = (int*)malloc(sizeof(int) * capacity);
+    INIT_ASSERT(pPool->pDenominators);
+    pPool->pFreeHandles = (fractionHandle*)malloc(sizeof(fractionHandle) *
+            capacity);
+    INIT_ASSERT(pPool->pFreeHandles);
+
+#undef INIT_ASSERT
+
+    *ppOut = pPool;
+    return 0;
+}
+
+/**
+ * Releases a pool of fractions (and every fraction on it)
+ *
+ * @param  [ in]ppPool The pool to be dealloc'ed
+ */
+void fractionPool_clean(fractionPool **ppPool) {
+    fractionPool *pPool;
+
+    /* Check that the object was initialized */
+    if (!ppPool || !(*ppPool)) {
+        return;
+    }
+    pPool = *ppPool;
+
+    if (pPool->pNumerators) {
+        free(pPool->pNumerators);
+    }
+    if (pPool->pDenominators) {
+        free(pPool->pDenominators);
+    }
+    if (pPool->pFreeHandles) {
+        free(pPool->pFreeHandles);
+    }
+
+    free(pPool);
+    *ppPool = 0;
+}
+
+/**
+ * Double the capacity of every array on the pool
+ *
+ * @param  [ in]pPool The pool
+ * @return            0 on success, 1 on failure
+ */
+static int fractionPool_expand(fractionPool *pPool) {
+    fractionHandle *pHandles;
+    int *pDens, *pNums;
+    int capacity;
+
+    if (pPool->capacity > INT_MAX / 2) {
+        return 1;
+    }
+    capacity = pPool->capacity * 2;
+
+    /* Update each array as soon as it's realloc'ed, so nothing leaks if a
+     * latter one fails */
+    pNums = (int*)realloc(pPool->pNumerators, sizeof(int) * capacity);
+    if (!pNums) {
+        return 1;
+    }
+    pPool->pNumerators = pNums;
+
+    pDens = (int*)realloc(pPool->pDenominators, sizeof(int) * capacity);
+    if (!pDens) {
+        return 1;
+    }
+    pPool->pDenominators = pDens;
+
+    pHandles = (fractionHandle*)realloc(pPool->pFreeHandles,
+            sizeof(fractionHandle) * capacity);
+    if (!pHandles) {
+        return 1;
+    }
+    pPool->pFreeHandles = pHandles;
+
+    pPool->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Store the (widened) result of an operation on its lowest terms
+ *
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ * @param  [ in]num    The result's numerator
+ * @param  [ in]den    The result's denominator
+ */
+static void fractionPool_store(fractionPool *pPool, fractionHandle handle,
+        int64_t num, int64_t den) {
+    if (num >= INT_MIN && num <= INT_MAX && den >= INT_MIN &&
+            den <= INT_MAX) {
+        int num32, den32;
+
+        num32 = (int)num;
+        den32 = (int)den;
+        gcd_reduce(&num32, &den32);
+        pPool->pNumerators[handle] = num32;
+        pPool->pDenominators[handle] = den32;
+    }
+    else {
+        gcd_reduce64(&num, &den);
+        pPool->pNumerators[handle] = (int)num;
+        pPool->pDenominators[handle] = (int)den;
+    }
+}
+
+/**
+ * Initializes a fraction on the pool from its numerator and denominator
+ *
+ * @param  [out]pOut        The fraction's handle
+ * @param  [ in]pPool       The pool
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ * @return                  0 on success, 1 on failure
+ */
+int fractionPool_getFraction(fractionHandle *pOut, fractionPool *pPool,
+        int numerator, int denominator) {
+    fractionHandle handle;
+
+    /* Try to recycle a handle */
+    if (pPool->numFreeHandles > 0) {
+        pPool->numFreeHandles--;
+        handle = pPool->pFreeHandles[pPool->numFreeHandles];
+    }
+    else {
+        if (pPool->usedHandles >= pPool->capacity &&
+                fractionPool_expand(pPool) != 0) {
+            return 1;
+        }
+        handle = (fractionHandle)pPool->usedHandles;
+        pPool->usedHandles++;
+    }
+
+    /* Initialize it */
+    fractionPool_store(pPool, handle, numerator, denominator);
+
+    *pOut = handle;
+    return 0;
+}
+
+/**
+ * Initializes many fractions on the pool at once, reducing them in blocks
+ *
+ * NOTE: The handles aren't necessarily contiguous, since released ones are
+ *       recycled first
+ *
+ * @param  [out]pOut  The fractions' handles
+ * @param  [ in]pPool The pool
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions
+ * @return            0 on success, 1 on failure
+ */
+int fractionPool_getFractions(fractionHandle *pOut, fractionPool *pPool,
+        const int *pNums, const int *pDens, int len) {
+    int blockNums[FRACTION_POOL_BLOCK], blockDens[FRACTION_POOL_BLOCK];
+    int i, j, end;
+
+    /* Expand the pool beforehand, so this never fails midway */
+    while (len - pPool->numFreeHandles > pPool->capacity - pPool->usedHandles) {
+        if (fractionPool_expand(pPool) != 0) {
+            return 1;
+        }
+    }
+
+    for (i = 0; i < len; i = end) {
+        end = i + FRACTION_POOL_BLOCK;
+        if (end > len) {
+            end = len;
+        }
+
+        /* Reduce a copy of the block, since the handles may be scattered */
+        memcpy(blockNums, pNums + i, sizeof(int) * (end - i));
+        memcpy(blockDens, pDens + i, sizeof(int) * (end - i));
+        gcd_reduceBlock(blockNums, blockDens, end - i);
+
+        for (j = i; j < end; j++) {
+            fractionHandle handle;
+
+            if (pPool->numFreeHandles > 0) {
+                pPool->numFreeHandles--;
+                handle = pPool->pFreeHandles[pPool->numFreeHandles];
+            }
+            else {
+                handle = (fractionHandle)pPool->usedHandles;
+                pPool->usedHandles++;
+            }
+
+            pPool->pNumerators[handle] = blockNums[j - i];
+            pPool->pDenominators[handle] = blockDens[j - i];
+            pOut[j] = handle;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Initializes a fraction on the pool from an integer number
+ *
+ * @param  [out]pOut  The fraction's handle
+ * @param  [ in]pPool The pool
+ * @param  [ in]val   The fraction initial value
+ * @return            0 on success, 1 on failure
+ */
+int fractionPool_igetFraction(fractionHandle *pOut, fractionPool *pPool,
+        int val) {
+    return fractionPool_getFraction(pOut, pPool, val, 1);
+}
+
+/**
+ * Initializes a fraction on the pool with the value of a regular fraction
+ *
+ * @param  [out]pOut  The fraction's handle
+ * @param  [ in]pPool The pool
+ * @param  [ in]pSrc  The orignal number
+ * @return            0 on success, 1 on failure
+ */
+int fractionPool_fromFraction(fractionHandle *pOut, fractionPool *pPool,
+        fraction *pSrc) {
+    return fractionPool_getFraction(pOut, pPool, pSrc->value.numerator,
+            pSrc->value.denominator);
+}
+
+/**
+ * Releases a fraction, so its handle may be recycled
+ *
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_release(fractionPool *pPool, fractionHandle handle) {
+    /* The stack is as big as the arrays, so it never overflows */
+    pPool->pFreeHandles[pPool->numFreeHandles] = handle;
+    pPool->numFreeHandles++;
+}
+
+/**
+ * Retrieve both arrays of the pool, so they may be directly processed
+ *
+ * NOTE: Both pointers are invalidated whenever a fraction is retrieved from
+ *       the pool (since the arrays may have to be expanded)!
+ *
+ * @param  [out]ppNumerators   Every fraction's numerator
+ * @param  [out]ppDenominators Every fraction's denominator
+ * @param  [out]pLen           Number of entries on each array (including
+ *                             released ones)
+ * @param  [ in]pPool          The pool
+ */
+void fractionPool_getArrays(int **ppNumerators, int **ppDenominators,
+        int *pLen, fractionPool *pPool) {
+    *ppNumerators = pPool->pNumerators;
+    *ppDenominators = pPool->pDenominators;
+    *pLen = pPool->usedHandles;
+}
+
+/**
+ * Adds two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     One of the summands
+ * @param  [ in]b     The other summand
+ */
+void fractionPool_sum(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b) {
+    int *pDens, *pNums;
+
+    STATS_INC(pPool->pManager->opsFractionPool);
+    pNums = pPool->pNumerators;
+    pDens = pPool->pDenominators;
+    fractionPool_store(pPool, out,
+            (int64_t)pNums[a] * pDens[b] + (int64_t)pNums[b] * pDens[a],
+            (int64_t)pDens[a] * pDens[b]);
+}
+
+/**
+ * Subtracts two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     The minuend
+ * @param  [ in]b     The subtrahend
+ */
+void fractionPool_sub(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b) {
+    int *pDens, *pNums;
+
+    STATS_INC(pPool->pManager->opsFractionPool);
+    pNums = pPool->pNumerators;
+    pDens = pPool->pDenominators;
+    fractionPool_store(pPool, out,
+            (int64_t)pNums[a] * pDens[b] - (int64_t)pNums[b] * pDens[a],
+            (int64_t)pDens[a] * pDens[b]);
+}
+
+/**
+ * Multiplies two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     One of the factors
+ * @param  [ in]b     The other factor
+ */
+void fractionPool_mul(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b) {
+    int *pDens, *pNums;
+
+    STATS_INC(pPool->pManager->opsFractionPool);
+    pNums = pPool->pNumerators;
+    pDens = pPool->pDenominators;
+    fractionPool_store(pPool, out, (int64_t)pNums[a] * pNums[b],
+            (int64_t)pDens[a] * pDens[b]);
+}
+
+/**
+ * Divides two fractional numbers on a pool
+ *
+ * NOTE: The output may be one of the inputs!
+ *
+ * @param  [ in]pPool The pool
+ * @param  [ in]out   The operation's result
+ * @param  [ in]a     The dividend
+ * @param  [ in]b     The divisor
+ */
+void fractionPool_div(fractionPool *pPool, fractionHandle out,
+        fractionHandle a, fractionHandle b) {
+    int *pDens, *pNums;
+
+    STATS_INC(pPool->pManager->opsFractionPool);
+    pNums = pPool->pNumerators;
+    pDens = pPool->pDenominators;
+    fractionPool_store(pPool, out, (int64_t)pNums[a] * pDens[b],
+            (int64_t)pDens[a] * pNums[b]);
+}
+
+/**
+ * Converts a fractional number on a pool to a regular fraction
+ *
+ * @param  [out]pOut   The converted fraction
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_toFraction(fraction *pOut, fractionPool *pPool,
+        fractionHandle handle) {
+    pOut->value.numerator = pPool->pNumerators[handle];
+    pOut->value.denominator = pPool->pDenominators[handle];
+    pOut->isSimplified = 1;
+}
+
+/**
+ * Converts a fractional number on a pool to an integer, retrieving only its
+ * quotient
+ *
+ * @param  [out]pOut   The converted fraction
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_iconvert(int *pOut, fractionPool *pPool,
+        fractionHandle handle) {
+    *pOut = pPool->pNumerators[handle] / pPool->pDenominators[handle];
+}
+
+/**
+ * Converts a fractional number on a pool to a double
+ *
+ * @param  [out]pOut   The converted fraction
+ * @param  [ in]pPool  The pool
+ * @param  [ in]handle The fraction
+ */
+void fractionPool_dconvert(double *pOut, fractionPool *pPool,
+        fractionHandle handle) {
+    *pOut = pPool->pNumerators[handle] /
+            (double)pPool->pDenominators[handle];
+}
+
+/**
+ * Converts a fractional number on a pool through a division, retrieving the
+ * number's quotient and remainder
+ *
+ * @param  [out]pQuotOut The fraction's quotient
+ * @param  [out]pRemOut  The fraction's remainder
+ * @param  [ in]pPool    The pool
+ * @param  [ in]handle   The fraction
+ */
+void fractionPool_divConvert(int *pQuotOut, int *pRemOut, fractionPool *pPool,
+        fractionHandle handle) {
+    *pQuotOut = pPool->pNumerators[handle] / pPool->pDenominators[handle];
+    *pRemOut = pPool->pNumerators[handle] % pPool->pDenominators[handle];
+}
+
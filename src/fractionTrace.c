@@ -0,0 +1,375 @@
+/**
+ * Sampled tracing of the manager's operations
+ *
+ * Every public entry point on regular fractions has a trace point, which
+ * compiles to nothing unless the lib was built with FRACTION_TRACE. See
+ * fraction_internal/trace.h for how the events are sampled and pushed into
+ * the manager's ring.
+ *
+ * Durations are measured in ticks of the time-stamp counter, on x86, and in
+ * nanoseconds on everything else. The time-stamp counter is calibrated
+ * against the monotonic clock the first time the tick length is requested.
+ *
+ * @file src/fractionTrace.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/manager.h>
+#include <fraction_internal/trace.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#  define TRACE_HAS_TSC
+#endif
+
+/** Operations skipped before checking again whether a manager that doesn't
+ * trace anything started doing so */
+#define TRACE_IDLE_INTERVAL 4096
+
+/** How long the time-stamp counter is calibrated, in nanoseconds */
+#define TRACE_CALIBRATION_NS 10000000
+
+/** Name of every operation, indexed by FRACTION_TRACE_* */
+static const char *trace_opNames[FRACTION_TRACE_NUM_OPS] = {
+    "get",
+    "iget",
+    "fxGet",
+    "fget",
+    "dget",
+    "clone",
+    "sum",
+    "sub",
+    "mul",
+    "div",
+    "iconvert",
+    "fxconvert",
+    "fconvert",
+    "dconvert",
+    "divConvert",
+    "getTerms",
+    "vconvert",
+    "dapprox",
+    "fapprox",
+    "dexact",
+    "fma"
+};
+
+/**
+ * Retrieve the name of a traced operation
+ *
+ * @param  [out]ppOut The operation's name (or "unknown")
+ * @param  [ in]op    The operation (one of FRACTION_TRACE_*)
+ */
+void fractionTrace_getOpName(const char **ppOut, int op) {
+    if (op < 0 || op >= FRACTION_TRACE_NUM_OPS) {
+        *ppOut = "unknown";
+        return;
+    }
+    *ppOut = trace_opNames[op];
+}
+
+#if defined(FRACTION_TRACE)
+
+__thread traceSpan trace_span;
+
+/** Nanoseconds per tick, calibrated on the first request */
+static double trace_nsPerTick = 1.0;
+static pthread_once_t trace_calibrateOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Retrieve the monotonic clock, in nanoseconds
+ *
+ * @return The current time
+ */
+static uint64_t trace_getNs() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Retrieve the current tick
+ *
+ * @return The current tick
+ */
+static uint64_t trace_now() {
+#if defined(TRACE_HAS_TSC)
+    return (uint64_t)__rdtsc();
+#else
+    return trace_getNs();
+#endif
+}
+
+/**
+ * Measure how many ticks of the time-stamp counter there are in a known
+ * interval
+ */
+static void trace_calibrate() {
+#if defined(TRACE_HAS_TSC)
+    uint64_t startNs, startTick, endNs, endTick;
+
+    startNs = trace_getNs();
+    startTick = trace_now();
+    do {
+        endNs = trace_getNs();
+    } while (endNs - startNs < TRACE_CALIBRATION_NS);
+    endTick = trace_now();
+
+    if (endTick > startTick) {
+        trace_nsPerTick = (double)(endNs - startNs) /
+                (double)(endTick - startTick);
+    }
+#endif
+}
+
+/**
+ * Retrieve how many bits are required to store the biggest term of a fraction
+ *
+ * @param  [ in]num The fraction's numerator
+ * @param  [ in]den The fraction's denominator
+ * @return          The number of bits (ignoring the sign)
+ */
+static int trace_getBits(int64_t num, int64_t den) {
+    uint64_t val;
+
+    /* Negate on unsigned values, so INT64_MIN doesn't overflow */
+    val = (num < 0) ? -(uint64_t)num : (uint64_t)num;
+    val |= (den < 0) ? -(uint64_t)den : (uint64_t)den;
+    if (val == 0) {
+        return 0;
+    }
+    return 64 - __builtin_clzll(val);
+}
+
+/**
+ * Initializes a ring of events
+ *
+ * @param  [ in]pRing    The ring
+ * @param  [ in]capacity Minimum number of events on the ring
+ * @param  [ in]interval Trace 1 in every 'interval' operations (or nothing, if
+ *                       0)
+ * @return               0 on success, 1 on failure
+ */
+int trace_init(traceRing *pRing, int capacity, int interval) {
+    uint64_t i, numSlots;
+
+    memset(pRing, 0x0, sizeof(traceRing));
+    if (interval <= 0) {
+        return 0;
+    }
+
+    numSlots = 2;
+    while (numSlots < (uint64_t)capacity) {
+        numSlots *= 2;
+    }
+
+    pRing->pSlots = (traceSlot*)malloc(sizeof(traceSlot) * numSlots);
+    if (!pRing->pSlots) {
+        return 1;
+    }
+    for (i = 0; i < numSlots; i++) {
+        pRing->pSlots[i].seq = i;
+    }
+    pRing->mask = numSlots - 1;
+    pRing->interval = interval;
+
+    return 0;
+}
+
+/**
+ * Releases a ring of events
+ *
+ * @param  [ in]pRing The ring
+ */
+void trace_clean(traceRing *pRing) {
+    free(pRing->pSlots);
+    memset(pRing, 0x0, sizeof(traceRing));
+}
+
+/**
+ * Start sampling the calling thread's current operation (unless the manager
+ * doesn't trace anything)
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [ in]numA The first operand's numerator
+ * @param  [ in]denA The first operand's denominator
+ * @param  [ in]numB The second operand's numerator
+ * @param  [ in]denB The second operand's denominator
+ */
+void trace_begin(fractionManager *pMng, int64_t numA, int64_t denA,
+        int64_t numB, int64_t denB) {
+    traceSpan *pSpan;
+
+    pSpan = &trace_span;
+    if (!pMng->trace.pSlots) {
+        pSpan->countdown = TRACE_IDLE_INTERVAL;
+        return;
+    }
+
+    if (pMng->trace.interval > 1) {
+        /* xorshift32, seeded from the span's (thread local) address */
+        if (pSpan->seed == 0) {
+            pSpan->seed = (uint32_t)(uintptr_t)pSpan | 1;
+        }
+        pSpan->seed ^= pSpan->seed << 13;
+        pSpan->seed ^= pSpan->seed >> 17;
+        pSpan->seed ^= pSpan->seed << 5;
+        pSpan->countdown = 1 + (int)(pSpan->seed %
+                ((uint32_t)pMng->trace.interval * 2 - 1));
+    }
+    else {
+        pSpan->countdown = 1;
+    }
+    pSpan->isSampled = 1;
+    pSpan->numSimplifications = 0;
+    pSpan->bitsA = trace_getBits(numA, denA);
+    pSpan->bitsB = trace_getBits(numB, denB);
+    pSpan->pManager = pMng;
+    pSpan->start = trace_now();
+}
+
+/**
+ * Finish sampling the calling thread's current operation, pushing it into
+ * the manager's ring
+ *
+ * @param  [ in]op The operation (one of FRACTION_TRACE_*)
+ */
+void trace_end(int op) {
+    traceSpan *pSpan;
+    traceRing *pRing;
+    traceSlot *pSlot;
+    uint64_t end, pos;
+
+    end = trace_now();
+    pSpan = &trace_span;
+    pSpan->isSampled = 0;
+    pRing = &(pSpan->pManager->trace);
+
+    /* Claim a free slot (i.e., one whose sequence matches its position) */
+    pos = __atomic_load_n(&(pRing->head), __ATOMIC_RELAXED);
+    while (1) {
+        int64_t diff;
+
+        pSlot = &(pRing->pSlots[pos & pRing->mask]);
+        diff = (int64_t)(__atomic_load_n(&(pSlot->seq), __ATOMIC_ACQUIRE) -
+                pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&(pRing->head), &pos, pos + 1,
+                    1/*weak*/, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            /* pos was updated to the current head */
+        }
+        else if (diff < 0) {
+            /* The slot still holds an event from the previous lap */
+            __atomic_add_fetch(&(pRing->numDropped), 1, __ATOMIC_RELAXED);
+            return;
+        }
+        else {
+            pos = __atomic_load_n(&(pRing->head), __ATOMIC_RELAXED);
+        }
+    }
+
+    pSlot->event.op = op;
+    pSlot->event.bitsA = pSpan->bitsA;
+    pSlot->event.bitsB = pSpan->bitsB;
+    pSlot->event.numSimplifications = pSpan->numSimplifications;
+    pSlot->event.ticks = end - pSpan->start;
+    /* Publish the event to the consumer */
+    __atomic_store_n(&(pSlot->seq), pos + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Move the sampled operations out of the manager's ring (oldest first)
+ *
+ * NOTE: Only a single thread may drain a manager's ring at a time
+ *
+ * @param  [out]pEvents     The sampled operations
+ * @param  [out]pNumEvents  Number of drained operations
+ * @param  [out]pNumDropped Number of operations dropped because the ring was
+ *                          full, since the last drain (may be NULL)
+ * @param  [ in]pMng        The fraction manager
+ * @param  [ in]maxEvents   Maximum number of operations drained
+ * @return                  0 on success, 1 if tracing wasn't compiled (or
+ *                          isn't enabled on the manager)
+ */
+int fractionManager_drainTrace(fractionTraceEvent *pEvents, int *pNumEvents,
+        uint64_t *pNumDropped, fractionManager *pMng, int maxEvents) {
+    traceRing *pRing;
+    uint64_t pos;
+    int num;
+
+    *pNumEvents = 0;
+    if (pNumDropped) {
+        *pNumDropped = 0;
+    }
+    pRing = &(pMng->trace);
+    if (!pRing->pSlots) {
+        return 1;
+    }
+
+    pos = pRing->tail;
+    num = 0;
+    while (num < maxEvents) {
+        traceSlot *pSlot;
+
+        pSlot = &(pRing->pSlots[pos & pRing->mask]);
+        if (__atomic_load_n(&(pSlot->seq), __ATOMIC_ACQUIRE) != pos + 1) {
+            /* Either empty or still being written */
+            break;
+        }
+        pEvents[num] = pSlot->event;
+        /* Free the slot for the producers' next lap */
+        __atomic_store_n(&(pSlot->seq), pos + pRing->mask + 1,
+                __ATOMIC_RELEASE);
+        pos++;
+        num++;
+    }
+    pRing->tail = pos;
+
+    *pNumEvents = num;
+    if (pNumDropped) {
+        *pNumDropped = __atomic_exchange_n(&(pRing->numDropped), 0,
+                __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+/**
+ * Retrieve how long each tick of the traced durations takes
+ *
+ * NOTE: The first call calibrates the time-stamp counter, which takes a few
+ *       milliseconds
+ *
+ * @param  [out]pOut Nanoseconds per tick
+ */
+void fractionTrace_getNsPerTick(double *pOut) {
+    pthread_once(&trace_calibrateOnce, trace_calibrate);
+    *pOut = trace_nsPerTick;
+}
+
+#else /* !FRACTION_TRACE */
+
+/* Tracing wasn't compiled, so there's never anything to drain */
+
+int fractionManager_drainTrace(fractionTraceEvent *pEvents, int *pNumEvents,
+        uint64_t *pNumDropped, fractionManager *pMng, int maxEvents) {
+    *pNumEvents = 0;
+    if (pNumDropped) {
+        *pNumDropped = 0;
+    }
+    return 1;
+}
+
+void fractionTrace_getNsPerTick(double *pOut) {
+    *pOut = 1.0;
+}
+
+#endif /* FRACTION_TRACE */
+
@@ -0,0 +1,202 @@
+/**
+ * Computes the greatest common divisor of integers, which is used to keep
+ * fractions on their lowest terms
+ *
+ * This is done through the binary (Stein's) algorithm. Every common factor of
+ * two is removed at once by counting the trailing zeros of both numbers. Then,
+ * the biggest number is repeatedly subtracted by the smallest one (and has its
+ * trailing zeros removed) until both are equal. Since each iteration removes
+ * at least one bit, it takes O(log n) iterations and never divides anything.
+ *
+ * @file src/gcd.c
+ */
+#include <fraction_internal/gcd.h>
+
+/** Count the trailing zeros of a non-zero number */
+#if defined(__GNUC__)
+#  define GCD_CTZ(val) __builtin_ctz(val)
+#  define GCD_CTZ64(val) __builtin_ctzll(val)
+#else
+static int GCD_CTZ(unsigned int val) {
+    int count;
+
+    count = 0;
+    while (!(val & 1)) {
+        val >>= 1;
+        count++;
+    }
+
+    return count;
+}
+
+static int GCD_CTZ64(uint64_t val) {
+    int count;
+
+    count = 0;
+    while (!(val & 1)) {
+        val >>= 1;
+        count++;
+    }
+
+    return count;
+}
+#endif
+
+/**
+ * Calculate the greatest common divisor of two unsigned numbers
+ *
+ * NOTE: gcd(0, b) is b, so gcd(0, 0) is 0
+ *
+ * @param  [ in]a A number
+ * @param  [ in]b The other number
+ * @return        The greatest common divisor
+ */
+unsigned int gcd_u32(unsigned int a, unsigned int b) {
+    int shift;
+
+    if (a == 0) {
+        return b;
+    }
+    else if (b == 0) {
+        return a;
+    }
+
+    /* Every factor of two common to both numbers is part of the result */
+    shift = GCD_CTZ(a | b);
+    a >>= GCD_CTZ(a);
+
+    /* From now on, 'a' is always odd and smaller than (or equal to) 'b' */
+    do {
+        b >>= GCD_CTZ(b);
+        if (a > b) {
+            unsigned int tmp;
+
+            tmp = a;
+            a = b;
+            b = tmp;
+        }
+        b -= a;
+    } while (b != 0);
+
+    return a << shift;
+}
+
+/**
+ * Calculate the greatest common divisor of two unsigned 64 bits numbers
+ *
+ * NOTE: gcd(0, b) is b, so gcd(0, 0) is 0
+ *
+ * @param  [ in]a A number
+ * @param  [ in]b The other number
+ * @return        The greatest common divisor
+ */
+uint64_t gcd_u64(uint64_t a, uint64_t b) {
+    int shift;
+
+    if (a == 0) {
+        return b;
+    }
+    else if (b == 0) {
+        return a;
+    }
+
+    /* Use the faster 32 bits version as soon as both numbers fit on it */
+    if ((a | b) <= 0xffffffffu) {
+        return gcd_u32((unsigned int)a, (unsigned int)b);
+    }
+
+    shift = GCD_CTZ64(a | b);
+    a >>= GCD_CTZ64(a);
+
+    do {
+        b >>= GCD_CTZ64(b);
+        if (a > b) {
+            uint64_t tmp;
+
+            tmp = a;
+            a = b;
+            b = tmp;
+        }
+        b -= a;
+    } while (b != 0);
+
+    return a << shift;
+}
+
+/**
+ * Reduce a pair of numerator and denominator to its lowest terms, also moving
+ * the sign to the numerator (so the denominator is always positive)
+ *
+ * NOTE: A zero denominator is left untouched
+ *
+ * @param  [ in]pNum The numerator
+ * @param  [ in]pDen The denominator
+ */
+void gcd_reduce(int *pNum, int *pDen) {
+    unsigned int den, div, num;
+    int isNegative;
+
+    if (*pDen == 0) {
+        return;
+    }
+
+    /* Work on the absolute values, so INT_MIN is handled correctly */
+    isNegative = (*pNum < 0) != (*pDen < 0);
+    num = (unsigned int)*pNum;
+    if (*pNum < 0) {
+        num = 0u - num;
+    }
+    den = (unsigned int)*pDen;
+    if (*pDen < 0) {
+        den = 0u - den;
+    }
+
+    div = gcd_u32(num, den);
+    num /= div;
+    den /= div;
+
+    if (isNegative) {
+        num = 0u - num;
+    }
+    *pNum = (int)num;
+    *pDen = (int)den;
+}
+
+/**
+ * Reduce a pair of 64 bits numerator and denominator to its lowest terms, also
+ * moving the sign to the numerator (so the denominator is always positive)
+ *
+ * NOTE: A zero denominator is left untouched
+ *
+ * @param  [ in]pNum The numerator
+ * @param  [ in]pDen The denominator
+ */
+void gcd_reduce64(int64_t *pNum, int64_t *pDen) {
+    uint64_t den, div, num;
+    int isNegative;
+
+    if (*pDen == 0) {
+        return;
+    }
+
+    isNegative = (*pNum < 0) != (*pDen < 0);
+    num = (uint64_t)*pNum;
+    if (*pNum < 0) {
+        num = 0u - num;
+    }
+    den = (uint64_t)*pDen;
+    if (*pDen < 0) {
+        den = 0u - den;
+    }
+
+    div = gcd_u64(num, den);
+    num /= div;
+    den /= div;
+
+    if (isNegative) {
+        num = 0u - num;
+    }
+    *pNum = (int64_t)num;
+    *pDen = (int64_t)den;
+}
+
@@ -0,0 +1,313 @@
+/**
+ * Reduces blocks of fractions to their lowest terms, calculating the greatest
+ * common divisor of many fractions at once
+ *
+ * On x86, the binary GCD is done on every lane of a SIMD register (8 lanes
+ * with AVX2 and 4 with SSE4.1). Each lane's trailing zeros are counted by
+ * converting its lowest set bit to a float and reading its exponent. Then,
+ * every lane is repeatedly shifted right by its trailing zeros and has its
+ * biggest number subtracted by its smallest one (through unsigned min/max),
+ * until every lane's subtrahend reaches zero. Lastly, both terms are divided
+ * by the divisor on doubles (which is exact, since they are divisible and
+ * smaller than 2^53).
+ *
+ * The best kernel is selected on the first call, based on the running CPU.
+ * Groups of fractions with a zero denominator or with INT_MIN on any term
+ * (as well as the block's tail) are reduced by the scalar algorithm.
+ *
+ * @file src/gcdBlock.c
+ */
+#include <fraction_internal/gcd.h>
+
+#include <limits.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+        !defined(__EMSCRIPTEN__)
+#  define GCD_BLOCK_X86
+#  include <immintrin.h>
+#endif
+
+/** Signature of every block reduction kernel */
+typedef void (*gcdBlockKernel)(int *pNums, int *pDens, int len);
+
+/**
+ * Reduce a block of numerators and denominators to their lowest terms, one
+ * fraction at a time
+ *
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+static void gcd_reduceBlockScalar(int *pNums, int *pDens, int len) {
+    int i;
+
+    for (i = 0; i < len; i++) {
+        gcd_reduce(pNums + i, pDens + i);
+    }
+}
+
+#if defined(GCD_BLOCK_X86)
+
+/**
+ * Divide every lane of a number by a divisor, through doubles
+ *
+ * @param  [ in]val The dividends (which must be positive)
+ * @param  [ in]div The divisors
+ * @return          The quotients
+ */
+__attribute__((target("sse4.1")))
+static __m128i gcd_divSSE(__m128i val, __m128i div) {
+    __m128i hi, lo;
+
+    lo = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(val),
+            _mm_cvtepi32_pd(div)));
+    hi = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(_mm_srli_si128(val, 8)),
+            _mm_cvtepi32_pd(_mm_srli_si128(div, 8))));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+/**
+ * Reduce a block of numerators and denominators to their lowest terms, four
+ * fractions at a time
+ *
+ * SSE has no per-lane shift, so trailing zeros are removed one bit at a time
+ * (which takes a single iteration for most lanes)
+ *
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+__attribute__((target("sse4.1")))
+static void gcd_reduceBlockSSE(int *pNums, int *pDens, int len) {
+    __m128i one, zero;
+    int i;
+
+    one = _mm_set1_epi32(1);
+    zero = _mm_setzero_si128();
+
+    for (i = 0; i + 4 <= len; i += 4) {
+        __m128i a, b, den, lowBit, num, sign;
+
+        num = _mm_loadu_si128((__m128i*)(pNums + i));
+        den = _mm_loadu_si128((__m128i*)(pDens + i));
+        sign = _mm_or_si128(_mm_xor_si128(num, den), one);
+        a = _mm_abs_epi32(num);
+        b = _mm_abs_epi32(den);
+
+        /* Only INT_MIN stays negative after abs */
+        if (!_mm_testz_si128(_mm_or_si128(a, b), _mm_set1_epi32(INT_MIN)) ||
+                _mm_movemask_epi8(_mm_cmpeq_epi32(b, zero)) != 0) {
+            gcd_reduceBlockScalar(pNums + i, pDens + i, 4);
+            continue;
+        }
+        num = a;
+        den = b;
+
+        /* gcd(0, b) = gcd(b, b) */
+        a = _mm_blendv_epi8(a, b, _mm_cmpeq_epi32(a, zero));
+
+        /* Store the common power of two, and make 'a' odd */
+        lowBit = _mm_or_si128(a, b);
+        lowBit = _mm_and_si128(lowBit, _mm_sub_epi32(zero, lowBit));
+        while (1) {
+            __m128i even;
+
+            even = _mm_cmpeq_epi32(_mm_and_si128(a, one), zero);
+            if (_mm_testz_si128(even, even)) {
+                break;
+            }
+            a = _mm_blendv_epi8(a, _mm_srli_epi32(a, 1), even);
+        }
+
+        while (1) {
+            __m128i active, diff, min;
+
+            active = _mm_xor_si128(_mm_cmpeq_epi32(b, zero),
+                    _mm_set1_epi32(-1));
+            if (_mm_testz_si128(active, active)) {
+                break;
+            }
+
+            /* Make 'b' odd (a zero 'b' is left as is) */
+            while (1) {
+                __m128i even;
+
+                even = _mm_and_si128(active,
+                        _mm_cmpeq_epi32(_mm_and_si128(b, one), zero));
+                if (_mm_testz_si128(even, even)) {
+                    break;
+                }
+                b = _mm_blendv_epi8(b, _mm_srli_epi32(b, 1), even);
+            }
+
+            min = _mm_min_epu32(a, b);
+            diff = _mm_sub_epi32(_mm_max_epu32(a, b), min);
+            a = _mm_blendv_epi8(a, min, active);
+            b = _mm_blendv_epi8(b, diff, active);
+        }
+        a = _mm_mullo_epi32(a, lowBit);
+
+        /* Divide both terms and move the sign to the numerator */
+        num = _mm_sign_epi32(gcd_divSSE(num, a), sign);
+        den = gcd_divSSE(den, a);
+        _mm_storeu_si128((__m128i*)(pNums + i), num);
+        _mm_storeu_si128((__m128i*)(pDens + i), den);
+    }
+
+    gcd_reduceBlockScalar(pNums + i, pDens + i, len - i);
+}
+
+/**
+ * Count the trailing zeros of every (non-zero) lane, by converting its lowest
+ * set bit to a float and reading its exponent
+ *
+ * @param  [ in]val The lanes
+ * @return          Each lane's number of trailing zeros
+ */
+__attribute__((target("avx2")))
+static __m256i gcd_ctzAVX2(__m256i val) {
+    __m256i lowBit, exp;
+
+    lowBit = _mm256_and_si256(val, _mm256_sub_epi32(_mm256_setzero_si256(),
+            val));
+    exp = _mm256_castps_si256(_mm256_cvtepi32_ps(lowBit));
+    exp = _mm256_and_si256(_mm256_srli_epi32(exp, 23), _mm256_set1_epi32(0xff));
+    return _mm256_sub_epi32(exp, _mm256_set1_epi32(127));
+}
+
+/**
+ * Divide every lane of a number by a divisor, through doubles
+ *
+ * @param  [ in]val The dividends (which must be positive)
+ * @param  [ in]div The divisors
+ * @return          The quotients
+ */
+__attribute__((target("avx2")))
+static __m256i gcd_divAVX2(__m256i val, __m256i div) {
+    __m128i hi, lo;
+
+    lo = _mm256_cvttpd_epi32(_mm256_div_pd(
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(val)),
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(div))));
+    hi = _mm256_cvttpd_epi32(_mm256_div_pd(
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(val, 1)),
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(div, 1))));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+/**
+ * Reduce a block of numerators and denominators to their lowest terms, eight
+ * fractions at a time
+ *
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+__attribute__((target("avx2")))
+static void gcd_reduceBlockAVX2(int *pNums, int *pDens, int len) {
+    __m256i one, zero;
+    int i;
+
+    one = _mm256_set1_epi32(1);
+    zero = _mm256_setzero_si256();
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256i a, b, den, lowBit, num, sign;
+
+        num = _mm256_loadu_si256((__m256i*)(pNums + i));
+        den = _mm256_loadu_si256((__m256i*)(pDens + i));
+        sign = _mm256_or_si256(_mm256_xor_si256(num, den), one);
+        a = _mm256_abs_epi32(num);
+        b = _mm256_abs_epi32(den);
+
+        /* Only INT_MIN stays negative after abs */
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(a, b)))
+                != 0 || _mm256_movemask_epi8(_mm256_cmpeq_epi32(b, zero))
+                != 0) {
+            gcd_reduceBlockScalar(pNums + i, pDens + i, 8);
+            continue;
+        }
+        num = a;
+        den = b;
+
+        /* gcd(0, b) = gcd(b, b) */
+        a = _mm256_blendv_epi8(a, b, _mm256_cmpeq_epi32(a, zero));
+
+        /* Store the common power of two, and make 'a' odd */
+        lowBit = _mm256_or_si256(a, b);
+        lowBit = _mm256_and_si256(lowBit, _mm256_sub_epi32(zero, lowBit));
+        a = _mm256_srlv_epi32(a, gcd_ctzAVX2(a));
+
+        while (1) {
+            __m256i active, diff, min;
+
+            active = _mm256_xor_si256(_mm256_cmpeq_epi32(b, zero),
+                    _mm256_set1_epi32(-1));
+            if (_mm256_testz_si256(active, active)) {
+                break;
+            }
+
+            /* Make 'b' odd (a zero 'b' counts a bogus number of zeros, but
+             * stays zero either way) */
+            b = _mm256_srlv_epi32(b, gcd_ctzAVX2(b));
+
+            min = _mm256_min_epu32(a, b);
+            diff = _mm256_sub_epi32(_mm256_max_epu32(a, b), min);
+            a = _mm256_blendv_epi8(a, min, active);
+            b = _mm256_blendv_epi8(b, diff, active);
+        }
+        a = _mm256_mullo_epi32(a, lowBit);
+
+        /* Divide both terms and move the sign to the numerator */
+        num = _mm256_sign_epi32(gcd_divAVX2(num, a), sign);
+        den = gcd_divAVX2(den, a);
+        _mm256_storeu_si256((__m256i*)(pNums + i), num);
+        _mm256_storeu_si256((__m256i*)(pDens + i), den);
+    }
+
+    gcd_reduceBlockSSE(pNums + i, pDens + i, len - i);
+}
+
+#endif /* GCD_BLOCK_X86 */
+
+/**
+ * Select the best kernel for the running CPU
+ *
+ * @return The kernel
+ */
+static gcdBlockKernel gcd_selectKernel() {
+#if defined(GCD_BLOCK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return gcd_reduceBlockAVX2;
+    }
+    else if (__builtin_cpu_supports("sse4.1")) {
+        return gcd_reduceBlockSSE;
+    }
+#endif
+    return gcd_reduceBlockScalar;
+}
+
+/** The kernel selected for the running CPU (selecting it is idempotent, so
+ * racing threads atomically store the same pointer) */
+static gcdBlockKernel gcd_kernel = 0;
+
+/**
+ * Reduce a block of numerators and denominators to their lowest terms, just
+ * like gcd_reduce does for each pair
+ *
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+void gcd_reduceBlock(int *pNums, int *pDens, int len) {
+    gcdBlockKernel kernel;
+
+    kernel = __atomic_load_n(&gcd_kernel, __ATOMIC_RELAXED);
+    if (!kernel) {
+        kernel = gcd_selectKernel();
+        __atomic_store_n(&gcd_kernel, kernel, __ATOMIC_RELAXED);
+    }
+    kernel(pNums, pDens, len);
+}
+
@@ -0,0 +1,103 @@
+/**
+ * Exact running sums of fractions, kept over a common denominator
+ *
+ * The running sum is stored on 64 bits terms, over the least common multiple
+ * of the denominators added so far, and it isn't reduced after each term.
+ * So, adding a term costs a few multiplications (and a gcd, only if its
+ * denominator doesn't divide the running one). Whenever a term would
+ * overflow the running sum, both are reduced to their lowest terms and the
+ * term is added again.
+ *
+ * @file src/include/fraction_internal/accum.h
+ */
+#ifndef __ACCUM_H__
+#define __ACCUM_H__
+
+#include <stdint.h>
+
+/** Running sum of fractions */
+struct stAccum {
+    /** The sum's numerator */
+    int64_t num;
+    /** The sum's denominator (positive, or 0 if any term had a zero
+     * denominator) */
+    int64_t den;
+};
+typedef struct stAccum accum;
+
+/**
+ * Initialize a running sum with a fraction
+ *
+ * @param  [out]pAcc The running sum
+ * @param  [ in]num  The fraction's numerator
+ * @param  [ in]den  The fraction's denominator
+ */
+void accum_init(accum *pAcc, int num, int den);
+
+/**
+ * Add a (widened) fraction to the running sum
+ *
+ * The term is always added exactly, unless even the sum of both reduced
+ * fractions can't be calculated on 64 bits (in which case, the running
+ * sum's value is left untouched)
+ *
+ * @param  [ in]pAcc The running sum
+ * @param  [ in]num  The term's numerator (which musn't be INT64_MIN)
+ * @param  [ in]den  The term's denominator (which musn't be INT64_MIN)
+ * @return           0 on success, 1 on overflow
+ */
+int accum_add(accum *pAcc, int64_t num, int64_t den);
+
+/**
+ * Add an array of fractions to the running sum, stopping at the first one
+ * that can't be added (i.e., that overflows the running sum or that has a
+ * zero denominator)
+ *
+ * @param  [ in]pAcc  The running sum
+ * @param  [ in]pNums The fractions' numerators
+ * @param  [ in]pDens The fractions' denominators
+ * @param  [ in]len   Number of fractions on every array
+ * @return            Number of fractions added
+ */
+int accum_addArray(accum *pAcc, const int *pNums, const int *pDens, int len);
+
+/**
+ * Add the products of the elements of two arrays of fractions to the running
+ * sum
+ *
+ * The sum is exact as long as every reduced product and every reduced partial
+ * sum fit into an int (i.e., whenever multiplying and then summing the
+ * fractions would also be exact), and usually way past that. Otherwise, the
+ * partial sum wraps around, just like the result of a regular sum would.
+ *
+ * @param  [ in]pAcc   The running sum
+ * @param  [ in]pNumsA The first factors' numerators
+ * @param  [ in]pDensA The first factors' denominators
+ * @param  [ in]pNumsB The second factors' numerators
+ * @param  [ in]pDensB The second factors' denominators
+ * @param  [ in]len    Number of fractions on every array
+ */
+void accum_addProducts(accum *pAcc, const int *pNumsA, const int *pDensA,
+        const int *pNumsB, const int *pDensB, int len);
+
+/**
+ * Add the product of two fractions to the running sum, just like
+ * accum_addProducts does for each pair of elements
+ *
+ * @param  [ in]pAcc The running sum
+ * @param  [ in]numA The first factor's numerator
+ * @param  [ in]denA The first factor's denominator
+ * @param  [ in]numB The second factor's numerator
+ * @param  [ in]denB The second factor's denominator
+ */
+void accum_addProduct(accum *pAcc, int numA, int denA, int numB, int denB);
+
+/**
+ * Reduce the running sum to its lowest terms
+ *
+ * @param  [ in]pAcc The running sum
+ */
+void accum_reduce(accum *pAcc);
+
+#endif /* __ACCUM_H__ */
+
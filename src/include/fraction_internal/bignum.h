@@ -0,0 +1,161 @@
+/**
+ * Arbitrary precision integers, used as the terms of big fractions
+ *
+ * Any number that fits into 64 bits is stored inline (on 'small'), without
+ * alloc'ing anything. As soon as an operation overflows, its result is
+ * promoted to a list of 32 bits limbs (on 'pLimbs', least significant limb
+ * first), which stores the number's magnitude. Results that fit into 64 bits
+ * once again are demoted back to their inline representation.
+ *
+ * Limbs are retrieved from the fraction manager, on pools of power-of-two
+ * sizes, so they are recycled just like fractions are.
+ *
+ * Every function that outputs a number accepts one of its inputs as the
+ * output.
+ *
+ * @file src/include/fraction_internal/bignum.h
+ */
+#ifndef __BIGNUM_H__
+#define __BIGNUM_H__
+
+#include <fraction/fraction.h>
+
+#include <stdint.h>
+
+/** Number of limbs on the smallest list of limbs */
+#define BIGNUM_MIN_LIMBS 4
+/** Number of sizes of list of limbs (each twice as big as the previous) */
+#define BIGNUM_NUM_CLASSES 24
+
+/** Arbitrary precision integer */
+struct stBignum {
+    /** The number's value, if it fits into 64 bits (i.e., if !pLimbs) */
+    int64_t small;
+    /** The number's magnitude, if it doesn't fit into 64 bits */
+    uint32_t *pLimbs;
+    /** How many limbs are used */
+    int numLimbs;
+    /** How many limbs were alloc'ed */
+    int capLimbs;
+    /** Whether the number is negative (only used along pLimbs) */
+    int isNegative;
+};
+typedef struct stBignum bignum;
+
+/**
+ * Initializes a number from an integer (this never allocs anything)
+ *
+ * @param  [ in]pNum The number
+ * @param  [ in]val  Its initial value
+ */
+void bignum_init(bignum *pNum, int64_t val);
+
+/**
+ * Releases the number's limbs (if any), setting it to 0
+ *
+ * @param  [ in]pMng The fraction manager that alloc'ed the limbs
+ * @param  [ in]pNum The number
+ */
+void bignum_clean(fractionManager *pMng, bignum *pNum);
+
+/**
+ * Retrieve a number's sign
+ *
+ * @param  [ in]pNum The number
+ * @return           -1 if it's negative, 0 if it's zero and 1 if positive
+ */
+int bignum_sign(const bignum *pNum);
+
+/**
+ * Copy a number
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The copy
+ * @param  [ in]pSrc The original number
+ * @return           0 on success, 1 on failure
+ */
+int bignum_copy(fractionManager *pMng, bignum *pOut, const bignum *pSrc);
+
+/**
+ * Negate a number, in place
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [ in]pNum The number
+ * @return           0 on success, 1 on failure
+ */
+int bignum_negate(fractionManager *pMng, bignum *pNum);
+
+/**
+ * Add two numbers
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The sum
+ * @param  [ in]pA   One of the summands
+ * @param  [ in]pB   The other summand
+ * @return           0 on success, 1 on failure
+ */
+int bignum_add(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB);
+
+/**
+ * Subtract two numbers
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The difference
+ * @param  [ in]pA   The minuend
+ * @param  [ in]pB   The subtrahend
+ * @return           0 on success, 1 on failure
+ */
+int bignum_sub(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB);
+
+/**
+ * Multiply two numbers
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The product
+ * @param  [ in]pA   One of the factors
+ * @param  [ in]pB   The other factor
+ * @return           0 on success, 1 on failure
+ */
+int bignum_mul(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB);
+
+/**
+ * Divide two numbers, truncating the quotient toward zero (so the remainder
+ * has the dividend's sign)
+ *
+ * @param  [ in]pMng  The fraction manager
+ * @param  [out]pQuot The quotient (may be NULL)
+ * @param  [out]pRem  The remainder (may be NULL)
+ * @param  [ in]pA    The dividend
+ * @param  [ in]pB    The divisor
+ * @return            0 on success, 1 on failure (or division by zero)
+ */
+int bignum_divmod(fractionManager *pMng, bignum *pQuot, bignum *pRem,
+        const bignum *pA, const bignum *pB);
+
+/**
+ * Calculate the (non-negative) greatest common divisor of two numbers
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [out]pOut The greatest common divisor
+ * @param  [ in]pA   A number
+ * @param  [ in]pB   The other number
+ * @return           0 on success, 1 on failure
+ */
+int bignum_gcd(fractionManager *pMng, bignum *pOut, const bignum *pA,
+        const bignum *pB);
+
+/**
+ * Convert a number to a double, as value * 2^exponent, so even numbers
+ * bigger than the biggest double may be divided by one another
+ *
+ * @param  [out]pExp The exponent
+ * @param  [ in]pNum The number
+ * @return           The number's value, scaled down by 2^exponent
+ */
+double bignum_toDouble(int *pExp, const bignum *pNum);
+
+#endif /* __BIGNUM_H__ */
+
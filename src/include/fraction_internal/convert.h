@@ -0,0 +1,34 @@
+/**
+ * Converts blocks of numerators and denominators to floating point numbers
+ *
+ * @file src/include/fraction_internal/convert.h
+ */
+#ifndef __CONVERT_H__
+#define __CONVERT_H__
+
+/**
+ * Convert a block of numerators and denominators to doubles, just like
+ * fractionValue_dconvert does for each pair
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+void convert_toDoubleBlock(double *pOut, const int *pNums, const int *pDens,
+        int len);
+
+/**
+ * Convert a block of numerators and denominators to floats, just like
+ * fractionValue_fconvert does for each pair
+ *
+ * @param  [out]pOut  The converted fractions
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+void convert_toFloatBlock(float *pOut, const int *pNums, const int *pDens,
+        int len);
+
+#endif /* __CONVERT_H__ */
+
@@ -0,0 +1,46 @@
+/**
+ * Overflow-checked operations on the terms of 64 bits fractions, so they may
+ * be reused by other kinds of fractions as a fast path
+ *
+ * @file src/include/fraction_internal/fraction64.h
+ */
+#ifndef __FRACTION64_INTERNAL_H__
+#define __FRACTION64_INTERNAL_H__
+
+#include <stdint.h>
+
+/**
+ * Multiply two fractions, given by their terms. The result is only stored if
+ * it fits into 64 bits
+ *
+ * NOTE: Either denominator may be negative, so this also divides fractions
+ *
+ * @param  [out]pNum The result's numerator
+ * @param  [out]pDen The result's denominator
+ * @param  [ in]numA The first fraction's numerator
+ * @param  [ in]denA The first fraction's denominator
+ * @param  [ in]numB The second fraction's numerator
+ * @param  [ in]denB The second fraction's denominator
+ * @return           0 on success, 1 on overflow or division by zero
+ */
+int fraction64_mulTerms(int64_t *pNum, int64_t *pDen, int64_t numA,
+        int64_t denA, int64_t numB, int64_t denB);
+
+/**
+ * Add (or subtract) two fractions on their lowest terms, given by their
+ * terms. The result is only stored if it fits into 64 bits
+ *
+ * @param  [out]pNum  The result's numerator
+ * @param  [out]pDen  The result's denominator
+ * @param  [ in]numA  The first fraction's numerator
+ * @param  [ in]denA  The first fraction's (positive) denominator
+ * @param  [ in]numB  The second fraction's numerator
+ * @param  [ in]denB  The second fraction's (positive) denominator
+ * @param  [ in]isSub Whether the second fraction should be subtracted
+ * @return            0 on success, 1 on overflow
+ */
+int fraction64_addTerms(int64_t *pNum, int64_t *pDen, int64_t numA,
+        int64_t denA, int64_t numB, int64_t denB, int isSub);
+
+#endif /* __FRACTION64_INTERNAL_H__ */
+
@@ -0,0 +1,73 @@
+/**
+ * Computes the greatest common divisor of integers, which is used to keep
+ * fractions on their lowest terms
+ *
+ * This is done through the binary (Stein's) algorithm. Every common factor of
+ * two is removed at once by counting the trailing zeros of both numbers. Then,
+ * the biggest number is repeatedly subtracted by the smallest one (and has its
+ * trailing zeros removed) until both are equal. Since each iteration removes
+ * at least one bit, it takes O(log n) iterations and never divides anything.
+ *
+ * @file src/include/fraction_internal/gcd.h
+ */
+#ifndef __GCD_H__
+#define __GCD_H__
+
+#include <stdint.h>
+
+/**
+ * Calculate the greatest common divisor of two unsigned numbers
+ *
+ * NOTE: gcd(0, b) is b, so gcd(0, 0) is 0
+ *
+ * @param  [ in]a A number
+ * @param  [ in]b The other number
+ * @return        The greatest common divisor
+ */
+unsigned int gcd_u32(unsigned int a, unsigned int b);
+
+/**
+ * Calculate the greatest common divisor of two unsigned 64 bits numbers
+ *
+ * NOTE: gcd(0, b) is b, so gcd(0, 0) is 0
+ *
+ * @param  [ in]a A number
+ * @param  [ in]b The other number
+ * @return        The greatest common divisor
+ */
+uint64_t gcd_u64(uint64_t a, uint64_t b);
+
+/**
+ * Reduce a pair of numerator and denominator to its lowest terms, also moving
+ * the sign to the numerator (so the denominator is always positive)
+ *
+ * NOTE: A zero denominator is left untouched
+ *
+ * @param  [ in]pNum The numerator
+ * @param  [ in]pDen The denominator
+ */
+void gcd_reduce(int *pNum, int *pDen);
+
+/**
+ * Reduce a pair of 64 bits numerator and denominator to its lowest terms, also
+ * moving the sign to the numerator (so the denominator is always positive)
+ *
+ * NOTE: A zero denominator is left untouched
+ *
+ * @param  [ in]pNum The numerator
+ * @param  [ in]pDen The denominator
+ */
+void gcd_reduce64(int64_t *pNum, int64_t *pDen);
+
+/**
+ * Reduce a block of numerators and denominators to their lowest terms, just
+ * like gcd_reduce does for each pair
+ *
+ * @param  [ in]pNums The numerators
+ * @param  [ in]pDens The denominators
+ * @param  [ in]len   Number of pairs
+ */
+void gcd_reduceBlock(int *pNums, int *pDens, int len);
+
+#endif /* __GCD_H__ */
+
@@ -0,0 +1,173 @@
+/**
+ * Defines the fraction manager and every kind of fractional number, so they
+ * may be shared by all modules of the lib
+ *
+ * @file src/include/fraction_internal/manager.h
+ */
+#ifndef __MANAGER_H__
+#define __MANAGER_H__
+
+#include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+#include <fraction_internal/accum.h>
+#include <fraction_internal/bignum.h>
+#include <fraction_internal/pool.h>
+#include <fraction_internal/prime.h>
+#include <fraction_internal/spf.h>
+#include <fraction_internal/trace.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+/** Number of pairs on the smallest list of factors */
+#define FACTORED_MIN_PAIRS 8
+/** Number of sizes of lists of factors (each twice as big as the previous) */
+#define FACTORED_NUM_CLASSES 24
+
+/** Keep references to all fraction lists and the list of primes */
+struct stFractionManager {
+    /** Recycle every fraction alloc'ed by this manager */
+    pool fractions;
+    /** Recycle every 64 bits fraction alloc'ed by this manager */
+    pool fractions64;
+    /** Recycle every big fraction alloc'ed by this manager */
+    pool fractionsBig;
+    /** Recycle every factored fraction alloc'ed by this manager */
+    pool fractionsFactored;
+    /** Recycle the limbs of big numbers, by size (BIGNUM_MIN_LIMBS << i).
+     * These are only initialized when first used */
+    pool limbs[BIGNUM_NUM_CLASSES];
+    /** Recycle the lists of factors of factored fractions, by size
+     * (FACTORED_MIN_PAIRS << i). These are only initialized when first
+     * used */
+    pool factors[FACTORED_NUM_CLASSES];
+    /** List of sequential prime numbers, extended on demand */
+    primeTable primes;
+    /** Smallest prime factor of every odd number up to a limit (if
+     * enabled) */
+    spfTable spf;
+    /** Whether results are only simplified when observed (or about to
+     * overflow) */
+    int isLazy;
+    /** Whether the manager may be used by many threads at once */
+    int isConcurrent;
+    /** Protects lazily initializing pools, on concurrent managers */
+    pthread_mutex_t lock;
+#if defined(FRACTION_STATS)
+    /** Arithmetic operations on each kind of fraction */
+    uint64_t opsFraction;
+    uint64_t opsFraction64;
+    uint64_t opsFractionBig;
+    uint64_t opsFractionFactored;
+    uint64_t opsFractionPool;
+    /** Number of times a regular fraction was reduced */
+    uint64_t numSimplifications;
+#endif
+#if defined(FRACTION_TRACE)
+    /** Sampled operations, waiting to be drained */
+    traceRing trace;
+#endif
+};
+
+/** Fractional number */
+struct stFraction {
+    /** The fraction's terms */
+    fractionValue value;
+    /** Whether the fraction is on its lowest terms (with a positive
+     * denominator) */
+    int isSimplified;
+    /** Reference to the manager that alloc'ed this object */
+    fractionManager *pManager;
+};
+
+/** Fractional number with 64 bits terms, always kept on its lowest terms */
+struct stFraction64 {
+    /** The fraction's numerator */
+    int64_t numerator;
+    /** The fraction's denominator (always positive) */
+    int64_t denominator;
+    /** Reference to the manager that alloc'ed this object */
+    fractionManager *pManager;
+};
+
+/** Fractional number with arbitrary precision, always kept on its lowest
+ * terms */
+struct stFractionBig {
+    /** The fraction's numerator */
+    bignum numerator;
+    /** The fraction's denominator (always positive) */
+    bignum denominator;
+    /** Reference to the manager that alloc'ed this object */
+    fractionManager *pManager;
+};
+
+/** A prime factor of a factored fraction, and its exponent (positive on the
+ * numerator, negative on the denominator) */
+struct stFactorPair {
+    /** The prime */
+    int prime;
+    /** How many times it divides the numerator (or the denominator, if
+     * negative) */
+    int exponent;
+};
+typedef struct stFactorPair factorPair;
+
+/** Fractional number stored as a list of prime factors, so multiplications
+ * simply add exponents. It's kept as regular terms (on its lowest terms) if
+ * it's zero or if it was last output by a sum */
+struct stFractionFactored {
+    /** The fraction's prime factors (by increasing prime), if isFactored */
+    factorPair *pFactors;
+    /** Buffer where the next result is stored, before being swapped with
+     * pFactors (so the output may be one of the inputs) */
+    factorPair *pSpare;
+    /** Number of prime factors */
+    int numFactors;
+    /** Number of alloc'ed entries on pFactors */
+    int capFactors;
+    /** Number of alloc'ed entries on pSpare */
+    int capSpare;
+    /** Whether the factored fraction is negative (only used if
+     * isFactored) */
+    int isNegative;
+    /** Whether the fraction is stored as its list of prime factors */
+    int isFactored;
+    /** The fraction's numerator, if !isFactored */
+    int64_t numerator;
+    /** The fraction's denominator (always positive), if !isFactored */
+    int64_t denominator;
+    /** Reference to the manager that alloc'ed this object */
+    fractionManager *pManager;
+};
+
+/** Fractional numbers stored as arrays of numerators and denominators */
+struct stFractionPool {
+    /** The manager that created this pool */
+    fractionManager *pManager;
+    /** Every fraction's numerator, indexed by its handle */
+    int *pNumerators;
+    /** Every fraction's denominator, indexed by its handle */
+    int *pDenominators;
+    /** Stack of released handles */
+    fractionHandle *pFreeHandles;
+    /** Number of handles on the stack */
+    int numFreeHandles;
+    /** Number of alloc'ed entries on every array */
+    int capacity;
+    /** Number of entries ever retrieved (i.e., the next unused handle) */
+    int usedHandles;
+};
+
+/** Running sum of many fractional numbers, kept over a common denominator */
+struct stFractionAccumulator {
+    /** The manager that created this accumulator */
+    fractionManager *pManager;
+    /** Sum of every fraction added since the running sum was last folded */
+    accum sum;
+    /** Sum of every fraction folded so far (or 0, if the running sum never
+     * overflowed) */
+    fractionBig *pBig;
+};
+
+#endif /* __MANAGER_H__ */
+
@@ -0,0 +1,159 @@
+/**
+ * Recycles objects of a fixed size
+ *
+ * Objects are alloc'ed in buffers of many objects at once, and those buffers
+ * are only released when the pool itself is cleaned. Therefore, an object is
+ * never moved around after it has been retrieved, no matter how much the pool
+ * grows. Released objects are kept on a linked list (which uses the object's
+ * own memory), so they may be recycled later.
+ *
+ * A pool may also be shared by many threads. In that case, each thread keeps
+ * a small cache (a magazine) of free objects, so most retrievals and releases
+ * don't synchronize at all. Full magazines are flushed to the pool's list of
+ * free objects in chains, through a single atomic compare-and-swap. Empty
+ * magazines are refilled from that list (or from a new buffer) while holding
+ * the pool's lock, so only a single thread ever removes objects from the list
+ * (which avoids the ABA problem). Since buffers never move, expanding the
+ * pool never invalidates objects used by other threads.
+ *
+ * @file src/include/fraction_internal/pool.h
+ */
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <fraction/fraction.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+/** Number of objects cached by each thread, on concurrent pools */
+#define POOL_MAGAZINE_SIZE 64
+
+/** Buffer of objects, from which new references are recycled */
+struct stPoolBuffer {
+    /** All objects alloc'ed on this buffer */
+    char *pObjects;
+    /** Number of alloc'ed objects */
+    int numObjects;
+    /** Number of used objects */
+    int usedObjects;
+};
+typedef struct stPoolBuffer poolBuffer;
+
+/** Free objects cached by a single thread */
+struct stPoolMagazine {
+    /** The cached objects */
+    void *ppObjects[POOL_MAGAZINE_SIZE];
+    /** Number of cached objects */
+    int numObjects;
+    /** The thread that uses this magazine */
+    pthread_t owner;
+    /** The pool's next magazine */
+    struct stPoolMagazine *pNext;
+};
+typedef struct stPoolMagazine poolMagazine;
+
+/** Keep references to every buffer of a given object */
+struct stPool {
+    /** Store all buffers */
+    poolBuffer **ppBuffers;
+    /** Number of buffers */
+    int numBuffers;
+    /** Size of each object, in bytes */
+    int objectSize;
+    /** How many objects are alloc'ed on each buffer */
+    int objectsPerBuffer;
+    /** Linked list of released objects */
+    void *pFreeObjects;
+    /** Whether the pool was initialized */
+    int isReady;
+    /** Whether the pool may be used by many threads at once */
+    int isConcurrent;
+    /** Unique identifier, used to find each thread's magazine */
+    unsigned long id;
+    /** Index of the pool on each thread's table of magazines (unique among
+     * live pools) */
+    int slot;
+    /** Protects expanding the pool, removing objects from the list of
+     * released objects and the list of magazines */
+    pthread_mutex_t lock;
+    /** Every thread's magazine */
+    poolMagazine *pMagazines;
+#if defined(FRACTION_STATS)
+    /** Number of objects currently retrieved */
+    int64_t numLive;
+    /** Most objects ever retrieved at once */
+    int64_t highWater;
+#endif
+};
+typedef struct stPool pool;
+
+/**
+ * Initializes a pool and "pre-alloc" its first buffer
+ *
+ * NOTE: The pool is only marked as ready (atomically) after everything else
+ *       is set, so pool_isReady may be used to lazily initialize it
+ *
+ * @param  [ in]pPool            The pool
+ * @param  [ in]objectSize       Size of each object, in bytes
+ * @param  [ in]objectsPerBuffer How many objects are alloc'ed at once
+ * @param  [ in]isConcurrent     Whether the pool may be used by many threads
+ * @return                       0 on success, 1 on failure
+ */
+int pool_init(pool *pPool, int objectSize, int objectsPerBuffer,
+        int isConcurrent);
+
+/**
+ * Check whether a pool was already initialized
+ *
+ * @param  [ in]pPool The pool
+ * @return            1 if it was initialized, 0 otherwise
+ */
+int pool_isReady(pool *pPool);
+
+/**
+ * Releases every buffer alloc'ed by the pool
+ *
+ * NOTE: Every object retrieved from this pool is also released!
+ *
+ * @param  [ in]pPool The pool
+ */
+void pool_clean(pool *pPool);
+
+/**
+ * Alloc/retrieve a new object
+ *
+ * @param  [out]ppOut The alloc'ed object
+ * @param  [ in]pPool The pool
+ * @return            0 on success, 1 on failure
+ */
+int pool_getObject(void **ppOut, pool *pPool);
+
+/**
+ * Releases an object, so it may be recycled
+ *
+ * @param  [ in]pPool The pool that alloc'ed the object
+ * @param  [ in]pObj  The object
+ */
+void pool_releaseObject(pool *pPool, void *pObj);
+
+/**
+ * Return every object cached by the calling thread to the pool, so other
+ * threads may recycle them
+ *
+ * @param  [ in]pPool The pool
+ */
+void pool_flushThreadCache(pool *pPool);
+
+#if defined(FRACTION_STATS)
+/**
+ * Retrieve how many objects of the pool are in use
+ *
+ * @param  [out]pOut  The pool's usage
+ * @param  [ in]pPool The pool
+ */
+void pool_getStats(fractionObjectStats *pOut, pool *pPool);
+#endif
+
+#endif /* __POOL_H__ */
+
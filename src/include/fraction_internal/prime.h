@@ -1,20 +1,96 @@
 /**
  * Handles generation of list of sequential prime numbers
  *
- * This is done through a bit-based sieve. This sieve start with all bits set to
- * 0 (which means its a prime number). Then, for every 0 bit found, all bits in
- * positions multiple of the current one are set to 1. As soon as this operation
- * is finished, the sieve is searched for the next 0 bit and the process is
- * repeated.
+ * This is done through a segmented sieve of Eratosthenes. Only numbers
+ * coprime to 2, 3, 5 and 7 (i.e., 48 of every 210 numbers) are represented in
+ * the sieve, each by a single bit. The sieve is processed in segments small
+ * enough to fit in the L1 cache: every prime up to the square root of the
+ * limit marks its multiples on the segment (skipping multiples that aren't on
+ * the wheel), and then every unmarked bit is emitted as a prime, so primes are
+ * counted and stored in a single pass.
+ *
+ * The range may also be split among many threads, each sieving its own
+ * contiguous segments. Their lists are concatenated at the end.
+ *
+ * Tables of primes start with the primes up to a given number, and are then
+ * extended on demand, sieving only the missing segments. Their capacity is
+ * doubled as needed (up to an optional maximum size). On tables shared by many
+ * threads, replaced lists are kept until the table is cleaned, so readers
+ * never see them released.
+ *
+ * Tables may also start from a list cached in a file, which is mapped
+ * read-only (so its pages are shared by every process that maps it). If the
+ * file is missing, invalid or too small, the list is sieved and then written
+ * to the file (and mapped back), for the next tables. Mapped lists are never
+ * modified: extending the table copies it into a new (alloc'ed) list, and it's
+ * only unmapped along the table.
+ *
+ * If the lib is built with FRACTION_EMBED_PRIMES, a list of primes generated
+ * at build time is stored as a constant on the lib. Tables that don't need
+ * any bigger prime simply point to it (without sieving or alloc'ing
+ * anything), and copy it only when extended.
  *
  * @file src/include/fraction_internal/prime.h
  */
 #ifndef __PRIME_H__
 #define __PRIME_H__
 
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** List of sequential primes which may grow on demand */
+struct stPrimeTable {
+    /** Every prime found so far */
+    int *pPrimes;
+    /** Number of primes on the list */
+    int numPrimes;
+    /** Number of primes alloc'ed on the list */
+    int capPrimes;
+    /** Biggest number checked for primality */
+    int maxChecked;
+    /** Maximum size of the list, in bytes (or 0, if it's unbounded) */
+    int maxBytes;
+    /** Number of threads used to sieve */
+    int numThreads;
+    /** Lists replaced by bigger ones, which are only released along the
+     * table (since other threads may be using them) */
+    int **ppRetired;
+    /** Number of replaced lists */
+    int numRetired;
+    /** Read-only mapping of the cache file the table started from (if
+     * any), which is only unmapped along the table */
+    void *pMap;
+    /** Size of the mapping, in bytes */
+    size_t mapSize;
+    /** Whether the list of primes is the mapped one */
+    int isMapped;
+    /** Whether the list of primes is the one embedded into the lib */
+    int isEmbedded;
+    /** Whether the table may be used by many threads at once */
+    int isConcurrent;
+    /** Protects extending the table */
+    pthread_mutex_t lock;
+#if defined(FRACTION_STATS)
+    /** Number of numbers factored through the table */
+    uint64_t numFactorizations;
+    /** Number of trial divisions by the table's primes */
+    uint64_t numTrialDivisions;
+#endif
+};
+typedef struct stPrimeTable primeTable;
+
+#if defined(FRACTION_EMBED_PRIMES)
+/** Every prime up to prime_embeddedMax, generated at build time */
+extern const int prime_embedded[];
+/** Number of primes on the embedded list */
+extern const int prime_numEmbedded;
+/** Biggest number checked for primality on the embedded list */
+extern const int prime_embeddedMax;
+#endif
+
 /**
- * Create a list of primes that goes up to the prime closest to maxNumberChecked
- * rounded up to the nearest 8 multiple
+ * Create a list of every prime up to maxNumberChecked
  *
  * @param  [out]ppList           The list of sequencial primes
  * @param  [out]pLen             How many numbers there are in the list
@@ -23,5 +99,119 @@
  */
 int prime_genPrimeList(int **ppList, int *pLen, int maxNumberChecked);
 
+/**
+ * Create a list of every prime up to maxNumberChecked, splitting the sieve
+ * among many threads
+ *
+ * @param  [out]ppList           The list of sequencial primes
+ * @param  [out]pLen             How many numbers there are in the list
+ * @param  [ in]maxNumberChecked Biggest number to be checked for primality
+ * @param  [ in]numThreads       Number of threads used to sieve
+ * @return                       0 on success, 1 on failure
+ */
+int prime_genPrimeListThreaded(int **ppList, int *pLen, int maxNumberChecked,
+        int numThreads);
+
+/**
+ * Initializes a table of primes, which may later grow on demand
+ *
+ * @param  [ in]pTable           The table
+ * @param  [ in]maxNumberChecked Biggest number initially checked for primality
+ * @param  [ in]numThreads       Number of threads used to sieve
+ * @param  [ in]maxBytes         Maximum size of the table, in bytes (or 0, if
+ *                               it may grow without bounds)
+ * @param  [ in]isConcurrent     Whether the table may be used by many threads
+ * @return                       0 on success, 1 on failure
+ */
+int prime_initTable(primeTable *pTable, int maxNumberChecked, int numThreads,
+        int maxBytes, int isConcurrent);
+
+/**
+ * Initializes a table of primes from a cache file, which may later grow on
+ * demand
+ *
+ * If the file doesn't have every prime up to maxNumberChecked, the list is
+ * sieved and then the file is (re)written. Failing to write the file isn't
+ * an error, as the table is still usable
+ *
+ * @param  [ in]pTable           The table
+ * @param  [ in]pPath            Path of the cache file
+ * @param  [ in]maxNumberChecked Biggest number initially checked for primality
+ * @param  [ in]numThreads       Number of threads used to sieve
+ * @param  [ in]maxBytes         Maximum size of the table, in bytes (or 0, if
+ *                               it may grow without bounds)
+ * @param  [ in]isConcurrent     Whether the table may be used by many threads
+ * @return                       0 on success, 1 on failure
+ */
+int prime_initTableCached(primeTable *pTable, const char *pPath,
+        int maxNumberChecked, int numThreads, int maxBytes, int isConcurrent);
+
+/**
+ * Replace the table's list by the one on a cache file, mapping it read-only
+ *
+ * NOTE: This must only be called on tables that were just initialized (and
+ *       aren't used by other threads yet)
+ *
+ * @param  [ in]pTable           The table
+ * @param  [ in]pPath            Path of the cache file
+ * @param  [ in]maxNumberChecked Biggest number that must have been checked
+ *                               for primality on the file
+ * @return                       0 on success, 1 if the file is missing,
+ *                               invalid (or from another version of the
+ *                               lib) or too small
+ */
+int prime_mapCache(primeTable *pTable, const char *pPath,
+        int maxNumberChecked);
+
+/**
+ * Write every prime currently on the table to a cache file
+ *
+ * The list is written to a temporary file (on the same directory), which then
+ * replaces the cache file, so readers never see partially written files
+ *
+ * @param  [ in]pPath  Path of the cache file
+ * @param  [ in]pTable The table
+ * @return             0 on success, 1 on failure
+ */
+int prime_writeCache(const char *pPath, primeTable *pTable);
+
+/**
+ * Release the table's mapped cache file (if any)
+ *
+ * @param  [ in]pTable The table
+ */
+void prime_unmapCache(primeTable *pTable);
+
+/**
+ * Releases every list alloc'ed by the table
+ *
+ * @param  [ in]pTable The table
+ */
+void prime_cleanTable(primeTable *pTable);
+
+/**
+ * Make sure that every prime up to a given number is on the table, extending
+ * it (one whole sieve segment at a time) if needed
+ *
+ * @param  [ in]pTable The table
+ * @param  [ in]value  The number
+ * @return             0 on success, 1 on failure (e.g., if the table would
+ *                     grow bigger than its maximum size)
+ */
+int prime_ensure(primeTable *pTable, int value);
+
+/**
+ * Retrieve every prime currently on the table
+ *
+ * NOTE: On concurrent tables, the list stays valid (although it may not
+ *       grow) until the table is cleaned, even if other threads extend it.
+ *       Otherwise, it's only valid until the table is extended
+ *
+ * @param  [out]ppList The list of sequencial primes
+ * @param  [out]pLen   How many numbers there are in the list
+ * @param  [ in]pTable The table
+ */
+void prime_getList(const int **ppList, int *pLen, primeTable *pTable);
+
 #endif /* __PRIME_H__ */
 
@@ -0,0 +1,65 @@
+/**
+ * Table with the smallest prime factor of every odd number up to a limit,
+ * used to factor numbers in as many lookups as they have prime factors
+ *
+ * The table is built by a linear sieve, which marks every composite exactly
+ * once (as its smallest prime factor times a cofactor). Since even numbers are
+ * factored by counting trailing zeros, only odd numbers are stored, on 16 bits
+ * entries: the smallest factor of an odd composite up to 2^31 is never bigger
+ * than its square root, and primes are stored as 0.
+ *
+ * @file src/include/fraction_internal/spf.h
+ */
+#ifndef __SPF_H__
+#define __SPF_H__
+
+#include <fraction_internal/prime.h>
+
+#include <stdint.h>
+
+/** Smallest prime factor of every odd number up to a limit */
+struct stSpfTable {
+    /** Smallest prime factor of every odd number (as n / 2), or 0 for
+     * primes */
+    uint16_t *pEntries;
+    /** Biggest number on the table */
+    int limit;
+};
+typedef struct stSpfTable spfTable;
+
+/**
+ * Initializes a table of smallest prime factors
+ *
+ * @param  [ in]pTable The table
+ * @param  [ in]limit  Biggest number on the table
+ * @return             0 on success, 1 on failure
+ */
+int spf_init(spfTable *pTable, int limit);
+
+/**
+ * Releases a table of smallest prime factors
+ *
+ * @param  [ in]pTable The table
+ */
+void spf_clean(spfTable *pTable);
+
+/**
+ * Factor a positive number into primes (in increasing order). Factors bigger
+ * than the table's limit are found through trial division by the table of
+ * primes, until the remaining cofactor is on the table
+ *
+ * @param  [out]pFactors     The number's distinct prime factors (there are at
+ *                           most 9 of them)
+ * @param  [out]pExponents   The exponent of each prime factor
+ * @param  [out]pNumFactors  Number of distinct prime factors
+ * @param  [ in]pTable       The table (may be NULL, to only use trial
+ *                           division)
+ * @param  [ in]pPrimeTable  Table of primes, extended as needed
+ * @param  [ in]value        The number
+ * @return                   0 on success, 1 on failure
+ */
+int spf_factor(int *pFactors, int *pExponents, int *pNumFactors,
+        spfTable *pTable, primeTable *pPrimeTable, uint32_t value);
+
+#endif /* __SPF_H__ */
+
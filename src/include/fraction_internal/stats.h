@@ -0,0 +1,30 @@
+/**
+ * Performance counters, only compiled if FRACTION_STATS is defined
+ *
+ * Counters are updated through relaxed atomic increments, so they are safe
+ * on concurrent managers but never order (nor synchronize) anything else.
+ * When FRACTION_STATS isn't defined, every macro expands to nothing (and
+ * its arguments aren't even evaluated), so the counters don't need to exist.
+ *
+ * @file src/include/fraction_internal/stats.h
+ */
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#if defined(FRACTION_STATS)
+/** Increment a counter */
+#  define STATS_INC(counter) \
+        __atomic_add_fetch(&(counter), 1, __ATOMIC_RELAXED)
+/** Add a value to a counter */
+#  define STATS_ADD(counter, val) \
+        __atomic_add_fetch(&(counter), (val), __ATOMIC_RELAXED)
+/** Read a counter */
+#  define STATS_LOAD(counter) \
+        __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#else
+#  define STATS_INC(counter) do {} while (0)
+#  define STATS_ADD(counter, val) do {} while (0)
+#endif
+
+#endif /* __STATS_H__ */
+
@@ -0,0 +1,158 @@
+/**
+ * Sampled tracing of the manager's operations, only compiled if
+ * FRACTION_TRACE is defined
+ *
+ * Each thread counts down the operations it executes and, every N of them
+ * (N being the manager's trace interval, on average), one is sampled: its
+ * operands' magnitudes, how many times it reduced a fraction and its
+ * duration (in ticks of the time-stamp counter, if there's one) are
+ * recorded. Unsampled operations only decrement the (thread local) counter.
+ * The actual distance between samples is randomized (between 1 and 2N - 1),
+ * so loops with a period that divides N don't always sample the same
+ * operation.
+ *
+ * Sampled events are pushed into a bounded ring owned by the manager. Many
+ * threads may push at once, each claiming a slot through a compare-and-swap
+ * on the ring's head. Every slot has a sequence number, which tells whether
+ * it's free, being written or ready to be read, so a single consumer may
+ * drain the ring while it's being written (without any lock). Events are
+ * dropped (and counted) if the ring is full.
+ *
+ * When FRACTION_TRACE isn't defined, every macro expands to nothing.
+ *
+ * @file src/include/fraction_internal/trace.h
+ */
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <fraction/fraction.h>
+
+#include <stdint.h>
+
+#if defined(FRACTION_TRACE)
+
+/** A slot on the ring of events */
+struct stTraceSlot {
+    /** Sequence number: equal to the slot's position when it's free, and to
+     * its position plus one when it holds an event */
+    uint64_t seq;
+    /** The event */
+    fractionTraceEvent event;
+};
+typedef struct stTraceSlot traceSlot;
+
+/** Bounded ring of sampled events, written by many threads and drained by
+ * a single one */
+struct stTraceRing {
+    /** Every slot of the ring */
+    traceSlot *pSlots;
+    /** Number of slots minus one (the number of slots is a power of two) */
+    uint64_t mask;
+    /** Trace 1 in every 'interval' operations (or nothing, if 0) */
+    int interval;
+    /** Keep the producers' and consumer's positions on their own cache
+     * lines */
+    char pad0[64];
+    /** Position where the next event is written */
+    uint64_t head;
+    /** Number of events dropped because the ring was full */
+    uint64_t numDropped;
+    char pad1[64];
+    /** Position where the next event is read */
+    uint64_t tail;
+};
+typedef struct stTraceRing traceRing;
+
+/** State of the calling thread's trace point */
+struct stTraceSpan {
+    /** Operations left until the next sampled one */
+    int countdown;
+    /** Whether the current operation is being sampled */
+    int isSampled;
+    /** Number of reductions done by the current operation */
+    int numSimplifications;
+    /** Bits on the biggest term of each operand */
+    int bitsA;
+    int bitsB;
+    /** When the current operation started */
+    uint64_t start;
+    /** State of the generator that randomizes the distance between
+     * samples */
+    uint32_t seed;
+    /** The manager that executes the current operation */
+    fractionManager *pManager;
+};
+typedef struct stTraceSpan traceSpan;
+
+/** The calling thread's trace point */
+extern __thread traceSpan trace_span;
+
+/**
+ * Initializes a ring of events
+ *
+ * @param  [ in]pRing    The ring
+ * @param  [ in]capacity Minimum number of events on the ring
+ * @param  [ in]interval Trace 1 in every 'interval' operations (or nothing, if
+ *                       0)
+ * @return               0 on success, 1 on failure
+ */
+int trace_init(traceRing *pRing, int capacity, int interval);
+
+/**
+ * Releases a ring of events
+ *
+ * @param  [ in]pRing The ring
+ */
+void trace_clean(traceRing *pRing);
+
+/**
+ * Start sampling the calling thread's current operation (unless the manager
+ * doesn't trace anything)
+ *
+ * @param  [ in]pMng The fraction manager
+ * @param  [ in]numA The first operand's numerator
+ * @param  [ in]denA The first operand's denominator
+ * @param  [ in]numB The second operand's numerator
+ * @param  [ in]denB The second operand's denominator
+ */
+void trace_begin(fractionManager *pMng, int64_t numA, int64_t denA,
+        int64_t numB, int64_t denB);
+
+/**
+ * Finish sampling the calling thread's current operation, pushing it into
+ * the manager's ring
+ *
+ * @param  [ in]op The operation (one of FRACTION_TRACE_*)
+ */
+void trace_end(int op);
+
+/** Start a trace point, sampling it if it's the thread's turn */
+#  define TRACE_BEGIN(pMng, numA, denA, numB, denB) \
+    do { \
+      if (--trace_span.countdown <= 0) { \
+        trace_begin((pMng), (numA), (denA), (numB), (denB)); \
+      } \
+    } while (0)
+/** Finish a trace point, recording it if it was sampled */
+#  define TRACE_END(op) \
+    do { \
+      if (trace_span.isSampled) { \
+        trace_end(op); \
+      } \
+    } while (0)
+/** Count a reduction on the current trace point */
+#  define TRACE_SIMPLIFY() \
+    do { \
+      trace_span.numSimplifications++; \
+    } while (0)
+
+#else
+
+#  define TRACE_BEGIN(pMng, numA, denA, numB, denB) do {} while (0)
+#  define TRACE_END(op) do {} while (0)
+#  define TRACE_SIMPLIFY() do {} while (0)
+
+#endif /* FRACTION_TRACE */
+
+#endif /* __TRACE_H__ */
+
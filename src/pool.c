@@ -0,0 +1,622 @@
+/**
+ * Recycles objects of a fixed size
+ *
+ * Objects are alloc'ed in buffers of many objects at once, and those buffers
+ * are only released when the pool itself is cleaned. Therefore, an object is
+ * never moved around after it has been retrieved, no matter how much the pool
+ * grows. Released objects are kept on a linked list (which uses the object's
+ * own memory), so they may be recycled later.
+ *
+ * A pool may also be shared by many threads. In that case, each thread keeps
+ * a small cache (a magazine) of free objects, so most retrievals and releases
+ * don't synchronize at all. Full magazines are flushed to the pool's list of
+ * free objects in chains, through a single atomic compare-and-swap. Empty
+ * magazines are refilled from that list (or from a new buffer) while holding
+ * the pool's lock, so only a single thread ever removes objects from the list
+ * (which avoids the ABA problem). Since buffers never move, expanding the
+ * pool never invalidates objects used by other threads.
+ *
+ * @file src/pool.c
+ */
+#include <fraction_internal/pool.h>
+#include <fraction_internal/stats.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Minimum number of slots on each thread's table of magazines */
+#define POOL_THREAD_SLOTS 16
+
+/** Reference to the magazine of the calling thread for a given pool */
+struct stPoolThreadSlot {
+    /** The pool's identifier */
+    unsigned long poolId;
+    /** The magazine */
+    poolMagazine *pMagazine;
+};
+typedef struct stPoolThreadSlot poolThreadSlot;
+
+/** The calling thread's magazines, indexed by the pool's slot. Live pools
+ * never share a slot, but slots of cleaned pools are reused, so the pool's
+ * identifier must also match (identifiers are never reused, so stale entries
+ * never match) */
+static __thread poolThreadSlot *pool_pThreadSlots = 0;
+/** Number of entries on the calling thread's table of magazines */
+static __thread int pool_numThreadSlots = 0;
+/** Releases each thread's table of magazines when the thread exits */
+static pthread_key_t pool_threadSlotsKey;
+static pthread_once_t pool_threadSlotsOnce = PTHREAD_ONCE_INIT;
+
+/** Protects giving slots to pools and releasing them */
+static pthread_mutex_t pool_slotsLock = PTHREAD_MUTEX_INITIALIZER;
+/** Slots released by cleaned pools (there's room for every slot, so
+ * releasing one never fails) */
+static int *pool_pFreeSlots = 0;
+/** Number of released slots */
+static int pool_numFreeSlots = 0;
+/** Number of slots ever given to pools */
+static int pool_numSlots = 0;
+/** Last identifier given to a concurrent pool */
+static unsigned long pool_lastId = 0;
+
+/**
+ * Retrieve a slot that isn't used by any other live pool
+ *
+ * @param  [out]pSlot The slot
+ * @return            0 on success, 1 on failure
+ */
+static int pool_getSlot(int *pSlot) {
+    int irv;
+
+    irv = 0;
+    pthread_mutex_lock(&pool_slotsLock);
+    if (pool_numFreeSlots > 0) {
+        pool_numFreeSlots--;
+        *pSlot = pool_pFreeSlots[pool_numFreeSlots];
+    }
+    else {
+        int *pFreeSlots;
+
+        pFreeSlots = (int*)realloc(pool_pFreeSlots,
+                sizeof(int) * (pool_numSlots + 1));
+        if (pFreeSlots) {
+            pool_pFreeSlots = pFreeSlots;
+            *pSlot = pool_numSlots;
+            pool_numSlots++;
+        }
+        else {
+            irv = 1;
+        }
+    }
+    pthread_mutex_unlock(&pool_slotsLock);
+
+    return irv;
+}
+
+/**
+ * Release a slot, so it may be reused by another pool
+ *
+ * @param  [ in]slot The slot
+ */
+static void pool_releaseSlot(int slot) {
+    pthread_mutex_lock(&pool_slotsLock);
+    pool_pFreeSlots[pool_numFreeSlots] = slot;
+    pool_numFreeSlots++;
+    pthread_mutex_unlock(&pool_slotsLock);
+}
+
+/**
+ * Create the key that releases the tables of magazines of finished threads
+ */
+static void pool_initThreadSlotsKey() {
+    pthread_key_create(&pool_threadSlotsKey, free);
+}
+
+/**
+ * Retrieve the calling thread's entry for a given slot, expanding the
+ * thread's table if required
+ *
+ * @param  [ in]slot The slot
+ * @return           The entry (or NULL, if the table couldn't be expanded)
+ */
+static poolThreadSlot* pool_getThreadSlot(int slot) {
+    poolThreadSlot *pSlots;
+    int num;
+
+    if (slot < pool_numThreadSlots) {
+        return &(pool_pThreadSlots[slot]);
+    }
+
+    num = pool_numThreadSlots * 2;
+    if (num < POOL_THREAD_SLOTS) {
+        num = POOL_THREAD_SLOTS;
+    }
+    if (num <= slot) {
+        num = slot + 1;
+    }
+    pthread_once(&pool_threadSlotsOnce, pool_initThreadSlotsKey);
+    pSlots = (poolThreadSlot*)realloc(pool_pThreadSlots,
+            sizeof(poolThreadSlot) * num);
+    if (!pSlots) {
+        return 0;
+    }
+    memset(pSlots + pool_numThreadSlots, 0x0,
+            sizeof(poolThreadSlot) * (num - pool_numThreadSlots));
+    pthread_setspecific(pool_threadSlotsKey, pSlots);
+    pool_pThreadSlots = pSlots;
+    pool_numThreadSlots = num;
+
+    return &(pSlots[slot]);
+}
+
+/**
+ * Alloc a new buffer and append it to the pool's list of buffers
+ *
+ * @param  [ in]pPool The pool
+ * @return            0 on success, 1 on failure
+ */
+static int pool_expand(pool *pPool) {
+    poolBuffer *pBuffer, **ppBuffers;
+
+    /* Alloc the buffer itself */
+    pBuffer = (poolBuffer*)malloc(sizeof(poolBuffer));
+    if (!pBuffer) {
+        return 1;
+    }
+    memset(pBuffer, 0x0, sizeof(poolBuffer));
+
+    pBuffer->numObjects = pPool->objectsPerBuffer;
+    pBuffer->pObjects = (char*)malloc(pPool->objectSize *
+            pBuffer->numObjects);
+    if (!pBuffer->pObjects) {
+        free(pBuffer);
+        return 1;
+    }
+
+    /* Store it in the list */
+    ppBuffers = (poolBuffer**)realloc(pPool->ppBuffers,
+            sizeof(poolBuffer*) * (pPool->numBuffers + 1));
+    if (!ppBuffers) {
+        free(pBuffer->pObjects);
+        free(pBuffer);
+        return 1;
+    }
+    ppBuffers[pPool->numBuffers] = pBuffer;
+    pPool->ppBuffers = ppBuffers;
+    pPool->numBuffers++;
+
+    return 0;
+}
+
+/**
+ * Initializes a pool and "pre-alloc" its first buffer
+ *
+ * @param  [ in]pPool            The pool
+ * @param  [ in]objectSize       Size of each object, in bytes
+ * @param  [ in]objectsPerBuffer How many objects are alloc'ed at once
+ * @return                       0 on success, 1 on failure
+ */
+int pool_init(pool *pPool, int objectSize, int objectsPerBuffer,
+        int isConcurrent) {
+    int irv;
+
+    /* Released objects store the next one on the list, so they must be at
+     * least as big (and aligned) as a pointer */
+    if (objectSize < (int)sizeof(void*)) {
+        objectSize = (int)sizeof(void*);
+    }
+    objectSize = (objectSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    /* Every field is set individually (instead of clearing the pool), so
+     * threads checking whether the pool is ready never race against it */
+    pPool->ppBuffers = 0;
+    pPool->numBuffers = 0;
+    pPool->objectSize = objectSize;
+    pPool->objectsPerBuffer = objectsPerBuffer;
+    pPool->pFreeObjects = 0;
+    pPool->isConcurrent = isConcurrent;
+    pPool->pMagazines = 0;
+#if defined(FRACTION_STATS)
+    pPool->numLive = 0;
+    pPool->highWater = 0;
+#endif
+    if (isConcurrent) {
+        /* Failed pools are left as non-concurrent, so cleaning them doesn't
+         * release anything twice */
+        if (pool_getSlot(&(pPool->slot)) != 0) {
+            pPool->isConcurrent = 0;
+            return 1;
+        }
+        pPool->id = __atomic_add_fetch(&pool_lastId, 1, __ATOMIC_RELAXED);
+        if (pthread_mutex_init(&(pPool->lock), 0) != 0) {
+            pool_releaseSlot(pPool->slot);
+            pPool->isConcurrent = 0;
+            return 1;
+        }
+    }
+
+    irv = pool_expand(pPool);
+    if (irv != 0) {
+        pool_clean(pPool);
+        return irv;
+    }
+
+    /* Only publish the pool after everything else is set */
+    __atomic_store_n(&(pPool->isReady), 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Check whether a pool was already initialized
+ *
+ * @param  [ in]pPool The pool
+ * @return            1 if it was initialized, 0 otherwise
+ */
+int pool_isReady(pool *pPool) {
+    return __atomic_load_n(&(pPool->isReady), __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Releases every buffer alloc'ed by the pool
+ *
+ * NOTE: Every object retrieved from this pool is also released!
+ *
+ * @param  [ in]pPool The pool
+ */
+void pool_clean(pool *pPool) {
+    if (pPool->ppBuffers) {
+        int i;
+
+        i = 0;
+        while (i < pPool->numBuffers) {
+            if (pPool->ppBuffers[i]) {
+                if (pPool->ppBuffers[i]->pObjects) {
+                    free(pPool->ppBuffers[i]->pObjects);
+                }
+                free(pPool->ppBuffers[i]);
+            }
+            i++;
+        }
+
+        free(pPool->ppBuffers);
+    }
+
+    if (pPool->isConcurrent) {
+        while (pPool->pMagazines) {
+            poolMagazine *pMag;
+
+            pMag = pPool->pMagazines;
+            pPool->pMagazines = pMag->pNext;
+            free(pMag);
+        }
+        pthread_mutex_destroy(&(pPool->lock));
+        pool_releaseSlot(pPool->slot);
+    }
+
+    memset(pPool, 0x0, sizeof(pool));
+}
+
+/**
+ * Retrieve an object that was never used, expanding the pool if required
+ *
+ * @param  [out]ppOut The alloc'ed object
+ * @param  [ in]pPool The pool
+ * @return            0 on success, 1 on failure
+ */
+static int pool_getUnusedObject(void **ppOut, pool *pPool) {
+    poolBuffer *pCurBuffer;
+
+    pCurBuffer = pPool->ppBuffers[pPool->numBuffers - 1];
+    if (pCurBuffer->usedObjects >= pCurBuffer->numObjects) {
+        if (pool_expand(pPool) != 0) {
+            return 1;
+        }
+        pCurBuffer = pPool->ppBuffers[pPool->numBuffers - 1];
+    }
+
+    *ppOut = pCurBuffer->pObjects + pCurBuffer->usedObjects *
+            pPool->objectSize;
+    pCurBuffer->usedObjects++;
+
+    return 0;
+}
+
+/**
+ * Retrieve the calling thread's magazine, creating it if needed
+ *
+ * @param  [ in]pPool The pool
+ * @return            The magazine (or NULL, if it couldn't be alloc'ed)
+ */
+static poolMagazine* pool_getMagazine(pool *pPool) {
+    poolThreadSlot *pSlot;
+    poolMagazine *pMag;
+    pthread_t self;
+
+    pSlot = pool_getThreadSlot(pPool->slot);
+    if (pSlot && pSlot->poolId == pPool->id) {
+        return pSlot->pMagazine;
+    }
+
+    /* Look for the thread's magazine (a new thread may also reuse the
+     * magazine of a finished thread with the same id) */
+    self = pthread_self();
+    pthread_mutex_lock(&(pPool->lock));
+    pMag = pPool->pMagazines;
+    while (pMag && !pthread_equal(pMag->owner, self)) {
+        pMag = pMag->pNext;
+    }
+    if (!pMag) {
+        pMag = (poolMagazine*)malloc(sizeof(poolMagazine));
+        if (pMag) {
+            memset(pMag, 0x0, sizeof(poolMagazine));
+            pMag->owner = self;
+            pMag->pNext = pPool->pMagazines;
+            pPool->pMagazines = pMag;
+        }
+    }
+    pthread_mutex_unlock(&(pPool->lock));
+
+    if (pMag && pSlot) {
+        pSlot->poolId = pPool->id;
+        pSlot->pMagazine = pMag;
+    }
+    return pMag;
+}
+
+/**
+ * Atomically push a chain of objects into the list of released objects
+ *
+ * @param  [ in]pPool  The pool
+ * @param  [ in]pFirst The first object on the chain
+ * @param  [ in]pLast  The last object on the chain
+ */
+static void pool_pushChain(pool *pPool, void *pFirst, void *pLast) {
+    void *pHead;
+
+    pHead = __atomic_load_n(&(pPool->pFreeObjects), __ATOMIC_RELAXED);
+    do {
+        *((void**)pLast) = pHead;
+    } while (!__atomic_compare_exchange_n(&(pPool->pFreeObjects), &pHead,
+            pFirst, 1/*weak*/, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * Retrieve an object from a pool shared by many threads, refilling the
+ * calling thread's magazine if it's empty
+ *
+ * @param  [out]ppOut The alloc'ed object
+ * @param  [ in]pPool The pool
+ * @return            0 on success, 1 on failure
+ */
+static int pool_getObjectConcurrent(void **ppOut, pool *pPool) {
+    poolMagazine *pMag;
+    void *pFirst, *pLast, *pHead;
+    int irv, max, num;
+
+    pMag = pool_getMagazine(pPool);
+    if (pMag && pMag->numObjects > 0) {
+        pMag->numObjects--;
+        *ppOut = pMag->ppObjects[pMag->numObjects];
+        return 0;
+    }
+
+    /* Refill half of the magazine (or retrieve a single object, if there's
+     * no magazine) */
+    max = 1;
+    if (pMag) {
+        max += POOL_MAGAZINE_SIZE / 2;
+    }
+
+    pthread_mutex_lock(&(pPool->lock));
+
+    /* Detach a chain from the list. Since no other thread removes objects
+     * concurrently, the chain below the head never changes (new objects may
+     * only be pushed on top of it, failing the exchange) */
+    pHead = __atomic_load_n(&(pPool->pFreeObjects), __ATOMIC_ACQUIRE);
+    do {
+        pFirst = pHead;
+        pLast = pHead;
+        num = 0;
+        if (pHead) {
+            num = 1;
+            while (num < max && *((void**)pLast)) {
+                pLast = *((void**)pLast);
+                num++;
+            }
+        }
+    } while (pHead && !__atomic_compare_exchange_n(&(pPool->pFreeObjects),
+            &pHead, *((void**)pLast), 1/*weak*/, __ATOMIC_ACQUIRE,
+            __ATOMIC_ACQUIRE));
+
+    /* Move the detached chain into the output and the magazine */
+    irv = 0;
+    if (num > 0) {
+        *ppOut = pFirst;
+        pFirst = *((void**)pFirst);
+        num--;
+        while (num > 0) {
+            pMag->ppObjects[pMag->numObjects] = pFirst;
+            pMag->numObjects++;
+            pFirst = *((void**)pFirst);
+            num--;
+        }
+    }
+    else {
+        /* Otherwise, use objects that were never retrieved */
+        irv = pool_getUnusedObject(ppOut, pPool);
+        while (irv == 0 && pMag && pMag->numObjects < max - 1) {
+            if (pool_getUnusedObject(&(pMag->ppObjects[pMag->numObjects]),
+                    pPool) != 0) {
+                break;
+            }
+            pMag->numObjects++;
+        }
+    }
+
+    pthread_mutex_unlock(&(pPool->lock));
+
+    return irv;
+}
+
+/**
+ * Releases an object into a pool shared by many threads, flushing half of
+ * the calling thread's magazine if it's full
+ *
+ * @param  [ in]pPool The pool that alloc'ed the object
+ * @param  [ in]pObj  The object
+ */
+static void pool_releaseObjectConcurrent(pool *pPool, void *pObj) {
+    poolMagazine *pMag;
+    void *pLast;
+
+    pMag = pool_getMagazine(pPool);
+    if (pMag && pMag->numObjects < POOL_MAGAZINE_SIZE) {
+        pMag->ppObjects[pMag->numObjects] = pObj;
+        pMag->numObjects++;
+        return;
+    }
+
+    /* Chain the object with half of the magazine and push them at once */
+    pLast = pObj;
+    while (pMag && pMag->numObjects > POOL_MAGAZINE_SIZE / 2) {
+        pMag->numObjects--;
+        *((void**)pLast) = pMag->ppObjects[pMag->numObjects];
+        pLast = pMag->ppObjects[pMag->numObjects];
+    }
+    pool_pushChain(pPool, pObj, pLast);
+}
+
+#if defined(FRACTION_STATS)
+/**
+ * Count a retrieved object, updating the pool's high-water mark
+ *
+ * @param  [ in]pPool The pool
+ */
+static void pool_countRetrieved(pool *pPool) {
+    int64_t live, max;
+
+    live = STATS_INC(pPool->numLive);
+    max = STATS_LOAD(pPool->highWater);
+    while (live > max && !__atomic_compare_exchange_n(&(pPool->highWater),
+            &max, live, 1/*weak*/, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+#endif
+
+/**
+ * Alloc/retrieve a new object
+ *
+ * @param  [out]ppOut The alloc'ed object
+ * @param  [ in]pPool The pool
+ * @return            0 on success, 1 on failure
+ */
+int pool_getObject(void **ppOut, pool *pPool) {
+    int irv;
+
+    if (pPool->isConcurrent) {
+        irv = pool_getObjectConcurrent(ppOut, pPool);
+    }
+    else if (pPool->pFreeObjects) {
+        /* Try to recycle a reference */
+        *ppOut = pPool->pFreeObjects;
+        pPool->pFreeObjects = *((void**)pPool->pFreeObjects);
+        irv = 0;
+    }
+    else {
+        /* Otherwise, try to retrieve an already alloc'ed object or expand
+         * the buffer */
+        irv = pool_getUnusedObject(ppOut, pPool);
+    }
+
+#if defined(FRACTION_STATS)
+    if (irv == 0) {
+        pool_countRetrieved(pPool);
+    }
+#endif
+    return irv;
+}
+
+/**
+ * Releases an object, so it may be recycled
+ *
+ * @param  [ in]pPool The pool that alloc'ed the object
+ * @param  [ in]pObj  The object
+ */
+void pool_releaseObject(pool *pPool, void *pObj) {
+    STATS_ADD(pPool->numLive, -1);
+
+    if (pPool->isConcurrent) {
+        pool_releaseObjectConcurrent(pPool, pObj);
+        return;
+    }
+
+    /* Append it to the list of freed objects */
+    *((void**)pObj) = pPool->pFreeObjects;
+    pPool->pFreeObjects = pObj;
+}
+
+/**
+ * Return every object cached by the calling thread to the pool, so other
+ * threads may recycle them
+ *
+ * @param  [ in]pPool The pool
+ */
+void pool_flushThreadCache(pool *pPool) {
+    poolMagazine *pMag;
+    void *pFirst, *pLast;
+
+    if (!pPool->isConcurrent) {
+        return;
+    }
+
+    pMag = pool_getMagazine(pPool);
+    if (!pMag || pMag->numObjects == 0) {
+        return;
+    }
+
+    pMag->numObjects--;
+    pFirst = pMag->ppObjects[pMag->numObjects];
+    pLast = pFirst;
+    while (pMag->numObjects > 0) {
+        pMag->numObjects--;
+        *((void**)pLast) = pMag->ppObjects[pMag->numObjects];
+        pLast = pMag->ppObjects[pMag->numObjects];
+    }
+    pool_pushChain(pPool, pFirst, pLast);
+}
+
+#if defined(FRACTION_STATS)
+/**
+ * Retrieve how many objects of the pool are in use
+ *
+ * @param  [out]pOut  The pool's usage
+ * @param  [ in]pPool The pool
+ */
+void pool_getStats(fractionObjectStats *pOut, pool *pPool) {
+    int64_t numRetrieved;
+    int i;
+
+    /* Buffers may only be appended while holding the lock */
+    if (pPool->isConcurrent) {
+        pthread_mutex_lock(&(pPool->lock));
+    }
+    numRetrieved = 0;
+    i = 0;
+    while (i < pPool->numBuffers) {
+        numRetrieved += pPool->ppBuffers[i]->usedObjects;
+        i++;
+    }
+    pOut->numBuffers = pPool->numBuffers;
+    if (pPool->isConcurrent) {
+        pthread_mutex_unlock(&(pPool->lock));
+    }
+
+    /* Objects cached by threads are also counted as free */
+    pOut->numLive = STATS_LOAD(pPool->numLive);
+    pOut->numFree = numRetrieved - pOut->numLive;
+    pOut->highWater = STATS_LOAD(pPool->highWater);
+}
+#endif
+
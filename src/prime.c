@@ -1,22 +1,523 @@
 /**
  * Handles generation of list of sequential prime numbers
  *
- * This is done through a bit-based sieve. This sieve start with all bits set to
- * 0 (which means its a prime number). Then, for every 0 bit found, all bits in
- * positions multiple of the current one are set to 1. As soon as this operation
- * is finished, the sieve is searched for the next 0 bit and the process is
- * repeated.
+ * This is done through a segmented sieve of Eratosthenes. Only numbers
+ * coprime to 2, 3, 5 and 7 (i.e., 48 of every 210 numbers) are represented in
+ * the sieve, each by a single bit. The sieve is processed in segments small
+ * enough to fit in the L1 cache: every prime up to the square root of the
+ * limit marks its multiples on the segment (skipping multiples that aren't on
+ * the wheel), and then every unmarked bit is emitted as a prime, so primes are
+ * counted and stored in a single pass.
+ *
+ * The range may also be split among many threads, each sieving its own
+ * contiguous segments. Their lists are concatenated at the end.
+ *
+ * Tables of primes start with the primes up to a given number, and are then
+ * extended on demand, sieving only the missing segments. Their capacity is
+ * doubled as needed (up to an optional maximum size). On tables shared by many
+ * threads, replaced lists are kept until the table is cleaned, so readers
+ * never see them released.
  *
  * @file src/prime.c
  */
 #include <fraction_internal/prime.h>
 
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+/** Product of the primes on the wheel (2, 3, 5 and 7) */
+#define PRIME_WHEEL 210
+/** Numbers coprime to the wheel on each of its turns */
+#define PRIME_WHEEL_SPOKES 48
+/** Number of wheel turns on each segment (48 bits each, so 32256 bytes) */
+#define PRIME_SEGMENT_TURNS 5376
+/** Number of 64 bits words on each segment */
+#define PRIME_SEGMENT_WORDS (PRIME_SEGMENT_TURNS * PRIME_WHEEL_SPOKES / 64)
+
+/** Primes on the wheel, which aren't represented on the sieve */
+static const int prime_wheelPrimes[4] = {2, 3, 5, 7};
+
+/** Every number on a wheel turn coprime to it */
+static const int prime_spokes[PRIME_WHEEL_SPOKES] = {
+      1,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,
+     53,  59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103,
+    107, 109, 113, 121, 127, 131, 137, 139, 143, 149, 151, 157,
+    163, 167, 169, 173, 179, 181, 187, 191, 193, 197, 199, 209
+};
+
+/** Bit of each residue modulo the wheel (-1 if it isn't coprime to it) */
+static signed char prime_spokeBit[PRIME_WHEEL];
+/** Spoke of the first residue equal or bigger than each residue */
+static signed char prime_nextSpoke[PRIME_WHEEL];
+/** Whether both tables above were initialized */
+static int prime_isWheelReady = 0;
+
+/** A prime used to sieve, along the next multiple to be marked (as
+ * turn * PRIME_WHEEL + residue) */
+struct stPrimeSieving {
+    /** The prime */
+    int64_t prime;
+    /** Turn of the next multiple */
+    int64_t turn;
+    /** Residue of the next multiple */
+    int residue;
+    /** Spoke of the next multiple's cofactor */
+    int spoke;
+};
+typedef struct stPrimeSieving primeSieving;
+
+/** Range sieved by a single thread */
+struct stPrimeTask {
+    /** Every prime used for sieving */
+    const int *pSievingPrimes;
+    /** Number of sieving primes */
+    int numSievingPrimes;
+    /** First wheel turn sieved */
+    int64_t firstTurn;
+    /** Wheel turn after the last sieved one */
+    int64_t lastTurn;
+    /** Numbers up to this one are ignored */
+    int64_t minValue;
+    /** Biggest number checked for primality */
+    int64_t maxNumberChecked;
+    /** The primes found */
+    int *pList;
+    /** Number of primes found */
+    int len;
+    /** Whether sieving failed */
+    int didFail;
+};
+typedef struct stPrimeTask primeTask;
+
 /**
- * Create a list of primes that goes up to the prime closest to maxNumberChecked
- * rounded up to the nearest 8 multiple
+ * Initialize the wheel's lookup tables
+ *
+ * NOTE: Every thread writes the same values, so racing on it is harmless
+ */
+static void prime_initWheel() {
+    int i, spoke;
+
+    if (__atomic_load_n(&prime_isWheelReady, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    spoke = 0;
+    for (i = 0; i < PRIME_WHEEL; i++) {
+        prime_nextSpoke[i] = (signed char)spoke;
+        prime_spokeBit[i] = -1;
+        if (spoke < PRIME_WHEEL_SPOKES && prime_spokes[spoke] == i) {
+            prime_spokeBit[i] = (signed char)spoke;
+            spoke++;
+        }
+    }
+
+    __atomic_store_n(&prime_isWheelReady, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Create a list of odd primes up to a small limit, through a simple sieve
+ *
+ * @param  [out]ppList The list of primes
+ * @param  [out]pLen   Number of primes on the list
+ * @param  [ in]limit  Biggest number checked for primality
+ * @return             0 on success, 1 on failure
+ */
+static int prime_genSmallList(int **ppList, int *pLen, int limit) {
+    unsigned char *pSieve;
+    int i, len, *pList;
+
+    /* Only odd numbers are mapped, as i = 2 * index + 1 */
+    pSieve = (unsigned char*)malloc(limit / 2 + 1);
+    if (!pSieve) {
+        return 1;
+    }
+    memset(pSieve, 0x0, limit / 2 + 1);
+
+    pList = (int*)malloc(sizeof(int) * (limit / 2 + 1));
+    if (!pList) {
+        free(pSieve);
+        return 1;
+    }
+
+    len = 0;
+    for (i = 3; i <= limit; i += 2) {
+        if (!pSieve[i / 2]) {
+            int j;
+
+            pList[len] = i;
+            len++;
+            for (j = i * i; j <= limit; j += 2 * i) {
+                pSieve[j / 2] = 1;
+            }
+        }
+    }
+
+    free(pSieve);
+    *ppList = pList;
+    *pLen = len;
+    return 0;
+}
+
+/**
+ * Find the first multiple of a sieving prime that should be marked on a
+ * given wheel turn (or after it)
+ *
+ * @param  [out]pState The sieving state
+ * @param  [ in]prime  The prime
+ * @param  [ in]turn   The first turn to be sieved
+ */
+static void prime_initSieving(primeSieving *pState, int64_t prime,
+        int64_t turn) {
+    int64_t cofactor, value;
+    int residue, spoke;
+
+    /* Multiples smaller than prime^2 are marked by smaller primes */
+    cofactor = (turn * PRIME_WHEEL + prime - 1) / prime;
+    if (cofactor < prime) {
+        cofactor = prime;
+    }
+
+    /* Move to the next cofactor coprime to the wheel */
+    residue = (int)(cofactor % PRIME_WHEEL);
+    spoke = prime_nextSpoke[residue];
+    cofactor -= residue;
+    if (spoke >= PRIME_WHEEL_SPOKES) {
+        spoke = 0;
+        cofactor += PRIME_WHEEL;
+    }
+    cofactor += prime_spokes[spoke];
+
+    value = cofactor * prime;
+    pState->prime = prime;
+    pState->turn = value / PRIME_WHEEL;
+    pState->residue = (int)(value % PRIME_WHEEL);
+    pState->spoke = spoke;
+}
+
+/**
+ * Append a prime to a growable list
+ *
+ * @param  [ in]pTask The task whose list is appended
+ * @param  [ in]pCap  The list's capacity
+ * @param  [ in]prime The prime
+ * @return            0 on success, 1 on failure
+ */
+static int prime_append(primeTask *pTask, int *pCap, int prime) {
+    if (pTask->len >= *pCap) {
+        int *pList;
+        int cap;
+
+        cap = *pCap * 2;
+        if (cap < 1024) {
+            cap = 1024;
+        }
+        pList = (int*)realloc(pTask->pList, sizeof(int) * cap);
+        if (!pList) {
+            return 1;
+        }
+        pTask->pList = pList;
+        *pCap = cap;
+    }
+
+    pTask->pList[pTask->len] = prime;
+    pTask->len++;
+    return 0;
+}
+
+/**
+ * Sieve a range of wheel turns, one segment at a time
+ *
+ * @param  [ in]pArg The task
+ * @return           Always NULL
+ */
+static void* prime_sieveRange(void *pArg) {
+    primeSieving *pStates;
+    primeTask *pTask;
+    uint64_t *pSegment;
+    int64_t segTurn;
+    int cap, i, isDone, numStates;
+
+    pTask = (primeTask*)pArg;
+    pTask->pList = 0;
+    pTask->len = 0;
+    pTask->didFail = 1;
+    cap = 0;
+
+    pSegment = (uint64_t*)malloc(sizeof(uint64_t) * PRIME_SEGMENT_WORDS);
+    pStates = (primeSieving*)malloc(sizeof(primeSieving) *
+            (pTask->numSievingPrimes + 1));
+    if (!pSegment || !pStates) {
+        goto cleanup;
+    }
+
+    /* Skip 3, 5 and 7, which are on the wheel */
+    numStates = 0;
+    for (i = 0; i < pTask->numSievingPrimes; i++) {
+        if (pTask->pSievingPrimes[i] > 7) {
+            prime_initSieving(pStates + numStates, pTask->pSievingPrimes[i],
+                    pTask->firstTurn);
+            numStates++;
+        }
+    }
+
+    isDone = 0;
+    for (segTurn = pTask->firstTurn; !isDone && segTurn < pTask->lastTurn;
+            segTurn += PRIME_SEGMENT_TURNS) {
+        int64_t endTurn, endValue;
+        int numBits, numWords;
+
+        /* The last segment only spans up to the last turn (so small ranges
+         * don't sieve nor scan a whole segment) */
+        endTurn = segTurn + PRIME_SEGMENT_TURNS;
+        if (endTurn > pTask->lastTurn) {
+            endTurn = pTask->lastTurn;
+        }
+        endValue = endTurn * PRIME_WHEEL;
+        numBits = (int)(endTurn - segTurn) * PRIME_WHEEL_SPOKES;
+        numWords = (numBits + 63) / 64;
+        memset(pSegment, 0x0, sizeof(uint64_t) * numWords);
+        /* Bits past the last turn aren't on the segment */
+        if (numBits & 63) {
+            pSegment[numWords - 1] |= ~(uint64_t)0 << (numBits & 63);
+        }
+        /* 1 isn't a prime */
+        if (segTurn == 0) {
+            pSegment[0] |= 1;
+        }
+
+        /* Mark every multiple of every sieving prime on the segment */
+        for (i = 0; i < numStates; i++) {
+            primeSieving *pState;
+            int64_t primeTurns, turn;
+            int primeResidue, residue, spoke;
+
+            pState = pStates + i;
+            if (pState->prime * pState->prime >= endValue) {
+                /* Primes are sorted, so no other prime marks anything */
+                break;
+            }
+
+            primeTurns = pState->prime / PRIME_WHEEL;
+            primeResidue = (int)(pState->prime % PRIME_WHEEL);
+            turn = pState->turn;
+            residue = pState->residue;
+            spoke = pState->spoke;
+            while (turn < endTurn) {
+                int bit, gap;
+
+                bit = (int)(turn - segTurn) * PRIME_WHEEL_SPOKES +
+                        prime_spokeBit[residue];
+                pSegment[bit >> 6] |= (uint64_t)1 << (bit & 63);
+
+                /* Move to the next cofactor coprime to the wheel */
+                if (spoke + 1 < PRIME_WHEEL_SPOKES) {
+                    gap = prime_spokes[spoke + 1] - prime_spokes[spoke];
+                    spoke++;
+                }
+                else {
+                    gap = PRIME_WHEEL + 1 - prime_spokes[spoke];
+                    spoke = 0;
+                }
+                turn += primeTurns * gap;
+                residue += primeResidue * gap;
+                while (residue >= PRIME_WHEEL) {
+                    residue -= PRIME_WHEEL;
+                    turn++;
+                }
+            }
+            pState->turn = turn;
+            pState->residue = residue;
+            pState->spoke = spoke;
+        }
+
+        /* Emit every unmarked bit, up to the biggest number checked */
+        for (i = 0; !isDone && i < numWords; i++) {
+            uint64_t word;
+
+            word = ~pSegment[i];
+            while (word) {
+                int64_t value;
+                int bit;
+
+#if defined(__GNUC__)
+                bit = __builtin_ctzll(word);
+#else
+                bit = 0;
+                while (!(word & ((uint64_t)1 << bit))) {
+                    bit++;
+                }
+#endif
+                word &= word - 1;
+
+                bit += i * 64;
+                value = (segTurn + bit / PRIME_WHEEL_SPOKES) * PRIME_WHEEL +
+                        prime_spokes[bit % PRIME_WHEEL_SPOKES];
+                if (value > pTask->maxNumberChecked) {
+                    isDone = 1;
+                    break;
+                }
+                else if (value <= pTask->minValue) {
+                    continue;
+                }
+                if (prime_append(pTask, &cap, (int)value) != 0) {
+                    goto cleanup;
+                }
+            }
+        }
+    }
+
+    pTask->didFail = 0;
+cleanup:
+    if (pSegment) {
+        free(pSegment);
+    }
+    if (pStates) {
+        free(pStates);
+    }
+
+    return 0;
+}
+
+/**
+ * Create a list of every prime on an interval, splitting the sieve among many
+ * threads
+ *
+ * @param  [out]ppList     The list of sequencial primes
+ * @param  [out]pLen       How many numbers there are in the list
+ * @param  [ in]minValue   Numbers up to this one are ignored
+ * @param  [ in]maxValue   Biggest number to be checked for primality
+ * @param  [ in]numThreads Number of threads used to sieve
+ * @return                 0 on success, 1 on failure
+ */
+static int prime_genInterval(int **ppList, int *pLen, int64_t minValue,
+        int64_t maxValue, int numThreads) {
+    primeTask *pTasks;
+    int *pList, *pSievingPrimes;
+    int64_t firstTurn, numSegments, numTurns, segPerThread;
+    int i, irv, len, numSievingPrimes;
+
+    prime_initWheel();
+
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+
+    /* Retrieve every prime required to sieve the range */
+    irv = prime_genSmallList(&pSievingPrimes, &numSievingPrimes,
+            (int)sqrt((double)maxValue) + 1);
+    if (irv != 0) {
+        return 1;
+    }
+
+    /* Split the segments evenly among the threads */
+    firstTurn = (minValue + 1) / PRIME_WHEEL;
+    numTurns = maxValue / PRIME_WHEEL + 1 - firstTurn;
+    numSegments = (numTurns + PRIME_SEGMENT_TURNS - 1) / PRIME_SEGMENT_TURNS;
+    if (numThreads > numSegments) {
+        numThreads = (int)numSegments;
+    }
+    segPerThread = (numSegments + numThreads - 1) / numThreads;
+
+    pTasks = (primeTask*)malloc(sizeof(primeTask) * numThreads);
+    if (!pTasks) {
+        free(pSievingPrimes);
+        return 1;
+    }
+    memset(pTasks, 0x0, sizeof(primeTask) * numThreads);
+    for (i = 0; i < numThreads; i++) {
+        pTasks[i].pSievingPrimes = pSievingPrimes;
+        pTasks[i].numSievingPrimes = numSievingPrimes;
+        pTasks[i].firstTurn = i * segPerThread * PRIME_SEGMENT_TURNS;
+        pTasks[i].lastTurn = (i + 1) * segPerThread * PRIME_SEGMENT_TURNS;
+        if (pTasks[i].lastTurn > numTurns) {
+            pTasks[i].lastTurn = numTurns;
+        }
+        pTasks[i].firstTurn += firstTurn;
+        pTasks[i].lastTurn += firstTurn;
+        pTasks[i].minValue = minValue;
+        pTasks[i].maxNumberChecked = maxValue;
+        pTasks[i].didFail = 1;
+    }
+
+    /* The first range is always sieved on the calling thread */
+    if (numThreads == 1) {
+        prime_sieveRange(pTasks);
+    }
+    else {
+        pthread_t *pThreads;
+
+        pThreads = (pthread_t*)malloc(sizeof(pthread_t) * numThreads);
+        if (pThreads) {
+            int numStarted;
+
+            numStarted = 1;
+            while (numStarted < numThreads) {
+                if (pthread_create(pThreads + numStarted, 0, prime_sieveRange,
+                        pTasks + numStarted) != 0) {
+                    break;
+                }
+                numStarted++;
+            }
+            prime_sieveRange(pTasks);
+            for (i = 1; i < numStarted; i++) {
+                pthread_join(pThreads[i], 0);
+            }
+            free(pThreads);
+        }
+    }
+
+    /* Concatenate every list, after 2, 3, 5 and 7 */
+    irv = 0;
+    len = 4;
+    for (i = 0; i < numThreads; i++) {
+        irv = irv || pTasks[i].didFail;
+        len += pTasks[i].len;
+    }
+    pList = 0;
+    if (irv == 0) {
+        pList = (int*)malloc(sizeof(int) * len);
+    }
+    if (pList) {
+        int j;
+
+        j = 0;
+        for (i = 0; i < 4; i++) {
+            if (prime_wheelPrimes[i] > minValue &&
+                    prime_wheelPrimes[i] <= maxValue) {
+                pList[j] = prime_wheelPrimes[i];
+                j++;
+            }
+        }
+        for (i = 0; i < numThreads; i++) {
+            /* Threads that found no prime may not have alloc'ed a list */
+            if (pTasks[i].len > 0) {
+                memcpy(pList + j, pTasks[i].pList,
+                        sizeof(int) * pTasks[i].len);
+            }
+            j += pTasks[i].len;
+        }
+
+        *ppList = pList;
+        *pLen = j;
+    }
+
+    for (i = 0; i < numThreads; i++) {
+        if (pTasks[i].pList) {
+            free(pTasks[i].pList);
+        }
+    }
+    free(pTasks);
+    free(pSievingPrimes);
+
+    return pList == 0;
+}
+
+/**
+ * Create a list of every prime up to maxNumberChecked
  *
  * @param  [out]ppList           The list of sequencial primes
  * @param  [out]pLen             How many numbers there are in the list
@@ -24,86 +525,306 @@
  * @return                       0 on success, 1 on failure
  */
 int prime_genPrimeList(int **ppList, int *pLen, int maxNumberChecked) {
-    /** Map of prime numbers */
-    unsigned char *pBitSieve;
-    int i, len, *pList, sieveLen;
+    return prime_genPrimeListThreaded(ppList, pLen, maxNumberChecked, 1);
+}
 
-    pBitSieve = 0;
-    pList = 0;
-    len = 0;
+/**
+ * Create a list of every prime up to maxNumberChecked, splitting the sieve
+ * among many threads
+ *
+ * @param  [out]ppList           The list of sequencial primes
+ * @param  [out]pLen             How many numbers there are in the list
+ * @param  [ in]maxNumberChecked Biggest number to be checked for primality
+ * @param  [ in]numThreads       Number of threads used to sieve
+ * @return                       0 on success, 1 on failure
+ */
+int prime_genPrimeListThreaded(int **ppList, int *pLen, int maxNumberChecked,
+        int numThreads) {
+    if (maxNumberChecked < 2) {
+        maxNumberChecked = 2;
+    }
+
+    return prime_genInterval(ppList, pLen, 1, maxNumberChecked, numThreads);
+}
+
+/**
+ * Initializes a table of primes, which may later grow on demand
+ *
+ * @param  [ in]pTable           The table
+ * @param  [ in]maxNumberChecked Biggest number initially checked for primality
+ * @param  [ in]numThreads       Number of threads used to sieve
+ * @param  [ in]maxBytes         Maximum size of the table, in bytes (or 0, if
+ *                               it may grow without bounds)
+ * @param  [ in]isConcurrent     Whether the table may be used by many threads
+ * @return                       0 on success, 1 on failure
+ */
+int prime_initTable(primeTable *pTable, int maxNumberChecked, int numThreads,
+        int maxBytes, int isConcurrent) {
+    memset(pTable, 0x0, sizeof(primeTable));
+
+    if (maxNumberChecked < 2) {
+        maxNumberChecked = 2;
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    pTable->numThreads = numThreads;
+    pTable->maxBytes = maxBytes;
+
+    if (isConcurrent) {
+        if (pthread_mutex_init(&(pTable->lock), 0) != 0) {
+            return 1;
+        }
+        pTable->isConcurrent = 1;
+    }
+
+#if defined(FRACTION_EMBED_PRIMES)
+    /* Point to the list built into the lib, as long as it's big enough (and
+     * it fits into the table) */
+    if (maxNumberChecked <= prime_embeddedMax && (maxBytes == 0 ||
+            prime_numEmbedded <= maxBytes / (int)sizeof(int))) {
+        pTable->pPrimes = (int*)prime_embedded;
+        pTable->numPrimes = prime_numEmbedded;
+        pTable->capPrimes = prime_numEmbedded;
+        pTable->maxChecked = prime_embeddedMax;
+        pTable->isEmbedded = 1;
+        return 0;
+    }
+#endif
 
-    /* Get the number of bytes required for the sieve */
-    sieveLen = maxNumberChecked >> 4;
-    if (sieveLen == 0 || maxNumberChecked % 8 != 0) {
-        sieveLen++;
+    if (prime_genInterval(&(pTable->pPrimes), &(pTable->numPrimes), 1,
+            maxNumberChecked, numThreads) != 0) {
+        prime_cleanTable(pTable);
+        return 1;
     }
-    /* Alloc and initialize the sieve */
-    pBitSieve = (unsigned char*)malloc(sieveLen);
-    if (!pBitSieve) {
+    pTable->capPrimes = pTable->numPrimes;
+    pTable->maxChecked = maxNumberChecked;
+
+    if (maxBytes > 0 && pTable->capPrimes > maxBytes / (int)sizeof(int)) {
+        prime_cleanTable(pTable);
         return 1;
     }
-    memset(pBitSieve, 0x0, sieveLen);
 
-    /* Search for all prime bits so their multiples may be marked */
-    i = 3;
-    while (((i - 3) >> 4) < sieveLen) {
-        int mappedI;
+    return 0;
+}
 
-        mappedI = (i - 3) >> 1;
-        /* If a 0 bit was found, its a new prime number */
-        if (!(pBitSieve[mappedI >> 3] & (1 << (mappedI & 7)))) {
-            int j;
+/**
+ * Releases every list alloc'ed by the table
+ *
+ * @param  [ in]pTable The table
+ */
+void prime_cleanTable(primeTable *pTable) {
+    int i;
 
-            /* Increase the number of primes found */
-            len++;
-            /* Get the index of the next odd multiple of 'i' */
-            j = i + (i << 1) + 3;
+    if (pTable->pPrimes && !pTable->isMapped && !pTable->isEmbedded) {
+        free(pTable->pPrimes);
+    }
+    prime_unmapCache(pTable);
+    for (i = 0; i < pTable->numRetired; i++) {
+        free(pTable->ppRetired[i]);
+    }
+    if (pTable->ppRetired) {
+        free(pTable->ppRetired);
+    }
+    if (pTable->isConcurrent) {
+        pthread_mutex_destroy(&(pTable->lock));
+    }
+
+    memset(pTable, 0x0, sizeof(primeTable));
+}
 
-            /* Mark all odd multiple of 'i' */
-            while (((j - 3) >> 4) < sieveLen) {
-                int mappedJ;
+/**
+ * Extend the table with every prime up to a given limit
+ *
+ * @param  [ in]pTable The table
+ * @param  [ in]limit  Biggest number to be checked for primality
+ * @return             0 on success, 1 on failure
+ */
+static int prime_extend(primeTable *pTable, int64_t limit) {
+    int *pList, *pNew;
+    int cap, len, maxCap;
 
-                mappedJ = (j - 3) >> 1;
-                pBitSieve[mappedJ >> 3] |= (1 << (mappedJ & 7));
+    if (prime_genInterval(&pList, &len, pTable->maxChecked, limit,
+            pTable->numThreads) != 0) {
+        return 1;
+    }
 
-                j += (i << 1) + 3;
+    maxCap = INT_MAX;
+    if (pTable->maxBytes > 0) {
+        maxCap = pTable->maxBytes / (int)sizeof(int);
+    }
+    if (len > maxCap - pTable->numPrimes) {
+        free(pList);
+        return 1;
+    }
+
+    /* Double the table's capacity, so growing it is amortized */
+    if (pTable->numPrimes + len > pTable->capPrimes) {
+        int **ppRetired;
+
+        cap = pTable->capPrimes * 2;
+        if (cap < pTable->numPrimes + len || cap > maxCap || cap < 0) {
+            cap = pTable->numPrimes + len;
+        }
+
+        /* Other threads may be reading the current list, so it's only
+         * released along the table (and neither the mapped nor the
+         * embedded lists are ever released) */
+        if (pTable->isConcurrent && !pTable->isMapped &&
+                !pTable->isEmbedded) {
+            ppRetired = (int**)realloc(pTable->ppRetired,
+                    sizeof(int*) * (pTable->numRetired + 1));
+            if (!ppRetired) {
+                free(pList);
+                return 1;
             }
+            pTable->ppRetired = ppRetired;
+        }
+
+        pNew = (int*)malloc(sizeof(int) * cap);
+        if (!pNew) {
+            free(pList);
+            return 1;
         }
-        /* Go to the next number */
-        i += 2;
+        memcpy(pNew, pTable->pPrimes, sizeof(int) * pTable->numPrimes);
+        memcpy(pNew + pTable->numPrimes, pList, sizeof(int) * len);
+
+        if (pTable->isMapped || pTable->isEmbedded) {
+            pTable->isMapped = 0;
+            pTable->isEmbedded = 0;
+        }
+        else if (pTable->isConcurrent) {
+            pTable->ppRetired[pTable->numRetired] = pTable->pPrimes;
+            pTable->numRetired++;
+        }
+        else {
+            free(pTable->pPrimes);
+        }
+        pTable->capPrimes = cap;
+        __atomic_store_n(&(pTable->pPrimes), pNew, __ATOMIC_RELEASE);
     }
+    else {
+        /* Readers never go past the number of primes, so appending is safe */
+        memcpy(pTable->pPrimes + pTable->numPrimes, pList, sizeof(int) * len);
+    }
+    free(pList);
 
-    /* Alloc the return buffer */
-    pList = (int*)malloc(sizeof(int) * (len + 1));
-    if (!pList) {
-        free(pBitSieve);
+    __atomic_store_n(&(pTable->numPrimes), pTable->numPrimes + len,
+            __ATOMIC_RELEASE);
+    __atomic_store_n(&(pTable->maxChecked), (int)limit, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Initializes a table of primes from a cache file, which may later grow on
+ * demand
+ *
+ * If the file doesn't have every prime up to maxNumberChecked, the list is
+ * sieved and then the file is (re)written. Failing to write the file isn't
+ * an error, as the table is still usable
+ *
+ * @param  [ in]pTable           The table
+ * @param  [ in]pPath            Path of the cache file
+ * @param  [ in]maxNumberChecked Biggest number initially checked for primality
+ * @param  [ in]numThreads       Number of threads used to sieve
+ * @param  [ in]maxBytes         Maximum size of the table, in bytes (or 0, if
+ *                               it may grow without bounds)
+ * @param  [ in]isConcurrent     Whether the table may be used by many threads
+ * @return                       0 on success, 1 on failure
+ */
+int prime_initTableCached(primeTable *pTable, const char *pPath,
+        int maxNumberChecked, int numThreads, int maxBytes, int isConcurrent) {
+    /* Start from the smallest list (or the embedded one), which is replaced
+     * by the cached one */
+    if (prime_initTable(pTable, 2, numThreads, maxBytes, isConcurrent) != 0) {
+        return 1;
+    }
+    /* The embedded list is already shared by every process */
+    if (pTable->isEmbedded && pTable->maxChecked >= maxNumberChecked) {
+        return 0;
+    }
+    if (prime_mapCache(pTable, pPath, maxNumberChecked) == 0) {
+        if (maxBytes == 0 || pTable->numPrimes <= maxBytes / (int)sizeof(int)) {
+            return 0;
+        }
+        /* The file is too big for this table (but not for others), so it's
+         * kept as is */
+        prime_cleanTable(pTable);
+        return prime_initTable(pTable, maxNumberChecked, numThreads, maxBytes,
+                isConcurrent);
+    }
+
+    if (maxNumberChecked > pTable->maxChecked &&
+            prime_extend(pTable, maxNumberChecked) != 0) {
+        prime_cleanTable(pTable);
         return 1;
     }
 
-    pList[0] = 2;
-    /* Loop through the sieve and store all prime numbers */
-    i = 3;
-    len = 1;
-    while ((i - 3) >> 4 < sieveLen) {
-        int mappedI;
+    /* Share the list with the next tables (and with this one, by mapping
+     * it back) */
+    if (prime_writeCache(pPath, pTable) == 0) {
+        prime_mapCache(pTable, pPath, maxNumberChecked);
+    }
 
-        mappedI = (i - 3) >> 1;
-        /* If a 0 bit was found, its a prime number */
-        if (!(pBitSieve[mappedI >> 3] & (1 << (mappedI & 7)))) {
-            pList[len] = (i << 1) + 3;
-            len++;
+    return 0;
+}
+
+/**
+ * Make sure that every prime up to a given number is on the table, extending
+ * it (one whole sieve segment at a time) if needed
+ *
+ * @param  [ in]pTable The table
+ * @param  [ in]value  The number
+ * @return             0 on success, 1 on failure (e.g., if the table would
+ *                     grow bigger than its maximum size)
+ */
+int prime_ensure(primeTable *pTable, int value) {
+    int64_t limit, span;
+    int irv;
+
+    if (value <= __atomic_load_n(&(pTable->maxChecked), __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+
+    if (pTable->isConcurrent) {
+        pthread_mutex_lock(&(pTable->lock));
+    }
+
+    /* Extend the table up to the end of the segment that contains the value,
+     * as if segments started at zero */
+    irv = 0;
+    if (value > pTable->maxChecked) {
+        span = (int64_t)PRIME_SEGMENT_TURNS * PRIME_WHEEL;
+        limit = ((int64_t)value / span + 1) * span - 1;
+        if (limit > INT_MAX) {
+            limit = INT_MAX;
         }
-        /* Go to the next number */
-        i += 2;
+        irv = prime_extend(pTable, limit);
     }
 
-    /* Set the return parameters */
-    *pLen = len;
-    *ppList = pList;
-    /* Clear the local memory */
-    pList = 0;
-    free(pBitSieve);
+    if (pTable->isConcurrent) {
+        pthread_mutex_unlock(&(pTable->lock));
+    }
 
-    return 0;
+    return irv;
+}
+
+/**
+ * Retrieve every prime currently on the table
+ *
+ * NOTE: On concurrent tables, the list stays valid (although it may not
+ *       grow) until the table is cleaned, even if other threads extend it.
+ *       Otherwise, it's only valid until the table is extended
+ *
+ * @param  [out]ppList The list of sequencial primes
+ * @param  [out]pLen   How many numbers there are in the list
+ * @param  [ in]pTable The table
+ */
+void prime_getList(const int **ppList, int *pLen, primeTable *pTable) {
+    /* Lists are published before their length, and newer lists contain every
+     * prime of older ones */
+    *pLen = __atomic_load_n(&(pTable->numPrimes), __ATOMIC_ACQUIRE);
+    *ppList = __atomic_load_n(&(pTable->pPrimes), __ATOMIC_ACQUIRE);
 }
 
@@ -0,0 +1,272 @@
+/**
+ * Caches tables of primes in files, so they may be shared by many processes
+ *
+ * A cache file is a small header followed by the list of primes, in the
+ * host's byte order. The header identifies the format (so files written by
+ * other versions of the lib, or on hosts with another byte order, are
+ * rejected), the biggest number checked for primality and a checksum of the
+ * list (FNV-1a, one prime at a time).
+ *
+ * Valid files are mapped read-only, so their pages are kept only once on the
+ * page cache, regardless of how many processes (and managers) map them.
+ * Verifying the checksum reads the whole list once, which is still a lot
+ * cheaper than sieving it.
+ *
+ * Files are written to a temporary file on the same directory, which is then
+ * renamed over the cache file. So, processes that race to create the same
+ * file never see it partially written, and processes that already mapped a
+ * replaced file keep using it.
+ *
+ * Mapping files requires POSIX, so caching is unavailable on Windows (and
+ * tables are always sieved).
+ *
+ * @file src/primeCache.c
+ */
+/* mkstemp and fchmod aren't declared on strict ISO C builds (e.g., -std=c99)
+ * unless POSIX is requested explicitly */
+#define _POSIX_C_SOURCE 200809L
+
+#include <fraction_internal/prime.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/** Identifies cache files ("FPRM", as read in the host's byte order) */
+#define PRIME_CACHE_MAGIC 0x4d525046u
+/** Version of the cache file's format */
+#define PRIME_CACHE_VERSION 1u
+
+/** Header of every cache file, which is followed by its list of primes */
+struct stPrimeCacheHeader {
+    /** Always PRIME_CACHE_MAGIC */
+    uint32_t magic;
+    /** Always PRIME_CACHE_VERSION */
+    uint32_t version;
+    /** Size of each prime, in bytes */
+    uint32_t primeSize;
+    /** Biggest number checked for primality */
+    int32_t maxChecked;
+    /** Number of primes on the list */
+    int32_t numPrimes;
+    /** Unused (so the list stays 8 bytes aligned) */
+    uint32_t reserved;
+    /** Checksum of the list */
+    uint64_t checksum;
+};
+typedef struct stPrimeCacheHeader primeCacheHeader;
+
+#if !defined(_WIN32)
+
+/**
+ * Calculate the checksum of a list of primes
+ *
+ * @param  [ in]pList The list
+ * @param  [ in]len   Number of primes on the list
+ * @return            The checksum
+ */
+static uint64_t prime_checksum(const int *pList, int len) {
+    uint64_t hash;
+    int i;
+
+    hash = 0xcbf29ce484222325ULL;
+    for (i = 0; i < len; i++) {
+        hash ^= (uint32_t)pList[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * Replace the table's list by the one on a cache file, mapping it read-only
+ *
+ * NOTE: This must only be called on tables that were just initialized (and
+ *       aren't used by other threads yet)
+ *
+ * @param  [ in]pTable           The table
+ * @param  [ in]pPath            Path of the cache file
+ * @param  [ in]maxNumberChecked Biggest number that must have been checked
+ *                               for primality on the file
+ * @return                       0 on success, 1 if the file is missing,
+ *                               invalid (or from another version of the
+ *                               lib) or too small
+ */
+int prime_mapCache(primeTable *pTable, const char *pPath,
+        int maxNumberChecked) {
+    const primeCacheHeader *pHeader;
+    const int *pList;
+    struct stat st;
+    void *pMap;
+    size_t size;
+    int fd;
+
+    fd = open(pPath, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(primeCacheHeader)
+            || (uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+        close(fd);
+        return 1;
+    }
+    size = (size_t)st.st_size;
+    pMap = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    /* The mapping is kept even after the file is closed */
+    close(fd);
+    if (pMap == MAP_FAILED) {
+        return 1;
+    }
+
+    pHeader = (const primeCacheHeader*)pMap;
+    pList = (const int*)(pHeader + 1);
+    if (pHeader->magic != PRIME_CACHE_MAGIC ||
+            pHeader->version != PRIME_CACHE_VERSION ||
+            pHeader->primeSize != sizeof(int) || pHeader->numPrimes < 1 ||
+            (uint64_t)size != sizeof(primeCacheHeader) +
+            (uint64_t)pHeader->numPrimes * sizeof(int) ||
+            pHeader->maxChecked < maxNumberChecked ||
+            prime_checksum(pList, pHeader->numPrimes) != pHeader->checksum) {
+        munmap(pMap, size);
+        return 1;
+    }
+
+    /* Nobody else uses the table yet, so its list may simply be released */
+    if (pTable->pPrimes && !pTable->isMapped && !pTable->isEmbedded) {
+        free(pTable->pPrimes);
+    }
+    prime_unmapCache(pTable);
+    pTable->pPrimes = (int*)pList;
+    pTable->numPrimes = pHeader->numPrimes;
+    pTable->capPrimes = pHeader->numPrimes;
+    pTable->maxChecked = pHeader->maxChecked;
+    pTable->pMap = pMap;
+    pTable->mapSize = size;
+    pTable->isMapped = 1;
+    pTable->isEmbedded = 0;
+
+    return 0;
+}
+
+/**
+ * Write a whole buffer to a file
+ *
+ * @param  [ in]fd   The file
+ * @param  [ in]pBuf The buffer
+ * @param  [ in]len  Size of the buffer, in bytes
+ * @return           0 on success, 1 on failure
+ */
+static int prime_writeAll(int fd, const void *pBuf, size_t len) {
+    const char *pCur;
+
+    pCur = (const char*)pBuf;
+    while (len > 0) {
+        ssize_t num;
+
+        num = write(fd, pCur, len);
+        if (num <= 0) {
+            return 1;
+        }
+        pCur += num;
+        len -= (size_t)num;
+    }
+
+    return 0;
+}
+
+/**
+ * Write every prime currently on the table to a cache file
+ *
+ * The list is written to a temporary file (on the same directory), which then
+ * replaces the cache file, so readers never see partially written files
+ *
+ * @param  [ in]pPath  Path of the cache file
+ * @param  [ in]pTable The table
+ * @return             0 on success, 1 on failure
+ */
+int prime_writeCache(const char *pPath, primeTable *pTable) {
+    primeCacheHeader header;
+    const int *pList;
+    char *pTmpPath;
+    size_t len;
+    int fd, irv, numPrimes;
+
+    prime_getList(&pList, &numPrimes, pTable);
+
+    memset(&header, 0x0, sizeof(primeCacheHeader));
+    header.magic = PRIME_CACHE_MAGIC;
+    header.version = PRIME_CACHE_VERSION;
+    header.primeSize = sizeof(int);
+    header.maxChecked = __atomic_load_n(&(pTable->maxChecked),
+            __ATOMIC_ACQUIRE);
+    header.numPrimes = numPrimes;
+    header.checksum = prime_checksum(pList, numPrimes);
+
+    len = strlen(pPath);
+    pTmpPath = (char*)malloc(len + sizeof(".XXXXXX"));
+    if (!pTmpPath) {
+        return 1;
+    }
+    memcpy(pTmpPath, pPath, len);
+    memcpy(pTmpPath + len, ".XXXXXX", sizeof(".XXXXXX"));
+
+    fd = mkstemp(pTmpPath);
+    if (fd < 0) {
+        free(pTmpPath);
+        return 1;
+    }
+
+    /* mkstemp only allows the owner to read it, but it must be shared */
+    irv = fchmod(fd, 0644) != 0 ||
+            prime_writeAll(fd, &header, sizeof(primeCacheHeader)) != 0 ||
+            prime_writeAll(fd, pList, sizeof(int) * (size_t)numPrimes) != 0;
+    irv |= close(fd) != 0;
+    if (irv == 0) {
+        irv = rename(pTmpPath, pPath) != 0;
+    }
+    if (irv != 0) {
+        unlink(pTmpPath);
+    }
+
+    free(pTmpPath);
+    return irv;
+}
+
+/**
+ * Release the table's mapped cache file (if any)
+ *
+ * @param  [ in]pTable The table
+ */
+void prime_unmapCache(primeTable *pTable) {
+    if (pTable->pMap) {
+        munmap(pTable->pMap, pTable->mapSize);
+    }
+    pTable->pMap = 0;
+    pTable->mapSize = 0;
+    pTable->isMapped = 0;
+}
+
+#else /* _WIN32 */
+
+int prime_mapCache(primeTable *pTable, const char *pPath,
+        int maxNumberChecked) {
+    return 1;
+}
+
+int prime_writeCache(const char *pPath, primeTable *pTable) {
+    return 1;
+}
+
+void prime_unmapCache(primeTable *pTable) {
+}
+
+#endif /* _WIN32 */
+
@@ -0,0 +1,226 @@
+/**
+ * Table with the smallest prime factor of every odd number up to a limit,
+ * used to factor numbers in as many lookups as they have prime factors
+ *
+ * The table is built by a linear sieve, which marks every composite exactly
+ * once (as its smallest prime factor times a cofactor). Since even numbers are
+ * factored by counting trailing zeros, only odd numbers are stored, on 16 bits
+ * entries: the smallest factor of an odd composite up to 2^31 is never bigger
+ * than its square root, and primes are stored as 0.
+ *
+ * @file src/spf.c
+ */
+#include <fraction_internal/prime.h>
+#include <fraction_internal/spf.h>
+#include <fraction_internal/stats.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Initializes a table of smallest prime factors
+ *
+ * @param  [ in]pTable The table
+ * @param  [ in]limit  Biggest number on the table
+ * @return             0 on success, 1 on failure
+ */
+int spf_init(spfTable *pTable, int limit) {
+    int64_t i;
+    int *pPrimes;
+    int maxPrimes, numPrimes;
+
+    memset(pTable, 0x0, sizeof(spfTable));
+    if (limit < 3) {
+        limit = 3;
+    }
+
+    pTable->pEntries = (uint16_t*)malloc(sizeof(uint16_t) * (limit / 2 + 1));
+    if (!pTable->pEntries) {
+        return 1;
+    }
+    memset(pTable->pEntries, 0x0, sizeof(uint16_t) * (limit / 2 + 1));
+    pTable->limit = limit;
+
+    /* Upper bound of the number of primes (Rosser and Schoenfeld) */
+    maxPrimes = (int)(1.25506 * limit / log((double)limit)) + 16;
+    pPrimes = (int*)malloc(sizeof(int) * maxPrimes);
+    if (!pPrimes) {
+        spf_clean(pTable);
+        return 1;
+    }
+
+    /* Mark each odd composite as its smallest factor times a cofactor whose
+     * smallest factor isn't smaller than it */
+    numPrimes = 0;
+    for (i = 3; i <= limit; i += 2) {
+        int j, spf;
+
+        spf = pTable->pEntries[i / 2];
+        if (spf == 0) {
+            pPrimes[numPrimes] = (int)i;
+            numPrimes++;
+            spf = (int)i;
+        }
+
+        for (j = 0; j < numPrimes && pPrimes[j] <= spf; j++) {
+            int64_t composite;
+
+            composite = i * pPrimes[j];
+            if (composite > limit) {
+                break;
+            }
+            pTable->pEntries[composite / 2] = (uint16_t)pPrimes[j];
+        }
+    }
+
+    free(pPrimes);
+    return 0;
+}
+
+/**
+ * Releases a table of smallest prime factors
+ *
+ * @param  [ in]pTable The table
+ */
+void spf_clean(spfTable *pTable) {
+    if (pTable->pEntries) {
+        free(pTable->pEntries);
+    }
+    memset(pTable, 0x0, sizeof(spfTable));
+}
+
+/**
+ * Append a prime factor to a factorization
+ *
+ * @param  [ in]pFactors    The prime factors
+ * @param  [ in]pExponents  The exponent of each prime factor
+ * @param  [ in]pNumFactors Number of distinct prime factors
+ * @param  [ in]prime       The prime factor
+ * @param  [ in]exponent    Its exponent
+ */
+static void spf_append(int *pFactors, int *pExponents, int *pNumFactors,
+        int prime, int exponent) {
+    pFactors[*pNumFactors] = prime;
+    pExponents[*pNumFactors] = exponent;
+    (*pNumFactors)++;
+}
+
+/**
+ * Factor a positive number into primes (in increasing order). Factors bigger
+ * than the table's limit are found through trial division by the table of
+ * primes, until the remaining cofactor is on the table
+ *
+ * @param  [out]pFactors     The number's distinct prime factors (there are at
+ *                           most 9 of them)
+ * @param  [out]pExponents   The exponent of each prime factor
+ * @param  [out]pNumFactors  Number of distinct prime factors
+ * @param  [ in]pTable       The table (may be NULL, to only use trial
+ *                           division)
+ * @param  [ in]pPrimeTable  Table of primes, extended as needed
+ * @param  [ in]value        The number
+ * @return                   0 on success, 1 on failure
+ */
+int spf_factor(int *pFactors, int *pExponents, int *pNumFactors,
+        spfTable *pTable, primeTable *pPrimeTable, uint32_t value) {
+    int limit;
+
+    if (value == 0) {
+        return 1;
+    }
+    *pNumFactors = 0;
+    STATS_INC(pPrimeTable->numFactorizations);
+
+    /* Factors of two are simply the trailing zeros */
+    if (!(value & 1)) {
+        int exp;
+
+        exp = 0;
+        while (!(value & 1)) {
+            value >>= 1;
+            exp++;
+        }
+        spf_append(pFactors, pExponents, pNumFactors, 2, exp);
+    }
+
+    limit = 0;
+    if (pTable) {
+        limit = pTable->limit;
+    }
+
+    /* Use trial division until the cofactor is on the table */
+    if (value > (uint32_t)limit) {
+        const int *pList;
+        uint32_t root;
+        int i, len;
+
+        root = (uint32_t)sqrt((double)value);
+        while ((uint64_t)root * root > value) {
+            root--;
+        }
+        if (prime_ensure(pPrimeTable, (int)root) != 0) {
+            return 1;
+        }
+        prime_getList(&pList, &len, pPrimeTable);
+
+        /* Skip 2, which was already removed */
+        for (i = 1; i < len && value > (uint32_t)limit; i++) {
+            uint32_t prime;
+
+            prime = (uint32_t)pList[i];
+            if ((uint64_t)prime * prime > value) {
+                break;
+            }
+            if (value % prime == 0) {
+                int exp;
+
+                exp = 0;
+                do {
+                    value /= prime;
+                    exp++;
+                } while (value % prime == 0);
+                spf_append(pFactors, pExponents, pNumFactors, (int)prime,
+                        exp);
+            }
+        }
+        STATS_ADD(pPrimeTable->numTrialDivisions, i - 1);
+
+        /* If nothing up to its root divides it, the cofactor is a prime */
+        if (value > 1 && value > (uint32_t)limit) {
+            spf_append(pFactors, pExponents, pNumFactors, (int)value, 1);
+            value = 1;
+        }
+    }
+
+    /* Lookup every remaining factor */
+    while (value > 1) {
+        uint32_t prime;
+        int exp;
+
+        prime = pTable->pEntries[value / 2];
+        if (prime == 0) {
+            prime = value;
+        }
+
+        exp = 0;
+        do {
+            uint32_t next;
+
+            value /= prime;
+            exp++;
+
+            next = pTable->pEntries[value / 2];
+            if (next == 0) {
+                next = value;
+            }
+            if (next != prime) {
+                break;
+            }
+        } while (value > 1);
+        spf_append(pFactors, pExponents, pNumFactors, (int)prime, exp);
+    }
+
+    return 0;
+}
+
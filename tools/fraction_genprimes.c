@@ -0,0 +1,58 @@
+/**
+ * Generates the list of primes embedded into the lib (if it's built with
+ * EMBED_PRIMES=yes), as a C source file
+ *
+ * Every prime up to the given number is sieved by the lib's own sieve and
+ * output as a constant array, so it's stored on the lib's read-only data.
+ *
+ * Usage: fraction_genprimes <maxNumberChecked>
+ *
+ * @file tools/fraction_genprimes.c
+ */
+#include <fraction_internal/prime.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Number of primes on each line of the output */
+#define GEN_PRIMES_PER_LINE 8
+
+int main(int argc, char *argv[]) {
+    int *pList;
+    int i, len, maxNumberChecked;
+
+    maxNumberChecked = 0;
+    if (argc == 2) {
+        maxNumberChecked = atoi(argv[1]);
+    }
+    if (maxNumberChecked < 2) {
+        fprintf(stderr, "Usage: %s <maxNumberChecked>\n", argv[0]);
+        return 1;
+    }
+
+    if (prime_genPrimeList(&pList, &len, maxNumberChecked) != 0) {
+        fprintf(stderr, "Failed to generate the list of primes\n");
+        return 1;
+    }
+
+    printf("/**\n"
+            " * Every prime up to %d (generated by tools/fraction_genprimes.c"
+            ")\n"
+            " */\n"
+            "#include <fraction_internal/prime.h>\n"
+            "\n"
+            "const int prime_embedded[%d] = {", maxNumberChecked, len);
+    for (i = 0; i < len; i++) {
+        if (i % GEN_PRIMES_PER_LINE == 0) {
+            printf("\n   ");
+        }
+        printf(" %d%s", pList[i], (i < len - 1) ? "," : "");
+    }
+    printf("\n};\n"
+            "const int prime_numEmbedded = %d;\n"
+            "const int prime_embeddedMax = %d;\n", len, maxNumberChecked);
+
+    free(pList);
+    return 0;
+}
+
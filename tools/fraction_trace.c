@@ -0,0 +1,303 @@
+/**
+ * Dumps the latency of sampled operations as histograms
+ *
+ * A few threads run a random mix of constructors, arithmetic operations and
+ * converters, on operands of growing magnitudes, while a consumer thread
+ * periodically drains the manager's trace ring. Afterwards, a histogram of
+ * every operation's latency (in power of two buckets of nanoseconds) is
+ * printed, followed by the slowest sampled operations.
+ *
+ * The lib must be built with FRACTION_TRACE (e.g., 'make trace').
+ *
+ * Usage: fraction_trace [interval]
+ *
+ * @file tools/fraction_trace.c
+ */
+/* rand_r and nanosleep aren't declared on strict ISO C builds */
+#define _POSIX_C_SOURCE 200809L
+
+#include <fraction/fraction.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Number of threads running the workload */
+#define TRACE_NUM_WORKERS 4
+/** Operations executed by each thread on each magnitude */
+#define TRACE_NUM_STEPS 200000
+/** Number of power of two buckets on each histogram */
+#define TRACE_NUM_BUCKETS 32
+/** Width of the histograms' bars */
+#define TRACE_BAR_WIDTH 40
+/** Number of slowest operations printed */
+#define TRACE_NUM_SLOWEST 10
+/** Maximum number of events drained at once */
+#define TRACE_DRAIN_SIZE 1024
+
+/** Bits on the operands' terms, on each run of the workload */
+static const int trace_magnitudes[] = {4, 8, 12, 15};
+#define TRACE_NUM_MAGNITUDES \
+        (int)(sizeof(trace_magnitudes) / sizeof(trace_magnitudes[0]))
+
+static fractionManager *pFMng = 0;
+/** Number of threads still running the workload */
+static int numRunning;
+
+/** Sampled operations, aggregated by the consumer */
+static uint64_t pHistograms[FRACTION_TRACE_NUM_OPS][TRACE_NUM_BUCKETS];
+static uint64_t pNumSamples[FRACTION_TRACE_NUM_OPS];
+static double pTotalNs[FRACTION_TRACE_NUM_OPS];
+static fractionTraceEvent pSlowest[TRACE_NUM_SLOWEST];
+static int numSlowest;
+static uint64_t numDropped;
+static double nsPerTick;
+
+/**
+ * Retrieve a random term with the given number of bits
+ *
+ * @param  [ in]pSeed The thread's seed
+ * @param  [ in]bits  Number of bits on the term
+ * @return            The term (never 0)
+ */
+static int trace_randTerm(unsigned int *pSeed, int bits) {
+    return rand_r(pSeed) % (1 << bits) + 1;
+}
+
+/**
+ * Run the mixed workload
+ *
+ * @param  [ in]pArg The thread's index
+ * @return           Nothing
+ */
+static void* trace_work(void *pArg) {
+    unsigned int seed;
+    int i, j;
+
+    seed = (unsigned int)time(0) + (unsigned int)(intptr_t)pArg;
+    for (i = 0; i < TRACE_NUM_MAGNITUDES; i++) {
+        int bits;
+
+        bits = trace_magnitudes[i];
+        for (j = 0; j < TRACE_NUM_STEPS; j++) {
+            fraction *pA, *pB, *pOut;
+            double dval;
+            int num, den;
+
+            if (fractionManager_getFraction(&pA, pFMng,
+                    trace_randTerm(&seed, bits) - (1 << (bits - 1)),
+                    trace_randTerm(&seed, bits)) != 0) {
+                continue;
+            }
+            if (fractionManager_getFraction(&pB, pFMng,
+                    trace_randTerm(&seed, bits), trace_randTerm(&seed, bits))
+                    != 0) {
+                fractionManager_releaseFraction(pA);
+                continue;
+            }
+            if (fractionManager_igetFraction(&pOut, pFMng, 0) != 0) {
+                fractionManager_releaseFraction(pA);
+                fractionManager_releaseFraction(pB);
+                continue;
+            }
+
+            switch (rand_r(&seed) % 4) {
+                case 0: fraction_sum(pOut, pA, pB); break;
+                case 1: fraction_sub(pOut, pA, pB); break;
+                case 2: fraction_mul(pOut, pA, pB); break;
+                default: fraction_div(pOut, pA, pB); break;
+            }
+            fraction_dconvert(&dval, pOut);
+            fraction_getTerms(&num, &den, pOut);
+
+            fractionManager_releaseFraction(pA);
+            fractionManager_releaseFraction(pB);
+            fractionManager_releaseFraction(pOut);
+        }
+    }
+
+    fractionManager_flushThreadCache(pFMng);
+    __atomic_sub_fetch(&numRunning, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * Aggregate a sampled operation
+ *
+ * @param  [ in]pEvent The operation
+ */
+static void trace_collect(const fractionTraceEvent *pEvent) {
+    uint64_t ns;
+    int bucket, i;
+
+    if (pEvent->op < 0 || pEvent->op >= FRACTION_TRACE_NUM_OPS) {
+        return;
+    }
+
+    ns = (uint64_t)(pEvent->ticks * nsPerTick);
+    bucket = 0;
+    while (bucket < TRACE_NUM_BUCKETS - 1 && (ns >> (bucket + 1)) > 0) {
+        bucket++;
+    }
+    pHistograms[pEvent->op][bucket]++;
+    pNumSamples[pEvent->op]++;
+    pTotalNs[pEvent->op] += ns;
+
+    /* Keep the slowest operations sorted, from the slowest one */
+    if (numSlowest == TRACE_NUM_SLOWEST &&
+            pSlowest[numSlowest - 1].ticks >= pEvent->ticks) {
+        return;
+    }
+    if (numSlowest < TRACE_NUM_SLOWEST) {
+        numSlowest++;
+    }
+    i = numSlowest - 1;
+    while (i > 0 && pSlowest[i - 1].ticks < pEvent->ticks) {
+        pSlowest[i] = pSlowest[i - 1];
+        i--;
+    }
+    pSlowest[i] = *pEvent;
+}
+
+/**
+ * Move every sampled operation out of the manager
+ *
+ * @return 0 on success, 1 if tracing isn't available
+ */
+static int trace_drain() {
+    fractionTraceEvent pEvents[TRACE_DRAIN_SIZE];
+    uint64_t dropped;
+    int i, num;
+
+    do {
+        if (fractionManager_drainTrace(pEvents, &num, &dropped, pFMng,
+                TRACE_DRAIN_SIZE) != 0) {
+            return 1;
+        }
+        numDropped += dropped;
+        for (i = 0; i < num; i++) {
+            trace_collect(&pEvents[i]);
+        }
+    } while (num == TRACE_DRAIN_SIZE);
+
+    return 0;
+}
+
+/**
+ * Print every histogram and the slowest operations
+ */
+static void trace_print() {
+    int op, i;
+
+    printf("ns/tick: %.4f\n", nsPerTick);
+    for (op = 0; op < FRACTION_TRACE_NUM_OPS; op++) {
+        const char *pName;
+        uint64_t max;
+        int first, last;
+
+        if (pNumSamples[op] == 0) {
+            continue;
+        }
+        fractionTrace_getOpName(&pName, op);
+        printf("\n%s: %llu samples, mean %.1f ns\n", pName,
+                (unsigned long long)pNumSamples[op],
+                pTotalNs[op] / pNumSamples[op]);
+
+        max = 0;
+        first = TRACE_NUM_BUCKETS;
+        last = 0;
+        for (i = 0; i < TRACE_NUM_BUCKETS; i++) {
+            if (pHistograms[op][i] == 0) {
+                continue;
+            }
+            if (first == TRACE_NUM_BUCKETS) {
+                first = i;
+            }
+            last = i;
+            if (pHistograms[op][i] > max) {
+                max = pHistograms[op][i];
+            }
+        }
+        for (i = first; i <= last; i++) {
+            int len;
+
+            len = (int)(pHistograms[op][i] * TRACE_BAR_WIDTH / max);
+            printf("  [%10llu, %10llu) ns %10llu |%.*s\n",
+                    (i == 0) ? 0ULL : 1ULL << i, 1ULL << (i + 1),
+                    (unsigned long long)pHistograms[op][i], len,
+                    "########################################");
+        }
+    }
+
+    printf("\nslowest operations:\n");
+    for (i = 0; i < numSlowest; i++) {
+        const char *pName;
+
+        fractionTrace_getOpName(&pName, pSlowest[i].op);
+        printf("  %-10s %10.0f ns, operands of %2d and %2d bits, "
+                "%d simplifications\n", pName, pSlowest[i].ticks * nsPerTick,
+                pSlowest[i].bitsA, pSlowest[i].bitsB,
+                pSlowest[i].numSimplifications);
+    }
+    printf("\ndropped: %llu\n", (unsigned long long)numDropped);
+}
+
+int main(int argc, char *argv[]) {
+    fractionManagerConfig config;
+    pthread_t pThreads[TRACE_NUM_WORKERS];
+    struct timespec delay;
+    int i, irv;
+
+    fractionManager_getDefaultConfig(&config);
+    config.isConcurrent = 1;
+    config.traceCapacity = 1 << 16;
+    if (argc == 2) {
+        config.traceInterval = atoi(argv[1]);
+    }
+    if (config.traceInterval <= 0) {
+        fprintf(stderr, "Usage: %s [interval]\n", argv[0]);
+        return 1;
+    }
+
+    irv = fractionManager_initConfig(&pFMng, &config);
+    if (irv != 0) {
+        fprintf(stderr, "Failed to initialize the fraction manager\n");
+        return 1;
+    }
+    if (trace_drain() != 0) {
+        fprintf(stderr, "The lib wasn't built with FRACTION_TRACE\n");
+        fractionManager_clean(&pFMng);
+        return 1;
+    }
+    fractionTrace_getNsPerTick(&nsPerTick);
+
+    numRunning = TRACE_NUM_WORKERS;
+    for (i = 0; i < TRACE_NUM_WORKERS; i++) {
+        irv = pthread_create(&pThreads[i], 0, trace_work, (void*)(intptr_t)i);
+        if (irv != 0) {
+            fprintf(stderr, "Failed to create a worker\n");
+            exit(1);
+        }
+    }
+
+    /* Drain while the workers run, so (hopefully) nothing is dropped */
+    delay.tv_sec = 0;
+    delay.tv_nsec = 1000000;
+    while (__atomic_load_n(&numRunning, __ATOMIC_ACQUIRE) > 0) {
+        trace_drain();
+        nanosleep(&delay, 0);
+    }
+    for (i = 0; i < TRACE_NUM_WORKERS; i++) {
+        pthread_join(pThreads[i], 0);
+    }
+    trace_drain();
+
+    trace_print();
+
+    fractionManager_clean(&pFMng);
+    return 0;
+}
+
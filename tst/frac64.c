@@ -0,0 +1,125 @@
+/**
+ * Simple test to check whether operations on 64 bits fractions work and
+ * detect overflows
+ *
+ * @file tst/frac64.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/** Retrieve a random number with (roughly) the requested number of bits */
+static int64_t getRandom(int bits) {
+    uint64_t val;
+
+    val = ((uint64_t)rand() << 32) ^ ((uint64_t)rand() << 16) ^ rand();
+    val &= ((uint64_t)1 << bits) - 1;
+    if (rand() & 1) {
+        return -(int64_t)val;
+    }
+    return (int64_t)val;
+}
+
+int main(int argc, char *argv[]) {
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        fraction64 *pA, *pB, *pOut;
+        int64_t a, b, c, quot, rem;
+        double val;
+
+        /* Big enough to overflow a regular fraction, but not these */
+        a = getRandom(20 + rand() % 21);
+        b = getRandom(20);
+        if (b == 0) {
+            b = 1;
+        }
+        c = getRandom(20) | 1;
+
+        irv = fractionManager_igetFraction64(&pA, pFMng, a);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction64(&pB, pFMng, b);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction64(&pOut, pFMng, 0);
+        assert(irv == 0);
+
+        irv = fraction64_sum(pOut, pA, pB);
+        assert(irv == 0);
+        fraction64_iconvert(&quot, pOut);
+        assert(quot == a + b);
+
+        irv = fraction64_sub(pOut, pA, pB);
+        assert(irv == 0);
+        fraction64_iconvert(&quot, pOut);
+        assert(quot == a - b);
+
+        irv = fraction64_mul(pOut, pA, pB);
+        assert(irv == 0);
+        fraction64_iconvert(&quot, pOut);
+        assert(quot == a * b);
+
+        /* a / b must be kept on its lowest terms */
+        irv = fraction64_div(pOut, pA, pB);
+        assert(irv == 0);
+        fraction64_divConvert(&quot, &rem, pOut);
+        assert(quot == a / b);
+
+        /* (a / b) * (b / c) == a / c, even though a * b may be huge */
+        fractionManager_releaseFraction64(pB);
+        irv = fractionManager_getFraction64(&pB, pFMng, b, c);
+        assert(irv == 0);
+        irv = fraction64_mul(pOut, pOut, pB);
+        assert(irv == 0);
+        fraction64_iconvert(&quot, pOut);
+        assert(quot == a / c);
+        fraction64_dconvert(&val, pOut);
+        assert(val > (double)a / c - 1.0 && val < (double)a / c + 1.0);
+
+        /* a * a only fits if |a| <= floor(sqrt(INT64_MAX)) */
+        irv = fraction64_mul(pOut, pA, pA);
+        assert((irv == 0) == (a >= -3037000499ll && a <= 3037000499ll));
+        if (irv != 0) {
+            /* The output must be left untouched */
+            fraction64_iconvert(&quot, pOut);
+            assert(quot == a / c);
+        }
+
+        fractionManager_releaseFraction64(pA);
+        fractionManager_releaseFraction64(pB);
+        fractionManager_releaseFraction64(pOut);
+
+        num--;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,266 @@
+/**
+ * Simple test to check whether accumulators sum fractions exactly, even when
+ * their running sums overflow
+ *
+ * @file tst/frac_accum.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Biggest number of fractions summed by each round */
+#define MAX_LEN 1000
+
+static fractionManager *pFMng = 0;
+static fractionAccumulator *pAcc = 0;
+static fractionAccumulator *pOther = 0;
+
+void do_clean() {
+    fractionAccumulator_clean(&pAcc);
+    fractionAccumulator_clean(&pOther);
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Check that a big fraction has the same value as another
+ */
+static void assertEqualBig(fractionBig *pA, fractionBig *pB) {
+    fractionBig *pDiff;
+    int64_t quot;
+    double val;
+    int irv;
+
+    irv = fractionManager_igetFractionBig(&pDiff, pFMng, 0);
+    assert(irv == 0);
+    irv = fractionBig_sub(pDiff, pA, pB);
+    assert(irv == 0);
+    irv = fractionBig_iconvert(&quot, pDiff);
+    assert(irv == 0 && quot == 0);
+    fractionBig_dconvert(&val, pDiff);
+    assert(val == 0.0);
+    fractionManager_releaseFractionBig(pDiff);
+}
+
+/**
+ * Check that a 64 bits fraction has the expected (int sized) terms
+ */
+static void assertFraction64(fraction64 *pFrac64, int num, int den) {
+    fraction *pFrac;
+    int irv, n, d;
+
+    irv = fractionManager_igetFraction(&pFrac, pFMng, 0);
+    assert(irv == 0);
+    irv = fraction64_narrow(pFrac, pFrac64);
+    assert(irv == 0);
+    fraction_getTerms(&n, &d, pFrac);
+    assert(n == num && d == den);
+    fractionManager_releaseFraction(pFrac);
+}
+
+int main(int argc, char *argv[]) {
+    static int pNums[MAX_LEN], pDens[MAX_LEN];
+    static fraction *ppFracs[MAX_LEN];
+    int i, irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    /* Each round sums a few whole arrays */
+    num = num / 10 + 1;
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+    irv = fractionAccumulator_init(&pAcc, pFMng);
+    assert(irv == 0);
+    irv = fractionAccumulator_init(&pOther, pFMng);
+    assert(irv == 0);
+
+    /* Empty accumulators sum to zero, and zero denominators are rejected */
+    {
+        fraction *pFrac;
+        fraction64 *pFrac64;
+        int n, d;
+
+        irv = fractionManager_getFraction(&pFrac, pFMng, 5, 7);
+        assert(irv == 0);
+        irv = fractionManager_getFraction64(&pFrac64, pFMng, 5, 7);
+        assert(irv == 0);
+        irv = fractionAccumulator_snapshot(pFrac, pAcc);
+        assert(irv == 0);
+        fraction_getTerms(&n, &d, pFrac);
+        assert(n == 0 && d == 1);
+
+        irv = fractionAccumulator_addTerms(pAcc, 3, 0);
+        assert(irv == 1);
+        irv = fractionAccumulator_addTerms(pAcc, -3, 6);
+        assert(irv == 0);
+        pNums[0] = 1;
+        pDens[0] = 0;
+        pNums[1] = 1;
+        pDens[1] = 3;
+        irv = fractionAccumulator_addTermsArray(pAcc, pNums, pDens, 2);
+        assert(irv == 1);
+        irv = fractionAccumulator_snapshot64(pFrac64, pAcc);
+        assert(irv == 0);
+        assertFraction64(pFrac64, -1, 6);
+
+        /* Snapshots don't reset the sum, but finalizing does */
+        fractionManager_releaseFraction(pFrac);
+        irv = fractionAccumulator_finalize(&pFrac, pAcc);
+        assert(irv == 0);
+        fraction_getTerms(&n, &d, pFrac);
+        assert(n == -1 && d == 6);
+        irv = fractionAccumulator_snapshot64(pFrac64, pAcc);
+        assert(irv == 0);
+        assertFraction64(pFrac64, 0, 1);
+
+        fractionManager_releaseFraction(pFrac);
+        fractionManager_releaseFraction64(pFrac64);
+    }
+
+    srand(time(0));
+
+    while (num > 0) {
+        fractionBig *pRef, *pTerm, *pSum;
+        fraction64 *pFrac64;
+        fraction *pFinal, *pFrac;
+        int a, b, d, len, mode, n;
+
+        /* Lazy managers result in unreduced fractions */
+        fractionManager_setLazy(pFMng, num % 2);
+
+        /* Either small terms with power of two denominators, so the sum
+         * always fits into an int, or random ones, so it quickly overflows
+         * 64 bits */
+        mode = rand() % 2;
+        len = rand() % MAX_LEN + 1;
+        for (i = 0; i < len; i++) {
+            if (mode == 0) {
+                pNums[i] = rand() % 0x800 - 0x400;
+                pDens[i] = 1 << (rand() % 11);
+            }
+            else {
+                pNums[i] = rand() % 0x10000 - 0x8000;
+                pDens[i] = rand() % 0x4000 + 1;
+            }
+            if (rand() % 2) {
+                pDens[i] = -pDens[i];
+            }
+            irv = fractionManager_getFraction(&ppFracs[i], pFMng, pNums[i],
+                    pDens[i]);
+            assert(irv == 0);
+        }
+        /* Multiplying by 1 leaves the fractions unreduced on lazy mode */
+        irv = fractionManager_getFraction(&pFrac, pFMng, 3, 3);
+        assert(irv == 0);
+        for (i = 0; i < len; i += 3) {
+            fraction_mul(ppFracs[i], ppFracs[i], pFrac);
+        }
+        fractionManager_releaseFraction(pFrac);
+
+        irv = fractionManager_igetFractionBig(&pRef, pFMng, 0);
+        assert(irv == 0);
+        for (i = 0; i < len; i++) {
+            irv = fractionManager_getFractionBig(&pTerm, pFMng, pNums[i],
+                    pDens[i]);
+            assert(irv == 0);
+            irv = fractionBig_sum(pRef, pRef, pTerm);
+            assert(irv == 0);
+            fractionManager_releaseFractionBig(pTerm);
+        }
+
+        /* One at a time (on one accumulator) and in bulk (on the other) */
+        for (i = 0; i < len; i++) {
+            irv = fractionAccumulator_add(pAcc, ppFracs[i]);
+            assert(irv == 0);
+        }
+        if (rand() % 2) {
+            irv = fractionAccumulator_addTermsArray(pOther, pNums, pDens,
+                    len);
+        }
+        else {
+            irv = fractionAccumulator_addArray(pOther, ppFracs, len);
+        }
+        assert(irv == 0);
+
+        /* Small sums are retrieved as is, and they must agree */
+        irv = fractionManager_igetFraction64(&pFrac64, pFMng, 0);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pFrac, pFMng, 0);
+        assert(irv == 0);
+        if (mode == 0) {
+            irv = fractionBig_narrow(pFrac64, pRef);
+            assert(irv == 0);
+            irv = fraction64_narrow(pFrac, pFrac64);
+            assert(irv == 0);
+            fraction_getTerms(&n, &d, pFrac);
+
+            irv = fractionAccumulator_snapshot64(pFrac64, pAcc);
+            assert(irv == 0);
+            assertFraction64(pFrac64, n, d);
+            irv = fractionAccumulator_snapshot(pFrac, pOther);
+            assert(irv == 0);
+            fraction_getTerms(&a, &b, pFrac);
+            assert(a == n && b == d);
+        }
+
+        /* Adding the same fractions twice doubles the sum (even if it was
+         * already folded into a big fraction) */
+        irv = fractionAccumulator_addTermsArray(pAcc, pNums, pDens, len);
+        assert(irv == 0);
+        irv = fractionBig_sum(pRef, pRef, pRef);
+        assert(irv == 0);
+
+        irv = fractionAccumulator_finalizeBig(&pSum, pAcc);
+        assert(irv == 0);
+        assertEqualBig(pSum, pRef);
+        fractionManager_releaseFractionBig(pSum);
+
+        /* Finalizing resets the accumulator */
+        irv = fractionAccumulator_snapshot(pFrac, pAcc);
+        assert(irv == 0);
+        fraction_getTerms(&n, &d, pFrac);
+        assert(n == 0 && d == 1);
+
+        /* Only sums that fit into a regular fraction may be retrieved as
+         * one (otherwise, the accumulator is left untouched) */
+        pFinal = 0;
+        irv = fractionAccumulator_finalize(&pFinal, pOther);
+        if (irv != 0) {
+            assert(mode != 0 && pFinal == 0);
+            fractionAccumulator_reset(pOther);
+        }
+        else {
+            fractionManager_releaseFraction(pFinal);
+        }
+        irv = fractionAccumulator_snapshot64(pFrac64, pOther);
+        assert(irv == 0);
+        assertFraction64(pFrac64, 0, 1);
+
+        for (i = 0; i < len; i++) {
+            fractionManager_releaseFraction(ppFracs[i]);
+        }
+        fractionManager_releaseFraction(pFrac);
+        fractionManager_releaseFraction64(pFrac64);
+        fractionManager_releaseFractionBig(pRef);
+
+        num--;
+    }
+
+    return 0;
+}
+
@@ -6,6 +6,7 @@
 #include <fraction/fraction.h>
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -15,6 +16,20 @@ void do_clean() {
     fractionManager_clean(&pFMng);
 }
 
+/**
+ * Retrieve the greatest common divisor of two (positive) numbers
+ */
+static int64_t get_gcd(int64_t a, int64_t b) {
+    while (b != 0) {
+        int64_t tmp;
+
+        tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+    return a;
+}
+
 int main(int argc, char *argv[]) {
     int irv, num;
 
@@ -57,6 +72,52 @@ int main(int argc, char *argv[]) {
         fractionManager_releaseFraction(pA);
         fractionManager_releaseFraction(pB);
 
+        /* Fractions whose denominators share a few factors, which must be
+         * left untouched */
+        {
+            fraction *pOut;
+            int64_t expNum, expDen, div;
+            int c, d, e, f, g, h;
+
+            g = rand() % 36 + 1;
+            c = rand() % 0x4000 - 0x2000;
+            d = g * (rand() % 0x1000 + 1);
+            e = rand() % 0x4000 - 0x2000;
+            f = g * (rand() % 0x1000 + 1);
+
+            irv = fractionManager_getFraction(&pA, pFMng, c, d);
+            assert(irv == 0);
+            irv = fractionManager_getFraction(&pB, pFMng, e, f);
+            assert(irv == 0);
+            irv = fractionManager_igetFraction(&pOut, pFMng, 0);
+            assert(irv == 0);
+            fraction_getTerms(&c, &d, pA);
+            fraction_getTerms(&e, &f, pB);
+
+            expNum = (int64_t)c * f + (int64_t)e * d;
+            expDen = (int64_t)d * f;
+            div = get_gcd(expNum < 0 ? -expNum : expNum, expDen);
+            expNum /= div;
+            expDen /= div;
+
+            fraction_sum(pOut, pA, pB);
+            fraction_getTerms(&g, &h, pOut);
+            assert(g == expNum && h == expDen);
+            fraction_getTerms(&g, &h, pA);
+            assert(g == c && h == d);
+            fraction_getTerms(&g, &h, pB);
+            assert(g == e && h == f);
+
+            /* The output may be one of the inputs */
+            fraction_sum(pA, pA, pB);
+            fraction_getTerms(&g, &h, pA);
+            assert(g == expNum && h == expDen);
+
+            fractionManager_releaseFraction(pA);
+            fractionManager_releaseFraction(pB);
+            fractionManager_releaseFraction(pOut);
+        }
+
         num--;
     }
 
@@ -0,0 +1,179 @@
+/**
+ * Simple test to check whether doubles and floats are converted into their
+ * best rational approximations (and into their exact values)
+ *
+ * @file tst/frac_approx.c
+ */
+/* M_PI isn't defined on strict ISO C builds */
+#define _XOPEN_SOURCE 700
+
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Biggest denominator checked through brute force */
+#define MAX_DENOMINATOR 256
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Retrieve the distance between a number and a fraction's value
+ */
+static double get_error(double val, fraction *pFrac) {
+    int num, den;
+
+    fraction_getTerms(&num, &den, pFrac);
+    return fabs(val - num / (double)den);
+}
+
+/**
+ * Check whether a fraction is on its lowest terms
+ */
+static int is_reduced(fraction *pFrac) {
+    int a, b;
+
+    fraction_getTerms(&a, &b, pFrac);
+    if (b <= 0) {
+        return 0;
+    }
+    a = abs(a);
+    while (b != 0) {
+        int tmp;
+
+        tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+    return a == 1;
+}
+
+int main(int argc, char *argv[]) {
+    fraction *pFrac;
+    int denominator, irv, num, numerator;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    /* Well known values */
+    irv = fractionManager_dapproxFraction(&pFrac, pFMng, 0.1, 0, 0);
+    assert(irv == 0);
+    fraction_getTerms(&numerator, &denominator, pFrac);
+    assert(numerator == 1 && denominator == 10);
+    fractionManager_releaseFraction(pFrac);
+    irv = fractionManager_dapproxFraction(&pFrac, pFMng, -M_PI, 1000, -1);
+    assert(irv == 0);
+    fraction_getTerms(&numerator, &denominator, pFrac);
+    assert(numerator == -355 && denominator == 113);
+    fractionManager_releaseFraction(pFrac);
+    irv = fractionManager_dapproxFraction(&pFrac, pFMng, M_PI, 0, 1e-2);
+    assert(irv == 0);
+    fraction_getTerms(&numerator, &denominator, pFrac);
+    assert(numerator == 22 && denominator == 7);
+    fractionManager_releaseFraction(pFrac);
+    irv = fractionManager_fapproxFraction(&pFrac, pFMng, 0.3f, 0, 0);
+    assert(irv == 0);
+    fraction_getTerms(&numerator, &denominator, pFrac);
+    assert(numerator == 3 && denominator == 10);
+    fractionManager_releaseFraction(pFrac);
+    /* Way past what the decimal constructors could handle */
+    irv = fractionManager_dapproxFraction(&pFrac, pFMng, 1234567.5, 0, 0);
+    assert(irv == 0);
+    fraction_getTerms(&numerator, &denominator, pFrac);
+    assert(numerator == 2469135 && denominator == 2);
+    fractionManager_releaseFraction(pFrac);
+
+    /* Exact values */
+    irv = fractionManager_dexactFraction(&pFrac, pFMng, -2.375);
+    assert(irv == 0);
+    fraction_getTerms(&numerator, &denominator, pFrac);
+    assert(numerator == -19 && denominator == 8);
+    fractionManager_releaseFraction(pFrac);
+    irv = fractionManager_dexactFraction(&pFrac, pFMng, 0.1);
+    assert(irv == 1);
+
+    /* Values that can't be represented */
+    irv = fractionManager_dapproxFraction(&pFrac, pFMng, 1e10, 0, 0);
+    assert(irv == 1);
+    irv = fractionManager_dapproxFraction(&pFrac, pFMng, NAN, 0, 0);
+    assert(irv == 1);
+    irv = fractionManager_fapproxFraction(&pFrac, pFMng, -INFINITY, 0, 0);
+    assert(irv == 1);
+
+    srand(time(0));
+
+    while (num > 0) {
+        double val, maxError, best;
+        int i, maxDen;
+
+        val = (rand() - RAND_MAX / 2) / (double)(rand() % 0x10000 + 1);
+        maxDen = rand() % MAX_DENOMINATOR + 1;
+
+        /* Nothing with a smaller denominator may be closer */
+        irv = fractionManager_dapproxFraction(&pFrac, pFMng, val, maxDen, -1);
+        assert(irv == 0);
+        assert(is_reduced(pFrac));
+        fraction_getTerms(&numerator, &denominator, pFrac);
+        assert(denominator <= maxDen);
+        best = get_error(val, pFrac);
+        for (i = 1; i <= maxDen; i++) {
+            assert(fabs(val - floor(val * i + 0.5) / i) >= best - 1e-9);
+        }
+        fractionManager_releaseFraction(pFrac);
+
+        /* Nothing with a smaller denominator may be close enough */
+        maxError = (rand() % 1000 + 1) * 1e-6;
+        irv = fractionManager_dapproxFraction(&pFrac, pFMng, val, 0, maxError);
+        assert(irv == 0);
+        assert(is_reduced(pFrac));
+        assert(get_error(val, pFrac) <= maxError);
+        fraction_getTerms(&numerator, &denominator, pFrac);
+        for (i = 1; i < denominator; i++) {
+            assert(fabs(val - floor(val * i + 0.5) / i) > maxError);
+        }
+        fractionManager_releaseFraction(pFrac);
+
+        /* Converts back to the very same value */
+        irv = fractionManager_dapproxFraction(&pFrac, pFMng, val, 0, 0);
+        assert(irv == 0);
+        assert(is_reduced(pFrac));
+        fraction_getTerms(&numerator, &denominator, pFrac);
+        assert(numerator / (double)denominator == val);
+        fractionManager_releaseFraction(pFrac);
+
+        /* Dyadic values are always exact */
+        val = (rand() % 0x100000 - 0x80000) / (double)(1 << (rand() % 20));
+        irv = fractionManager_dexactFraction(&pFrac, pFMng, val);
+        assert(irv == 0);
+        assert(is_reduced(pFrac));
+        fraction_getTerms(&numerator, &denominator, pFrac);
+        assert(numerator / (double)denominator == val);
+        fractionManager_releaseFraction(pFrac);
+
+        num--;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,174 @@
+/**
+ * Simple test to check whether batch operations yield the same results as
+ * operating on each fraction of a pool
+ *
+ * @file tst/frac_batch.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+static fractionPool *pPool = 0;
+static fractionHandle *pHandles = 0;
+static int *pOutNums = 0;
+static int *pOutDens = 0;
+
+void do_clean() {
+    if (pHandles) {
+        free(pHandles);
+    }
+    if (pOutNums) {
+        free(pOutNums);
+    }
+    if (pOutDens) {
+        free(pOutDens);
+    }
+    fractionPool_clean(&pPool);
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Check that every result of a batch operation is equal to the pool's
+ *
+ * @param  [ in]pNums The batch results' numerators
+ * @param  [ in]pDens The batch results' denominators
+ * @param  [ in]num   Number of results
+ */
+static void assertEqual(int *pNums, int *pDens, int num) {
+    int *pPoolNums, *pPoolDens;
+    int i, len;
+
+    fractionPool_getArrays(&pPoolNums, &pPoolDens, &len, pPool);
+    for (i = 0; i < num; i++) {
+        fractionHandle out;
+
+        out = pHandles[i * 3 + 2];
+        assert(pNums[i] == pPoolNums[out]);
+        assert(pDens[i] == pPoolDens[out]);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int *pNumsA, *pDensA, *pNumsB, *pDensB, *pPoolNums, *pPoolDens;
+    int i, irv, len, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000000/*maxNumberChecked*/);
+    assert(irv == 0);
+    irv = fractionPool_init(&pPool, pFMng, num * 3);
+    assert(irv == 0);
+
+    pHandles = (fractionHandle*)malloc(sizeof(fractionHandle) * num * 3);
+    assert(pHandles);
+    pOutNums = (int*)malloc(sizeof(int) * num * 2);
+    assert(pOutNums);
+    pOutDens = (int*)malloc(sizeof(int) * num * 2);
+    assert(pOutDens);
+
+    srand(time(0));
+
+    /* Store the operands of each operation as a, b and output */
+    for (i = 0; i < num; i++) {
+        int a, b;
+
+        a = rand() % 0x8000 - 0x4000;
+        b = rand() % 0x4000 + 1;
+        irv = fractionPool_getFraction(pHandles + i * 3, pPool, a, b);
+        assert(irv == 0);
+
+        a = rand() % 0x8000 - 0x4000;
+        b = rand() % 0x4000 + 1;
+        if (a == 0) {
+            a = 1;
+        }
+        irv = fractionPool_getFraction(pHandles + i * 3 + 1, pPool, a, b);
+        assert(irv == 0);
+
+        irv = fractionPool_igetFraction(pHandles + i * 3 + 2, pPool, 0);
+        assert(irv == 0);
+    }
+
+    /* Copy the operands into contiguous arrays */
+    fractionPool_getArrays(&pPoolNums, &pPoolDens, &len, pPool);
+    assert(len == num * 3);
+    pNumsA = pOutNums + num;
+    pDensA = pOutDens + num;
+    pNumsB = (int*)malloc(sizeof(int) * num * 2);
+    assert(pNumsB);
+    pDensB = pNumsB + num;
+    for (i = 0; i < num; i++) {
+        pNumsA[i] = pPoolNums[pHandles[i * 3]];
+        pDensA[i] = pPoolDens[pHandles[i * 3]];
+        pNumsB[i] = pPoolNums[pHandles[i * 3 + 1]];
+        pDensB[i] = pPoolDens[pHandles[i * 3 + 1]];
+    }
+
+#define CHECK_OP(op) \
+  do { \
+    for (i = 0; i < num; i++) { \
+        fractionPool_ ## op(pPool, pHandles[i * 3 + 2], pHandles[i * 3], \
+                pHandles[i * 3 + 1]); \
+    } \
+    fractionBatch_ ## op(pOutNums, pOutDens, pNumsA, pDensA, pNumsB, pDensB, \
+            num); \
+    assertEqual(pOutNums, pOutDens, num); \
+  } while (0)
+
+    CHECK_OP(sum);
+    CHECK_OP(sub);
+    CHECK_OP(mul);
+    CHECK_OP(div);
+
+#undef CHECK_OP
+
+    /* Broadcast the first b, in place */
+#define CHECK_OP(op) \
+  do { \
+    for (i = 0; i < num; i++) { \
+        fractionPool_ ## op(pPool, pHandles[i * 3 + 2], pHandles[i * 3 + 2], \
+                pHandles[1]); \
+    } \
+    fractionBatch_ ## op ## Scalar(pOutNums, pOutDens, pOutNums, pOutDens, \
+            pNumsB[0], pDensB[0], num); \
+    assertEqual(pOutNums, pOutDens, num); \
+  } while (0)
+
+    /* Reset every output to a */
+    for (i = 0; i < num; i++) {
+        fractionPool_sub(pPool, pHandles[i * 3 + 2], pHandles[i * 3],
+                pHandles[i * 3]);
+        fractionPool_sum(pPool, pHandles[i * 3 + 2], pHandles[i * 3 + 2],
+                pHandles[i * 3]);
+        pOutNums[i] = pNumsA[i];
+        pOutDens[i] = pDensA[i];
+    }
+
+    CHECK_OP(mul);
+    CHECK_OP(div);
+    CHECK_OP(sum);
+    CHECK_OP(sub);
+
+#undef CHECK_OP
+
+    free(pNumsB);
+
+    return 0;
+}
+
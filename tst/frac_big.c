@@ -0,0 +1,137 @@
+/**
+ * Simple test to check whether operations on big fractions stay exact, even
+ * after their terms get promoted from 64 bits
+ *
+ * @file tst/frac_big.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/** How many fractions are multiplied/added on each round */
+#define NUM_TERMS 40
+
+int main(int argc, char *argv[]) {
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    /* Each round is much more expensive than on other tests */
+    num = num / 20 + 1;
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        fractionBig *ppTerms[NUM_TERMS], *pProd, *pSum;
+        fraction64 *pSmall;
+        double dSum, val;
+        int64_t quot;
+        int i;
+
+        irv = fractionManager_igetFractionBig(&pProd, pFMng, 1);
+        assert(irv == 0);
+        irv = fractionManager_igetFractionBig(&pSum, pFMng, 0);
+        assert(irv == 0);
+
+        /* Multiply and add a bunch of random fractions, so the terms get
+         * much bigger than 64 bits */
+        dSum = 0.0;
+        i = 0;
+        while (i < NUM_TERMS) {
+            int64_t a, b;
+
+            a = rand() - RAND_MAX / 2;
+            b = rand() + 1;
+            if (a == 0) {
+                a = 1;
+            }
+
+            irv = fractionManager_getFractionBig(&ppTerms[i], pFMng, a, b);
+            assert(irv == 0);
+            irv = fractionBig_mul(pProd, pProd, ppTerms[i]);
+            assert(irv == 0);
+            irv = fractionBig_sum(pSum, pSum, ppTerms[i]);
+            assert(irv == 0);
+            dSum += (double)a / b;
+
+            i++;
+        }
+
+        fractionBig_dconvert(&val, pSum);
+        assert(val - dSum < 1e-6 && dSum - val < 1e-6);
+        fractionBig_dconvert(&val, pProd);
+        assert(val == val);
+
+        /* Undo everything (on a different order), which must result in
+         * exactly 1 and 0 */
+        i = NUM_TERMS - 1;
+        while (i >= 0) {
+            int j;
+
+            j = (i * 7) % NUM_TERMS;
+            irv = fractionBig_div(pProd, pProd, ppTerms[j]);
+            assert(irv == 0);
+            irv = fractionBig_sub(pSum, pSum, ppTerms[j]);
+            assert(irv == 0);
+
+            i--;
+        }
+
+        irv = fractionManager_igetFraction64(&pSmall, pFMng, 0);
+        assert(irv == 0);
+        irv = fractionBig_narrow(pSmall, pProd);
+        assert(irv == 0);
+        fraction64_iconvert(&quot, pSmall);
+        assert(quot == 1);
+        fractionManager_releaseFraction64(pSmall);
+        irv = fractionBig_iconvert(&quot, pProd);
+        assert(irv == 0);
+        assert(quot == 1);
+        irv = fractionBig_iconvert(&quot, pSum);
+        assert(irv == 0);
+        assert(quot == 0);
+        fractionBig_dconvert(&val, pSum);
+        assert(val == 0.0);
+
+        /* Division by zero must fail */
+        irv = fractionBig_div(pProd, pProd, pSum);
+        assert(irv != 0);
+
+        i = 0;
+        while (i < NUM_TERMS) {
+            fractionManager_releaseFractionBig(ppTerms[i]);
+            i++;
+        }
+        fractionManager_releaseFractionBig(pProd);
+        fractionManager_releaseFractionBig(pSum);
+
+        num--;
+    }
+
+    return 0;
+}
+
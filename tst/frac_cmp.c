@@ -0,0 +1,274 @@
+/**
+ * Simple test to check whether comparing and sorting fractions agrees with
+ * comparing their reduced values, even if they are left unreduced
+ *
+ * @file tst/frac_cmp.c
+ */
+#include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Biggest array ever sorted by the test (so it's also radix sorted) */
+#define MAX_LEN 600
+
+static fractionManager *pFMng = 0;
+static fraction *ppFracs[MAX_LEN];
+static fraction *ppSorted[MAX_LEN];
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Retrieve a random term on [1, 2^bits), which may also be negative
+ */
+static int get_term(int bits, int isSigned) {
+    int val;
+
+    val = rand() % ((1 << bits) - 1) + 1;
+    if (isSigned && rand() % 2) {
+        val = -val;
+    }
+    return val;
+}
+
+/**
+ * Retrieve two adjacent fractions on [0, 1), C/D < A/B, whose difference
+ * (1 / (B * D)) is usually too small to be noticed by doubles
+ */
+static void get_neighbours(int *pA, int *pB, int *pC, int *pD) {
+    int64_t a, b, c, d, r0, r1, s0, s1;
+
+    do {
+        b = (1 << 29) + rand() % (1 << 29);
+        d = (1 << 29) + rand() % (1 << 29);
+
+        /* Find the inverse of D modulo B (so A * D - B * C = 1) */
+        r0 = b;
+        r1 = d % b;
+        s0 = 0;
+        s1 = 1;
+        while (r1 != 0) {
+            int64_t q, tmp;
+
+            q = r0 / r1;
+            tmp = r0 - q * r1;
+            r0 = r1;
+            r1 = tmp;
+            tmp = s0 - q * s1;
+            s0 = s1;
+            s1 = tmp;
+        }
+    } while (r0 != 1);
+
+    a = ((s0 % b) + b) % b;
+    c = (a * d - 1) / b;
+    *pA = (int)a;
+    *pB = (int)b;
+    *pC = (int)c;
+    *pD = (int)d;
+}
+
+/**
+ * Compare two fractions through their reduced values
+ */
+static int get_cmp(fraction *pA, fraction *pB) {
+    fractionValue a, b;
+
+    fraction_vconvert(&a, pA);
+    fraction_vconvert(&b, pB);
+    return fractionValue_compare(&a, &b);
+}
+
+/**
+ * Retrieve the index of a fraction on the unsorted array
+ */
+static int get_index(fraction *pFrac, int len) {
+    int i;
+
+    for (i = 0; i < len; i++) {
+        if (ppFracs[i] == pFrac) {
+            return i;
+        }
+    }
+    assert(0);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    int cmp, i, irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    for (i = 0; i < num; i++) {
+        fraction *pA, *pB, *pOut, *pDiv;
+        int64_t lhs, rhs;
+        int a, b, c, d, k, sign;
+
+        /* Lazy managers keep the operands unreduced (and dividing by a
+         * negative fraction leaves a negative denominator) */
+        fractionManager_setLazy(pFMng, i % 2);
+
+        a = get_term(14, 1);
+        b = get_term(14, 0);
+        c = get_term(14, 1);
+        d = get_term(14, 0);
+        if (rand() % 4 == 0) {
+            /* Same value, on different terms */
+            k = get_term(3, 0);
+            c = a * k;
+            d = b * k;
+        }
+        else if (rand() % 4 == 0) {
+            a = 0;
+        }
+        lhs = (int64_t)a * d;
+        rhs = (int64_t)c * b;
+        cmp = (lhs > rhs) - (lhs < rhs);
+        sign = (a > 0) - (a < 0);
+
+        irv = fractionManager_getFraction(&pA, pFMng, a, b);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&pB, pFMng, c, d);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&pDiv, pFMng, -1, 1);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pOut, pFMng, 0);
+        assert(irv == 0);
+        if (rand() % 2) {
+            /* Negate both fractions, which flips their order */
+            fraction_div(pA, pA, pDiv);
+            fraction_div(pB, pB, pDiv);
+            cmp = -cmp;
+            sign = -sign;
+        }
+
+        assert(fraction_cmp(pA, pB) == cmp);
+        assert(fraction_cmp(pB, pA) == -cmp);
+        assert(fraction_cmp(pA, pA) == 0);
+        assert(fraction_eq(pA, pB) == (cmp == 0));
+        assert(fraction_eq(pB, pB));
+        assert(fraction_isZero(pA) == (a == 0));
+        assert(fraction_sign(pA) == sign);
+        assert(fraction_sign(pDiv) == -1);
+
+        fraction_min(pOut, pA, pB);
+        assert(fraction_cmp(pOut, cmp <= 0 ? pA : pB) == 0);
+        fraction_max(pOut, pA, pB);
+        assert(fraction_cmp(pOut, cmp >= 0 ? pA : pB) == 0);
+        assert(get_cmp(pA, pB) == cmp);
+
+        /* The output may be one of the inputs */
+        fraction_max(pB, pA, pB);
+        assert(fraction_cmp(pB, cmp >= 0 ? pA : pOut) == 0);
+        fraction_min(pA, pA, pB);
+        assert(fraction_cmp(pA, pB) == (cmp >= 0 ? 0 : -1));
+
+        /* Fractions too close for doubles are still ordered exactly */
+        get_neighbours(&a, &b, &c, &d);
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+        irv = fractionManager_getFraction(&pA, pFMng, a, b);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&pB, pFMng, c, d);
+        assert(irv == 0);
+        assert(fraction_cmp(pA, pB) == 1);
+        assert(fraction_cmp(pB, pA) == -1);
+        assert(!fraction_eq(pA, pB));
+
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+        fractionManager_releaseFraction(pDiv);
+        fractionManager_releaseFraction(pOut);
+    }
+
+    /* Each round sorts a whole array */
+    num = num / 10 + 1;
+    while (num > 0) {
+        fraction *pK;
+        int j, len;
+
+        fractionManager_setLazy(pFMng, num % 2);
+
+        /* Many repeated values (some of them on different terms, so they
+         * must stay on their original order, and some of them with negative
+         * denominators) and a few neighbours */
+        len = rand() % MAX_LEN + 1;
+        irv = fractionManager_getFraction(&pK, pFMng, -5, 5);
+        assert(irv == 0);
+        for (i = 0; i < len; i++) {
+            int a, b, c, d;
+
+            if (i + 1 < len && rand() % 8 == 0) {
+                get_neighbours(&a, &b, &c, &d);
+                irv = fractionManager_getFraction(&ppFracs[i], pFMng, a, b);
+                assert(irv == 0);
+                i++;
+                irv = fractionManager_getFraction(&ppFracs[i], pFMng, c, d);
+                assert(irv == 0);
+                continue;
+            }
+            irv = fractionManager_getFraction(&ppFracs[i], pFMng,
+                    get_term(4, 1), get_term(3, 0));
+            assert(irv == 0);
+            if (rand() % 2) {
+                fraction_div(ppFracs[i], ppFracs[i], pK);
+            }
+        }
+        fractionManager_releaseFraction(pK);
+
+        for (i = 0; i < len; i++) {
+            ppSorted[i] = ppFracs[i];
+        }
+        irv = fraction_sortArray(ppSorted, len);
+        assert(irv == 0);
+
+        for (i = 0; i < len; i++) {
+            /* Every fraction is still there, exactly once */
+            for (j = 0; j < i; j++) {
+                assert(ppSorted[j] != ppSorted[i]);
+            }
+            get_index(ppSorted[i], len);
+
+            if (i > 0) {
+                cmp = fraction_cmp(ppSorted[i - 1], ppSorted[i]);
+                assert(cmp <= 0);
+                assert(get_cmp(ppSorted[i - 1], ppSorted[i]) == cmp);
+                if (cmp == 0) {
+                    assert(get_index(ppSorted[i - 1], len) <
+                            get_index(ppSorted[i], len));
+                }
+            }
+        }
+
+        for (i = 0; i < len; i++) {
+            fractionManager_releaseFraction(ppFracs[i]);
+        }
+        num--;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,176 @@
+/**
+ * Stress test for concurrent managers: many threads retrieve and release
+ * fractions at once, and hand some of them to other threads
+ *
+ * @file tst/frac_concurrent.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Number of threads using the manager at once */
+#define NUM_THREADS 4
+/** Number of fractions retrieved by each thread on every iteration */
+#define NUM_TERMS 8
+/** Number of fractions that may be waiting to be handed to other threads */
+#define MAILBOX_SIZE 64
+
+static fractionManager *pFMng = 0;
+
+/** Fractions handed from one thread to another, along their values */
+static fraction *ppMailbox[MAILBOX_SIZE];
+static int pMailboxValues[MAILBOX_SIZE];
+static int mailboxLen = 0;
+static pthread_mutex_t mailboxLock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Number of iterations of each thread */
+static int numIterations = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Check that a fraction has the expected (integer) value
+ *
+ * @param  [ in]pFrac The fraction
+ * @param  [ in]val   The expected value
+ */
+static void assertValue(fraction *pFrac, int val) {
+    int quot, rem;
+
+    fraction_divConvert(&quot, &rem, pFrac);
+    assert(quot == val);
+    assert(rem == 0);
+}
+
+/**
+ * Repeatedly retrieve fractions, hand some to other threads and release the
+ * rest (along those received from other threads)
+ *
+ * @param  [ in]pArg The thread's seed
+ * @return           Always NULL
+ */
+static void* stress(void *pArg) {
+    unsigned int seed;
+    int i, irv;
+
+    seed = (unsigned int)(uintptr_t)pArg;
+
+    for (i = 0; i < numIterations; i++) {
+        fraction *ppTerms[NUM_TERMS], *pTwo;
+        fractionBig *pBig, *pFactor;
+        int pValues[NUM_TERMS];
+        int j;
+
+        irv = fractionManager_igetFraction(&pTwo, pFMng, 2);
+        assert(irv == 0);
+        for (j = 0; j < NUM_TERMS; j++) {
+            seed = seed * 1103515245u + 12345u;
+            pValues[j] = (int)((seed >> 16) % 10000);
+            irv = fractionManager_igetFraction(ppTerms + j, pFMng,
+                    pValues[j]);
+            assert(irv == 0);
+
+            /* (val * 2) / 2, so the fraction is actually operated on */
+            fraction_mul(ppTerms[j], ppTerms[j], pTwo);
+            fraction_div(ppTerms[j], ppTerms[j], pTwo);
+        }
+        fractionManager_releaseFraction(pTwo);
+
+        /* Hand half of the fractions to other threads and take theirs */
+        pthread_mutex_lock(&mailboxLock);
+        for (j = 0; j < NUM_TERMS / 2; j++) {
+            if (mailboxLen > 0) {
+                mailboxLen--;
+                assertValue(ppMailbox[mailboxLen], pMailboxValues[mailboxLen]);
+                fractionManager_releaseFraction(ppMailbox[mailboxLen]);
+            }
+            if (mailboxLen < MAILBOX_SIZE) {
+                ppMailbox[mailboxLen] = ppTerms[j];
+                pMailboxValues[mailboxLen] = pValues[j];
+                ppTerms[j] = 0;
+                mailboxLen++;
+            }
+        }
+        pthread_mutex_unlock(&mailboxLock);
+
+        for (j = 0; j < NUM_TERMS; j++) {
+            if (ppTerms[j]) {
+                assertValue(ppTerms[j], pValues[j]);
+                fractionManager_releaseFraction(ppTerms[j]);
+            }
+        }
+
+        /* Also exercise the limbs of big fractions: (2^30)^4 / (2^30)^4 */
+        irv = fractionManager_igetFractionBig(&pBig, pFMng, 1);
+        assert(irv == 0);
+        irv = fractionManager_igetFractionBig(&pFactor, pFMng, 1 << 30);
+        assert(irv == 0);
+        for (j = 0; j < 4; j++) {
+            irv = fractionBig_mul(pBig, pBig, pFactor);
+            assert(irv == 0);
+        }
+        for (j = 0; j < 4; j++) {
+            irv = fractionBig_div(pBig, pBig, pFactor);
+            assert(irv == 0);
+        }
+        fractionManager_releaseFractionBig(pFactor);
+        fractionManager_releaseFractionBig(pBig);
+    }
+
+    fractionManager_flushThreadCache(pFMng);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t pThreads[NUM_THREADS];
+    fractionManagerConfig config;
+    int i, irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    numIterations = num;
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    fractionManager_getDefaultConfig(&config);
+    config.isConcurrent = 1;
+    irv = fractionManager_initConfig(&pFMng, &config);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        irv = pthread_create(pThreads + i, 0, stress,
+                (void*)(uintptr_t)rand());
+        assert(irv == 0);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(pThreads[i], 0);
+    }
+
+    /* Release everything left on the mailbox */
+    while (mailboxLen > 0) {
+        mailboxLen--;
+        assertValue(ppMailbox[mailboxLen], pMailboxValues[mailboxLen]);
+        fractionManager_releaseFraction(ppMailbox[mailboxLen]);
+    }
+
+    return 0;
+}
+
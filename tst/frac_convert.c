@@ -0,0 +1,222 @@
+/**
+ * Simple test to check whether arrays of fractions are converted into the
+ * same values as the scalar converters (and, for fixed points, into the
+ * correctly rounded values)
+ *
+ * @file tst/frac_convert.c
+ */
+#include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Number of fractions converted at once (so it spans a few blocks) */
+#define ARRAY_SIZE 1000
+/** Number of rounding modes */
+#define NUM_ROUNDINGS 5
+
+static fractionManager *pFMng = 0;
+static fraction *ppFracs[ARRAY_SIZE];
+
+void do_clean() {
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE; i++) {
+        if (ppFracs[i]) {
+            fractionManager_releaseFraction(ppFracs[i]);
+        }
+    }
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Retrieve the expected fixed point value of a fraction, through 128 bits
+ * operations
+ */
+static int64_t get_fixedPoint(int *pSaturated, int num, int den, int digits,
+        int rounding) {
+    __int128 val, quot, rem;
+    int isNegative;
+
+    val = (__int128)num * fractionValue_pow10[digits];
+    if (den < 0) {
+        val = -val;
+        den = -den;
+    }
+    isNegative = (val < 0);
+    if (isNegative) {
+        val = -val;
+    }
+    quot = val / den;
+    rem = val % den;
+
+    switch (rounding) {
+    case FRACTION_ROUND_FLOOR:
+        quot += (isNegative && rem != 0);
+        break;
+    case FRACTION_ROUND_CEIL:
+        quot += (!isNegative && rem != 0);
+        break;
+    case FRACTION_ROUND_HALF_AWAY:
+        quot += (rem * 2 >= den);
+        break;
+    case FRACTION_ROUND_HALF_EVEN:
+        quot += (rem * 2 > den || (rem * 2 == den && (quot & 1)));
+        break;
+    default:
+        break;
+    }
+    if (isNegative) {
+        quot = -quot;
+    }
+
+    *pSaturated = 1;
+    if (quot > INT64_MAX) {
+        return INT64_MAX;
+    }
+    else if (quot < INT64_MIN) {
+        return INT64_MIN;
+    }
+    *pSaturated = 0;
+    return (int64_t)quot;
+}
+
+int main(int argc, char *argv[]) {
+    double pDoubles[ARRAY_SIZE];
+    float pFloats[ARRAY_SIZE];
+    int64_t pFixed[ARRAY_SIZE];
+    int pNums[4], pDens[4];
+    int64_t pOut[4];
+    int i, irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    /* Ties: 5/2, -5/2, 7/2 and -7/2 */
+    pNums[0] = 5;
+    pNums[1] = -5;
+    pNums[2] = 7;
+    pNums[3] = -7;
+    pDens[0] = pDens[1] = pDens[2] = pDens[3] = 2;
+    irv = fractionBatch_fxconvert(pOut, pNums, pDens, 0, FRACTION_ROUND_TRUNC,
+            4);
+    assert(irv == 0);
+    assert(pOut[0] == 2 && pOut[1] == -2 && pOut[2] == 3 && pOut[3] == -3);
+    irv = fractionBatch_fxconvert(pOut, pNums, pDens, 0, FRACTION_ROUND_FLOOR,
+            4);
+    assert(irv == 0);
+    assert(pOut[0] == 2 && pOut[1] == -3 && pOut[2] == 3 && pOut[3] == -4);
+    irv = fractionBatch_fxconvert(pOut, pNums, pDens, 0, FRACTION_ROUND_CEIL,
+            4);
+    assert(irv == 0);
+    assert(pOut[0] == 3 && pOut[1] == -2 && pOut[2] == 4 && pOut[3] == -3);
+    irv = fractionBatch_fxconvert(pOut, pNums, pDens, 0,
+            FRACTION_ROUND_HALF_AWAY, 4);
+    assert(irv == 0);
+    assert(pOut[0] == 3 && pOut[1] == -3 && pOut[2] == 4 && pOut[3] == -4);
+    irv = fractionBatch_fxconvert(pOut, pNums, pDens, 0,
+            FRACTION_ROUND_HALF_EVEN, 4);
+    assert(irv == 0);
+    assert(pOut[0] == 2 && pOut[1] == -2 && pOut[2] == 4 && pOut[3] == -4);
+
+    /* 1/3 with every digit, a zero denominator and a saturated value */
+    pNums[0] = 1;
+    pDens[0] = 3;
+    pNums[1] = 7;
+    pDens[1] = 0;
+    pNums[2] = -INT_MAX;
+    pDens[2] = 1;
+    pNums[3] = 2;
+    pDens[3] = -3;
+    irv = fractionBatch_fxconvert(pOut, pNums, pDens, 18,
+            FRACTION_ROUND_HALF_AWAY, 4);
+    assert(irv == 1);
+    assert(pOut[0] == 333333333333333333LL);
+    assert(pOut[1] == 0);
+    assert(pOut[2] == INT64_MIN);
+    assert(pOut[3] == -666666666666666667LL);
+    /* Digits past the maximum are clamped */
+    irv = fractionBatch_fxconvert(pOut, pNums, pDens, 30,
+            FRACTION_ROUND_TRUNC, 1);
+    assert(irv == 0);
+    assert(pOut[0] == 333333333333333333LL);
+
+    srand(time(0));
+
+    while (num > 0) {
+        int digits, rounding;
+
+        for (i = 0; i < ARRAY_SIZE; i++) {
+            int a, b;
+
+            if (ppFracs[i]) {
+                fractionManager_releaseFraction(ppFracs[i]);
+            }
+            a = rand() - RAND_MAX / 2;
+            b = rand() % 0x10000 + 1;
+            if (rand() % 2) {
+                b = -b;
+            }
+            irv = fractionManager_getFraction(&ppFracs[i], pFMng, a, b);
+            assert(irv == 0);
+        }
+
+        /* Must be bit for bit equal to the scalar converters */
+        fraction_dconvertArray(pDoubles, ppFracs, ARRAY_SIZE);
+        fraction_fconvertArray(pFloats, ppFracs, ARRAY_SIZE);
+        for (i = 0; i < ARRAY_SIZE; i++) {
+            double dval;
+            float fval;
+
+            fraction_dconvert(&dval, ppFracs[i]);
+            fraction_fconvert(&fval, ppFracs[i]);
+            assert(memcmp(&dval, &pDoubles[i], sizeof(double)) == 0);
+            assert(memcmp(&fval, &pFloats[i], sizeof(float)) == 0);
+        }
+
+        digits = rand() % (FRACTION_MAX_DECIMAL_DIGITS + 1);
+        rounding = rand() % NUM_ROUNDINGS;
+        irv = fraction_fxconvertArray(pFixed, ppFracs, digits, rounding,
+                ARRAY_SIZE);
+        {
+            int isSaturated;
+
+            isSaturated = 0;
+            for (i = 0; i < ARRAY_SIZE; i++) {
+                int64_t expected;
+                int a, b, saturated;
+
+                fraction_getTerms(&a, &b, ppFracs[i]);
+                expected = get_fixedPoint(&saturated, a, b, digits, rounding);
+                assert(pFixed[i] == expected);
+                isSaturated |= saturated;
+            }
+            assert(irv == isSaturated);
+        }
+
+        num--;
+    }
+
+    return 0;
+}
+
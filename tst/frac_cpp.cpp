@@ -0,0 +1,187 @@
+/**
+ * Simple test to check whether the C++ fractions are evaluated at compile
+ * time and whether they agree with the C API
+ *
+ * @file tst/frac_cpp.cpp
+ */
+#include <fraction/fraction.hpp>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <ratio>
+
+/** The C API's fraction has the same name, so use an alias */
+template <typename T> using cppFraction = libfraction::fraction<T>;
+#if defined(__SIZEOF_INT128__)
+typedef cppFraction<libfraction::int128> cppFraction128;
+#endif
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/* Everything below must be folded by the compiler */
+static_assert(cppFraction<int32_t>(6, -4) == cppFraction<int32_t>(-3, 2),
+        "fractions must be kept on their lowest terms");
+static_assert(cppFraction<int32_t>(1, 3) + cppFraction<int32_t>(1, 6) ==
+        cppFraction<int32_t>(1, 2), "sums must be reduced");
+static_assert(cppFraction<int16_t>(300, 7) * cppFraction<int16_t>(7, 300) ==
+        1, "products must be calculated on the wide type");
+static_assert(cppFraction<int64_t>::fromRatio<std::milli>() * 1000 == 1,
+        "ratios must be converted");
+static_assert(cppFraction<int64_t>(INT64_MAX, 3) /
+        cppFraction<int64_t>(INT64_MAX, 6) == 2,
+        "products must not overflow if the result fits");
+static_assert(cppFraction<int32_t>(-1, 3) < cppFraction<int32_t>(-1, 4),
+        "comparisons must be exact");
+static_assert(cppFraction<int32_t>(7, 2).quotient() == 3 &&
+        cppFraction<int32_t>(7, 2).remainder() == 1, "wrong quotient");
+static_assert(static_cast<cppFraction<int16_t>>(cppFraction<int64_t>(4,
+        8)) == cppFraction<int16_t>(1, 2), "wrong conversion");
+
+/**
+ * Check whether a functor may be evaluated at compile time (i.e., whether its
+ * result didn't overflow)
+ */
+template <typename F, int = (F()(), 0)>
+constexpr bool isConstant(int) { return true; }
+template <typename F>
+constexpr bool isConstant(...) { return false; }
+
+struct mulFits {
+    constexpr cppFraction<int16_t> operator()() const {
+        return cppFraction<int16_t>(300) * cppFraction<int16_t>(100);
+    }
+};
+struct mulOverflows {
+    constexpr cppFraction<int16_t> operator()() const {
+        return cppFraction<int16_t>(30000) * cppFraction<int16_t>(30000);
+    }
+};
+struct sumOverflows {
+    constexpr cppFraction<int16_t> operator()() const {
+        return cppFraction<int16_t>(1, 30000) +
+                cppFraction<int16_t>(1, 29999);
+    }
+};
+struct negOverflows {
+    constexpr cppFraction<int32_t> operator()() const {
+        return -cppFraction<int32_t>(INT32_MIN);
+    }
+};
+struct divOverflows {
+    constexpr cppFraction<int64_t> operator()() const {
+        return cppFraction<int64_t>(INT64_MIN, -1);
+    }
+};
+
+static_assert(isConstant<mulFits>(0), "results that fit must compile");
+static_assert(!isConstant<mulOverflows>(0) && !isConstant<sumOverflows>(0) &&
+        !isConstant<negOverflows>(0) && !isConstant<divOverflows>(0),
+        "overflowing results must not compile");
+
+#if defined(__SIZEOF_INT128__)
+static_assert(cppFraction128(INT64_MAX) * INT64_MAX / INT64_MAX == INT64_MAX,
+        "128 bits products must not overflow if the result fits");
+static_assert(cppFraction128(2, 3) > cppFraction128(3, 5) &&
+        cppFraction128(-5, 7) < cppFraction128(-2, 3),
+        "comparisons must be exact");
+#endif
+
+/**
+ * Check a random operation against the C API
+ *
+ * @param  [ in]numA The first fraction's numerator
+ * @param  [ in]denA The first fraction's denominator
+ * @param  [ in]numB The second fraction's numerator
+ * @param  [ in]denB The second fraction's denominator
+ */
+template <typename T>
+static void check(int numA, int denA, int numB, int denB) {
+    ::fraction *pA, *pB, *pOut;
+    cppFraction<T> a(numA, denA), b(numB, denB), res;
+    int irv;
+
+    irv = a.toFraction(&pA, pFMng);
+    assert(irv == 0);
+    irv = b.toFraction(&pB, pFMng);
+    assert(irv == 0);
+    irv = fractionManager_igetFraction(&pOut, pFMng, 0);
+    assert(irv == 0);
+
+    assert(cppFraction<T>::fromFraction(pA) == a);
+
+    fraction_sum(pOut, pA, pB);
+    assert(cppFraction<T>::fromFraction(pOut) == a + b);
+    fraction_sub(pOut, pA, pB);
+    assert(cppFraction<T>::fromFraction(pOut) == a - b);
+    fraction_mul(pOut, pA, pB);
+    assert(cppFraction<T>::fromFraction(pOut) == a * b);
+    if (numB != 0) {
+        fraction_div(pOut, pA, pB);
+        assert(cppFraction<T>::fromFraction(pOut) == a / b);
+    }
+
+    /* Comparisons must agree with doubles (which are exact on these) */
+    assert((a < b) == (static_cast<double>(a) < static_cast<double>(b)));
+    assert((a == b) == (static_cast<double>(a) == static_cast<double>(b)));
+
+    res = a;
+    res += b;
+    res -= b;
+    assert(res == a);
+
+    fractionManager_releaseFraction(pA);
+    fractionManager_releaseFraction(pB);
+    fractionManager_releaseFraction(pOut);
+}
+
+int main(int argc, char *argv[]) {
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        int numA, denA, numB, denB;
+
+        /* Keep the terms small enough so no result overflows an int */
+        numA = rand() % 0x8000 - 0x4000;
+        denA = rand() % 0x4000 + 1;
+        numB = rand() % 0x8000 - 0x4000;
+        denB = rand() % 0x4000 + 1;
+
+        check<int32_t>(numA, denA, numB, denB);
+        check<int64_t>(numA, denA, numB, denB);
+#if defined(__SIZEOF_INT128__)
+        check<libfraction::int128>(numA, denA, numB, denB);
+#endif
+
+        num--;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,254 @@
+/**
+ * Simple test to check whether fused multiply-adds, dot products and axpys
+ * result in the same values as multiplying and then summing each pair
+ *
+ * @file tst/frac_dot.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Biggest array ever used by the test (so it spans a few blocks) */
+#define MAX_LEN 600
+
+static fractionManager *pFMng = 0;
+static fraction *ppA[MAX_LEN];
+static fraction *ppB[MAX_LEN];
+static int pNumsA[MAX_LEN], pDensA[MAX_LEN];
+static int pNumsB[MAX_LEN], pDensB[MAX_LEN];
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Retrieve the greatest common divisor of two (positive) numbers
+ */
+static int64_t get_gcd(int64_t a, int64_t b) {
+    while (b != 0) {
+        int64_t tmp;
+
+        tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+    return a;
+}
+
+/**
+ * Retrieve a random term on [1, 2^bits), which may also be negative
+ */
+static int get_term(int bits, int isSigned) {
+    int val;
+
+    val = rand() % ((1 << bits) - 1) + 1;
+    if (isSigned && rand() % 2) {
+        val = -val;
+    }
+    return val;
+}
+
+/**
+ * Check that a fraction has the expected value
+ */
+static void assertFraction(fraction *pFrac, int64_t num, int64_t den) {
+    int64_t div;
+    int n, d;
+
+    div = get_gcd(num < 0 ? -num : num, den);
+    fraction_getTerms(&n, &d, pFrac);
+    assert(n == num / div && d == den / div);
+}
+
+/**
+ * Replace both arrays of fractions by the ones on the arrays of terms
+ */
+static void getArrays(int len) {
+    int i, irv;
+
+    for (i = 0; i < MAX_LEN; i++) {
+        if (ppA[i]) {
+            fractionManager_releaseFraction(ppA[i]);
+            fractionManager_releaseFraction(ppB[i]);
+        }
+        ppA[i] = 0;
+        ppB[i] = 0;
+    }
+    for (i = 0; i < len; i++) {
+        irv = fractionManager_getFraction(&ppA[i], pFMng, pNumsA[i],
+                pDensA[i]);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&ppB[i], pFMng, pNumsB[i],
+                pDensB[i]);
+        assert(irv == 0);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int i, irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    /* Each round operates on a few whole arrays */
+    num = num / 10 + 1;
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        fraction *pA, *pB, *pC, *pOut;
+        int64_t sum;
+        int a, b, c, d, e, f, len, n;
+
+        /* Lazy managers must result in the same values */
+        fractionManager_setLazy(pFMng, num % 2);
+
+        /* A * B + C, on terms small enough for the result to fit */
+        a = get_term(7, 1);
+        b = get_term(7, 0);
+        c = get_term(7, 1);
+        d = get_term(7, 0);
+        e = get_term(7, 1);
+        f = get_term(7, 0);
+        irv = fractionManager_getFraction(&pA, pFMng, a, b);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&pB, pFMng, c, d);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&pC, pFMng, e, f);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pOut, pFMng, 0);
+        assert(irv == 0);
+
+        fraction_fma(pOut, pA, pB, pC);
+        assertFraction(pOut, (int64_t)a * c * f + (int64_t)e * b * d,
+                (int64_t)b * d * f);
+        assertFraction(pA, a, b);
+        assertFraction(pB, c, d);
+        assertFraction(pC, e, f);
+
+        /* The output may be one of the inputs */
+        fraction_fma(pA, pA, pA, pC);
+        assertFraction(pA, (int64_t)a * a * f + (int64_t)e * b * b,
+                (int64_t)b * b * f);
+        fraction_fma(pC, pB, pB, pC);
+        assertFraction(pC, (int64_t)c * c * f + (int64_t)e * d * d,
+                (int64_t)d * d * f);
+
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+        fractionManager_releaseFraction(pC);
+
+        /* Fractions with power of two denominators, so the result is on
+         * 2^10 and must match multiplying and then summing every pair */
+        len = rand() % MAX_LEN;
+        sum = 0;
+        for (i = 0; i < len; i++) {
+            pNumsA[i] = get_term(4, 1);
+            pDensA[i] = 1 << (rand() % 6);
+            pNumsB[i] = get_term(4, 1);
+            pDensB[i] = 1 << (rand() % 6);
+            sum += (int64_t)pNumsA[i] * pNumsB[i] *
+                    ((1 << 10) / (pDensA[i] * pDensB[i]));
+        }
+        getArrays(len);
+
+        irv = fractionManager_igetFraction(&pC, pFMng, 0);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pB, pFMng, 0);
+        assert(irv == 0);
+        for (i = 0; i < len; i++) {
+            fraction_mul(pB, ppA[i], ppB[i]);
+            fraction_sum(pC, pC, pB);
+        }
+        assertFraction(pC, sum, 1 << 10);
+        fractionManager_releaseFraction(pB);
+        fractionManager_releaseFraction(pC);
+
+        fraction_dot(pOut, ppA, ppB, len);
+        assertFraction(pOut, sum, 1 << 10);
+        fractionBatch_dot(&n, &d, pNumsA, pDensA, pNumsB, pDensB, len);
+        e = (int)get_gcd(sum < 0 ? -sum : sum, 1 << 10);
+        assert(n == sum / e && d == (1 << 10) / e);
+
+        /* Fractions whose common denominator grows way past 64 bits, but
+         * every pair sums to an integer (so the running sum has to be
+         * reduced now and then) */
+        len = (rand() % (MAX_LEN / 2)) * 2;
+        sum = 0;
+        for (i = 0; i < len; i += 2) {
+            int k, s;
+
+            d = get_term(14, 0);
+            n = rand() % 0x4000 - 0x2000;
+            k = rand() % 16 - 8;
+            s = get_term(1, 1);
+            pNumsA[i] = n;
+            pDensA[i] = d;
+            pNumsA[i + 1] = k * d - n;
+            pDensA[i + 1] = d;
+            pNumsB[i] = s;
+            pDensB[i] = 1;
+            pNumsB[i + 1] = s;
+            pDensB[i + 1] = 1;
+            sum += k * s;
+        }
+        getArrays(len);
+
+        fraction_dot(pOut, ppA, ppB, len);
+        assertFraction(pOut, sum, 1);
+        fractionBatch_dot(&n, &d, pNumsA, pDensA, pNumsB, pDensB, len);
+        assert(n == sum && d == 1);
+
+        /* The output may be on either array */
+        if (len > 0) {
+            fraction_dot(ppB[len - 1], ppA, ppB, len);
+            assertFraction(ppB[len - 1], sum, 1);
+        }
+
+        fractionManager_releaseFraction(pOut);
+
+        /* Y = A * X + Y, where the factor is also the first element of Y
+         * (so its original value must be used for every element) */
+        len = rand() % (MAX_LEN - 1) + 1;
+        for (i = 0; i < len; i++) {
+            pNumsA[i] = get_term(7, 1);
+            pDensA[i] = get_term(7, 0);
+            pNumsB[i] = get_term(7, 1);
+            pDensB[i] = get_term(7, 0);
+        }
+        getArrays(len);
+        a = pNumsA[0];
+        b = pDensA[0];
+
+        fraction_axpy(ppA, ppA[0], ppB, len);
+        for (i = 0; i < len; i++) {
+            assertFraction(ppA[i],
+                    (int64_t)a * pNumsB[i] * pDensA[i] +
+                    (int64_t)pNumsA[i] * b * pDensB[i],
+                    (int64_t)b * pDensB[i] * pDensA[i]);
+            assertFraction(ppB[i], pNumsB[i], pDensB[i]);
+        }
+
+        num--;
+    }
+
+    return 0;
+}
+
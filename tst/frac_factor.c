@@ -0,0 +1,125 @@
+/**
+ * Simple test to check whether numbers are factored correctly, both through
+ * the table of smallest prime factors and through trial division
+ *
+ * @file tst/frac_factor.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+static fractionManager *pSpfMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+    fractionManager_clean(&pSpfMng);
+}
+
+/**
+ * Check whether a number is prime, through trial division
+ *
+ * @param  [ in]val The number
+ * @return          1 if it's prime, 0 otherwise
+ */
+static int isPrime(int val) {
+    int i;
+
+    if (val < 2) {
+        return 0;
+    }
+    for (i = 2; (int64_t)i * i <= val; i++) {
+        if (val % i == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Factor a number on both managers and check the factorizations
+ *
+ * @param  [ in]value The number
+ */
+static void assertFactors(int value) {
+    int pFactors[FRACTION_MAX_FACTORS], pExponents[FRACTION_MAX_FACTORS];
+    int pSpfFactors[FRACTION_MAX_FACTORS], pSpfExponents[FRACTION_MAX_FACTORS];
+    int i, irv, numFactors, numSpfFactors;
+    uint64_t mag, prod;
+
+    irv = fractionManager_factor(pFactors, pExponents, &numFactors, pFMng,
+            value);
+    assert(irv == 0);
+    irv = fractionManager_factor(pSpfFactors, pSpfExponents, &numSpfFactors,
+            pSpfMng, value);
+    assert(irv == 0);
+    assert(numFactors == numSpfFactors);
+
+    prod = 1;
+    for (i = 0; i < numFactors; i++) {
+        int j;
+
+        assert(pFactors[i] == pSpfFactors[i]);
+        assert(pExponents[i] == pSpfExponents[i]);
+        assert(i == 0 || pFactors[i] > pFactors[i - 1]);
+        assert(isPrime(pFactors[i]));
+        for (j = 0; j < pExponents[i]; j++) {
+            prod *= (uint64_t)pFactors[i];
+        }
+    }
+
+    mag = (uint64_t)((int64_t)value < 0 ? -(int64_t)value : value);
+    assert(prod == mag);
+}
+
+int main(int argc, char *argv[]) {
+    fractionManagerConfig config;
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    /* Keep a small prime table, so trial division must extend it */
+    irv = fractionManager_init(&pFMng, 100/*maxNumberChecked*/);
+    assert(irv == 0);
+    fractionManager_getDefaultConfig(&config);
+    config.spfLimit = 1000000;
+    irv = fractionManager_initConfig(&pSpfMng, &config);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    assertFactors(1);
+    assertFactors(-1);
+    assertFactors(INT_MAX);
+    assertFactors(INT_MIN);
+    assertFactors(223092870);
+
+    while (num > 0) {
+        /* Test numbers on the table as well as bigger ones */
+        assertFactors(rand() % 1000000 + 1);
+        assertFactors(rand() - RAND_MAX / 2 + 1);
+        assertFactors((rand() % 1000 + 1) * (rand() % 1000 + 1));
+
+        num--;
+    }
+
+    return 0;
+}
+
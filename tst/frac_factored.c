@@ -0,0 +1,203 @@
+/**
+ * Simple test to check whether long chains of multiplications and divisions
+ * on factored fractions stay exact, and whether sums switch them to regular
+ * terms (and back)
+ *
+ * @file tst/frac_factored.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/** How many fractions are multiplied on each round */
+#define NUM_TERMS 40
+
+int main(int argc, char *argv[]) {
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    /* Each round is much more expensive than on other tests */
+    num = num / 20 + 1;
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        fractionFactored *ppTerms[NUM_TERMS], *pProd, *pSum, *pTmp;
+        fractionBig *pBigProd, *pBigTerm;
+        fraction64 *pSmall, *pBigSmall;
+        fraction *pDen, *pFrac;
+        double dProd, val;
+        int64_t quot;
+        int a, b, i;
+
+        irv = fractionManager_igetFractionFactored(&pProd, pFMng, 1);
+        assert(irv == 0);
+        irv = fractionManager_igetFractionBig(&pBigProd, pFMng, 1);
+        assert(irv == 0);
+
+        /* Multiply a bunch of random fractions, checking against the
+         * (exact) big fractions */
+        dProd = 0.0;
+        i = 0;
+        while (i < NUM_TERMS) {
+            a = rand() - RAND_MAX / 2;
+            b = rand() + 1;
+            if (a == 0) {
+                a = 1;
+            }
+
+            irv = fractionManager_getFractionFactored(&ppTerms[i], pFMng, a,
+                    b);
+            assert(irv == 0);
+            assert(fractionFactored_isFactored(ppTerms[i]));
+            irv = fractionManager_getFractionBig(&pBigTerm, pFMng, a, b);
+            assert(irv == 0);
+
+            if (i % 3 == 2) {
+                irv = fractionFactored_div(pProd, pProd, ppTerms[i]);
+                assert(irv == 0);
+                irv = fractionBig_div(pBigProd, pBigProd, pBigTerm);
+                assert(irv == 0);
+                dProd -= log(fabs((double)a / b));
+            }
+            else {
+                irv = fractionFactored_mul(pProd, pProd, ppTerms[i]);
+                assert(irv == 0);
+                irv = fractionBig_mul(pBigProd, pBigProd, pBigTerm);
+                assert(irv == 0);
+                dProd += log(fabs((double)a / b));
+            }
+            assert(fractionFactored_isFactored(pProd));
+            fractionManager_releaseFractionBig(pBigTerm);
+
+            i++;
+        }
+
+        /* Both must agree on whether the result fits into 64 bits */
+        irv = fractionManager_igetFraction64(&pSmall, pFMng, 0);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction64(&pBigSmall, pFMng, 0);
+        assert(irv == 0);
+        if (fractionBig_narrow(pBigSmall, pBigProd) == 0) {
+            irv = fractionFactored_narrow64(pSmall, pProd);
+            assert(irv == 0);
+            assert(fraction64_sub(pSmall, pSmall, pBigSmall) == 0);
+            fraction64_iconvert(&quot, pSmall);
+            assert(quot == 0);
+        }
+        else {
+            irv = fractionFactored_narrow64(pSmall, pProd);
+            assert(irv != 0);
+        }
+        fractionManager_releaseFraction64(pSmall);
+        fractionManager_releaseFraction64(pBigSmall);
+        fractionManager_releaseFractionBig(pBigProd);
+
+        fractionFactored_dconvert(&val, pProd);
+        if (val != 0.0 && !isinf(val)) {
+            val = log(fabs(val));
+            assert(val - dProd < 1e-6 && dProd - val < 1e-6);
+        }
+
+        /* Undo everything (on a different order), which must result in
+         * exactly 1 */
+        i = NUM_TERMS - 1;
+        while (i >= 0) {
+            int j;
+
+            j = (i * 7) % NUM_TERMS;
+            if (j % 3 == 2) {
+                irv = fractionFactored_mul(pProd, pProd, ppTerms[j]);
+            }
+            else {
+                irv = fractionFactored_div(pProd, pProd, ppTerms[j]);
+            }
+            assert(irv == 0);
+
+            i--;
+        }
+        irv = fractionFactored_iconvert(&quot, pProd);
+        assert(irv == 0);
+        assert(quot == 1);
+
+        /* Sums switch to regular terms, and multiplications back */
+        a = rand() % 1000 - 500;
+        b = rand() % 1000 + 1;
+        irv = fractionManager_igetFraction(&pFrac, pFMng, a);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pDen, pFMng, b);
+        assert(irv == 0);
+        fraction_div(pFrac, pFrac, pDen);
+        fractionManager_releaseFraction(pDen);
+        irv = fractionManager_factorFraction(&pTmp, pFrac);
+        assert(irv == 0);
+        irv = fractionManager_cloneFactored(&pSum, pTmp);
+        assert(irv == 0);
+        irv = fractionFactored_sum(pSum, pSum, pTmp);
+        assert(irv == 0);
+        assert(!fractionFactored_isFactored(pSum));
+        irv = fractionFactored_mul(pSum, pSum, pProd);
+        assert(irv == 0);
+        assert(fractionFactored_isFactored(pSum) == (a != 0));
+        irv = fractionFactored_sub(pSum, pSum, pTmp);
+        assert(irv == 0);
+        irv = fractionFactored_sub(pSum, pSum, pTmp);
+        assert(irv == 0);
+        irv = fractionFactored_iconvert(&quot, pSum);
+        assert(irv == 0);
+        assert(quot == 0);
+        fractionFactored_dconvert(&val, pSum);
+        assert(val == 0.0);
+
+        /* The round trip must be exact */
+        irv = fractionFactored_narrow(pFrac, pTmp);
+        assert(irv == 0);
+        fraction_dconvert(&val, pFrac);
+        assert(val == (double)a / b);
+
+        /* Division by zero must fail */
+        irv = fractionFactored_div(pProd, pProd, pSum);
+        assert(irv != 0);
+
+        fractionManager_releaseFraction(pFrac);
+        fractionManager_releaseFractionFactored(pTmp);
+        fractionManager_releaseFractionFactored(pSum);
+        i = 0;
+        while (i < NUM_TERMS) {
+            fractionManager_releaseFractionFactored(ppTerms[i]);
+            i++;
+        }
+        fractionManager_releaseFractionFactored(pProd);
+
+        num--;
+    }
+
+    return 0;
+}
+
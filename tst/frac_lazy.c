@@ -0,0 +1,101 @@
+/**
+ * Simple test to check whether a lazy manager yields the same results as a
+ * regular one
+ *
+ * @file tst/frac_lazy.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+static fractionManager *pLazyMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+    fractionManager_clean(&pLazyMng);
+}
+
+int main(int argc, char *argv[]) {
+    fraction *pAcc, *pLazyAcc;
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000000/*maxNumberChecked*/);
+    assert(irv == 0);
+    irv = fractionManager_init(&pLazyMng, 1000000/*maxNumberChecked*/);
+    assert(irv == 0);
+    fractionManager_setLazy(pLazyMng, 1);
+
+    srand(time(0));
+
+    irv = fractionManager_igetFraction(&pAcc, pFMng, 0);
+    assert(irv == 0);
+    irv = fractionManager_igetFraction(&pLazyAcc, pLazyMng, 0);
+    assert(irv == 0);
+
+    while (num > 0) {
+        fraction *pA, *pB, *pLazyA, *pLazyB;
+        int a, b, quot, rem, lazyQuot, lazyRem;
+
+        /* Keep the denominators small, so the accumulator never overflows */
+        a = rand() % 64 - 32;
+        b = 1 << (rand() % 4);
+
+        irv = fractionManager_igetFraction(&pA, pFMng, a);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pB, pFMng, b);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pLazyA, pLazyMng, a);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pLazyB, pLazyMng, b);
+        assert(irv == 0);
+
+        /* acc = (acc + a / b) * b / b, so every operation is exercised */
+        fraction_div(pA, pA, pB);
+        fraction_sum(pAcc, pAcc, pA);
+        fraction_mul(pAcc, pAcc, pB);
+        fraction_div(pAcc, pAcc, pB);
+        fraction_sub(pAcc, pAcc, pB);
+        fraction_sum(pAcc, pAcc, pB);
+
+        fraction_div(pLazyA, pLazyA, pLazyB);
+        fraction_sum(pLazyAcc, pLazyAcc, pLazyA);
+        fraction_mul(pLazyAcc, pLazyAcc, pLazyB);
+        fraction_div(pLazyAcc, pLazyAcc, pLazyB);
+        fraction_sub(pLazyAcc, pLazyAcc, pLazyB);
+        fraction_sum(pLazyAcc, pLazyAcc, pLazyB);
+
+        /* The remainder is only equal if both were simplified */
+        fraction_divConvert(&quot, &rem, pAcc);
+        fraction_divConvert(&lazyQuot, &lazyRem, pLazyAcc);
+        assert(quot == lazyQuot);
+        assert(rem == lazyRem);
+
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+        fractionManager_releaseFraction(pLazyA);
+        fractionManager_releaseFraction(pLazyB);
+
+        num--;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,115 @@
+/**
+ * Simple test to check whether fractions reduced in blocks are equal to those
+ * reduced one at a time
+ *
+ * @file tst/frac_normalize.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+static fractionPool *pPool = 0;
+static fractionHandle *pHandles = 0;
+static int *pNums = 0;
+static int *pDens = 0;
+
+void do_clean() {
+    if (pHandles) {
+        free(pHandles);
+    }
+    if (pNums) {
+        free(pNums);
+    }
+    if (pDens) {
+        free(pDens);
+    }
+    fractionPool_clean(&pPool);
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Retrieve a random term, with lots of common factors of two
+ *
+ * @return The term
+ */
+static int getRandomTerm() {
+    switch (rand() % 8) {
+        case 0: return 0;
+        case 1: return INT_MAX;
+        case 2: return INT_MIN;
+        case 3: return rand() - RAND_MAX / 2;
+        default: return (rand() % 2000 - 1000) * (1 << (rand() % 16));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    fractionHandle *pBulk;
+    int *pPoolNums, *pPoolDens;
+    int i, irv, len, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000000/*maxNumberChecked*/);
+    assert(irv == 0);
+    irv = fractionPool_init(&pPool, pFMng, 16/*capacity*/);
+    assert(irv == 0);
+
+    pHandles = (fractionHandle*)malloc(sizeof(fractionHandle) * num * 2);
+    assert(pHandles);
+    pNums = (int*)malloc(sizeof(int) * num);
+    assert(pNums);
+    pDens = (int*)malloc(sizeof(int) * num);
+    assert(pDens);
+
+    srand(time(0));
+
+    /* Reduce every fraction one at a time, through the pool */
+    for (i = 0; i < num; i++) {
+        pNums[i] = getRandomTerm();
+        pDens[i] = getRandomTerm();
+        irv = fractionPool_getFraction(pHandles + i, pPool, pNums[i],
+                pDens[i]);
+        assert(irv == 0);
+    }
+
+    /* Release half of them, so bulk initialization recycles handles */
+    for (i = 0; i < num; i += 2) {
+        fractionPool_release(pPool, pHandles[i]);
+    }
+    pBulk = pHandles + num;
+    irv = fractionPool_getFractions(pBulk, pPool, pNums, pDens, num);
+    assert(irv == 0);
+
+    /* Lastly, reduce the arrays in place */
+    fractionBatch_normalize(pNums, pDens, num);
+
+    fractionPool_getArrays(&pPoolNums, &pPoolDens, &len, pPool);
+    for (i = 1; i < num; i += 2) {
+        assert(pNums[i] == pPoolNums[pHandles[i]]);
+        assert(pDens[i] == pPoolDens[pHandles[i]]);
+    }
+    for (i = 0; i < num; i++) {
+        assert(pNums[i] == pPoolNums[pBulk[i]]);
+        assert(pDens[i] == pPoolDens[pBulk[i]]);
+    }
+
+    return 0;
+}
+
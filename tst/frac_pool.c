@@ -0,0 +1,153 @@
+/**
+ * Simple test to check whether a fraction pool yields the same results as
+ * regular fractions
+ *
+ * @file tst/frac_pool.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+static fractionPool *pPool = 0;
+
+void do_clean() {
+    fractionPool_clean(&pPool);
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Check that a pooled fraction is equal to a regular one
+ *
+ * @param  [ in]handle The pooled fraction
+ * @param  [ in]pFrac  The regular fraction
+ */
+static void assertEqual(fractionHandle handle, fraction *pFrac) {
+    int quot, rem, poolQuot, poolRem;
+
+    fraction_divConvert(&quot, &rem, pFrac);
+    fractionPool_divConvert(&poolQuot, &poolRem, pPool, handle);
+    assert(quot == poolQuot);
+    assert(rem == poolRem);
+}
+
+/**
+ * Retrieve a regular fraction as numerator / denominator
+ *
+ * @param  [out]ppOut       The fraction
+ * @param  [ in]numerator   The fraction's numerator
+ * @param  [ in]denominator The fraction's denominator
+ */
+static void getFraction(fraction **ppOut, int numerator, int denominator) {
+    fraction *pDen;
+    int irv;
+
+    irv = fractionManager_igetFraction(ppOut, pFMng, numerator);
+    assert(irv == 0);
+    irv = fractionManager_igetFraction(&pDen, pFMng, denominator);
+    assert(irv == 0);
+    fraction_div(*ppOut, *ppOut, pDen);
+    fractionManager_releaseFraction(pDen);
+}
+
+int main(int argc, char *argv[]) {
+    fractionHandle acc;
+    fraction *pAcc;
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000000/*maxNumberChecked*/);
+    assert(irv == 0);
+    /* Start with a tiny pool, so it must be expanded */
+    irv = fractionPool_init(&pPool, pFMng, 16/*capacity*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    irv = fractionManager_igetFraction(&pAcc, pFMng, 0);
+    assert(irv == 0);
+    irv = fractionPool_igetFraction(&acc, pPool, 0);
+    assert(irv == 0);
+
+    while (num > 0) {
+        fractionHandle a, b, tmp;
+        fraction *pA, *pB, *pTmp;
+        int numA, denA, numB, denB;
+
+        numA = rand() % 64 - 32;
+        denA = rand() % 16 + 1;
+        numB = rand() % 64 - 32;
+        denB = 1 << (rand() % 4);
+        if (numA == 0) {
+            numA = 1;
+        }
+        if (numB == 0) {
+            numB = 1;
+        }
+
+        getFraction(&pA, numA, denA);
+        getFraction(&pB, numB, denB);
+        irv = fractionManager_igetFraction(&pTmp, pFMng, 0);
+        assert(irv == 0);
+        irv = fractionPool_getFraction(&a, pPool, numA, denA);
+        assert(irv == 0);
+        irv = fractionPool_fromFraction(&b, pPool, pB);
+        assert(irv == 0);
+        irv = fractionPool_igetFraction(&tmp, pPool, 0);
+        assert(irv == 0);
+
+        /* Check every operation on a separated output */
+        fraction_sum(pTmp, pA, pB);
+        fractionPool_sum(pPool, tmp, a, b);
+        assertEqual(tmp, pTmp);
+        fraction_sub(pTmp, pA, pB);
+        fractionPool_sub(pPool, tmp, a, b);
+        assertEqual(tmp, pTmp);
+        fraction_mul(pTmp, pA, pB);
+        fractionPool_mul(pPool, tmp, a, b);
+        assertEqual(tmp, pTmp);
+        fraction_div(pTmp, pA, pB);
+        fractionPool_div(pPool, tmp, a, b);
+        assertEqual(tmp, pTmp);
+
+        /* acc = (acc + b) * a / a, keeping the accumulator small */
+        fraction_sum(pAcc, pAcc, pB);
+        fraction_mul(pAcc, pAcc, pA);
+        fraction_div(pAcc, pAcc, pA);
+        fractionPool_sum(pPool, acc, acc, b);
+        fractionPool_mul(pPool, acc, acc, a);
+        fractionPool_div(pPool, acc, acc, a);
+        assertEqual(acc, pAcc);
+
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+        fractionManager_releaseFraction(pTmp);
+        /* Keep some handles alive, so the pool grows */
+        if (rand() % 4 != 0) {
+            fractionPool_release(pPool, a);
+        }
+        fractionPool_release(pPool, b);
+        fractionPool_release(pPool, tmp);
+
+        num--;
+    }
+
+    return 0;
+}
+
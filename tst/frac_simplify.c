@@ -0,0 +1,87 @@
+/**
+ * Simple test to check whether fractions are kept on their lowest terms, even
+ * when their terms are bigger than the manager's list of primes
+ *
+ * @file tst/frac_simplify.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/** Reference (Euclid's) greatest common divisor */
+static int gcd(int a, int b) {
+    while (b != 0) {
+        int tmp;
+
+        tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+
+    return a;
+}
+
+int main(int argc, char *argv[]) {
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    /* Use a really small list of primes, as it must not matter anymore */
+    irv = fractionManager_init(&pFMng, 16/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        fraction *pA, *pB;
+        int a, b, div, quot, rem;
+
+        a = rand() / 10;
+        b = rand() / 10 + 1;
+        /* Force a common factor on (roughly) half the cases */
+        if (rand() & 1) {
+            a = (a / 1024) * 1024;
+            b = (b / 1024 + 1) * 1024;
+        }
+        div = gcd(a, b);
+
+        irv = fractionManager_igetFraction(&pA, pFMng, a);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pB, pFMng, -b);
+        assert(irv == 0);
+        /* a / -b must be stored as -(a / div) / (b / div) */
+        fraction_div(pA, pA, pB);
+        fraction_divConvert(&quot, &rem, pA);
+        assert(quot == -(a / b));
+        assert(rem == -((a / div) % (b / div)));
+
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+
+        num--;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,141 @@
+/**
+ * Simple test to check whether the manager's performance counters track its
+ * operations and objects (if the lib was built with FRACTION_STATS)
+ *
+ * @file tst/frac_stats.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Number of fractions held at once, so the pool must grow */
+#define NUM_HELD 1500
+
+static fractionManager *pFMng = 0;
+static fraction *ppHeld[NUM_HELD];
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+int main(int argc, char *argv[]) {
+    fractionManagerStats stats;
+    uint64_t numOps, num64Ops, numFactors;
+    int i, irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    irv = fractionManager_getStats(&stats, pFMng);
+    if (irv != 0) {
+        /* Counters weren't compiled, so there's nothing else to check */
+        assert(stats.opsFraction == 0);
+        assert(stats.fractions.numLive == 0);
+        return 0;
+    }
+    assert(stats.opsFraction == 0);
+    assert(stats.fractions.numLive == 0);
+    assert(stats.fractions.numBuffers == 1);
+
+    srand(time(0));
+
+    numOps = 0;
+    num64Ops = 0;
+    numFactors = 0;
+    while (num > 0) {
+        fraction *pA, *pB, *pOut;
+        fraction64 *pA64;
+        int pFactors[FRACTION_MAX_FACTORS], pExps[FRACTION_MAX_FACTORS];
+        int len;
+
+        irv = fractionManager_getFraction(&pA, pFMng, rand() % 0x1000 - 0x800,
+                rand() % 0x1000 + 1);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&pB, pFMng, rand() % 0x1000 + 1,
+                rand() % 0x1000 + 1);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pOut, pFMng, 0);
+        assert(irv == 0);
+        irv = fractionManager_widenFraction(&pA64, pA);
+        assert(irv == 0);
+
+        irv = fractionManager_getStats(&stats, pFMng);
+        assert(irv == 0);
+        assert(stats.fractions.numLive == 3);
+        assert(stats.fractions64.numLive == 1);
+        assert(stats.fractions.highWater >= 3);
+
+        fraction_sum(pOut, pA, pB);
+        fraction_mul(pOut, pOut, pB);
+        fraction_div(pOut, pOut, pB);
+        numOps += 3;
+        fraction64_mul(pA64, pA64, pA64);
+        num64Ops++;
+
+        irv = fractionManager_factor(pFactors, pExps, &len, pFMng,
+                rand() % 0x10000 + 1);
+        assert(irv == 0);
+        numFactors++;
+
+        irv = fractionManager_getStats(&stats, pFMng);
+        assert(irv == 0);
+        assert(stats.opsFraction == numOps);
+        assert(stats.opsFraction64 == num64Ops);
+        assert(stats.numFactorizations >= numFactors);
+        assert(stats.numSimplifications > 0);
+
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+        fractionManager_releaseFraction(pOut);
+        fractionManager_releaseFraction64(pA64);
+
+        num--;
+    }
+
+    irv = fractionManager_getStats(&stats, pFMng);
+    assert(irv == 0);
+    assert(stats.fractions.numLive == 0);
+    assert(stats.fractions.numFree >= 3);
+    assert(stats.numPrimes > 0);
+    assert(stats.numTrialDivisions == 0 || stats.avgTrialDivisions > 0);
+
+    /* Hold enough fractions to require more buffers */
+    for (i = 0; i < NUM_HELD; i++) {
+        irv = fractionManager_igetFraction(&ppHeld[i], pFMng, i);
+        assert(irv == 0);
+    }
+    irv = fractionManager_getStats(&stats, pFMng);
+    assert(irv == 0);
+    assert(stats.fractions.numLive == NUM_HELD);
+    assert(stats.fractions.highWater == NUM_HELD);
+    assert(stats.fractions.numBuffers > 1);
+
+    for (i = 0; i < NUM_HELD; i++) {
+        fractionManager_releaseFraction(ppHeld[i]);
+    }
+    irv = fractionManager_getStats(&stats, pFMng);
+    assert(irv == 0);
+    assert(stats.fractions.numLive == 0);
+    assert(stats.fractions.numFree >= NUM_HELD);
+    assert(stats.fractions.highWater == NUM_HELD);
+
+    return 0;
+}
+
@@ -57,6 +57,54 @@ int main(int argc, char *argv[]) {
         fractionManager_releaseFraction(pA);
         fractionManager_releaseFraction(pB);
 
+        /* Fractions whose denominators share a few factors, which must be
+         * left untouched. Subtracting is the same as summing the negated
+         * fraction (which tst/frac_add.c checks against a reference) */
+        {
+            fraction *pOut, *pNeg;
+            int c, d, e, f, g, h, n, m;
+
+            g = rand() % 36 + 1;
+            c = rand() % 0x4000 - 0x2000;
+            d = g * (rand() % 0x1000 + 1);
+            e = rand() % 0x4000 - 0x2000;
+            f = g * (rand() % 0x1000 + 1);
+
+            irv = fractionManager_getFraction(&pA, pFMng, c, d);
+            assert(irv == 0);
+            irv = fractionManager_getFraction(&pB, pFMng, e, f);
+            assert(irv == 0);
+            irv = fractionManager_getFraction(&pNeg, pFMng, -e, f);
+            assert(irv == 0);
+            irv = fractionManager_igetFraction(&pOut, pFMng, 0);
+            assert(irv == 0);
+            fraction_getTerms(&c, &d, pA);
+            fraction_getTerms(&e, &f, pB);
+
+            fraction_sum(pOut, pA, pNeg);
+            fraction_getTerms(&n, &m, pOut);
+            fraction_sub(pOut, pA, pB);
+            fraction_getTerms(&g, &h, pOut);
+            assert(g == n && h == m);
+            fraction_getTerms(&g, &h, pA);
+            assert(g == c && h == d);
+            fraction_getTerms(&g, &h, pB);
+            assert(g == e && h == f);
+
+            /* Either input may be the output (and the order still matters) */
+            fraction_sub(pB, pA, pB);
+            fraction_getTerms(&g, &h, pB);
+            assert(g == n && h == m);
+            fraction_sub(pA, pA, pA);
+            fraction_getTerms(&g, &h, pA);
+            assert(g == 0 && h == 1);
+
+            fractionManager_releaseFraction(pA);
+            fractionManager_releaseFraction(pB);
+            fractionManager_releaseFraction(pNeg);
+            fractionManager_releaseFraction(pOut);
+        }
+
         num--;
     }
 
@@ -0,0 +1,150 @@
+/**
+ * Simple test to check whether sampled operations are recorded into the
+ * manager's trace ring (if the lib was built with FRACTION_TRACE)
+ *
+ * @file tst/frac_trace.c
+ */
+#include <fraction/fraction.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Number of slots on the ring */
+#define RING_SIZE 64
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+int main(int argc, char *argv[]) {
+    fractionManagerConfig config;
+    fractionTraceEvent pEvents[RING_SIZE * 2];
+    const char *pName;
+    uint64_t numDropped;
+    double nsPerTick;
+    int irv, num, numEvents;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    fractionTrace_getOpName(&pName, FRACTION_TRACE_SUM);
+    assert(pName[0] == 's' && pName[1] == 'u' && pName[2] == 'm');
+    fractionTrace_getOpName(&pName, FRACTION_TRACE_NUM_OPS);
+    assert(pName[0] == 'u');
+
+    /* Sample every single operation */
+    fractionManager_getDefaultConfig(&config);
+    config.traceInterval = 1;
+    config.traceCapacity = RING_SIZE;
+    irv = fractionManager_initConfig(&pFMng, &config);
+    assert(irv == 0);
+
+    irv = fractionManager_drainTrace(pEvents, &numEvents, &numDropped, pFMng,
+            RING_SIZE * 2);
+    if (irv != 0) {
+        /* Tracing wasn't compiled, so there's nothing else to check */
+        assert(numEvents == 0);
+        return 0;
+    }
+    assert(numEvents == 0);
+    fractionTrace_getNsPerTick(&nsPerTick);
+    assert(nsPerTick > 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        fraction *pA, *pB;
+        int a, b, c, d, i, val;
+
+        a = rand() % 0x1000 + 1;
+        b = rand() % 0x10000 + 0x8000;
+        c = rand() % 0x1000 + 1;
+        d = rand() % 0x100 + 1;
+
+        irv = fractionManager_getFraction(&pA, pFMng, a, b);
+        assert(irv == 0);
+        irv = fractionManager_getFraction(&pB, pFMng, c, d);
+        assert(irv == 0);
+        fraction_mul(pA, pA, pB);
+        fraction_iconvert(&val, pA);
+        fractionManager_releaseFraction(pB);
+        /* Denominators of zero are rejected before being traced */
+        irv = fractionManager_getFraction(&pB, pFMng, 1, 0);
+        assert(irv == 1);
+
+        irv = fractionManager_drainTrace(pEvents, &numEvents, &numDropped,
+                pFMng, RING_SIZE * 2);
+        assert(irv == 0);
+        assert(numDropped == 0);
+        assert(numEvents == 4);
+        assert(pEvents[0].op == FRACTION_TRACE_GET);
+        assert(pEvents[1].op == FRACTION_TRACE_GET);
+        assert(pEvents[2].op == FRACTION_TRACE_MUL);
+        assert(pEvents[3].op == FRACTION_TRACE_ICONVERT);
+        /* The second operand of a constructor is empty */
+        assert(pEvents[0].bitsA >= 16 && pEvents[0].bitsA <= 17);
+        assert(pEvents[0].bitsB == 0);
+        assert(pEvents[1].bitsA <= 13);
+        assert(pEvents[2].bitsB <= 13);
+        assert(pEvents[2].numSimplifications > 0);
+        for (i = 0; i < numEvents; i++) {
+            assert(pEvents[i].bitsA > 0);
+        }
+
+        fractionManager_releaseFraction(pA);
+
+        num--;
+    }
+
+    /* Overflow the ring, so events are dropped */
+    for (num = 0; num < RING_SIZE * 2; num++) {
+        int val;
+        fraction *pA;
+
+        irv = fractionManager_igetFraction(&pA, pFMng, num + 1);
+        assert(irv == 0);
+        fraction_iconvert(&val, pA);
+        assert(val == num + 1);
+        fractionManager_releaseFraction(pA);
+    }
+    irv = fractionManager_drainTrace(pEvents, &numEvents, &numDropped, pFMng,
+            RING_SIZE * 2);
+    assert(irv == 0);
+    assert(numEvents == RING_SIZE);
+    assert(numDropped == RING_SIZE * 3);
+    assert(pEvents[0].op == FRACTION_TRACE_IGET);
+    assert(pEvents[1].op == FRACTION_TRACE_ICONVERT);
+
+    /* The ring is usable again after being drained */
+    {
+        fraction *pA;
+
+        irv = fractionManager_igetFraction(&pA, pFMng, 7);
+        assert(irv == 0);
+        fractionManager_releaseFraction(pA);
+    }
+    irv = fractionManager_drainTrace(pEvents, &numEvents, &numDropped, pFMng,
+            RING_SIZE * 2);
+    assert(irv == 0);
+    assert(numEvents == 1);
+    assert(pEvents[0].op == FRACTION_TRACE_IGET);
+    assert(pEvents[0].bitsA == 3);
+
+    return 0;
+}
+
@@ -0,0 +1,126 @@
+/**
+ * Simple test to check whether plain fraction values agree with the
+ * manager's fractions
+ *
+ * @file tst/frac_value.c
+ */
+#include <fraction/fraction.h>
+#include <fraction/fraction_value.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+static fractionManager *pFMng = 0;
+
+void do_clean() {
+    fractionManager_clean(&pFMng);
+}
+
+/**
+ * Check that a fraction and a plain value have exactly the same terms
+ *
+ * @param  [ in]pFrac The fraction
+ * @param  [ in]pVal  The plain value
+ */
+static void checkSame(fraction *pFrac, const fractionValue *pVal) {
+    fractionValue tmp;
+
+    fraction_vconvert(&tmp, pFrac);
+    assert(tmp.numerator == pVal->numerator);
+    assert(tmp.denominator == pVal->denominator);
+    assert(pVal->denominator > 0);
+}
+
+int main(int argc, char *argv[]) {
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+
+    /* Register a function to clear the manager, even on assert failure */
+    atexit(do_clean);
+
+    irv = fractionManager_init(&pFMng, 1000/*maxNumberChecked*/);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        fraction *pA, *pB, *pOut;
+        fractionValue a, b, out;
+        double dA, dB, dOut;
+        int cmp;
+
+        /* Keep the terms small enough so no result overflows an int */
+        irv = fractionValue_init(&a, rand() % 0x8000 - 0x4000,
+                rand() % 0x8000 - 0x4000);
+        if (irv != 0) {
+            continue;
+        }
+        irv = fractionValue_init(&b, rand() % 0x8000 - 0x4000,
+                rand() % 0x4000 + 1);
+        assert(irv == 0);
+
+        irv = fractionManager_vgetFraction(&pA, pFMng, &a);
+        assert(irv == 0);
+        irv = fractionManager_vgetFraction(&pB, pFMng, &b);
+        assert(irv == 0);
+        irv = fractionManager_igetFraction(&pOut, pFMng, 0);
+        assert(irv == 0);
+        checkSame(pA, &a);
+        checkSame(pB, &b);
+
+        fractionValue_sum(&out, &a, &b);
+        fraction_sum(pOut, pA, pB);
+        checkSame(pOut, &out);
+
+        fractionValue_sub(&out, &a, &b);
+        fraction_sub(pOut, pA, pB);
+        checkSame(pOut, &out);
+
+        fractionValue_mul(&out, &a, &b);
+        fraction_mul(pOut, pA, pB);
+        checkSame(pOut, &out);
+
+        if (b.numerator != 0) {
+            fractionValue_div(&out, &a, &b);
+            fraction_div(pOut, pA, pB);
+            checkSame(pOut, &out);
+            fractionValue_dconvert(&dOut, &out);
+            fraction_dconvert(&dA, pOut);
+            assert(dA == dOut);
+        }
+
+        /* The output may be one of the inputs */
+        out = a;
+        fractionValue_mul(&out, &out, &out);
+        fraction_mul(pOut, pA, pA);
+        checkSame(pOut, &out);
+
+        /* Comparisons must agree with doubles (which are exact on these) */
+        fractionValue_dconvert(&dA, &a);
+        fractionValue_dconvert(&dB, &b);
+        cmp = fractionValue_compare(&a, &b);
+        assert(cmp == (dA > dB) - (dA < dB));
+        assert(fractionValue_compare(&a, &a) == 0);
+
+        fractionManager_releaseFraction(pA);
+        fractionManager_releaseFraction(pB);
+        fractionManager_releaseFraction(pOut);
+
+        num--;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,183 @@
+/**
+ * Simple test to check whether many concurrent pools in use at once keep
+ * their own magazine on every thread, so retrieving and releasing objects
+ * never waits for the pool's lock (which the test holds meanwhile)
+ *
+ * @file tst/pool_concurrent.c
+ */
+/* Barriers and clock_gettime aren't declared on strict ISO C builds */
+#define _POSIX_C_SOURCE 200809L
+
+#include <fraction_internal/pool.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Number of pools in use at once (many more than each thread's initial
+ * table of magazines) */
+#define NUM_POOLS 72
+/** Number of threads using the pools at once */
+#define NUM_THREADS 4
+/** How long the threads may take while every lock is held, in seconds */
+#define TIMEOUT 10
+
+static pool pPools[NUM_POOLS];
+
+/** Synchronizes the threads with the main one */
+static pthread_barrier_t barrier;
+/** Number of threads done while every lock was held */
+static int numDone = 0;
+static pthread_mutex_t doneLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t doneCond = PTHREAD_COND_INITIALIZER;
+
+/** Number of iterations of each thread on every round */
+static int numIterations = 0;
+
+void do_clean() {
+    int i;
+
+    for (i = 0; i < NUM_POOLS; i++) {
+        pool_clean(pPools + i);
+    }
+}
+
+/**
+ * Retrieve an object from every pool and release it, checking that no other
+ * thread touched it meanwhile
+ *
+ * @param  [ in]tag Value written into the objects
+ */
+static void useEveryPool(uintptr_t tag) {
+    int i, irv;
+
+    for (i = 0; i < NUM_POOLS; i++) {
+        uintptr_t *pObj;
+
+        irv = pool_getObject((void**)&pObj, pPools + i);
+        assert(irv == 0);
+        *pObj = tag;
+        assert(*pObj == tag);
+        pool_releaseObject(pPools + i, pObj);
+    }
+}
+
+/**
+ * Fill the thread's magazines, then keep using the pools while the main
+ * thread holds every lock
+ *
+ * @param  [ in]pArg The thread's index
+ * @return           Always NULL
+ */
+static void* stress(void *pArg) {
+    uintptr_t tag;
+    int i;
+
+    tag = (uintptr_t)pArg;
+
+    useEveryPool(tag);
+    pthread_barrier_wait(&barrier);
+
+    /* Every lock is held now */
+    pthread_barrier_wait(&barrier);
+    for (i = 0; i < numIterations; i++) {
+        useEveryPool(tag + (uintptr_t)i * NUM_THREADS);
+    }
+
+    pthread_mutex_lock(&doneLock);
+    numDone++;
+    pthread_cond_signal(&doneCond);
+    pthread_mutex_unlock(&doneLock);
+
+    for (i = 0; i < NUM_POOLS; i++) {
+        pool_flushThreadCache(pPools + i);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t pThreads[NUM_THREADS];
+    int i, irv, num, round;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    numIterations = num;
+
+    /* Register a function to clear the pools, even on assert failure */
+    atexit(do_clean);
+
+    for (i = 0; i < NUM_POOLS; i++) {
+        irv = pool_init(pPools + i, sizeof(uintptr_t), 64, 1/*isConcurrent*/);
+        assert(irv == 0);
+    }
+    irv = pthread_barrier_init(&barrier, 0, NUM_THREADS + 1);
+    assert(irv == 0);
+
+    for (round = 0; round < 4; round++) {
+        struct timespec deadline;
+
+        /* The main thread also caches magazines of pools that are recreated
+         * below, so it must never find them on the new pools */
+        useEveryPool(0);
+
+        numDone = 0;
+        for (i = 0; i < NUM_THREADS; i++) {
+            irv = pthread_create(pThreads + i, 0, stress,
+                    (void*)(uintptr_t)(i + 1));
+            assert(irv == 0);
+        }
+
+        pthread_barrier_wait(&barrier);
+        for (i = 0; i < NUM_POOLS; i++) {
+            pthread_mutex_lock(&(pPools[i].lock));
+        }
+        pthread_barrier_wait(&barrier);
+
+        /* Threads that wait for any lock never finish */
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += TIMEOUT;
+        pthread_mutex_lock(&doneLock);
+        irv = 0;
+        while (numDone < NUM_THREADS && irv != ETIMEDOUT) {
+            irv = pthread_cond_timedwait(&doneCond, &doneLock, &deadline);
+        }
+        assert(numDone == NUM_THREADS);
+        pthread_mutex_unlock(&doneLock);
+
+        for (i = 0; i < NUM_POOLS; i++) {
+            pthread_mutex_unlock(&(pPools[i].lock));
+        }
+        for (i = 0; i < NUM_THREADS; i++) {
+            pthread_join(pThreads[i], 0);
+        }
+
+        /* Recreate some pools (in a different order), so their slots are
+         * reused by other pools */
+        for (i = round % 2; i < NUM_POOLS; i += 2) {
+            pool_clean(pPools + i);
+        }
+        for (i = NUM_POOLS - 1 - (NUM_POOLS - 1 + round) % 2; i >= 0;
+                i -= 2) {
+            irv = pool_init(pPools + i, sizeof(uintptr_t), 64,
+                    1/*isConcurrent*/);
+            assert(irv == 0);
+        }
+    }
+
+    pthread_barrier_destroy(&barrier);
+
+    return 0;
+}
+
@@ -0,0 +1,213 @@
+/**
+ * Simple test to check whether tables of primes are correctly cached into
+ * (and mapped from) files, and whether invalid files are replaced
+ *
+ * @file tst/prime_cache.c
+ */
+#include <fraction/fraction.h>
+#include <fraction_internal/prime.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Biggest number ever checked by the test */
+#define MAX_VALUE 2000000
+
+static int *pReference = 0;
+static primeTable table;
+static primeTable other;
+static fractionManager *pFMng = 0;
+static char pPath[64];
+
+void do_clean() {
+    if (pReference) {
+        free(pReference);
+    }
+    prime_cleanTable(&table);
+    prime_cleanTable(&other);
+    fractionManager_clean(&pFMng);
+    unlink(pPath);
+}
+
+/**
+ * Check that a table contains exactly every prime up to its limit
+ *
+ * @param  [ in]pTable       The table
+ * @param  [ in]numReference Number of primes on the reference list
+ */
+static void assertTable(primeTable *pTable, int numReference) {
+    const int *pList;
+    int i, len;
+
+    prime_getList(&pList, &len, pTable);
+    for (i = 0; i < len; i++) {
+        assert(pList[i] == pReference[i]);
+    }
+    assert(pList[len - 1] <= pTable->maxChecked);
+    assert(len == numReference || pReference[len] > pTable->maxChecked);
+}
+
+/**
+ * Flip a bit somewhere on the cache file's list of primes
+ */
+static void corruptFile() {
+    FILE *pFile;
+    int c;
+
+    pFile = fopen(pPath, "r+b");
+    assert(pFile);
+    fseek(pFile, -5, SEEK_END);
+    c = fgetc(pFile);
+    fseek(pFile, -5, SEEK_END);
+    fputc(c ^ 0x10, pFile);
+    fclose(pFile);
+}
+
+int main(int argc, char *argv[]) {
+    fractionManagerConfig config;
+    fraction *pFrac;
+    int base, irv, num, numReference;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    /* Each round is much more expensive than on other tests */
+    num = num / 100 + 1;
+
+    sprintf(pPath, "/tmp/fraction_primes_%d.cache", (int)getpid());
+    unlink(pPath);
+
+    /* Register a function to clear the tables, even on assert failure */
+    atexit(do_clean);
+
+    /* Lists covered by the one embedded into the lib (if it was built with
+     * it) never use the file, so every other list must be bigger */
+    irv = prime_initTable(&table, 2, 1/*numThreads*/, 0/*maxBytes*/,
+            0/*isConcurrent*/);
+    assert(irv == 0);
+    base = table.isEmbedded ? table.maxChecked : 0;
+    prime_cleanTable(&table);
+    if (base > 0) {
+        irv = prime_initTableCached(&table, pPath, base, 1/*numThreads*/,
+                0/*maxBytes*/, 0/*isConcurrent*/);
+        assert(irv == 0);
+        assert(table.isEmbedded && !table.isMapped);
+        assert(access(pPath, F_OK) != 0);
+        prime_cleanTable(&table);
+    }
+
+    irv = prime_genPrimeList(&pReference, &numReference, base + MAX_VALUE +
+            1200000);
+    assert(irv == 0);
+
+    /* Missing files are created, and then mapped back */
+    irv = prime_mapCache(&table, pPath, 2);
+    assert(irv == 1);
+    irv = prime_initTableCached(&table, pPath, base + 100000,
+            1/*numThreads*/, 0/*maxBytes*/, 0/*isConcurrent*/);
+    assert(irv == 0);
+    assert(table.isMapped && table.maxChecked == base + 100000);
+    assertTable(&table, numReference);
+
+    /* Files with more primes than required are used as is */
+    irv = prime_initTableCached(&other, pPath, base + 5000, 1/*numThreads*/,
+            0/*maxBytes*/, 1/*isConcurrent*/);
+    assert(irv == 0);
+    assert(other.isMapped && other.maxChecked == base + 100000);
+    assertTable(&other, numReference);
+
+    /* Extending it replaces the mapped list (which stays mapped) */
+    irv = prime_ensure(&other, base + 300000);
+    assert(irv == 0);
+    assert(!other.isMapped && other.pMap != 0);
+    assertTable(&other, numReference);
+    prime_cleanTable(&other);
+
+    /* Tables that can't hold the cached list are sieved */
+    irv = prime_initTableCached(&other, pPath, 100, 1/*numThreads*/,
+            400/*maxBytes*/, 0/*isConcurrent*/);
+    assert(irv == 0);
+    assert(!other.isMapped && other.maxChecked == 100);
+    assertTable(&other, numReference);
+    prime_cleanTable(&other);
+
+    /* Files with too few primes are replaced (without affecting the tables
+     * that mapped them) */
+    irv = prime_initTableCached(&other, pPath, base + 200000,
+            2/*numThreads*/, 0/*maxBytes*/, 0/*isConcurrent*/);
+    assert(irv == 0);
+    assert(other.isMapped && other.maxChecked == base + 200000);
+    assertTable(&other, numReference);
+    assertTable(&table, numReference);
+    prime_cleanTable(&other);
+    prime_cleanTable(&table);
+
+    /* Corrupted files are rejected and replaced */
+    corruptFile();
+    irv = prime_mapCache(&table, pPath, 2);
+    assert(irv == 1);
+    irv = prime_initTableCached(&table, pPath, base + 150000,
+            1/*numThreads*/, 0/*maxBytes*/, 0/*isConcurrent*/);
+    assert(irv == 0);
+    assert(table.isMapped && table.maxChecked == base + 150000);
+    assertTable(&table, numReference);
+    prime_cleanTable(&table);
+
+    /* Managers may use files generated beforehand */
+    irv = fractionManager_genPrimeCache(pPath, 250000, 1/*numSieveThreads*/);
+    assert(irv == 0);
+    fractionManager_getDefaultConfig(&config);
+    config.maxNumberChecked = 1000;
+    config.pPrimeCachePath = pPath;
+    irv = fractionManager_initConfig(&pFMng, &config);
+    assert(irv == 0);
+    assert(pFMng);
+    irv = fractionManager_getFraction(&pFrac, pFMng, 2 * 3 * 7 * 199999,
+            3 * 199999);
+    assert(irv == 0);
+    fractionManager_releaseFraction(pFrac);
+    fractionManager_clean(&pFMng);
+
+    srand(time(0));
+
+    while (num > 0) {
+        int i, maxNumberChecked;
+
+        if (rand() % 4 == 0) {
+            unlink(pPath);
+        }
+        maxNumberChecked = base + rand() % 500000 + 1;
+        irv = prime_initTableCached(&table, pPath, maxNumberChecked,
+                rand() % 2 + 1, 0/*maxBytes*/, rand() % 2/*isConcurrent*/);
+        assert(irv == 0);
+        assert(table.isMapped && table.maxChecked >= maxNumberChecked);
+        assertTable(&table, numReference);
+
+        for (i = 0; i < 4; i++) {
+            int value;
+
+            value = base + rand() % MAX_VALUE;
+            irv = prime_ensure(&table, value);
+            assert(irv == 0);
+            assert(table.maxChecked >= value);
+            assertTable(&table, numReference);
+        }
+
+        prime_cleanTable(&table);
+        num--;
+    }
+
+    return 0;
+}
+
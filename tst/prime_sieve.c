@@ -0,0 +1,95 @@
+/**
+ * Simple test to check whether the list of primes is exact, no matter how
+ * many threads generated it
+ *
+ * @file tst/prime_sieve.c
+ */
+#include <fraction_internal/prime.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+static int *pList = 0;
+
+void do_clean() {
+    if (pList) {
+        free(pList);
+    }
+}
+
+/**
+ * Check whether a number is prime, through trial division
+ *
+ * @param  [ in]val The number
+ * @return          1 if it's prime, 0 otherwise
+ */
+static int isPrime(int val) {
+    int i;
+
+    if (val < 2) {
+        return 0;
+    }
+    for (i = 2; i * i <= val; i++) {
+        if (val % i == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int irv, num;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    /* Each round is much more expensive than on other tests */
+    num = num / 200 + 1;
+
+    /* Register a function to clear the list, even on assert failure */
+    atexit(do_clean);
+
+    srand(time(0));
+
+    while (num > 0) {
+        int i, len, max, prev;
+
+        /* Cover a few segments (of roughly 1.1 million numbers each) */
+        max = rand() % 2500000;
+        irv = prime_genPrimeListThreaded(&pList, &len, max, rand() % 4 + 1);
+        assert(irv == 0);
+
+        /* Every listed number must be prime, and nothing may be skipped */
+        prev = 1;
+        for (i = 0; i < len; i++) {
+            int j;
+
+            assert(pList[i] > prev);
+            for (j = prev + 1; j < pList[i]; j++) {
+                assert(!isPrime(j));
+            }
+            assert(isPrime(pList[i]));
+            prev = pList[i];
+        }
+        assert(prev <= max || (max < 2 && prev == 2));
+        for (i = prev + 1; i <= max; i++) {
+            assert(!isPrime(i));
+        }
+
+        free(pList);
+        pList = 0;
+        num--;
+    }
+
+    return 0;
+}
+
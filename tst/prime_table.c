@@ -0,0 +1,105 @@
+/**
+ * Simple test to check whether tables of primes grow correctly on demand
+ *
+ * @file tst/prime_table.c
+ */
+#include <fraction_internal/prime.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Biggest number ever checked by the test */
+#define MAX_VALUE 5000000
+
+static int *pReference = 0;
+static primeTable table;
+
+void do_clean() {
+    if (pReference) {
+        free(pReference);
+    }
+    prime_cleanTable(&table);
+}
+
+/**
+ * Check that the table contains exactly every prime up to its limit
+ *
+ * @param  [ in]numReference Number of primes on the reference list
+ */
+static void assertTable(int numReference) {
+    const int *pList;
+    int i, len;
+
+    prime_getList(&pList, &len, &table);
+    for (i = 0; i < len; i++) {
+        assert(pList[i] == pReference[i]);
+    }
+    assert(pList[len - 1] <= table.maxChecked);
+    assert(len == numReference || pReference[len] > table.maxChecked);
+}
+
+int main(int argc, char *argv[]) {
+    int irv, num, numReference;
+
+    num = 500;
+    if (argc == 2) {
+        char *pTmp;
+
+        num = 0;
+        pTmp = argv[1];
+        while (*pTmp) {
+            num = num * 10 + (*pTmp) - '0';
+            pTmp++;
+        }
+    }
+    /* Each round is much more expensive than on other tests */
+    num = num / 100 + 1;
+
+    /* Register a function to clear the tables, even on assert failure */
+    atexit(do_clean);
+
+    irv = prime_genPrimeList(&pReference, &numReference, MAX_VALUE +
+            1200000);
+    assert(irv == 0);
+
+    srand(time(0));
+
+    while (num > 0) {
+        int i;
+
+        irv = prime_initTable(&table, rand() % 1000, rand() % 2 + 1,
+                0/*maxBytes*/, rand() % 2/*isConcurrent*/);
+        assert(irv == 0);
+        assertTable(numReference);
+
+        /* Grow it, checking every number (even those already covered) */
+        for (i = 0; i < 8; i++) {
+            int value;
+
+            value = rand() % MAX_VALUE;
+            irv = prime_ensure(&table, value);
+            assert(irv == 0);
+            assert(table.maxChecked >= value);
+            assertTable(numReference);
+        }
+
+        prime_cleanTable(&table);
+        num--;
+    }
+
+    /* Check that the table never grows bigger than its maximum size */
+    irv = prime_initTable(&table, 100, 1/*numThreads*/, 400000/*maxBytes*/,
+            0/*isConcurrent*/);
+    assert(irv == 0);
+    irv = prime_ensure(&table, 1000000);
+    assert(irv == 0);
+    irv = prime_ensure(&table, 3000000);
+    assert(irv != 0);
+    assert(table.maxChecked >= 1000000 && table.maxChecked < 3000000);
+    assert(table.capPrimes * (int)sizeof(int) <= 400000);
+    assertTable(numReference);
+
+    return 0;
+}
+